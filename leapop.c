@@ -34,7 +34,20 @@
 #include <limits.h>
 #if defined WIN32 || _WIN32 || WIN64 || _WIN64
 #include <windows.h>
+#include <io.h>
 #undef PlaySound
+#else
+#include <sys/mman.h>
+#endif
+#if defined __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
 #endif
 
 #include <SDL.h>
@@ -48,6 +61,7 @@
 #if defined WIN32 || _WIN32 || WIN64 || _WIN64
 #define SLASH "\\"
 #define DEVNULL "NUL"
+#define fsync _commit
 #else
 #define SLASH "/"
 #define DEVNULL "/dev/null"
@@ -65,10 +79,13 @@
 #define EVENTS 256
 #define DISK_DIR_A "disk_appleii"
 #define BACKUP_A DISK_DIR_A SLASH "disk.bak"
+#define JOURNAL_A DISK_DIR_A SLASH "disk.jnl"
 #define DISK_DIR_B "disk_bbcmaster"
 #define BACKUP_B DISK_DIR_B SLASH "disk.bak"
+#define JOURNAL_B DISK_DIR_B SLASH "disk.jnl"
 #define DISK_DIR_C "disk_c64"
 #define BACKUP_C DISK_DIR_C SLASH "disk.bak"
+#define JOURNAL_C DISK_DIR_C SLASH "disk.jnl"
 #define MAX_PATHFILE 200
 #define MAX_TOWRITE 720
 #define WINDOW_WIDTH 560 + 2 + 50 /*** 612 ***/
@@ -80,17 +97,51 @@
 #define FONT_SIZE_15 15
 #define FONT_SIZE_11 11
 #define FONT_SIZE_20 20
+#define GLYPH_FIRST 32 /*** Space; the glyphs are printable ASCII. ***/
+#define GLYPHS 95
+#define GLYPHS_WIDTH 512 /*** Of the texture with the glyphs of a font. ***/
 #define NUM_SOUNDS 20 /*** Sounds that may play at the same time. ***/
+#define SOUNDS 30 /*** Converted sounds in the bank. ***/
+#define AUDIO_COMMANDS 64 /*** One slot always stays empty. ***/
+#define MIX_SAMPLES 1024 /*** Per pass of the mixer; 512 stereo frames. ***/
+#define AUDIO_PLAY 1
+#define AUDIO_VOLUME 2
 #define MAX_TEXT 100
 #define ADJ_BASE_X 339
 #define ADJ_BASE_Y 63
 #define MAX_OPTION 100
 #define MAX_WARNING 200
 #define MAX_ERROR 200
-#define MAX_INFO 200
 #define TABS_GUARD 8
 #define TABS_LEVEL 15
 #define BAR_FULL 437
+#define COPY_BUFFER 65536
+#define BACKUP_DIR "backups"
+#define BACKUP_KEEP 50 /*** Versions. ***/
+#define BACKUP_RANGES 40
+#define BACKUP_HASH 16
+#define BACKUP_LIST ((BACKUP_RANGES * 64) + MAX_TEXT) /*** NNNNN.txt size. ***/
+#define JOURNAL_MAGIC "LPJ1"
+#define JOURNAL_SIZE 131072 /*** Bytes. ***/
+#define UNDO_DELTAS 100000 /*** Must exceed sizeof (struct level). ***/
+#define UNDO_STEPS 4096
+#define TILE_ENTRIES 128 /*** Tile/mod pairs with an image. ***/
+#define TILE_MAX 0x3F /*** Highest tile in arTileEntry, with the X-bit. ***/
+#define IMAGES 600
+#define ATLAS_SIZE 2048 /*** Width and height of a page, in pixels. ***/
+#define ATLAS_PAGES 16
+#define ATLAS_GROUPS 3 /*** Various, dungeon, palace. ***/
+#define BATCH_QUADS 1024
+#define ATLAS_BYTES (ATLAS_SIZE * ATLAS_SIZE * 4) /*** Of a page; RGBA. ***/
+#define ATLAS_CACHE "atlas.cache"
+#define ATLAS_MAGIC "LPA4"
+#define ATLAS_PATH 64 /*** Bytes of the PNG path in a cache entry. ***/
+#define ATLAS_ENTRY (ATLAS_PATH + 36)
+#define DECODE_THREADS 8 /*** At most; one per core. ***/
+#define ATLAS_EVICT 20000 /*** Unused ms before a page of the other env. ***/
+#define ATLAS_SELECTED "*" /*** Appended to the path of a selected image. ***/
+#define CELL_WIDTH 117
+#define CELL_HEIGHT 146
 
 /*** Apple II: adamgreen (A0) ***/
 #define A0_PRODOS_OFFSET_1 0x103
@@ -137,7 +188,6 @@
 
 #define PNG_VARIOUS "various"
 #define PNG_LIVING "living"
-#define PNG_SLIVING "sliving"
 #define PNG_BUTTONS "buttons"
 #define PNG_EXTRAS "extras"
 #define PNG_ROOMS "rooms"
@@ -149,6 +199,10 @@
 #define TTPD_O 20 /*** Other rows, pixels behind superjacent rows. ***/
 #define DD_X 56 /*** Horizontal distance between (overlapping) tiles. ***/
 #define DD_Y 126 /*** Vertical distance between (overlapping) tiles. ***/
+#define FLAME_X 71 /*** Part of tile 0x13 that changes between frames. ***/
+#define FLAME_Y 21
+#define FLAME_WIDTH 21
+#define FLAME_HEIGHT 33
 
 #define TILEWIDTH 42 /*** On tiles screen. ***/
 #define TILEHEIGHT 52 /*** On tiles screen. ***/
@@ -185,7 +239,15 @@ char sPathFileA[MAX_PATHFILE + 2];
 char sPathFileB[MAX_PATHFILE + 2];
 char sPathFileC[MAX_PATHFILE + 2];
 char sPathFile[MAX_PATHFILE + 2];
+unsigned char *arDiskImage; /*** The mapped (or, on Windows, read) file. ***/
+unsigned long ulDiskImageSize;
+char sDiskImage[MAX_PATHFILE + 2];
+int iFdDiskImage;
+unsigned char arJournal[JOURNAL_SIZE + 2];
+int iJournalSize;
+int iJournalRanges;
 int iChanged;
+int arLevelChanged[LEVELS + 2];
 int iScreen;
 TTF_Font *font1;
 TTF_Font *font2;
@@ -242,11 +304,26 @@ int iStartLevel;
 int iCustomX, iCustomTile, iCustomMod;
 int iCustomHover, iCustomHoverOld;
 int iEmulator;
-char sInfo[MAX_INFO + 2];
 int iNoAnim;
+int iFullBAK; /*** 1 = --bak; saves also copy the image to disk.bak ***/
 int iFlameFrame;
-int cChecksum;
 Uint32 oldticks, newticks;
+SDL_Texture *frametex; /*** ShowScreen() draws here; NULL = on the window ***/
+int iFrameW, iFrameH;
+SDL_Rect flames; /*** Around the shown flames, scaled. ***/
+int iFlames;
+SDL_Rect damage; /*** Scaled. ***/
+int iDamage; /*** 1 = ShowScreen() only draws damage again. ***/
+SDL_Texture *roomtex; /*** See RoomLayer(); NULL = none ***/
+int iRoomW, iRoomH, iRoomValid;
+int iRoomLevel, iRoomRoom, iRoomGuard, iRoomInfo;
+char cRoomType;
+SDL_Rect roomflames; /*** The flames in roomtex, scaled. ***/
+int iRoomFlames;
+SDL_Rect arRoomBox[TILES + 2]; /*** What each location shows, scaled. ***/
+int iRoomSelected;
+SDL_Rect track; /*** Around what BatchImage() got, if iTrack is 1. ***/
+int iTrack;
 int iMouse;
 int iGuardTooltip;
 int iEventHover;
@@ -262,6 +339,7 @@ int iC64;
 int iOnC64;
 int iHomeComputerActive;
 int iModified;
+SDL_atomic_t aGameDone; /*** Set by StartGame(), cleared by GameDone(). ***/
 
 /*** EXE ***/
 int iEXEPrinceHP;
@@ -518,12 +596,19 @@ SDL_Color color_bl = {0x00, 0x00, 0x00, 255};
 SDL_Color color_wh = {0xff, 0xff, 0xff, 255};
 SDL_Color color_blue = {0x00, 0x00, 0xff, 255};
 SDL_Color color_gray = {0xbf, 0xbf, 0xbf, 255};
-SDL_Surface *message;
-SDL_Texture *messaget;
+struct glyphs {
+	SDL_Texture *tex;
+	int iW, iH; /*** Of tex. ***/
+	SDL_Rect arGlyph[GLYPHS + 2]; /*** On tex; GLYPHS is a white block. ***/
+	int arShift[GLYPHS + 2]; /*** From the pen to the left of arGlyph. ***/
+	int arAdvance[GLYPHS + 2];
+	int arKern[GLYPHS + 2][GLYPHS + 2]; /*** [left][right] ***/
+	int iHeight;
+};
+struct glyphs glyphs1, glyphs2, glyphs3; /*** Of font1, font2, font3. ***/
 SDL_Rect offset;
 
 /*** for copying ***/
-int arCopyPasteX[TILES + 2];
 unsigned char arCopyPasteTile[TILES + 2];
 unsigned char arCopyPasteMod[TILES + 2];
 unsigned char cCopyPasteGuardTile;
@@ -542,127 +627,232 @@ Uint32 trigleft, trigright;
 int iXJoy1, iYJoy1, iXJoy2, iYJoy2;
 
 /*** These are the levels. ***/
-int arRoomX[LEVELS + 2][ROOMS + 2][TILES + 2];
-unsigned char arRoomTiles[LEVELS + 2][ROOMS + 2][TILES + 2];
-unsigned char arRoomMod[LEVELS + 2][ROOMS + 2][TILES + 2];
-unsigned char arEventsRoom[LEVELS + 2][EVENTS + 2];
-unsigned char arEventsTile[LEVELS + 2][EVENTS + 2];
-int arEventsNext[LEVELS + 2][EVENTS + 2];
-unsigned char arEventsTimer[LEVELS + 2][EVENTS + 2];
-unsigned char arRoomLinks[LEVELS + 2][ROOMS + 2][4 + 2];
-unsigned char arBytes64[LEVELS + 2][64 + 2];
-unsigned char arStartLocation[LEVELS + 2][3 + 2];
-unsigned char arBytes4[LEVELS + 2][4 + 2];
-unsigned char arGuardTile[LEVELS + 2][ROOMS + 2];
-unsigned char arGuardDir[LEVELS + 2][ROOMS + 2];
-unsigned char arGuardUnk1[LEVELS + 2][ROOMS + 2]; /*** GdStartX ***/
-unsigned char arGuardUnk2[LEVELS + 2][ROOMS + 2]; /*** GdStartSeqL ***/
-unsigned char arGuardSkill[LEVELS + 2][ROOMS + 2];
-unsigned char arGuardUnk3[LEVELS + 2][ROOMS + 2]; /*** GdStartSeqH ***/
-unsigned char arGuardC[LEVELS + 2][ROOMS + 2]; /*** ? ***/
-unsigned char arBytes16[LEVELS + 2][16 + 2];
+struct room {
+	unsigned char arTile[TILES + 2]; /*** With the X-bit (32). ***/
+	unsigned char arMod[TILES + 2];
+	unsigned char arLink[4 + 2];
+	unsigned char cGuardTile;
+	unsigned char cGuardDir;
+	unsigned char cGuardUnk1; /*** GdStartX ***/
+	unsigned char cGuardUnk2; /*** GdStartSeqL ***/
+	unsigned char cGuardSkill;
+	unsigned char cGuardUnk3; /*** GdStartSeqH ***/
+	unsigned char cGuardC; /*** ? ***/
+};
+struct event {
+	unsigned char cRoom;
+	unsigned char cTile;
+	unsigned char cNext;
+	unsigned char cTimer;
+};
+struct level {
+	struct room arRoom[ROOMS + 2];
+	struct event arEvent[EVENTS + 2];
+	unsigned char arStartLocation[3 + 2];
+	unsigned char arBytes64[64 + 2];
+	unsigned char arBytes4[4 + 2];
+	unsigned char arBytes16[16 + 2];
+};
+struct level arLevels[LEVELS + 2];
+struct level arPristine[LEVELS + 2];
+struct level arUndoShadow[LEVELS + 2];
+struct level stRoomLevel; /*** What roomtex shows; see RoomLayer(). ***/
+
+/* Deltas and steps are numbered from 0 up, and are kept in rings; number
+ * modulo UNDO_DELTAS (UNDO_STEPS) is the slot. The deltas of a step are
+ * consecutive. When a ring is full, the oldest step and its deltas go.
+ */
+struct undo {
+	int iLevel;
+	int iFirst, iLast; /*** Deltas; iLast is one past the step. ***/
+	int iPrev, iNext; /*** Steps of the same level; -1 = none. ***/
+};
+unsigned short arUndoIndex[UNDO_DELTAS + 2]; /*** Byte in struct level. ***/
+unsigned char arUndoOld[UNDO_DELTAS + 2];
+unsigned char arUndoNew[UNDO_DELTAS + 2];
+struct undo arUndo[UNDO_STEPS + 2];
+int iUndoDeltas, iUndoOldestDelta;
+int iUndoSteps, iUndoOldest;
+int iUndoOpen; /*** The step that new deltas go to; -1 = none. ***/
+int arUndoDone[LEVELS + 2]; /*** Newest step to undo, per level. ***/
+int arUndoRedo[LEVELS + 2]; /*** Oldest step to redo, per level. ***/
+int arUndoSlot[sizeof (struct level) + 2]; /*** Delta of a byte. ***/
 
 int iDX, iDY, iTTP1, iTTPO;
 int iHor[10 + 2];
 int iVer0, iVer1, iVer2, iVer3, iVer4;
 
-SDL_Texture *imgloading;
-SDL_Texture *imgd[0xFF + 2][0xFF + 2][2 + 2];
-SDL_Texture *imgp[0xFF + 2][0xFF + 2][2 + 2];
-SDL_Texture *imgblack;
-SDL_Texture *imgprincel[2 + 2], *imgprincer[2 + 2];
-SDL_Texture *imgguardl[2 + 2], *imgguardr[2 + 2];
-SDL_Texture *imgskell[2 + 2], *imgskelr[2 + 2];
-SDL_Texture *imgfatl[2 + 2], *imgfatr[2 + 2];
-SDL_Texture *imgshadowl[2 + 2], *imgshadowr[2 + 2];
-SDL_Texture *imgjaffarl[2 + 2], *imgjaffarr[2 + 2];
-SDL_Texture *imgdisabled;
-SDL_Texture *imgunk[2 + 2];
-SDL_Texture *imgup_0;
-SDL_Texture *imgup_1;
-SDL_Texture *imgdown_0;
-SDL_Texture *imgdown_1;
-SDL_Texture *imgleft_0;
-SDL_Texture *imgleft_1;
-SDL_Texture *imgright_0;
-SDL_Texture *imgright_1;
-SDL_Texture *imgudno;
-SDL_Texture *imglrno;
-SDL_Texture *imgudnonfo;
-SDL_Texture *imgprevon_0;
-SDL_Texture *imgprevon_1;
-SDL_Texture *imgnexton_0;
-SDL_Texture *imgnexton_1;
-SDL_Texture *imgprevoff;
-SDL_Texture *imgnextoff;
-SDL_Texture *imgbara, *imgbarb, *imgbarc;
-SDL_Texture *imgextras[10 + 2];
-SDL_Texture *imgroomson_0;
-SDL_Texture *imgroomson_1;
-SDL_Texture *imgroomsoff;
-SDL_Texture *imgbroomson_0;
-SDL_Texture *imgbroomson_1;
-SDL_Texture *imgbroomsoff;
-SDL_Texture *imgeventson_0;
-SDL_Texture *imgeventson_1;
-SDL_Texture *imgeventsoff;
-SDL_Texture *imgsaveon_0;
-SDL_Texture *imgsaveon_1;
-SDL_Texture *imgsaveoff;
-SDL_Texture *imgquit_0;
-SDL_Texture *imgquit_1;
-SDL_Texture *imgrl;
-SDL_Texture *imgbrl;
-SDL_Texture *imgsrc;
-SDL_Texture *imgsrs;
-SDL_Texture *imgsrm;
-SDL_Texture *imgsrp;
-SDL_Texture *imgsrb;
-SDL_Texture *imgevents;
-SDL_Texture *imgsele;
-SDL_Texture *imgeventu;
-SDL_Texture *imgsell;
-SDL_Texture *imgdungeon;
-SDL_Texture *imgpalace;
-SDL_Texture *imgclosebig_0;
-SDL_Texture *imgclosebig_1;
-SDL_Texture *imgborderb;
-SDL_Texture *imgborders;
-SDL_Texture *imgbordersl;
-SDL_Texture *imgborderbl;
-SDL_Texture *imgfadedl;
-SDL_Texture *imgpopup;
-SDL_Texture *imgok[2 + 2];
-SDL_Texture *imgsave[2 + 2];
-SDL_Texture *imgpopup_yn;
-SDL_Texture *imgyes[2 + 2];
-SDL_Texture *imgno[2 + 2];
-SDL_Texture *imghelp;
-SDL_Texture *imgexe;
-SDL_Texture *imgfadeds;
-SDL_Texture *imgroom[24 + 2];
-SDL_Texture *imgchover;
-SDL_Texture *imgemulator;
-SDL_Texture *imgspriteflamed;
-SDL_Texture *imgspriteflamep;
-SDL_Texture *imgexetab;
-SDL_Texture *imgexetabs;
-SDL_Texture *imgexeenvok;
-SDL_Texture *imgexeenvwarn;
-SDL_Texture *imgmouse;
-SDL_Texture *imgtooltipg;
-SDL_Texture *imgpreviewb;
-SDL_Texture *imgeventh;
-SDL_Texture *imghc;
-SDL_Texture *imghcadis, *imghcaoff, *imghcaon, *imghcalb;
-SDL_Texture *imghcbdis, *imghcboff, *imghcbon, *imghcblb;
-SDL_Texture *imghccdis, *imghccoff, *imghccon, *imghcclb;
+struct image {
+	int iPage;
+	SDL_Rect rect; /*** On the page. ***/
+};
+struct image arImages[IMAGES + 2];
+int iImages;
+SDL_Surface *arAtlasSurface[ATLAS_PAGES + 2];
+SDL_Texture *arAtlasTex[ATLAS_PAGES + 2];
+int arAtlasDirty[ATLAS_PAGES + 2];
+int arAtlasX[ATLAS_PAGES + 2];
+int arAtlasY[ATLAS_PAGES + 2];
+int arAtlasShelf[ATLAS_PAGES + 2];
+int arAtlasGroupPage[ATLAS_GROUPS + 2];
+int arAtlasGroup[ATLAS_PAGES + 2]; /*** 0 = unknown ***/
+Uint32 arAtlasUsed[ATLAS_PAGES + 2]; /*** SDL_GetTicks() ***/
+int iAtlasPages, iAtlasComplete;
+char arImageFile[IMAGES + 2][ATLAS_PATH + 2]; /*** If not from the cache. ***/
+unsigned char *arAtlasCache;
+unsigned long ulAtlasCacheSize;
+unsigned long ulAtlasCachePixels; /*** Offset of the first page. ***/
+int iAtlasCachePages, iAtlasCacheEntries, iAtlasCacheNext, iAtlasCacheStale;
+struct decode {
+	char sImage[MAX_IMG + 2];
+	int iGroup;
+	struct image **imgImage; /*** Set when added to the atlas. ***/
+	struct image **imgSelected; /*** NULL, or also make the selected look. ***/
+	SDL_Surface *surface;
+	SDL_Surface *selected;
+	char sError[MAX_ERROR + 2];
+	int iBackground; /*** Not shown by the loading bar. ***/
+	int iDone;
+};
+struct decode arDecode[IMAGES + 2];
+int iDecodes, iDecodeNext, iDecodeAdded, iDecodeQuit, iDecodeBackground;
+SDL_Thread *arDecodeThread[DECODE_THREADS + 2];
+int iDecodeThreads;
+SDL_mutex *decodemutex;
+SDL_cond *decodejob, *decodedone;
+SDL_Rect arBatchSrc[BATCH_QUADS + 2];
+SDL_Rect arBatchDst[BATCH_QUADS + 2];
+int arBatchFlip[BATCH_QUADS + 2];
+int iBatchQuads, iBatchPage;
+#if SDL_VERSION_ATLEAST(2,0,18)
+SDL_Vertex arBatchVertex[(BATCH_QUADS * 4) + 2];
+int arBatchIndex[(BATCH_QUADS * 6) + 2];
+#endif
 
+struct image *imgloading;
+unsigned char arTileEntry[TILE_MAX + 2][0xFF + 2]; /*** 0 = unknown ***/
+struct image *arTileImg[2 + 2][TILE_ENTRIES + 2][2 + 2]; /*** d/p, entry, sel ***/
+int iTileEntries;
+struct image *imgblack;
+struct living {
+	struct image *img[2 + 2]; /*** 1 = normal, 2 = selected; looks right ***/
+	int iHorL, iHorR; /*** Per direction; looking left is drawn mirrored. ***/
+	int iVer;
+};
+struct living livprince, livguard, livskel, livfat, livshadow, livjaffar;
+struct image *imgdisabled;
+struct image *imgunk[2 + 2];
+struct image *imgup_0;
+struct image *imgup_1;
+struct image *imgdown_0;
+struct image *imgdown_1;
+struct image *imgleft_0;
+struct image *imgleft_1;
+struct image *imgright_0;
+struct image *imgright_1;
+struct image *imgudno;
+struct image *imglrno;
+struct image *imgudnonfo;
+struct image *imgprevon_0;
+struct image *imgprevon_1;
+struct image *imgnexton_0;
+struct image *imgnexton_1;
+struct image *imgprevoff;
+struct image *imgnextoff;
+struct image *imgbara, *imgbarb, *imgbarc;
+struct image *imgextras[10 + 2];
+struct image *imgroomson_0;
+struct image *imgroomson_1;
+struct image *imgroomsoff;
+struct image *imgbroomson_0;
+struct image *imgbroomson_1;
+struct image *imgbroomsoff;
+struct image *imgeventson_0;
+struct image *imgeventson_1;
+struct image *imgeventsoff;
+struct image *imgsaveon_0;
+struct image *imgsaveon_1;
+struct image *imgsaveoff;
+struct image *imgquit_0;
+struct image *imgquit_1;
+struct image *imgrl;
+struct image *imgbrl;
+struct image *imgsrc;
+struct image *imgsrs;
+struct image *imgsrm;
+struct image *imgsrp;
+struct image *imgsrb;
+struct image *imgevents;
+struct image *imgsele;
+struct image *imgeventu;
+struct image *imgsell;
+struct image *imgdungeon;
+struct image *imgpalace;
+struct image *imgclosebig_0;
+struct image *imgclosebig_1;
+struct image *imgborderb;
+struct image *imgborders;
+struct image *imgbordersl;
+struct image *imgborderbl;
+struct image *imgfadedl;
+struct image *imgpopup;
+struct image *imgok[2 + 2];
+struct image *imgsave[2 + 2];
+struct image *imgpopup_yn;
+struct image *imgyes[2 + 2];
+struct image *imgno[2 + 2];
+struct image *imghelp;
+struct image *imgexe;
+struct image *imgfadeds;
+struct image *imgroom[24 + 2];
+struct image *imgchover;
+struct image *imgemulator;
+struct image *imgspriteflamed;
+struct image *imgspriteflamep;
+struct image *imgexetab;
+struct image *imgexetabs;
+struct image *imgexeenvok;
+struct image *imgexeenvwarn;
+struct image *imgmouse;
+struct image *imgtooltipg;
+struct image *imgpreviewb;
+struct image *imgeventh;
+struct image *imghc;
+struct image *imghcadis, *imghcaoff, *imghcaon, *imghcalb;
+struct image *imghcbdis, *imghcboff, *imghcbon, *imghcblb;
+struct image *imghccdis, *imghccoff, *imghccon, *imghcclb;
+
+/*** Voices; only MixAudio() touches these. ***/
 struct sample {
 	Uint8 *data;
 	Uint32 dpos;
 	Uint32 dlen;
+	int iGain;
 } sounds[NUM_SOUNDS];
+int arActive[NUM_SOUNDS + 2]; /*** Voices that are playing. ***/
+int iActive;
+int iVolume;
+Sint32 arMix[MIX_SAMPLES + 2];
+int iMasterVolume; /*** In percent; -m=NR. ***/
+
+/* Commands from the main thread to the audio callback. Only the main
+ * thread moves the head, and only the callback moves the tail.
+ */
+struct command {
+	int iType;
+	Uint8 *data;
+	Uint32 dlen;
+	int iVolume;
+} arCommand[AUDIO_COMMANDS];
+SDL_atomic_t aCommandHead, aCommandTail;
+
+/*** Sound bank; converted to the device format once. ***/
+struct sound {
+	char sFile[MAX_PATHFILE + 2];
+	Uint8 *data;
+	Uint32 dlen;
+} arSound[SOUNDS + 2];
+int iSounds;
 
 void ShowUsage (void);
 int GetPathFileA (void);
@@ -679,11 +869,66 @@ void InitScreen (void);
 void InitPopUpSave (void);
 void ShowPopUpSave (void);
 void LoadFonts (void);
+void LoadGlyphs (TTF_Font *font, struct glyphs *gly);
 void MixAudio (void *unused, Uint8 *stream, int iLen);
+void MixVoice (Sint32 *arAcc, Sint16 *arSrc, int iSamples, int iGain);
+void MixOut (Sint16 *arOut, Sint32 *arAcc, int iSamples);
 void PlaySound (char *sFile);
+void PlaySoundGain (char *sFile, int iGain);
+void SetVolume (int iNewVolume);
+void ChangeVolume (int iChange);
+int SendAudio (struct command *cmd);
+void TakeAudio (void);
+void PreLoadSounds (void);
+struct sound *LoadSound (char *sFile);
+void PreLoadTiles (char cTypeP);
 void PreLoadSet (char cTypeP, int iTile, int iMod);
-void PreLoad (char *sPath, char *sPNG, SDL_Texture **imgImage);
+int TileEntry (int iTile, int iMod);
+struct image *TileImage (int iEntry, int iGreen);
+void PreLoad (char *sPath, char *sPNG, struct image **imgImage);
+void PreLoadLiving (char *sPNG, struct living *liv,
+	int iHorL, int iHorR, int iVer);
+void PreLoadBar (void);
+void AtlasLoad (int iGroup, char *sImage, struct image **imgImage,
+	struct image **imgSelected);
+SDL_Surface *Highlight (SDL_Surface *surface, int iCell);
+int InCell (int iX, int iY);
+int SelectedPNG (char *sImage, char *sPNG);
+struct image *AtlasAdd (int iGroup, SDL_Surface *surface);
+void AtlasUpload (int iPage);
+void AtlasDone (void);
+void AtlasComplete (void);
+void AtlasEvict (void);
+void AtlasCacheOpen (void);
+int AtlasCacheValid (void);
+struct image *AtlasCacheFind (char *sImage);
+void AtlasCachePut (unsigned char *sBytes, unsigned long ulValue);
+void AtlasCacheWrite (void);
+void AtlasCacheClose (void);
+int AtlasStat (char *sImage, struct stat *stStat);
+void DecodeStart (void);
+void DecodeQueue (int iGroup, char *sImage, struct image **imgImage,
+	struct image **imgSelected);
+int DecodeThread (void *unused);
+void DecodeWait (int iJobs);
+void DecodePoll (void);
+void DecodeStop (void);
+void BatchImage (struct image *img, SDL_Rect *loc, SDL_Rect *dest,
+	int iFlip);
+void BatchFlush (void);
+#if SDL_VERSION_ATLEAST(2,0,18)
+void BatchQuad (int iQuad, SDL_Rect *src, SDL_Rect *dst, int iTexW,
+	int iTexH, int iFlip, SDL_Color color);
+#endif
 void ShowScreen (void);
+void ShowRoom (void);
+void RoomLayer (void);
+int RoomChanged (void);
+void RoomBox (SDL_Rect *box);
+void ShowFlames (void);
+void FrameStart (void);
+void FrameEnd (void);
+int Damaged (SDL_Rect *rect);
 void InitPopUp (void);
 void ShowPopUp (void);
 void Help (void);
@@ -693,11 +938,12 @@ void ShowEXE (void);
 void InitScreenAction (char *sAction);
 void RunLevel (int iLevel);
 int StartGame (void *unused);
+void GameDone (void);
 void ClearRoom (void);
 void UseTile (int iTile, int iLocation, int iRoom);
 void Zoom (int iToggleFull);
 void LinkMinus (void);
-int BrokenRoomLinks (int iPrint);
+int BrokenRoomLinks (int iLevel, int iPrint);
 void ChangeEvent (int iAmount, int iChangePos);
 void ChangeCustom (int iAmount, int iType);
 void Prev (void);
@@ -715,15 +961,21 @@ void ChangePos (void);
 void RemoveOldRoom (void);
 void AddNewRoom (int iX, int iY, int iRoom);
 void LinkPlus (void);
-void ShowImage (SDL_Texture *img, int iX, int iY, char *sImageInfo);
+void ShowImage (struct image *img, int iX, int iY, char *sImageInfo);
+void ShowTile (int iTile, int iMod, int iX, int iY, int iGreen);
+void ShowLiving (struct living *liv, int iX, int iY, int iDir, int iGreen,
+	char *sImageInfo);
 void CustomRenderCopy (SDL_Texture* src, SDL_Rect* srcrect,
 	SDL_Rect *dstrect, char *sImageInfo);
 void CreateBAK (void);
+int CopyDiskImage (int iFdFrom, int iFdTo);
 void DisplayText (int iStartX, int iStartY, int iFontSize,
-	char arText[9 + 2][MAX_TEXT + 2], int iLines, TTF_Font *font);
+	char arText[9 + 2][MAX_TEXT + 2], int iLines, struct glyphs *gly);
+void ShowText (struct glyphs *gly, char *sText, int iX, int iY,
+	SDL_Color fore, SDL_Color *back);
 void InitRooms (void);
 void WhereToStart (void);
-void CheckSides (int iRoom, int iX, int iY);
+void CheckSides (int iLevel, int iRoom, int iX, int iY);
 void ShowRooms (int iRoom, int iX, int iY, int iNext);
 void BrokenRoomChange (int iRoom, int iSide, int *iX, int *iY);
 void ShowChange (void);
@@ -740,11 +992,12 @@ void EXESave (void);
 int PlusMinus (int *iWhat, int iX, int iY,
 	int iMin, int iMax, int iChange, int iAddChanged);
 void GetOptionValue (char *sArgv, char *sValue);
-int BitsToInt (char *sString);
-void IntToBits (int iInt, char *sOutput, int iBits);
-void GetAsEightBits (unsigned char cChar, char *sBinary);
-int ChecksumOrWrite (int iFd, int iLevel);
-int Verify (int iFd, int iOffset, char *sText);
+void BytesToEvent (int iLevel, int iEvent,
+	unsigned char cFDoors, unsigned char cSDoors);
+void EventToBytes (int iLevel, int iEvent,
+	unsigned char *cFDoors, unsigned char *cSDoors);
+int LevelToBytes (int iLevel, unsigned char *sBytes);
+int Verify (int iOffset, char *sText);
 void GetTileMod (int iGetRoom, int iGetTile, int *iTile, int *iMod);
 void GetTileModChange (int iGetTile, int *iTile, int *iMod);
 void ApplySkillIfNecessary (int iTile);
@@ -754,6 +1007,45 @@ void HomeComputer (void);
 void ShowHomeComputer (void);
 void PlaytestStart (int iLevel);
 void PlaytestStop (void);
+void LevelChanged (void);
+unsigned long OffsetFor (const unsigned long *ulA, const unsigned long *ulB,
+	const unsigned long *ulC);
+int BackupRanges (unsigned long *arOffset, int *arSize);
+void BackupHash (unsigned char *sBytes, int iSize, char *sHash);
+void BackupDir (char *sDir);
+int BackupNewest (char *sDir, int *iOldest);
+int BackupRead (char *sDir, int iVersion, char *sTime,
+	unsigned long *arOffset, int *arSize, char arHash[][BACKUP_HASH + 2]);
+void BackupVersion (void);
+int BackupWrite (char *sFile, unsigned char *sBytes, int iSize);
+void BackupClean (char *sDir);
+void BackupList (void);
+void BackupRestore (int iVersion);
+void Backups (int iList, int iRestore);
+void JournalStart (void);
+void JournalAdd (unsigned long ulOffset, unsigned char *sBytes, int iSize);
+unsigned long JournalNumber (unsigned char *sBytes);
+int JournalValid (unsigned char *sJournal, int iSize);
+int JournalApply (char *sPath, unsigned char *sJournal, int iSize);
+void JournalFile (char *sJournal);
+void JournalCommit (void);
+void JournalReplay (char *sPath, char *sJournal);
+int SyncDir (char *sPath);
+void UndoReset (void);
+void UndoForget (int iLevel);
+int UndoValid (int iStep);
+void UndoDrop (void);
+void UndoOpen (int iLevel);
+void UndoRecord (void);
+void UndoStep (void);
+void UndoApply (int iLevel, int iDelta, int iRedo);
+void UndoRedo (int iRedo);
+void LevelType (int iLevel);
+void LevelPristine (int iLevel, int iRestore);
+void DiscardChanges (int iAtLevel);
+int DiskImageOpen (char *sPath);
+void DiskImageClose (void);
+unsigned char DiskImageRead (unsigned long ulOffset);
 
 /*****************************************************************************/
 int main (int argc, char *argv[])
@@ -763,6 +1055,10 @@ int main (int argc, char *argv[])
 	SDL_version verc, verl;
 	time_t tm;
 	char sStartLevel[MAX_OPTION + 2];
+	char sRestore[MAX_OPTION + 2];
+	char sVolume[MAX_OPTION + 2];
+	int iListBackups;
+	int iRestore;
 
 	iDebug = 0;
 	iExtras = 0;
@@ -775,6 +1071,7 @@ int main (int argc, char *argv[])
 	iOnTileOld = 1;
 	iCopied = 0;
 	iNoAudio = 0;
+	iMasterVolume = 100;
 	iFullscreen = 0;
 	iNoController = 0;
 	iStartLevel = 1;
@@ -783,11 +1080,25 @@ int main (int argc, char *argv[])
 	iCustomMod = 0x00;
 	iEmulator = 0;
 	iNoAnim = 0;
+	iFullBAK = 0;
 	iMouse = 0;
 	iGuardTooltip = 0;
 	iEventHover = 0;
 	iHomeComputer = 0;
 	iModified = 0;
+	SDL_AtomicSet (&aGameDone, 0);
+	iListBackups = 0;
+	iRestore = 0;
+	iJournalSize = 0;
+	iJournalRanges = 0;
+	iUndoDeltas = 0;
+	iUndoOldestDelta = 0;
+	iUndoSteps = 0;
+	iUndoOldest = 0;
+	iUndoOpen = -1;
+	arDiskImage = NULL;
+	ulDiskImageSize = 0;
+	iFdDiskImage = -1;
 
 	if (argc > 1)
 	{
@@ -815,6 +1126,14 @@ int main (int argc, char *argv[])
 			{
 				iNoAudio = 1;
 			}
+			else if ((strncmp (argv[iArgLoop], "-m=", 3) == 0) ||
+				(strncmp (argv[iArgLoop], "--volume=", 9) == 0))
+			{
+				GetOptionValue (argv[iArgLoop], sVolume);
+				iMasterVolume = atoi (sVolume);
+				if ((iMasterVolume < 0) || (iMasterVolume > 100))
+					{ ShowUsage(); }
+			}
 			else if ((strcmp (argv[iArgLoop], "-z") == 0) ||
 				(strcmp (argv[iArgLoop], "--zoom") == 0))
 			{
@@ -860,6 +1179,23 @@ int main (int argc, char *argv[])
 			{
 				iHomeComputer = 3;
 			}
+			else if ((strcmp (argv[iArgLoop], "-u") == 0) ||
+				(strcmp (argv[iArgLoop], "--backups") == 0))
+			{
+				iListBackups = 1;
+			}
+			else if ((strcmp (argv[iArgLoop], "-i") == 0) ||
+				(strcmp (argv[iArgLoop], "--bak") == 0))
+			{
+				iFullBAK = 1;
+			}
+			else if ((strncmp (argv[iArgLoop], "-r=", 3) == 0) ||
+				(strncmp (argv[iArgLoop], "--restore=", 10) == 0))
+			{
+				GetOptionValue (argv[iArgLoop], sRestore);
+				iRestore = atoi (sRestore);
+				if (iRestore < 1) { ShowUsage(); }
+			}
 			else
 			{
 				ShowUsage();
@@ -871,6 +1207,9 @@ int main (int argc, char *argv[])
 	iBBCMaster = GetPathFileB();
 	iC64 = GetPathFileC();
 
+	if ((iListBackups == 1) || (iRestore != 0))
+		{ Backups (iListBackups, iRestore); }
+
 	srand ((unsigned)time(&tm));
 
 	/*** Show the SDL version used for compiling and linking. ***/
@@ -899,6 +1238,7 @@ void ShowUsage (void)
 		" exit\n");
 	printf ("  -d,        --debug          also show levels on the console\n");
 	printf ("  -n,        --noaudio        do not play sound effects\n");
+	printf ("  -m=NR,     --volume=NR      sound effect volume, 0-100\n");
 	printf ("  -z,        --zoom           double the interface size\n");
 	printf ("  -f,        --fullscreen     start in fullscreen mode\n");
 	printf ("  -l=NR,     --level=NR       start in level NR\n");
@@ -907,6 +1247,9 @@ void ShowUsage (void)
 	printf ("  -a,        --appleii        edit Apple II levels\n");
 	printf ("  -b,        --bbcmaster      edit BBC Master levels\n");
 	printf ("  -c,        --c64            edit C64 levels\n");
+	printf ("  -u,        --backups        list the backups and exit\n");
+	printf ("  -r=NR,     --restore=NR     restore backup NR and exit\n");
+	printf ("  -i,        --bak            also keep a full disk.bak on save\n");
 	printf ("\n");
 	exit (EXIT_NORMAL);
 }
@@ -919,7 +1262,6 @@ int GetPathFileA (void)
 	struct dirent *stDirent;
 	char sExtension[100 + 2];
 	char sWarning[MAX_WARNING + 2];
-	int iFd;
 	int iVerify[10 + 2];
 
 	iFound = 0;
@@ -976,10 +1318,12 @@ int GetPathFileA (void)
 		return (0);
 	}
 
+	/*** Was a save interrupted? ***/
+	JournalReplay (sPathFileA, JOURNAL_A);
+
 	/*** Which disk image: adamgreen (A0) or peterferrie (A1)? ***/
 	iDiskImageA = -1;
-	iFd = open (sPathFileA, O_RDONLY|O_BINARY);
-	if (iFd == -1)
+	if (DiskImageOpen (sPathFileA) == 0)
 	{
 		printf ("[ WARN ] Could not open \"%s\": %s!\n",
 			sPathFileA, strerror (errno));
@@ -988,10 +1332,10 @@ int GetPathFileA (void)
 	/*** A0 version (adamgreen) ***/
 	if (iDiskImageA == -1)
 	{
-		iVerify[1] = Verify (iFd, A0_PRODOS_OFFSET_1, A0_PRODOS_TEXT);
-		iVerify[2] = Verify (iFd, A0_PRODOS_OFFSET_2, A0_PRODOS_TEXT);
-		iVerify[3] = Verify (iFd, A0_POP_OFFSET_1, A0_POP_TEXT);
-		iVerify[4] = Verify (iFd, A0_POP_OFFSET_2, A0_POP_TEXT);
+		iVerify[1] = Verify (A0_PRODOS_OFFSET_1, A0_PRODOS_TEXT);
+		iVerify[2] = Verify (A0_PRODOS_OFFSET_2, A0_PRODOS_TEXT);
+		iVerify[3] = Verify (A0_POP_OFFSET_1, A0_POP_TEXT);
+		iVerify[4] = Verify (A0_POP_OFFSET_2, A0_POP_TEXT);
 		if ((iVerify[1] == 1) && (iVerify[2] == 1) &&
 			(iVerify[3] == 1) && (iVerify[4] == 1))
 		{
@@ -1002,10 +1346,10 @@ int GetPathFileA (void)
 	/*** A1 version (peterferrie) ***/
 	if (iDiskImageA == -1)
 	{
-		iVerify[1] = Verify (iFd, A1_PRODOS_OFFSET_1, A1_PRODOS_TEXT);
-		iVerify[2] = Verify (iFd, A1_PRODOS_OFFSET_2, A1_PRODOS_TEXT);
-		iVerify[3] = Verify (iFd, A1_POP_OFFSET_1, A1_POP_TEXT);
-		iVerify[4] = Verify (iFd, A1_POP_OFFSET_2, A1_POP_TEXT);
+		iVerify[1] = Verify (A1_PRODOS_OFFSET_1, A1_PRODOS_TEXT);
+		iVerify[2] = Verify (A1_PRODOS_OFFSET_2, A1_PRODOS_TEXT);
+		iVerify[3] = Verify (A1_POP_OFFSET_1, A1_POP_TEXT);
+		iVerify[4] = Verify (A1_POP_OFFSET_2, A1_POP_TEXT);
 		if ((iVerify[1] == 1) && (iVerify[2] == 1) &&
 			(iVerify[3] == 1) && (iVerify[4] == 1))
 		{
@@ -1013,7 +1357,7 @@ int GetPathFileA (void)
 			PrIfDe ("[ INFO ] peterferrie (A1)\n");
 		}
 	}
-	close (iFd);
+	DiskImageClose();
 
 	if (iDiskImageA == -1)
 	{
@@ -1036,7 +1380,6 @@ int GetPathFileB (void)
 	struct dirent *stDirent;
 	char sExtension[100 + 2];
 	char sWarning[MAX_WARNING + 2];
-	int iFd;
 	int iVerify[10 + 2];
 
 	iFound = 0;
@@ -1094,10 +1437,12 @@ int GetPathFileB (void)
 		return (0);
 	}
 
+	/*** Was a save interrupted? ***/
+	JournalReplay (sPathFileB, JOURNAL_B);
+
 	/*** Which disk image: kieranhj 1.0 (B0) or kieranhj 1.1 (B1)? ***/
 	iDiskImageB = -1;
-	iFd = open (sPathFileB, O_RDONLY|O_BINARY);
-	if (iFd == -1)
+	if (DiskImageOpen (sPathFileB) == 0)
 	{
 		printf ("[ WARN ] Could not open \"%s\": %s!\n",
 			sPathFileB, strerror (errno));
@@ -1106,8 +1451,8 @@ int GetPathFileB (void)
 	/*** B0 version (kieranhj 1.0) ***/
 	if (iDiskImageB == -1)
 	{
-		iVerify[1] = Verify (iFd, B0_POPBBCM_OFFSET, B0_POPBBCM_TEXT);
-		iVerify[2] = Verify (iFd, B0_VANDB_OFFSET, B0_VANDB_TEXT);
+		iVerify[1] = Verify (B0_POPBBCM_OFFSET, B0_POPBBCM_TEXT);
+		iVerify[2] = Verify (B0_VANDB_OFFSET, B0_VANDB_TEXT);
 		if ((iVerify[1] == 1) && (iVerify[2] == 1))
 		{
 			iDiskImageB = 0;
@@ -1117,15 +1462,15 @@ int GetPathFileB (void)
 	/*** B1 version (kieranhj 1.1) ***/
 	if (iDiskImageB == -1)
 	{
-		iVerify[1] = Verify (iFd, B1_POPBBCM_OFFSET, B1_POPBBCM_TEXT);
-		iVerify[2] = Verify (iFd, B1_VANDB_OFFSET, B1_VANDB_TEXT);
+		iVerify[1] = Verify (B1_POPBBCM_OFFSET, B1_POPBBCM_TEXT);
+		iVerify[2] = Verify (B1_VANDB_OFFSET, B1_VANDB_TEXT);
 		if ((iVerify[1] == 1) && (iVerify[2] == 1))
 		{
 			iDiskImageB = 1;
 			PrIfDe ("[ INFO ] kieranhj 1.1 (B1)\n");
 		}
 	}
-	close (iFd);
+	DiskImageClose();
 
 	if (iDiskImageB == -1)
 	{
@@ -1148,7 +1493,6 @@ int GetPathFileC (void)
 	struct dirent *stDirent;
 	char sExtension[100 + 2];
 	char sWarning[MAX_WARNING + 2];
-	int iFd;
 	int iVerify[10 + 2];
 
 	iFound = 0;
@@ -1206,10 +1550,12 @@ int GetPathFileC (void)
 		return (0);
 	}
 
+	/*** Was a save interrupted? ***/
+	JournalReplay (sPathFileC, JOURNAL_C);
+
 	/*** Which disk image: mrsid (C0)? ***/
 	iDiskImageC = -1;
-	iFd = open (sPathFileC, O_RDONLY|O_BINARY);
-	if (iFd == -1)
+	if (DiskImageOpen (sPathFileC) == 0)
 	{
 		printf ("[ WARN ] Could not open \"%s\": %s!\n",
 			sPathFileC, strerror (errno));
@@ -1218,15 +1564,15 @@ int GetPathFileC (void)
 	/*** C0 version (mrsid) ***/
 	if (iDiskImageC == -1)
 	{
-		iVerify[1] = Verify (iFd, C0_C64CART_OFFSET, C0_C64CART_TEXT);
-		iVerify[2] = Verify (iFd, C0_DATE_OFFSET, C0_DATE_TEXT);
+		iVerify[1] = Verify (C0_C64CART_OFFSET, C0_C64CART_TEXT);
+		iVerify[2] = Verify (C0_DATE_OFFSET, C0_DATE_TEXT);
 		if ((iVerify[1] == 1) && (iVerify[2] == 1))
 		{
 			iDiskImageC = 0;
 			PrIfDe ("[ INFO ] mrsid (C0)\n");
 		}
 	}
-	close (iFd);
+	DiskImageClose();
 
 	if (iDiskImageC == -1)
 	{
@@ -1251,15 +1597,6 @@ void LoadLevels (int iAtLevel)
 	int iTileMod;
 	int iTiles;
 	int iTemp;
-	int iRead;
-	unsigned char sRead[2 + 2];
-	int iEOF;
-	char sBinaryFDoors[9 + 2]; /*** 8 chars, plus \0 ***/
-	char sBinarySDoors[9 + 2]; /*** 8 chars, plus \0 ***/
-	char sEventsRoom[10 + 2];
-	char sEventsTile[10 + 2];
-	char sEventsTimer[10 + 2];
-	int iFd;
 
 	/*** Used for looping. ***/
 	int iRoomLoop;
@@ -1270,17 +1607,10 @@ void LoadLevels (int iAtLevel)
 	int iLevelLoop;
 	int iByteLoop;
 
-	/*** Set cCurType and iCurGuard. ***/
 	EXELoad();
-	switch (iEXEEnv1[iAtLevel])
-	{
-		case 0x00: case 0x02: cCurType = 'd'; break;
-		case 0x01: cCurType = 'p'; break;
-	}
-	iCurGuard = iEXEGuardS[iAtLevel];
+	LevelType (iAtLevel);
 
-	iFd = open (sPathFile, O_RDONLY|O_BINARY);
-	if (iFd == -1)
+	if (DiskImageOpen (sPathFile) == 0)
 	{
 		printf ("[FAILED] Could not open \"%s\": %s!\n",
 			sPathFile, strerror (errno));
@@ -1302,7 +1632,6 @@ void LoadLevels (int iAtLevel)
 				break;
 			default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 		}
-		lseek (iFd, iOffsetStart, SEEK_SET);
 
 		/*** We present level 0 to users as level 15. ***/
 		switch (iLevelLoop)
@@ -1311,30 +1640,23 @@ void LoadLevels (int iAtLevel)
 			default: iLevel = iLevelLoop - 1; break;
 		}
 
-		/*** Read the level into arLevel. ***/
+		/*** Copy the level from the disk image into arLevel. ***/
 		if (iDebug == 1)
 		{
 			printf ("[ INFO ] Level %i starts at offset 0x%02x (%i).\n",
 				iLevel, iOffsetStart, iOffsetStart);
 		}
 		iLevelRead = 0;
-		iEOF = 0;
-		do {
-			iRead = read (iFd, sRead, 1);
-			switch (iRead)
+		if ((unsigned long)iOffsetStart < ulDiskImageSize)
+		{
+			if (ulDiskImageSize - iOffsetStart < LEVEL_SIZE)
 			{
-				case -1:
-					printf ("[FAILED] Could not read from \"%s\": %s!\n",
-						sPathFile, strerror (errno));
-					exit (EXIT_ERROR);
-					break;
-				case 0: iEOF = 1; break;
-				default:
-					arLevel[iLevelRead] = sRead[0];
-					iLevelRead++;
-					break;
+				iLevelRead = ulDiskImageSize - iOffsetStart;
+			} else {
+				iLevelRead = LEVEL_SIZE;
 			}
-		} while ((iEOF == 0) && (iLevelRead < LEVEL_SIZE));
+			memcpy (arLevel, arDiskImage + iOffsetStart, iLevelRead);
+		}
 		iOffsetEnd = iOffsetStart + LEVEL_SIZE - 1;
 
 		if (iDebug == 1)
@@ -1357,15 +1679,8 @@ void LoadLevels (int iAtLevel)
 				iTiles++;
 				iTileValue = arLevel[iTiles];
 				iTileMod = arLevel[iTiles + (ROOMS * TILES)];
-				if (iTileValue >= 32)
-				{
-					iTileValue-=32;
-					arRoomX[iLevel][iRoomLoop][iTileLoop] = 1;
-				} else {
-					arRoomX[iLevel][iRoomLoop][iTileLoop] = 0;
-				}
-				arRoomTiles[iLevel][iRoomLoop][iTileLoop] = iTileValue;
-				arRoomMod[iLevel][iRoomLoop][iTileLoop] = iTileMod;
+				arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] = iTileValue;
+				arLevels[iLevel].arRoom[iRoomLoop].arMod[iTileLoop] = iTileMod;
 			}
 
 			/*** Debug. ***/
@@ -1376,13 +1691,13 @@ void LoadLevels (int iAtLevel)
 				for (iTileLoop = 1; iTileLoop <= 10; iTileLoop++)
 				{
 					PrintTileName (iLevel, iRoomLoop, iTileLoop,
-						arRoomTiles[iLevel][iRoomLoop][iTileLoop]);
+						arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F);
 					if (iTileLoop == 10) { printf ("\n"); } else { printf ("|"); }
 				}
 				for (iTileLoop = 1; iTileLoop <= 10; iTileLoop++)
 				{
-					PrintMod (arRoomTiles[iLevel][iRoomLoop][iTileLoop],
-						arRoomMod[iLevel][iRoomLoop][iTileLoop]);
+					PrintMod (arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F,
+						arLevels[iLevel].arRoom[iRoomLoop].arMod[iTileLoop]);
 					if (iTileLoop == 10) { printf ("\n"); } else { printf ("|"); }
 				}
 				for (iTemp = 1; iTemp <= 79; iTemp++) { printf ("-"); }
@@ -1390,13 +1705,13 @@ void LoadLevels (int iAtLevel)
 				for (iTileLoop = 11; iTileLoop <= 20; iTileLoop++)
 				{
 					PrintTileName (iLevel, iRoomLoop, iTileLoop,
-						arRoomTiles[iLevel][iRoomLoop][iTileLoop]);
+						arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F);
 					if (iTileLoop == 20) { printf ("\n"); } else { printf ("|"); }
 				}
 				for (iTileLoop = 11; iTileLoop <= 20; iTileLoop++)
 				{
-					PrintMod (arRoomTiles[iLevel][iRoomLoop][iTileLoop],
-						arRoomMod[iLevel][iRoomLoop][iTileLoop]);
+					PrintMod (arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F,
+						arLevels[iLevel].arRoom[iRoomLoop].arMod[iTileLoop]);
 					if (iTileLoop == 20) { printf ("\n"); } else { printf ("|"); }
 				}
 				for (iTemp = 1; iTemp <= 79; iTemp++) { printf ("-"); }
@@ -1404,13 +1719,13 @@ void LoadLevels (int iAtLevel)
 				for (iTileLoop = 21; iTileLoop <= 30; iTileLoop++)
 				{
 					PrintTileName (iLevel, iRoomLoop, iTileLoop,
-						arRoomTiles[iLevel][iRoomLoop][iTileLoop]);
+						arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F);
 					if (iTileLoop == 30) { printf ("\n"); } else { printf ("|"); }
 				}
 				for (iTileLoop = 21; iTileLoop <= 30; iTileLoop++)
 				{
-					PrintMod (arRoomTiles[iLevel][iRoomLoop][iTileLoop],
-						arRoomMod[iLevel][iRoomLoop][iTileLoop]);
+					PrintMod (arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F,
+						arLevels[iLevel].arRoom[iRoomLoop].arMod[iTileLoop]);
 					if (iTileLoop == 30) { printf ("\n"); } else { printf ("|"); }
 				}
 				printf ("\n");
@@ -1422,38 +1737,21 @@ void LoadLevels (int iAtLevel)
 		for (iEventLoop = 1; iEventLoop <= EVENTS; iEventLoop++)
 		{
 			iTiles++;
-			GetAsEightBits (arLevel[iTiles], sBinaryFDoors);
-			GetAsEightBits (arLevel[iTiles + EVENTS], sBinarySDoors);
-			snprintf (sEventsRoom, 10, "%c%c%c%c%c",
-				sBinarySDoors[0], sBinarySDoors[1], sBinarySDoors[2],
-				sBinaryFDoors[1], sBinaryFDoors[2]);
-			arEventsRoom[iLevel][iEventLoop] = BitsToInt (sEventsRoom);
-			snprintf (sEventsTile, 10, "%c%c%c%c%c",
-				sBinaryFDoors[3], sBinaryFDoors[4], sBinaryFDoors[5],
-				sBinaryFDoors[6], sBinaryFDoors[7]);
-			arEventsTile[iLevel][iEventLoop] = BitsToInt (sEventsTile) + 1;
-			switch (sBinaryFDoors[0])
-			{
-				case '0': arEventsNext[iLevel][iEventLoop] = 1; break;
-				case '1': arEventsNext[iLevel][iEventLoop] = 0; break;
-			}
-			snprintf (sEventsTimer, 10, "%c%c%c%c%c",
-				sBinarySDoors[3], sBinarySDoors[4], sBinarySDoors[5],
-				sBinarySDoors[6], sBinarySDoors[7]);
-			arEventsTimer[iLevel][iEventLoop] = BitsToInt (sEventsTimer);
+			BytesToEvent (iLevel, iEventLoop,
+				arLevel[iTiles], arLevel[iTiles + EVENTS]);
 
 			if (iDebug == 1)
 			{
 				printf ("[ INFO ] Event %i triggers room %i, tile %i. (next: ",
 					iEventLoop,
-					arEventsRoom[iLevel][iEventLoop],
-					arEventsTile[iLevel][iEventLoop]);
-				switch (arEventsNext[iLevel][iEventLoop])
+					arLevels[iLevel].arEvent[iEventLoop].cRoom,
+					arLevels[iLevel].arEvent[iEventLoop].cTile);
+				switch (arLevels[iLevel].arEvent[iEventLoop].cNext)
 				{
 					case 0: printf ("no"); break;
 					case 1: printf ("yes"); break;
 				}
-				printf (", timer: %i)\n", arEventsTimer[iLevel][iEventLoop]);
+				printf (", timer: %i)\n", arLevels[iLevel].arEvent[iEventLoop].cTimer);
 			}
 		}
 		iTiles+=EVENTS;
@@ -1465,16 +1763,16 @@ void LoadLevels (int iAtLevel)
 			for (iSideLoop = 1; iSideLoop <= 4; iSideLoop++)
 			{
 				iTiles++;
-				arRoomLinks[iLevel][iRoomLoop][iSideLoop] = arLevel[iTiles];
+				arLevels[iLevel].arRoom[iRoomLoop].arLink[iSideLoop] = arLevel[iTiles];
 			}
 			if (iDebug == 1)
 			{
 				printf ("[ INFO ] Room %i is connected to room (0 = none):"
 					" l%i, r%i, u%i, d%i\n", iRoomLoop,
-					arRoomLinks[iLevel][iRoomLoop][1],
-					arRoomLinks[iLevel][iRoomLoop][2],
-					arRoomLinks[iLevel][iRoomLoop][3],
-					arRoomLinks[iLevel][iRoomLoop][4]);
+					arLevels[iLevel].arRoom[iRoomLoop].arLink[1],
+					arLevels[iLevel].arRoom[iRoomLoop].arLink[2],
+					arLevels[iLevel].arRoom[iRoomLoop].arLink[3],
+					arLevels[iLevel].arRoom[iRoomLoop].arLink[4]);
 			}
 		}
 
@@ -1482,67 +1780,74 @@ void LoadLevels (int iAtLevel)
 		for (iByteLoop = 0; iByteLoop < 64; iByteLoop++)
 		{
 			iTiles++;
-			arBytes64[iLevel][iByteLoop] = arLevel[iTiles];
+			arLevels[iLevel].arBytes64[iByteLoop] = arLevel[iTiles];
 		}
 
 		/* We want remapped modifiers in all 24 rooms.
 		 * And [0] contains the first unused room.
 		 */
-		arBytes64[iLevel][0] = 0x19;
+		arLevels[iLevel].arBytes64[0] = 0x19;
 
 		/*** Extract start location. ***/
 		iTiles++;
-		arStartLocation[iLevel][1] = arLevel[iTiles]; /*** Room. ***/
+		arLevels[iLevel].arStartLocation[1] = arLevel[iTiles]; /*** Room. ***/
 		iTiles++;
-		arStartLocation[iLevel][2] = arLevel[iTiles] + 1; /*** Tile. ***/
+		arLevels[iLevel].arStartLocation[2] = arLevel[iTiles] + 1; /*** Tile. ***/
 		iTiles++;
-		arStartLocation[iLevel][3] = arLevel[iTiles]; /*** Direction. ***/
+		arLevels[iLevel].arStartLocation[3] = arLevel[iTiles]; /*** Direction. ***/
 		/*** 1 of 2 ***/
 		if ((iLevel == 1) || (iLevel == 13))
 		{
-			if (arStartLocation[iLevel][3] == 0x00)
-				{ arStartLocation[iLevel][3] = 0xFF; }
-					else { arStartLocation[iLevel][3] = 0x00; }
+			if (arLevels[iLevel].arStartLocation[3] == 0x00)
+				{ arLevels[iLevel].arStartLocation[3] = 0xFF; }
+					else { arLevels[iLevel].arStartLocation[3] = 0x00; }
 		}
 		if (iDebug == 1)
 		{
 			printf ("[ INFO ] The prince starts in room: %i, tile %i, turned: %c\n",
-				arStartLocation[iLevel][1], arStartLocation[iLevel][2],
-				cShowDirection (arStartLocation[iLevel][3]));
+				arLevels[iLevel].arStartLocation[1],
+					arLevels[iLevel].arStartLocation[2],
+				cShowDirection (arLevels[iLevel].arStartLocation[3]));
 		}
 
 		/*** Unknown (4). ***/
 		for (iByteLoop = 0; iByteLoop < 4; iByteLoop++)
 		{
 			iTiles++;
-			arBytes4[iLevel][iByteLoop] = arLevel[iTiles];
+			arLevels[iLevel].arBytes4[iByteLoop] = arLevel[iTiles];
 		}
 
 		/*** Extract guards. ***/
 		for (iGuardLoop = 1; iGuardLoop <= ROOMS; iGuardLoop++)
 		{
 			iTiles++;
-			arGuardTile[iLevel][iGuardLoop] = arLevel[iTiles] + 1;
-			arGuardDir[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 1)];
-			arGuardUnk1[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 2)];
-			arGuardUnk2[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 3)];
-			arGuardSkill[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 4)];
-			arGuardUnk3[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 5)];
-			arGuardC[iLevel][iGuardLoop] = arLevel[iTiles + (ROOMS * 6)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardTile = arLevel[iTiles] + 1;
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardDir =
+				arLevel[iTiles + (ROOMS * 1)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk1 =
+				arLevel[iTiles + (ROOMS * 2)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk2 =
+				arLevel[iTiles + (ROOMS * 3)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardSkill =
+				arLevel[iTiles + (ROOMS * 4)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk3 =
+				arLevel[iTiles + (ROOMS * 5)];
+			arLevels[iLevel].arRoom[iGuardLoop].cGuardC =
+				arLevel[iTiles + (ROOMS * 6)];
 
 			if (iDebug == 1)
 			{
-				if (arGuardTile[iLevel][iGuardLoop] <= TILES)
+				if (arLevels[iLevel].arRoom[iGuardLoop].cGuardTile <= TILES)
 				{
 					printf ("[ INFO ] (l%i) Guard; room:%i, tile:%i, dir:%c,"
 						" skill:%i, c:%i (%i/%i/%i)\n",
-						iLevel, iGuardLoop, arGuardTile[iLevel][iGuardLoop],
-						cShowDirection (arGuardDir[iLevel][iGuardLoop]),
-						arGuardSkill[iLevel][iGuardLoop],
-						arGuardC[iLevel][iGuardLoop],
-						arGuardUnk1[iLevel][iGuardLoop],
-						arGuardUnk2[iLevel][iGuardLoop],
-						arGuardUnk3[iLevel][iGuardLoop]);
+						iLevel, iGuardLoop, arLevels[iLevel].arRoom[iGuardLoop].cGuardTile,
+						cShowDirection (arLevels[iLevel].arRoom[iGuardLoop].cGuardDir),
+						arLevels[iLevel].arRoom[iGuardLoop].cGuardSkill,
+						arLevels[iLevel].arRoom[iGuardLoop].cGuardC,
+						arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk1,
+						arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk2,
+						arLevels[iLevel].arRoom[iGuardLoop].cGuardUnk3);
 				}
 			}
 		}
@@ -1552,7 +1857,7 @@ void LoadLevels (int iAtLevel)
 		for (iByteLoop = 0; iByteLoop < 16; iByteLoop++)
 		{
 			iTiles++;
-			arBytes16[iLevel][iByteLoop] = arLevel[iTiles];
+			arLevels[iLevel].arBytes16[iByteLoop] = arLevel[iTiles];
 		}
 
 		/*** Checksum. ***/
@@ -1564,7 +1869,10 @@ void LoadLevels (int iAtLevel)
 		}
 
 		PrIfDe ("[  OK  ] Checking for broken room links.\n");
-		arBrokenRoomLinks[iLevel] = BrokenRoomLinks (1);
+		arBrokenRoomLinks[iLevel] = BrokenRoomLinks (iLevel, 1);
+
+		arLevelChanged[iLevel] = 0;
+		LevelPristine (iLevel, 0);
 
 		if (iDebug == 1)
 		{
@@ -1572,7 +1880,8 @@ void LoadLevels (int iAtLevel)
 		}
 	}
 
-	close (iFd);
+	/*** Nothing to undo in what is on disk. ***/
+	UndoReset();
 }
 /*****************************************************************************/
 void SaveLevels (void)
@@ -1580,21 +1889,26 @@ void SaveLevels (void)
 {
 	int iOffsetStart;
 	int iLevel;
-	int iFd;
-	char sToWrite[MAX_TOWRITE + 2];
+	unsigned char sLevel[LEVEL_SIZE + 2];
+	unsigned char sToWrite[8 + 2];
+	int iChecksum;
+	int iPatched;
 
 	/*** Used for looping. ***/
 	int iLevelLoop;
 	int iByteLoop;
 
-	iFd = open (sPathFile, O_WRONLY|O_BINARY);
-	if (iFd == -1)
+	/*** To skip patches that are already on disk. ***/
+	if (DiskImageOpen (sPathFile) == 0)
 	{
 		printf ("[FAILED] Could not open \"%s\": %s!\n",
 			sPathFile, strerror (errno));
 		exit (EXIT_ERROR);
 	}
 
+	/*** Nothing is written before JournalCommit(). ***/
+	JournalStart();
+
 	for (iLevelLoop = 1; iLevelLoop <= LEVELS; iLevelLoop++)
 	{
 		switch (iHomeComputer)
@@ -1610,7 +1924,6 @@ void SaveLevels (void)
 				break;
 			default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 		}
-		lseek (iFd, iOffsetStart, SEEK_SET);
 
 		/*** We present level 0 to users as level 15. ***/
 		switch (iLevelLoop)
@@ -1619,13 +1932,21 @@ void SaveLevels (void)
 			default: iLevel = iLevelLoop - 1; break;
 		}
 
-		cChecksum = ChecksumOrWrite (-1, iLevel);
-
 		if ((iHomeComputer == 3) && (iLevel == 15))
 		{
 			/*** The C64 port has no demo level. ***/
+		} else if (arLevelChanged[iLevel] == 0) {
+			/*** Unchanged levels are already on disk. ***/
 		} else {
-			ChecksumOrWrite (iFd, iLevel);
+			iChecksum = LevelToBytes (iLevel, sLevel);
+			JournalAdd (iOffsetStart, sLevel, LEVEL_SIZE);
+			if (iDebug == 1)
+			{
+				printf ("[ INFO ] Saved checksum: 0x%02x (%i)\n",
+					iChecksum, iChecksum);
+			}
+			arLevelChanged[iLevel] = 0;
+			LevelPristine (iLevel, 0);
 		}
 	}
 
@@ -1639,12 +1960,15 @@ void SaveLevels (void)
 	}
 	if (iOffsetStart != 0x00)
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
+		iPatched = 1;
 		for (iByteLoop = 0; iByteLoop < 8; iByteLoop++)
 		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c", 0xEA); /*** nop ***/
-			write (iFd, sToWrite, 1);
+			sToWrite[iByteLoop] = 0xEA; /*** nop ***/
+			if (DiskImageRead (iOffsetStart + iByteLoop) != 0xEA)
+				{ iPatched = 0; }
 		}
+		if (iPatched == 0)
+			{ JournalAdd (iOffsetStart, sToWrite, 8); }
 	}
 
 	/*** There should be no saved game. ***/
@@ -1655,14 +1979,16 @@ void SaveLevels (void)
 		case 3: iOffsetStart = ulSavedLevelC[iDiskImageC]; break;
 		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
-	if (iOffsetStart != 0x00)
+	if ((iOffsetStart != 0x00) && (DiskImageRead (iOffsetStart) != 0xFF))
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", 0xFF); /*** negative ***/
-		write (iFd, sToWrite, 1);
+		sToWrite[0] = 0xFF; /*** negative ***/
+		JournalAdd (iOffsetStart, sToWrite, 1);
 	}
 
-	close (iFd);
+	JournalCommit();
+
+	/*** The next reader maps the file again, including these bytes. ***/
+	DiskImageClose();
 
 	PlaySound ("wav/save.wav");
 
@@ -1893,6 +2219,7 @@ void Quit (void)
 {
 	if (iChanged != 0) { InitPopUpSave(); }
 	if (iModified == 1) { PlaytestStop(); }
+	DiskImageClose();
 	TTF_CloseFont (font1);
 	TTF_CloseFont (font2);
 	TTF_CloseFont (font3);
@@ -1965,16 +2292,18 @@ void InitScreen (void)
 	{
 		PrIfDe ("[  OK  ] Initializing Audio\n");
 		fmt.freq = 44100;
-		fmt.format = AUDIO_S16;
+		fmt.format = AUDIO_S16SYS;
 		fmt.channels = 2;
 		fmt.samples = 512;
 		fmt.callback = MixAudio;
 		fmt.userdata = NULL;
+		iVolume = (iMasterVolume * SDL_MIX_MAXVOLUME) / 100;
 		if (SDL_OpenAudio (&fmt, NULL) < 0)
 		{
 			printf ("[FAILED] Unable to open audio: %s!\n", SDL_GetError());
 			exit (EXIT_ERROR);
 		}
+		PreLoadSounds();
 		SDL_PauseAudio (0);
 	}
 
@@ -2035,6 +2364,8 @@ void InitScreen (void)
 		PrIfDe ("[ INFO ] Using keyboard and mouse.\n");
 	}
 
+	AtlasCacheOpen();
+
 	/*** Home computer select ***/
 	if (iHomeComputer == 0)
 	{
@@ -2061,6 +2392,7 @@ void InitScreen (void)
 			PreLoad (PNG_GAMEPAD, "C64_off.png", &imghccoff);
 			PreLoad (PNG_GAMEPAD, "C64_on.png", &imghccon);
 		}
+		DecodeWait (iDecodes);
 		HomeComputer();
 		PlaySound ("wav/ok_close.wav");
 	}
@@ -2080,99 +2412,24 @@ void InitScreen (void)
 
 	/*** Loading... ***/
 	PreLoad (PNG_VARIOUS, "loading.png", &imgloading);
+	DecodeWait (iDecodes);
 	ShowImage (imgloading, 0, 0, "imgloading");
 	SDL_SetRenderDrawColor (ascreen, 0x22, 0x22, 0x22, SDL_ALPHA_OPAQUE);
 	barbox.x = 10 * iScale;
 	barbox.y = 10 * iScale;
 	barbox.w = 20 * iScale;
 	barbox.h = 441 * iScale;
+	BatchFlush();
 	SDL_RenderFillRect (ascreen, &barbox);
 	SDL_RenderPresent (ascreen);
 
 	iPreLoaded = 0;
 	iCurrentBarHeight = 0;
-	iNrToPreLoad = 454; /*** Value can be obtained via debug mode. ***/
+	iNrToPreLoad = 202; /*** Value can be obtained via debug mode. ***/
 	SDL_SetCursor (curWait);
 
-	/*** Dungeon and palace tiles. ***/
-	PreLoadSet ('d', 0x00, 0x00); PreLoadSet ('p', 0x00, 0x00);
-	PreLoadSet ('d', 0x00, 0x01); PreLoadSet ('p', 0x00, 0x01);
-	PreLoadSet ('d', 0x00, 0x02); PreLoadSet ('p', 0x00, 0x02);
-	PreLoadSet ('d', 0x00, 0x03); PreLoadSet ('p', 0x00, 0x03);
-	PreLoadSet ('d', 0x00, 0xFF); PreLoadSet ('p', 0x00, 0xFF);
-	PreLoadSet ('d', 0x01, 0x00); PreLoadSet ('p', 0x01, 0x00);
-	PreLoadSet ('d', 0x01, 0x01); PreLoadSet ('p', 0x01, 0x01);
-	PreLoadSet ('d', 0x01, 0x02); PreLoadSet ('p', 0x01, 0x02);
-	PreLoadSet ('d', 0x01, 0x03); PreLoadSet ('p', 0x01, 0x03);
-	PreLoadSet ('d', 0x01, 0xFF); PreLoadSet ('p', 0x01, 0xFF);
-	PreLoadSet ('d', 0x02, 0x00); PreLoadSet ('p', 0x02, 0x00);
-	PreLoadSet ('d', 0x02, 0x01); PreLoadSet ('p', 0x02, 0x01);
-	PreLoadSet ('d', 0x02, 0x02); PreLoadSet ('p', 0x02, 0x02);
-	PreLoadSet ('d', 0x02, 0x03); PreLoadSet ('p', 0x02, 0x03);
-	PreLoadSet ('d', 0x02, 0x04); PreLoadSet ('p', 0x02, 0x04);
-	PreLoadSet ('d', 0x02, 0x05); PreLoadSet ('p', 0x02, 0x05);
-	PreLoadSet ('d', 0x02, 0x06); PreLoadSet ('p', 0x02, 0x06);
-	PreLoadSet ('d', 0x02, 0x07); PreLoadSet ('p', 0x02, 0x07);
-	PreLoadSet ('d', 0x02, 0x08); PreLoadSet ('p', 0x02, 0x08);
-	PreLoadSet ('d', 0x02, 0x09); PreLoadSet ('p', 0x02, 0x09);
-	PreLoadSet ('d', 0x03, 0x00); PreLoadSet ('p', 0x03, 0x00);
-	PreLoadSet ('d', 0x04, 0x01); PreLoadSet ('p', 0x04, 0x01);
-	PreLoadSet ('d', 0x04, 0x02); PreLoadSet ('p', 0x04, 0x02);
-	PreLoadSet ('d', 0x05, 0x00); PreLoadSet ('p', 0x05, 0x00);
-	PreLoadSet ('d', 0x06, 0x00); PreLoadSet ('p', 0x06, 0x00);
-	PreLoadSet ('d', 0x07, 0x00); PreLoadSet ('p', 0x07, 0x00);
-	PreLoadSet ('d', 0x07, 0x01); PreLoadSet ('p', 0x07, 0x01);
-	PreLoadSet ('d', 0x07, 0x02); PreLoadSet ('p', 0x07, 0x02);
-	PreLoadSet ('d', 0x07, 0x03); PreLoadSet ('p', 0x07, 0x03);
-	PreLoadSet ('d', 0x08, 0x00); PreLoadSet ('p', 0x08, 0x00);
-	PreLoadSet ('d', 0x09, 0x00); PreLoadSet ('p', 0x09, 0x00);
-	PreLoadSet ('d', 0x0A, 0x00); PreLoadSet ('p', 0x0A, 0x00);
-	PreLoadSet ('d', 0x0A, 0x01); PreLoadSet ('p', 0x0A, 0x01);
-	PreLoadSet ('d', 0x0A, 0x02); PreLoadSet ('p', 0x0A, 0x02);
-	PreLoadSet ('d', 0x0A, 0x03); PreLoadSet ('p', 0x0A, 0x03);
-	PreLoadSet ('d', 0x0A, 0x04); PreLoadSet ('p', 0x0A, 0x04);
-	PreLoadSet ('d', 0x0A, 0x05); PreLoadSet ('p', 0x0A, 0x05);
-	PreLoadSet ('d', 0x0A, 0x06); PreLoadSet ('p', 0x0A, 0x06);
-	PreLoadSet ('d', 0x0B, 0x00); PreLoadSet ('p', 0x0B, 0x00);
-	PreLoadSet ('d', 0x0C, 0x00); PreLoadSet ('p', 0x0C, 0x00);
-	PreLoadSet ('d', 0x0C, 0x01); PreLoadSet ('p', 0x0C, 0x01);
-	PreLoadSet ('d', 0x0C, 0x02); PreLoadSet ('p', 0x0C, 0x02);
-	PreLoadSet ('d', 0x0C, 0x03); PreLoadSet ('p', 0x0C, 0x03);
-	PreLoadSet ('d', 0x0C, 0x04); PreLoadSet ('p', 0x0C, 0x04);
-	PreLoadSet ('d', 0x0C, 0x05); PreLoadSet ('p', 0x0C, 0x05);
-	PreLoadSet ('d', 0x0C, 0x06); PreLoadSet ('p', 0x0C, 0x06);
-	PreLoadSet ('d', 0x0C, 0x07); PreLoadSet ('p', 0x0C, 0x07);
-	PreLoadSet ('d', 0x0D, 0x00); PreLoadSet ('p', 0x0D, 0x00);
-	PreLoadSet ('d', 0x0E, 0x00); PreLoadSet ('p', 0x0E, 0x00);
-	PreLoadSet ('d', 0x0F, 0x00); PreLoadSet ('p', 0x0F, 0x00);
-	PreLoadSet ('d', 0x10, 0x00); PreLoadSet ('p', 0x10, 0x00);
-	PreLoadSet ('d', 0x11, 0x00); PreLoadSet ('p', 0x11, 0x00);
-	PreLoadSet ('d', 0x12, 0x00); PreLoadSet ('p', 0x12, 0x00);
-	PreLoadSet ('d', 0x12, 0x01); PreLoadSet ('p', 0x12, 0x01);
-	PreLoadSet ('d', 0x12, 0x02); PreLoadSet ('p', 0x12, 0x02);
-	PreLoadSet ('d', 0x12, 0x03); PreLoadSet ('p', 0x12, 0x03);
-	PreLoadSet ('d', 0x12, 0x04); PreLoadSet ('p', 0x12, 0x04);
-	PreLoadSet ('d', 0x12, 0x05); PreLoadSet ('p', 0x12, 0x05);
-	PreLoadSet ('d', 0x12, 0x80); PreLoadSet ('p', 0x12, 0x80);
-	PreLoadSet ('d', 0x12, 0x81); PreLoadSet ('p', 0x12, 0x81);
-	PreLoadSet ('d', 0x12, 0x82); PreLoadSet ('p', 0x12, 0x82);
-	PreLoadSet ('d', 0x12, 0x83); PreLoadSet ('p', 0x12, 0x83);
-	PreLoadSet ('d', 0x12, 0x84); PreLoadSet ('p', 0x12, 0x84);
-	PreLoadSet ('d', 0x12, 0x85); PreLoadSet ('p', 0x12, 0x85);
-	PreLoadSet ('d', 0x13, 0x00); PreLoadSet ('p', 0x13, 0x00);
-	PreLoadSet ('d', 0x14, 0x00); PreLoadSet ('p', 0x14, 0x00);
-	PreLoadSet ('d', 0x14, 0x01); PreLoadSet ('p', 0x14, 0x01);
-	PreLoadSet ('d', 0x15, 0x00); PreLoadSet ('p', 0x15, 0x00);
-	PreLoadSet ('d', 0x16, 0x00); PreLoadSet ('p', 0x16, 0x00);
-	PreLoadSet ('d', 0x17, 0x00); PreLoadSet ('p', 0x17, 0x00);
-	PreLoadSet ('d', 0x18, 0x00); PreLoadSet ('p', 0x18, 0x00);
-	PreLoadSet ('d', 0x19, 0x00); PreLoadSet ('p', 0x19, 0x00);
-	PreLoadSet ('d', 0x1A, 0x00); PreLoadSet ('p', 0x1A, 0x00);
-	PreLoadSet ('d', 0x1B, 0x00); PreLoadSet ('p', 0x1B, 0x00);
-	PreLoadSet ('d', 0x1C, 0x00); PreLoadSet ('p', 0x1C, 0x00);
-	PreLoadSet ('d', 0x1D, 0x00); PreLoadSet ('p', 0x1D, 0x00);
-	PreLoadSet ('d', 0x1E, 0x00); PreLoadSet ('p', 0x1E, 0x00);
-	PreLoadSet ('d', 0x2B, 0x00); PreLoadSet ('p', 0x2B, 0x00);
+	/*** Tiles; those of the other environment are loaded last. ***/
+	PreLoadTiles (cCurType);
 	PreLoad ("dungeon", "0x13_sprite.png", &imgspriteflamed);
 	PreLoad ("palace", "0x13_sprite.png", &imgspriteflamep);
 
@@ -2268,31 +2525,13 @@ void InitScreen (void)
 		PreLoad (PNG_GAMEPAD, "room_links.png", &imgrl);
 	}
 
-	/*** (s)living ***/
-	PreLoad (PNG_LIVING, "prince_l.png", &imgprincel[1]);
-	PreLoad (PNG_SLIVING, "prince_l.png", &imgprincel[2]);
-	PreLoad (PNG_LIVING, "prince_r.png", &imgprincer[1]);
-	PreLoad (PNG_SLIVING, "prince_r.png", &imgprincer[2]);
-	PreLoad (PNG_LIVING, "guard_l.png", &imgguardl[1]);
-	PreLoad (PNG_SLIVING, "guard_l.png", &imgguardl[2]);
-	PreLoad (PNG_LIVING, "guard_r.png", &imgguardr[1]);
-	PreLoad (PNG_SLIVING, "guard_r.png", &imgguardr[2]);
-	PreLoad (PNG_LIVING, "skel_l.png", &imgskell[1]);
-	PreLoad (PNG_SLIVING, "skel_l.png", &imgskell[2]);
-	PreLoad (PNG_LIVING, "skel_r.png", &imgskelr[1]);
-	PreLoad (PNG_SLIVING, "skel_r.png", &imgskelr[2]);
-	PreLoad (PNG_LIVING, "fat_l.png", &imgfatl[1]);
-	PreLoad (PNG_SLIVING, "fat_l.png", &imgfatl[2]);
-	PreLoad (PNG_LIVING, "fat_r.png", &imgfatr[1]);
-	PreLoad (PNG_SLIVING, "fat_r.png", &imgfatr[2]);
-	PreLoad (PNG_LIVING, "shadow_l.png", &imgshadowl[1]);
-	PreLoad (PNG_SLIVING, "shadow_l.png", &imgshadowl[2]);
-	PreLoad (PNG_LIVING, "shadow_r.png", &imgshadowr[1]);
-	PreLoad (PNG_SLIVING, "shadow_r.png", &imgshadowr[2]);
-	PreLoad (PNG_LIVING, "jaffar_l.png", &imgjaffarl[1]);
-	PreLoad (PNG_SLIVING, "jaffar_l.png", &imgjaffarl[2]);
-	PreLoad (PNG_LIVING, "jaffar_r.png", &imgjaffarr[1]);
-	PreLoad (PNG_SLIVING, "jaffar_r.png", &imgjaffarr[2]);
+	/*** living ***/
+	PreLoadLiving ("prince_r.png", &livprince, 35, 64, 42);
+	PreLoadLiving ("guard_r.png", &livguard, 48, 2, 42);
+	PreLoadLiving ("skel_r.png", &livskel, 28, 2, 54);
+	PreLoadLiving ("fat_r.png", &livfat, 48, 6, 42);
+	PreLoadLiving ("shadow_r.png", &livshadow, 26, 6, 52); /*** Guesses. ***/
+	PreLoadLiving ("jaffar_r.png", &livjaffar, 48, 16, 34);
 
 	/*** buttons ***/
 	PreLoad (PNG_BUTTONS, "up_0.png", &imgup_0);
@@ -2411,13 +2650,25 @@ void InitScreen (void)
 	PreLoad (PNG_ROOMS, "room23.png", &imgroom[23]);
 	PreLoad (PNG_ROOMS, "room24.png", &imgroom[24]);
 
+	/*** Decoded while editing, or when first shown. ***/
+	iDecodeBackground = 1;
+	switch (cCurType)
+	{
+		case 'd': PreLoadTiles ('p'); break;
+		case 'p': PreLoadTiles ('d'); break;
+	}
+	iDecodeBackground = 0;
+
+	AtlasDone();
 	if (iDebug == 1)
 		{ printf ("[ INFO ] Preloaded images: %i\n", iPreLoaded); }
+	arTileImg[1][0][1] = imgunk[1]; arTileImg[2][0][1] = imgunk[1];
+	arTileImg[1][0][2] = imgunk[2]; arTileImg[2][0][2] = imgunk[2];
 	SDL_SetCursor (curArrow);
 
 	/*** Defaults. ***/
 	iCurLevel = iStartLevel;
-	iCurRoom = arStartLocation[iCurLevel][1];
+	iCurRoom = arLevels[iCurLevel].arStartLocation[1];
 	iDownAt = 0;
 	iSelected = 1; /*** Start with the upper left selected. ***/
 	iScreen = 1;
@@ -2451,13 +2702,17 @@ void InitScreen (void)
 	InitPopUp();
 	while (1)
 	{
+		DecodePoll();
+		AtlasEvict();
+		GameDone();
+
 		if (iNoAnim == 0)
 		{
 			/*** This is for the game animation. ***/
 			newticks = SDL_GetTicks();
 			if (newticks > oldticks + REFRESH_GAME)
 			{
-				ShowScreen();
+				ShowFlames();
 				oldticks = newticks;
 			}
 		}
@@ -2467,7 +2722,7 @@ void InitScreen (void)
 			switch (event.type)
 			{
 				case SDL_CONTROLLERBUTTONDOWN:
-					/*** Nothing for now. ***/
+					UndoStep();
 					break;
 				case SDL_CONTROLLERBUTTONUP:
 					switch (event.cbutton.button)
@@ -2481,7 +2736,7 @@ void InitScreen (void)
 								case 1:
 									Quit(); break;
 								case 2:
-									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 									iScreen = 1; break;
 								case 3:
 									iScreen = 1; break;
@@ -2504,7 +2759,7 @@ void InitScreen (void)
 						case SDL_CONTROLLER_BUTTON_Y:
 							if (iScreen == 2)
 							{
-								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 							}
 							if (iScreen != 3)
 							{
@@ -2519,14 +2774,14 @@ void InitScreen (void)
 							}
 							if (iScreen == 3)
 							{
-								if (arEventsNext[iCurLevel][iChangeEvent] != 1)
+								if (arLevels[iCurLevel].arEvent[iChangeEvent].cNext != 1)
 								{
-									arEventsNext[iCurLevel][iChangeEvent] = 1;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 1;
 								} else {
-									arEventsNext[iCurLevel][iChangeEvent] = 0;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 0;
 								}
 								PlaySound ("wav/check_box.wav");
-								iChanged++;
+								LevelChanged();
 							}
 							break;
 						case SDL_CONTROLLER_BUTTON_GUIDE:
@@ -2570,9 +2825,9 @@ void InitScreen (void)
 						{
 							if (iScreen == 1)
 							{
-								if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][1];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[1];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -2589,9 +2844,9 @@ void InitScreen (void)
 						{
 							if (iScreen == 1)
 							{
-								if (arRoomLinks[iCurLevel][iCurRoom][2] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][2];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[2];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -2608,9 +2863,9 @@ void InitScreen (void)
 						{
 							if (iScreen == 1)
 							{
-								if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][3];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[3];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -2627,9 +2882,9 @@ void InitScreen (void)
 						{
 							if (iScreen == 1)
 							{
-								if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][4];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[4];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -2691,6 +2946,7 @@ void InitScreen (void)
 					ShowScreen();
 					break;
 				case SDL_KEYDOWN: /*** https://wiki.libsdl.org/SDL2/SDL_Keycode ***/
+					UndoStep();
 					switch (event.key.keysym.sym)
 					{
 						case SDLK_F1:
@@ -2729,7 +2985,7 @@ void InitScreen (void)
 										UseTile (-1, iTileLoop, iRoomLoop);
 									}
 								}
-								iChanged++;
+								LevelChanged();
 								PlaySound ("wav/ok_close.wav");
 							}
 							break;
@@ -2759,7 +3015,7 @@ void InitScreen (void)
 								case 1:
 									Quit(); break;
 								case 2:
-									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 									iScreen = 1; break;
 								case 3:
 									iScreen = 1; break;
@@ -2772,9 +3028,9 @@ void InitScreen (void)
 								switch (iScreen)
 								{
 									case 1:
-										if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
+										if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 										{
-											iCurRoom = arRoomLinks[iCurLevel][iCurRoom][1];
+											iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[1];
 											PlaySound ("wav/scroll.wav");
 										}
 										break;
@@ -2800,9 +3056,9 @@ void InitScreen (void)
 								switch (iScreen)
 								{
 									case 1:
-										if (arRoomLinks[iCurLevel][iCurRoom][2] != 0)
+										if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
 										{
-											iCurRoom = arRoomLinks[iCurLevel][iCurRoom][2];
+											iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[2];
 											PlaySound ("wav/scroll.wav");
 										}
 										break;
@@ -2827,9 +3083,9 @@ void InitScreen (void)
 							{
 								if (iScreen == 1)
 								{
-									if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
+									if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
 									{
-										iCurRoom = arRoomLinks[iCurLevel][iCurRoom][3];
+										iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[3];
 										PlaySound ("wav/scroll.wav");
 									}
 								}
@@ -2843,9 +3099,9 @@ void InitScreen (void)
 							{
 								if (iScreen == 1)
 								{
-									if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
+									if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 									{
-										iCurRoom = arRoomLinks[iCurLevel][iCurRoom][4];
+										iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[4];
 										PlaySound ("wav/scroll.wav");
 									}
 								}
@@ -2858,7 +3114,11 @@ void InitScreen (void)
 							break;
 						case SDLK_MINUS:
 						case SDLK_KP_MINUS:
-							if (iCurLevel != 1)
+							if ((event.key.keysym.mod & KMOD_LCTRL) ||
+								(event.key.keysym.mod & KMOD_RCTRL))
+							{
+								ChangeVolume (-10);
+							} else if (iCurLevel != 1)
 							{
 								if (iChanged != 0) { InitPopUpSave(); }
 								Prev();
@@ -2866,7 +3126,11 @@ void InitScreen (void)
 							break;
 						case SDLK_KP_PLUS:
 						case SDLK_EQUALS:
-							if (iCurLevel != LEVELS)
+							if ((event.key.keysym.mod & KMOD_LCTRL) ||
+								(event.key.keysym.mod & KMOD_RCTRL))
+							{
+								ChangeVolume (10);
+							} else if (iCurLevel != LEVELS)
 							{
 								if (iChanged != 0) { InitPopUpSave(); }
 								Next();
@@ -2889,7 +3153,7 @@ void InitScreen (void)
 						case SDLK_e:
 							if (iScreen == 2)
 							{
-								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 							}
 							if (iScreen != 3)
 							{
@@ -2900,8 +3164,11 @@ void InitScreen (void)
 						case SDLK_s:
 							if (iChanged != 0) { CallSave(); } break;
 						case SDLK_z:
-							if (iScreen == 1)
+							if ((event.key.keysym.mod & KMOD_LCTRL) ||
+								(event.key.keysym.mod & KMOD_RCTRL))
 							{
+								UndoRedo (0);
+							} else if (iScreen == 1) {
 								Zoom (0);
 								iExtras = 0;
 								PlaySound ("wav/extras.wav");
@@ -2923,12 +3190,12 @@ void InitScreen (void)
 								{
 									Sprinkle();
 									PlaySound ("wav/extras.wav");
-									iChanged++;
+									LevelChanged();
 								} else {
 									SetLocation (iCurRoom, iSelected,
 										(32 * iLastX) + iLastTile, iLastMod);
 									PlaySound ("wav/ok_close.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 							break;
@@ -2937,28 +3204,31 @@ void InitScreen (void)
 							{
 								FlipRoom (1);
 								PlaySound ("wav/extras.wav");
-								iChanged++;
+								LevelChanged();
 							}
 							break;
 						case SDLK_y:
-							if (iScreen == 3)
+							if ((event.key.keysym.mod & KMOD_LCTRL) ||
+								(event.key.keysym.mod & KMOD_RCTRL))
 							{
-								if (arEventsNext[iCurLevel][iChangeEvent] != 1)
+								UndoRedo (1);
+							} else if (iScreen == 3) {
+								if (arLevels[iCurLevel].arEvent[iChangeEvent].cNext != 1)
 								{
-									arEventsNext[iCurLevel][iChangeEvent] = 1;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 1;
 									PlaySound ("wav/check_box.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 							break;
 						case SDLK_n:
 							if (iScreen == 3)
 							{
-								if (arEventsNext[iCurLevel][iChangeEvent] != 0)
+								if (arLevels[iCurLevel].arEvent[iChangeEvent].cNext != 0)
 								{
-									arEventsNext[iCurLevel][iChangeEvent] = 0;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 0;
 									PlaySound ("wav/check_box.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 							break;
@@ -2970,11 +3240,11 @@ void InitScreen (void)
 								{
 									CopyPaste (2);
 									PlaySound ("wav/extras.wav");
-									iChanged++;
+									LevelChanged();
 								} else {
 									FlipRoom (2);
 									PlaySound ("wav/extras.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 							break;
@@ -3000,7 +3270,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x00, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_1: /*** floor ***/
@@ -3013,7 +3283,7 @@ void InitScreen (void)
 								} else {
 									SetLocation (iCurRoom, iSelected, 0x01, 0x01);
 								}
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_2: /*** loose tile ***/
@@ -3021,7 +3291,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x0B, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_3: /*** closed gate ***/
@@ -3029,7 +3299,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x04, 0x02);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_4: /*** open gate ***/
@@ -3037,7 +3307,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x04, 0x01);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_5: /*** torch ***/
@@ -3045,7 +3315,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x13, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_6: /*** spikes ***/
@@ -3053,7 +3323,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x02, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_7: /*** small pillar ***/
@@ -3061,7 +3331,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x03, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_8: /*** chomper ***/
@@ -3069,7 +3339,7 @@ void InitScreen (void)
 							if (iScreen == 1)
 							{
 								SetLocation (iCurRoom, iSelected, 0x12, 0x00);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						case SDLK_9: /*** wall ***/
@@ -3078,7 +3348,7 @@ void InitScreen (void)
 							{
 								/*** Yes, 0x01. Palace without wall pattern. ***/
 								SetLocation (iCurRoom, iSelected, 0x14, 0x01);
-								PlaySound ("wav/ok_close.wav"); iChanged++;
+								PlaySound ("wav/ok_close.wav"); LevelChanged();
 							}
 							break;
 						default: break;
@@ -3243,23 +3513,28 @@ void InitScreen (void)
 
 					break;
 				case SDL_MOUSEBUTTONDOWN:
+					UndoStep();
 					if (event.button.button == 1)
 					{
 						if (InArea (0, 50, 0 + 25, 50 + 386) == 1) /*** left arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][1] != 0) { iDownAt = 1; }
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
+								{ iDownAt = 1; }
 						}
 						if (InArea (587, 50, 587 + 25, 50 + 386) == 1) /*** right arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][2] != 0) { iDownAt = 2; }
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
+								{ iDownAt = 2; }
 						}
 						if (InArea (25, 25, 25 + 562, 25 + 25) == 1) /*** up arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][3] != 0) { iDownAt = 3; }
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
+								{ iDownAt = 3; }
 						}
 						if (InArea (25, 436, 25 + 562, 436 + 25) == 1) /*** down arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][4] != 0) { iDownAt = 4; }
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
+								{ iDownAt = 4; }
 						}
 						if (InArea (0, 25, 25, 50) == 1) /*** rooms ***/
 						{
@@ -3344,33 +3619,33 @@ void InitScreen (void)
 					{
 						if (InArea (0, 50, 0 + 25, 50 + 386) == 1) /*** left arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 							{
-								iCurRoom = arRoomLinks[iCurLevel][iCurRoom][1];
+								iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[1];
 								PlaySound ("wav/scroll.wav");
 							}
 						}
 						if (InArea (587, 50, 587 + 25, 50 + 386) == 1) /*** right arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][2] != 0)
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
 							{
-								iCurRoom = arRoomLinks[iCurLevel][iCurRoom][2];
+								iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[2];
 								PlaySound ("wav/scroll.wav");
 							}
 						}
 						if (InArea (25, 25, 25 + 562, 25 + 25) == 1) /*** up arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
 							{
-								iCurRoom = arRoomLinks[iCurLevel][iCurRoom][3];
+								iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[3];
 								PlaySound ("wav/scroll.wav");
 							}
 						}
 						if (InArea (25, 436, 25 + 562, 436 + 25) == 1) /*** down arrow ***/
 						{
-							if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
+							if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 							{
-								iCurRoom = arRoomLinks[iCurLevel][iCurRoom][4];
+								iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[4];
 								PlaySound ("wav/scroll.wav");
 							}
 						}
@@ -3388,7 +3663,7 @@ void InitScreen (void)
 						{
 							if (iScreen == 2)
 							{
-								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+								arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 							}
 							if (iScreen != 3)
 							{
@@ -3407,7 +3682,7 @@ void InitScreen (void)
 								case 1:
 									Quit(); break;
 								case 2:
-									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
+									arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
 									iScreen = 1; break;
 								case 3:
 									iScreen = 1; break;
@@ -3441,7 +3716,7 @@ void InitScreen (void)
 								{
 									SetLocation (iCurRoom, iSelected,
 										(32 * iLastX) + iLastTile, iLastMod);
-									PlaySound ("wav/ok_close.wav"); iChanged++;
+									PlaySound ("wav/ok_close.wav"); LevelChanged();
 								} else {
 									ChangePos();
 									ShowScreen(); break; /*** ? ***/
@@ -3467,7 +3742,7 @@ void InitScreen (void)
 							{
 								Sprinkle();
 								PlaySound ("wav/extras.wav");
-								iChanged++;
+								LevelChanged();
 							}
 
 							/*** 8 ***/
@@ -3475,7 +3750,7 @@ void InitScreen (void)
 							{
 								FlipRoom (1);
 								PlaySound ("wav/extras.wav");
-								iChanged++;
+								LevelChanged();
 							}
 
 							/*** 3 ***/
@@ -3483,7 +3758,7 @@ void InitScreen (void)
 							{
 								FlipRoom (2);
 								PlaySound ("wav/extras.wav");
-								iChanged++;
+								LevelChanged();
 							}
 
 							/*** 2 ***/
@@ -3498,7 +3773,7 @@ void InitScreen (void)
 							{
 								CopyPaste (2);
 								PlaySound ("wav/extras.wav");
-								iChanged++;
+								LevelChanged();
 							}
 
 							/*** 5 ***/
@@ -3534,7 +3809,7 @@ void InitScreen (void)
 													RemoveOldRoom();
 													AddNewRoom (iRoomLoop + 1,
 														iRoomLoop2 + 1, iMovingRoom);
-													iChanged++;
+													LevelChanged();
 												}
 												iMovingRoom = 0; iMovingNewBusy = 0;
 											}
@@ -3553,7 +3828,7 @@ void InitScreen (void)
 											{
 												RemoveOldRoom();
 												AddNewRoom (25, iRoomLoop2 + 1, iMovingRoom);
-												iChanged++;
+												LevelChanged();
 											}
 											iMovingRoom = 0; iMovingNewBusy = 0;
 										}
@@ -3596,9 +3871,9 @@ void InitScreen (void)
 										&& (iXPos <= ((217 + 14) +
 										((iRoomLoop - 1) * 15)) * iScale))
 									{
-										arEventsRoom[iCurLevel][iChangeEvent] = iRoomLoop;
+										arLevels[iCurLevel].arEvent[iChangeEvent].cRoom = iRoomLoop;
 										PlaySound ("wav/check_box.wav");
-										iChanged++;
+										LevelChanged();
 									}
 								}
 							}
@@ -3616,10 +3891,10 @@ void InitScreen (void)
 											&& (iYPos <= ((155 + 14) +
 											((iColLoop - 1) * 15)) * iScale))
 										{
-											arEventsTile[iCurLevel][iChangeEvent] =
+											arLevels[iCurLevel].arEvent[iChangeEvent].cTile =
 												((iColLoop - 1) * 10) + iRowLoop;
 											PlaySound ("wav/check_box.wav");
-											iChanged++;
+											LevelChanged();
 										}
 									}
 								}
@@ -3628,20 +3903,20 @@ void InitScreen (void)
 							/*** next ***/
 							if (InArea (502, 225, 502 + 14, 225 + 14) == 1) /*** N ***/
 							{
-								if (arEventsNext[iCurLevel][iChangeEvent] != 0)
+								if (arLevels[iCurLevel].arEvent[iChangeEvent].cNext != 0)
 								{
-									arEventsNext[iCurLevel][iChangeEvent] = 0;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 0;
 									PlaySound ("wav/check_box.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 							if (InArea (517, 225, 517 + 14, 225 + 14) == 1) /*** Y ***/
 							{
-								if (arEventsNext[iCurLevel][iChangeEvent] != 1)
+								if (arLevels[iCurLevel].arEvent[iChangeEvent].cNext != 1)
 								{
-									arEventsNext[iCurLevel][iChangeEvent] = 1;
+									arLevels[iCurLevel].arEvent[iChangeEvent].cNext = 1;
 									PlaySound ("wav/check_box.wav");
-									iChanged++;
+									LevelChanged();
 								}
 							}
 						}
@@ -3662,7 +3937,7 @@ void InitScreen (void)
 								}
 							}
 							PlaySound ("wav/ok_close.wav");
-							iChanged++;
+							LevelChanged();
 						}
 						if (iScreen == 2)
 						{
@@ -3687,15 +3962,15 @@ void InitScreen (void)
 							if ((keystate[SDL_SCANCODE_LSHIFT]) ||
 								(keystate[SDL_SCANCODE_RSHIFT]))
 							{ /*** right ***/
-								if (arRoomLinks[iCurLevel][iCurRoom][2] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][2];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[2];
 									PlaySound ("wav/scroll.wav");
 								}
 							} else { /*** up ***/
-								if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][3];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[3];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -3710,15 +3985,15 @@ void InitScreen (void)
 							if ((keystate[SDL_SCANCODE_LSHIFT]) ||
 								(keystate[SDL_SCANCODE_RSHIFT]))
 							{ /*** left ***/
-								if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][1];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[1];
 									PlaySound ("wav/scroll.wav");
 								}
 							} else { /*** down ***/
-								if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
+								if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 								{
-									iCurRoom = arRoomLinks[iCurLevel][iCurRoom][4];
+									iCurRoom = arLevels[iCurLevel].arRoom[iCurRoom].arLink[4];
 									PlaySound ("wav/scroll.wav");
 								}
 							}
@@ -3729,6 +4004,11 @@ void InitScreen (void)
 				case SDL_WINDOWEVENT:
 					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
 						{ ShowScreen(); } break;
+				case SDL_RENDER_TARGETS_RESET:
+					/*** frametex and roomtex were lost ***/
+					iRoomValid = 0;
+					ShowScreen();
+					break;
 				case SDL_QUIT:
 					Quit(); break;
 				default: break;
@@ -3872,9 +4152,10 @@ void ShowPopUpSave (void)
 		snprintf (arText[1], MAX_TEXT, "%s", "Do you wish to save these?");
 	}
 
-	DisplayText (140, 121, FONT_SIZE_15, arText, 2, font1);
+	DisplayText (140, 121, FONT_SIZE_15, arText, 2, &glyphs1);
 
 	/*** refresh screen ***/
+	BatchFlush();
 	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
@@ -3890,2734 +4171,2629 @@ void LoadFonts (void)
 	font3 = TTF_OpenFont ("ttf/Bitstream-Vera-Sans-Bold.ttf",
 		FONT_SIZE_20 * iScale);
 	if (font3 == NULL) { printf ("[FAILED] Font gone!\n"); exit (EXIT_ERROR); }
+	LoadGlyphs (font1, &glyphs1);
+	LoadGlyphs (font2, &glyphs2);
+	LoadGlyphs (font3, &glyphs3);
 }
 /*****************************************************************************/
-void MixAudio (void *unused, Uint8 *stream, int iLen)
+void LoadGlyphs (TTF_Font *font, struct glyphs *gly)
 /*****************************************************************************/
 {
-	int iTemp;
-	int iAmount;
+	/* Renders the glyphs of font once, next to each other on gly->tex, for
+	 * ShowText(). Below them is a white block, for the background of text.
+	 */
 
-	if (unused != NULL) { } /*** To prevent warnings. ***/
+	SDL_Surface *arSurface[GLYPHS + 2];
+	SDL_Surface *sheet;
+	SDL_Rect block;
+	SDL_Rect dest;
+	int iGlyphMinX, iGlyphMaxX, iGlyphMinY, iGlyphMaxY, iAdvance;
+	int iX, iY, iShelf;
+
+	/*** Used for looping. ***/
+	int iGlyphLoop;
+	int iGlyphLoop2;
 
-	SDL_memset (stream, 0, iLen); /*** SDL2 ***/
-	for (iTemp = 0; iTemp < NUM_SOUNDS; iTemp++)
+	gly->iHeight = TTF_FontHeight (font);
+	iX = 0;
+	iY = 0;
+	iShelf = 0;
+	for (iGlyphLoop = 0; iGlyphLoop < GLYPHS; iGlyphLoop++)
 	{
-		iAmount = (sounds[iTemp].dlen-sounds[iTemp].dpos);
-		if (iAmount > iLen)
+		arSurface[iGlyphLoop] = TTF_RenderGlyph_Blended (font,
+			GLYPH_FIRST + iGlyphLoop, color_wh);
+		if (arSurface[iGlyphLoop] == NULL)
 		{
-			iAmount = iLen;
+			printf ("[FAILED] Unable to render glyph %i: %s!\n",
+				GLYPH_FIRST + iGlyphLoop, SDL_GetError());
+			exit (EXIT_ERROR);
+		}
+		if (TTF_GlyphMetrics (font, GLYPH_FIRST + iGlyphLoop, &iGlyphMinX,
+			&iGlyphMaxX, &iGlyphMinY, &iGlyphMaxY, &iAdvance) == -1)
+		{
+			iGlyphMinX = 0;
+			iAdvance = arSurface[iGlyphLoop]->w;
+		}
+		/*** Like SDL_ttf, which starts a glyph left of the pen if needed. ***/
+		gly->arShift[iGlyphLoop] = (iGlyphMinX < 0) ? iGlyphMinX : 0;
+		gly->arAdvance[iGlyphLoop] = iAdvance;
+
+		/*** One pixel apart, so that nothing bleeds when scaled. ***/
+		if (iX + arSurface[iGlyphLoop]->w > GLYPHS_WIDTH)
+		{
+			iX = 0;
+			iY+=iShelf + 1;
+			iShelf = 0;
+		}
+		gly->arGlyph[iGlyphLoop].x = iX;
+		gly->arGlyph[iGlyphLoop].y = iY;
+		gly->arGlyph[iGlyphLoop].w = arSurface[iGlyphLoop]->w;
+		gly->arGlyph[iGlyphLoop].h = arSurface[iGlyphLoop]->h;
+		iX+=arSurface[iGlyphLoop]->w + 1;
+		if (arSurface[iGlyphLoop]->h > iShelf)
+			{ iShelf = arSurface[iGlyphLoop]->h; }
+	}
+	/*** The middle of a 4x4 block, so that no edge is sampled. ***/
+	block.x = 0;
+	block.y = iY + iShelf + 1;
+	block.w = 4;
+	block.h = 4;
+	gly->arGlyph[GLYPHS].x = block.x + 1;
+	gly->arGlyph[GLYPHS].y = block.y + 1;
+	gly->arGlyph[GLYPHS].w = 2;
+	gly->arGlyph[GLYPHS].h = 2;
+
+	for (iGlyphLoop = 0; iGlyphLoop < GLYPHS; iGlyphLoop++)
+	{
+		for (iGlyphLoop2 = 0; iGlyphLoop2 < GLYPHS; iGlyphLoop2++)
+		{
+#if SDL_TTF_VERSION_ATLEAST(2,0,14)
+			gly->arKern[iGlyphLoop][iGlyphLoop2] =
+				TTF_GetFontKerningSizeGlyphs (font, GLYPH_FIRST + iGlyphLoop,
+				GLYPH_FIRST + iGlyphLoop2);
+#else
+			gly->arKern[iGlyphLoop][iGlyphLoop2] = 0;
+#endif
 		}
-		SDL_MixAudio (stream, &sounds[iTemp].data[sounds[iTemp].dpos], iAmount,
-			SDL_MIX_MAXVOLUME);
-		sounds[iTemp].dpos += iAmount;
 	}
-}
-/*****************************************************************************/
-void PlaySound (char *sFile)
-/*****************************************************************************/
-{
-	int iIndex;
-	SDL_AudioSpec wave;
-	Uint8 *data;
-	Uint32 dlen;
-	SDL_AudioCVT cvt;
 
-	if (iNoAudio == 1) { return; }
-	for (iIndex = 0; iIndex < NUM_SOUNDS; iIndex++)
+	gly->iW = GLYPHS_WIDTH;
+	gly->iH = block.y + block.h;
+	sheet = SDL_CreateRGBSurfaceWithFormat (0, gly->iW, gly->iH, 32,
+		SDL_PIXELFORMAT_RGBA32);
+	if (sheet == NULL)
+	{
+		printf ("[FAILED] Unable to create a glyph sheet: %s!\n",
+			SDL_GetError());
+		exit (EXIT_ERROR);
+	}
+	for (iGlyphLoop = 0; iGlyphLoop < GLYPHS; iGlyphLoop++)
 	{
-		if (sounds[iIndex].dpos == sounds[iIndex].dlen)
+		/*** Copy, including alpha, instead of blending. ***/
+		SDL_SetSurfaceBlendMode (arSurface[iGlyphLoop], SDL_BLENDMODE_NONE);
+		dest = gly->arGlyph[iGlyphLoop];
+		if (SDL_BlitSurface (arSurface[iGlyphLoop], NULL, sheet, &dest) != 0)
 		{
-			break;
+			printf ("[FAILED] SDL_BlitSurface: %s!\n", SDL_GetError());
+			exit (EXIT_ERROR);
 		}
+		SDL_FreeSurface (arSurface[iGlyphLoop]);
 	}
-	if (iIndex == NUM_SOUNDS) { return; }
+	SDL_FillRect (sheet, &block, SDL_MapRGBA (sheet->format,
+		255, 255, 255, 255));
 
-	if (SDL_LoadWAV (sFile, &wave, &data, &dlen) == NULL)
+	if (gly->tex != NULL) { SDL_DestroyTexture (gly->tex); }
+	gly->tex = SDL_CreateTexture (ascreen, SDL_PIXELFORMAT_RGBA32,
+		SDL_TEXTUREACCESS_STATIC, gly->iW, gly->iH);
+	if (gly->tex == NULL)
 	{
-		printf ("[FAILED] Could not load %s: %s!\n", sFile, SDL_GetError());
+		printf ("[FAILED] Unable to create a glyph texture: %s!\n",
+			SDL_GetError());
 		exit (EXIT_ERROR);
 	}
-	SDL_BuildAudioCVT (&cvt, wave.format, wave.channels, wave.freq, AUDIO_S16, 2,
-		44100);
-	/*** The "+ 1" is a workaround for SDL bug #2274. ***/
-	cvt.buf = (Uint8 *)malloc (dlen * (cvt.len_mult + 1));
-	memcpy (cvt.buf, data, dlen);
-	cvt.len = dlen;
-	SDL_ConvertAudio (&cvt);
-	SDL_FreeWAV (data);
-
-	if (sounds[iIndex].data)
+	SDL_SetTextureBlendMode (gly->tex, SDL_BLENDMODE_BLEND);
+	if (SDL_UpdateTexture (gly->tex, NULL, sheet->pixels, sheet->pitch) != 0)
 	{
-		free (sounds[iIndex].data);
+		printf ("[ WARN ] SDL_UpdateTexture: %s!\n", SDL_GetError());
 	}
-	SDL_LockAudio();
-	sounds[iIndex].data = cvt.buf;
-	sounds[iIndex].dlen = cvt.len_cvt;
-	sounds[iIndex].dpos = 0;
-	SDL_UnlockAudio();
+	SDL_FreeSurface (sheet);
 }
 /*****************************************************************************/
-void PreLoadSet (char cTypeP, int iTile, int iMod)
+void MixAudio (void *unused, Uint8 *stream, int iLen)
 /*****************************************************************************/
 {
-	char sDir[MAX_PATHFILE + 2];
-	char sImage[MAX_IMG + 2];
-	int iBarHeight;
+	/* Only the voices in arActive[] are mixed. Samples are scaled by their
+	 * gain and added up in arMix[], and are saturated to 16 bits once, by
+	 * MixOut(). With at most NUM_SOUNDS voices at SDL_MIX_MAXVOLUME, the
+	 * sums cannot overflow 32 bits.
+	 */
 
-	switch (cTypeP)
+	Sint16 *arOut;
+	int iSamples, iChunk, iAmount, iGain;
+	struct sample *voice;
+
+	/*** Used for looping. ***/
+	int iActiveLoop;
+
+	if (unused != NULL) { } /*** To prevent warnings. ***/
+
+	TakeAudio();
+	if (iActive == 0)
 	{
-		case 'd':
-			/*** regular ***/
-			snprintf (sDir, MAX_PATHFILE, "png%sdungeon%s", SLASH, SLASH);
-			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
-			imgd[iTile][iMod][1] = IMG_LoadTexture (ascreen, sImage);
-			/*** selected ***/
-			snprintf (sDir, MAX_PATHFILE, "png%ssdungeon%s", SLASH, SLASH);
-			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
-			imgd[iTile][iMod][2] = IMG_LoadTexture (ascreen, sImage);
-			if ((!imgd[iTile][iMod][1]) || (!imgd[iTile][iMod][2]))
+		SDL_memset (stream, 0, iLen); /*** SDL2 ***/
+		return;
+	}
+
+	arOut = (Sint16 *)stream;
+	iSamples = iLen / 2;
+	while (iSamples > 0)
+	{
+		iChunk = iSamples;
+		if (iChunk > MIX_SAMPLES) { iChunk = MIX_SAMPLES; }
+		SDL_memset (arMix, 0, iChunk * sizeof (Sint32));
+		iActiveLoop = 0;
+		while (iActiveLoop < iActive)
+		{
+			voice = &sounds[arActive[iActiveLoop]];
+			iAmount = (voice->dlen - voice->dpos) / 2;
+			if (iAmount > iChunk) { iAmount = iChunk; }
+			iGain = (voice->iGain * iVolume) / SDL_MIX_MAXVOLUME;
+			if (iGain != 0)
 			{
-				printf ("[FAILED] IMG_LoadTexture: %s!\n", IMG_GetError());
-				exit (EXIT_ERROR);
+				MixVoice (arMix, (Sint16 *)&voice->data[voice->dpos],
+					iAmount, iGain);
 			}
-			break;
-		case 'p':
-			/*** regular ***/
-			snprintf (sDir, MAX_PATHFILE, "png%spalace%s", SLASH, SLASH);
-			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
-			imgp[iTile][iMod][1] = IMG_LoadTexture (ascreen, sImage);
-			/*** selected ***/
-			snprintf (sDir, MAX_PATHFILE, "png%sspalace%s", SLASH, SLASH);
-			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
-			imgp[iTile][iMod][2] = IMG_LoadTexture (ascreen, sImage);
-			if ((!imgp[iTile][iMod][1]) || (!imgp[iTile][iMod][2]))
+			voice->dpos += iAmount * 2;
+			if (voice->dpos == voice->dlen)
 			{
-				printf ("[FAILED] IMG_LoadTexture: %s!\n", IMG_GetError());
-				exit (EXIT_ERROR);
+				iActive--;
+				arActive[iActiveLoop] = arActive[iActive];
+			} else {
+				iActiveLoop++;
 			}
-			break;
+		}
+		MixOut (arOut, arMix, iChunk);
+		arOut+=iChunk;
+		iSamples-=iChunk;
 	}
-
-	iPreLoaded+=2;
-	iBarHeight = (int)(((float)iPreLoaded/(float)iNrToPreLoad) * BAR_FULL);
-	if (iBarHeight >= iCurrentBarHeight + 10) { LoadingBar (iBarHeight); }
 }
 /*****************************************************************************/
-void PreLoad (char *sPath, char *sPNG, SDL_Texture **imgImage)
+void MixVoice (Sint32 *arAcc, Sint16 *arSrc, int iSamples, int iGain)
 /*****************************************************************************/
 {
-	char sImage[MAX_IMG + 2];
-	int iBarHeight;
+	int iSample;
+#if defined __SSE2__
+	__m128i gain, src, lo, hi;
+#endif
 
-	snprintf (sImage, MAX_IMG, "png%s%s%s%s", SLASH, sPath, SLASH, sPNG);
-	*imgImage = IMG_LoadTexture (ascreen, sImage);
-	if (!*imgImage)
+	iSample = 0;
+#if defined __SSE2__
+	gain = _mm_set1_epi16 ((short)iGain);
+	for (; iSample + 8 <= iSamples; iSample+=8)
+	{
+		src = _mm_loadu_si128 ((__m128i *)&arSrc[iSample]);
+		lo = _mm_mullo_epi16 (src, gain);
+		hi = _mm_mulhi_epi16 (src, gain);
+		_mm_storeu_si128 ((__m128i *)&arAcc[iSample],
+			_mm_add_epi32 (_mm_loadu_si128 ((__m128i *)&arAcc[iSample]),
+			_mm_unpacklo_epi16 (lo, hi)));
+		_mm_storeu_si128 ((__m128i *)&arAcc[iSample + 4],
+			_mm_add_epi32 (_mm_loadu_si128 ((__m128i *)&arAcc[iSample + 4]),
+			_mm_unpackhi_epi16 (lo, hi)));
+	}
+#elif defined __ARM_NEON
+	for (; iSample + 8 <= iSamples; iSample+=8)
+	{
+		int16x8_t src = vld1q_s16 (&arSrc[iSample]);
+		vst1q_s32 (&arAcc[iSample], vmlal_n_s16 (vld1q_s32 (&arAcc[iSample]),
+			vget_low_s16 (src), (int16_t)iGain));
+		vst1q_s32 (&arAcc[iSample + 4], vmlal_n_s16 (vld1q_s32
+			(&arAcc[iSample + 4]), vget_high_s16 (src), (int16_t)iGain));
+	}
+#endif
+	for (; iSample < iSamples; iSample++)
 	{
-		printf ("[FAILED] IMG_LoadTexture: %s!\n", IMG_GetError());
-		exit (EXIT_ERROR);
+		arAcc[iSample]+=arSrc[iSample] * iGain;
 	}
+}
+/*****************************************************************************/
+void MixOut (Sint16 *arOut, Sint32 *arAcc, int iSamples)
+/*****************************************************************************/
+{
+	/*** Removes the gain scale (SDL_MIX_MAXVOLUME) and saturates. ***/
 
-	iPreLoaded++;
-	iBarHeight = (int)(((float)iPreLoaded/(float)iNrToPreLoad) * BAR_FULL);
-	if (iBarHeight >= iCurrentBarHeight + 10) { LoadingBar (iBarHeight); }
+	int iSample;
+	Sint32 iValue;
+
+	iSample = 0;
+#if defined __SSE2__
+	for (; iSample + 8 <= iSamples; iSample+=8)
+	{
+		_mm_storeu_si128 ((__m128i *)&arOut[iSample], _mm_packs_epi32
+			(_mm_srai_epi32 (_mm_loadu_si128 ((__m128i *)&arAcc[iSample]), 7),
+			_mm_srai_epi32 (_mm_loadu_si128 ((__m128i *)&arAcc[iSample + 4]), 7)));
+	}
+#elif defined __ARM_NEON
+	for (; iSample + 8 <= iSamples; iSample+=8)
+	{
+		vst1q_s16 (&arOut[iSample], vcombine_s16
+			(vqshrn_n_s32 (vld1q_s32 (&arAcc[iSample]), 7),
+			vqshrn_n_s32 (vld1q_s32 (&arAcc[iSample + 4]), 7)));
+	}
+#endif
+	for (; iSample < iSamples; iSample++)
+	{
+		iValue = arAcc[iSample] >> 7;
+		if (iValue > 32767) { iValue = 32767; }
+		if (iValue < -32768) { iValue = -32768; }
+		arOut[iSample] = (Sint16)iValue;
+	}
 }
 /*****************************************************************************/
-void ShowScreen (void)
+void PlaySound (char *sFile)
 /*****************************************************************************/
 {
-	int iTile;
-	int iMod;
-	int iLoc;
-	int iHorL, iVerL;
-	char sLevelBar[MAX_TEXT + 2];
-	char sLevelBarF[MAX_TEXT + 2];
-	int iUnusedRooms;
-	int iX, iY;
-	SDL_Texture *imgskel[2 + 2];
-	SDL_Texture *imgfat[2 + 2];
-	SDL_Texture *imgshadow[2 + 2];
-	SDL_Texture *imgjaffar[2 + 2];
-	SDL_Texture *imgguard[2 + 2];
-	int iEventUnused;
-	int iToRoom;
-	int iEventRoom, iEventTile, iEventNext, iShowTile, iShowMod;
-	char sText[MAX_TEXT + 2];
-	int iHorSkel, iHorFat, iHorShadow, iHorJaffar, iHorGuard;
+	PlaySoundGain (sFile, SDL_MIX_MAXVOLUME);
+}
+/*****************************************************************************/
+void PlaySoundGain (char *sFile, int iGain)
+/*****************************************************************************/
+{
+	struct sound *snd;
+	struct command cmd;
 
 	/*** Used for looping. ***/
-	int iTileLoop;
-	int iRoomLoop;
-	int iSideLoop;
-
-	/*** black background ***/
-	ShowImage (imgblack, 0, 0, "imgblack");
+	int iSoundLoop;
 
-	if (iScreen == 1)
+	if (iNoAudio == 1) { return; }
+	snd = NULL;
+	for (iSoundLoop = 0; iSoundLoop < iSounds; iSoundLoop++)
 	{
-		/*** One tile: 'top' row, room left down. ***/
-		if (arRoomLinks[iCurLevel][iCurRoom][1] != 0) /*** left ***/
+		if (strcmp (arSound[iSoundLoop].sFile, sFile) == 0)
 		{
-			if (arRoomLinks[iCurLevel]
-				[arRoomLinks[iCurLevel][iCurRoom][1]][4] != 0) /*** down ***/
-			{
-				GetTileMod (arRoomLinks[iCurLevel][arRoomLinks[iCurLevel]
-					[iCurRoom][1]][4], 10, &iTile, &iMod);
-			} else {
-				iTile = 0x14;
-				iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
-			}
-		} else {
-			iTile = 0x14;
-			iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
+			snd = &arSound[iSoundLoop];
+			break;
 		}
-		snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-		ShowImage (NULL, iHor[0], iVer4, sInfo);
-		ShowImage (imgfadeds, iHor[0], iVer4, "imgfadeds");
+	}
+	if (snd == NULL) { snd = LoadSound (sFile); }
 
-		/*** One tile: bottom row, room left. ***/
-		if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
-		{
-			GetTileMod (arRoomLinks[iCurLevel][iCurRoom][1], 30, &iTile, &iMod);
-		} else {
-			iTile = 0x14;
-			iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
-		}
-		snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-		ShowImage (NULL, iHor[0], iVer3, sInfo);
-		ShowImage (imgfadeds, iHor[0], iVer3, "imgfadeds");
+	cmd.iType = AUDIO_PLAY;
+	cmd.data = snd->data;
+	cmd.dlen = snd->dlen;
+	cmd.iVolume = iGain;
+	SendAudio (&cmd);
+}
+/*****************************************************************************/
+void SetVolume (int iNewVolume)
+/*****************************************************************************/
+{
+	struct command cmd;
 
-		/*** One tile: middle row, room left. ***/
-		if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
-		{
-			GetTileMod (arRoomLinks[iCurLevel][iCurRoom][1], 20, &iTile, &iMod);
-		} else {
-			iTile = 0x14;
-			iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
-		}
-		snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-		ShowImage (NULL, iHor[0], iVer2, sInfo);
-		ShowImage (imgfadeds, iHor[0], iVer2, "imgfadeds");
+	if (iNoAudio == 1) { return; }
+	cmd.iType = AUDIO_VOLUME;
+	cmd.data = NULL;
+	cmd.dlen = 0;
+	cmd.iVolume = iNewVolume;
+	SendAudio (&cmd);
+}
+/*****************************************************************************/
+void ChangeVolume (int iChange)
+/*****************************************************************************/
+{
+	iMasterVolume+=iChange;
+	if (iMasterVolume < 0) { iMasterVolume = 0; }
+	if (iMasterVolume > 100) { iMasterVolume = 100; }
+	SetVolume ((iMasterVolume * SDL_MIX_MAXVOLUME) / 100);
+	PlaySound ("wav/plus_minus.wav");
+	if (iDebug == 1)
+	{
+		printf ("[ INFO ] Sound effect volume: %i%%.\n", iMasterVolume);
+	}
+}
+/*****************************************************************************/
+int SendAudio (struct command *cmd)
+/*****************************************************************************/
+{
+	/* Called from the main thread only; the ring has a single producer, so
+	 * other threads must not call PlaySound() or SetVolume(). Never waits
+	 * for the audio device; if the callback has fallen that far behind, the
+	 * command is dropped, just like a sound that finds no free voice.
+	 */
 
-		/*** One tile: top row, room left. ***/
-		if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
-		{
-			GetTileMod (arRoomLinks[iCurLevel][iCurRoom][1], 10, &iTile, &iMod);
-		} else {
-			iTile = 0x14;
-			iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
-		}
-		snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-		ShowImage (NULL, iHor[0], iVer1, sInfo);
-		ShowImage (imgfadeds, iHor[0], iVer1, "imgfadeds");
+	int iHead, iNext;
 
-		/*** Under this room. ***/
-		if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
-		{
-			for (iTileLoop = 1; iTileLoop <= (TILES / 3); iTileLoop++)
-			{
-				GetTileMod (arRoomLinks[iCurLevel][iCurRoom][4], iTileLoop,
-					&iTile, &iMod);
-				snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-				ShowImage (NULL, iHor[iTileLoop], iVer4, sInfo);
-			}
-		}
+	iHead = SDL_AtomicGet (&aCommandHead);
+	iNext = (iHead + 1) % AUDIO_COMMANDS;
+	if (iNext == SDL_AtomicGet (&aCommandTail)) { return (0); }
+	arCommand[iHead] = *cmd;
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet (&aCommandHead, iNext);
 
-		/*** Inside the room. ***/
-		for (iTileLoop = 1; iTileLoop <= 30; iTileLoop++)
-		{
-			iLoc = 0;
-			iHorL = iHor[0]; /*** To prevent warnings. ***/
-			iVerL = iVer0; /*** To prevent warnings. ***/
-			if ((iTileLoop >= 1) && (iTileLoop <= 10))
-			{
-				iLoc = 20 + iTileLoop;
-				iHorL = iHor[iTileLoop];
-				iVerL = iVer3;
-			}
-			if ((iTileLoop >= 11) && (iTileLoop <= 20))
-			{
-				iLoc = iTileLoop;
-				iHorL = iHor[iTileLoop - 10];
-				iVerL = iVer2;
-			}
-			if ((iTileLoop >= 21) && (iTileLoop <= 30))
-			{
-				iLoc = -20 + iTileLoop;
-				iHorL = iHor[iTileLoop - 20];
-				iVerL = iVer1;
-			}
-			GetTileMod (iCurRoom, iLoc, &iTile, &iMod);
-			snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-			ShowImage (NULL, iHorL, iVerL, sInfo);
-			if (iLoc == iSelected)
-			{
-				snprintf (sInfo, MAX_INFO, "high=%02x_%02x", iTile, iMod);
-				ShowImage (NULL, iHorL, iVerL, sInfo);
-			}
+	return (1);
+}
+/*****************************************************************************/
+void TakeAudio (void)
+/*****************************************************************************/
+{
+	/*** Called from MixAudio(), in the audio thread. ***/
 
-			/*** prince ***/
-			if ((iCurRoom == arStartLocation[iCurLevel][1]) &&
-				(iLoc == arStartLocation[iCurLevel][2]))
-			{
-				switch (arStartLocation[iCurLevel][3])
-				{
-					case 0x00: /*** looks right ***/
-						ShowImage (imgprincer[1], iHorL + 64, iVerL + 42, "imgprincer[1]");
-						if (iSelected == iLoc)
-							{ ShowImage (imgprincer[2], iHorL + 64,
-							iVerL + 42, "imgprincer[2]"); }
-						break;
-					case 0xFF: /*** looks left ***/
-						ShowImage (imgprincel[1], iHorL + 35, iVerL + 42, "imgprincel[1]");
-						if (iSelected == iLoc)
-							{ ShowImage (imgprincel[2], iHorL + 35,
-							iVerL + 42, "imgprincel[2]"); }
-						break;
-					default:
-						printf ("[ WARN ] Strange prince direction: 0x%02x!\n",
-							arStartLocation[iCurLevel][3]);
-				}
-			}
+	int iTail;
+	struct command *cmd;
 
-			/*** guard ***/
-			if (arGuardTile[iCurLevel][iCurRoom] == iLoc)
-			{
-				switch (arGuardDir[iCurLevel][iCurRoom])
-				{
-					case 0xFF: /*** l ***/
-						imgskel[1] = imgskell[1];
-						imgfat[1] = imgfatl[1];
-						imgshadow[1] = imgshadowl[1];
-						imgjaffar[1] = imgjaffarl[1];
-						imgguard[1] = imgguardl[1];
-						imgskel[2] = imgskell[2];
-						imgfat[2] = imgfatl[2];
-						imgshadow[2] = imgshadowl[2];
-						imgjaffar[2] = imgjaffarl[2];
-						imgguard[2] = imgguardl[2];
-						iHorSkel = 28;
-						iHorFat = 48;
-						iHorShadow = 26; /*** Informed guess. ***/
-						iHorJaffar = 48;
-						iHorGuard = 48;
-						break;
-					case 0x00: /*** r ***/
-						imgskel[1] = imgskelr[1];
-						imgfat[1] = imgfatr[1];
-						imgshadow[1] = imgshadowr[1];
-						imgjaffar[1] = imgjaffarr[1];
-						imgguard[1] = imgguardr[1];
-						imgskel[2] = imgskelr[2];
-						imgfat[2] = imgfatr[2];
-						imgshadow[2] = imgshadowr[2];
-						imgjaffar[2] = imgjaffarr[2];
-						imgguard[2] = imgguardr[2];
-						iHorSkel = 2;
-						iHorFat = 6;
-						iHorShadow = 6; /*** Guess. ***/
-						iHorJaffar = 16;
-						iHorGuard = 2;
-						break;
-					default:
-						printf ("[FAILED] Incorrect guard direction: 0x%02x!\n",
-							arGuardDir[iCurLevel][iCurRoom]);
-						exit (EXIT_ERROR);
-				}
-				switch (iCurGuard)
+	/*** Used for looping. ***/
+	int iVoiceLoop;
+
+	iTail = SDL_AtomicGet (&aCommandTail);
+	while (iTail != SDL_AtomicGet (&aCommandHead))
+	{
+		SDL_MemoryBarrierAcquire();
+		cmd = &arCommand[iTail];
+		switch (cmd->iType)
+		{
+			case AUDIO_PLAY:
+				if (cmd->dlen == 0) { break; }
+				for (iVoiceLoop = 0; iVoiceLoop < NUM_SOUNDS; iVoiceLoop++)
 				{
-					case 0x01: /*** skeleton ***/
-						ShowImage (imgskel[1], iHorL + iHorSkel,
-							iVerL + 54, "imgskel[1]");
-						if (iLoc == iSelected)
-							{ ShowImage (imgskel[2], iHorL + iHorSkel,
-							iVerL + 54, "imgskel[2]"); }
-						break;
-					case 0x03: /*** fat ***/
-						ShowImage (imgfat[1], iHorL + iHorFat,
-							iVerL + 42, "imgfat[1]");
-						if (iLoc == iSelected)
-							{ ShowImage (imgfat[2], iHorL + iHorFat,
-							iVerL + 42, "imgfat[2]"); }
-						break;
-					case 0x04: /*** shadow ***/
-						ShowImage (imgshadow[1], iHorL + iHorShadow,
-							iVerL + 52, "imgshadow[1]"); /*** Informed guess. ***/
-						if (iLoc == iSelected)
-							{ ShowImage (imgshadow[2], iHorL + iHorShadow,
-							iVerL + 52, "imgshadow[2]"); } /*** Informed guess. ***/
-						break;
-					case 0x05: /*** Jaffar ***/
-						ShowImage (imgjaffar[1], iHorL + iHorJaffar,
-							iVerL + 34, "imgjaffar[1]");
-						if (iLoc == iSelected)
-							{ ShowImage (imgjaffar[2], iHorL + iHorJaffar,
-							iVerL + 34, "imgjaffar[2]"); }
-						break;
-					default: /*** guard; 0x00 and 0x02 ***/
-						ShowImage (imgguard[1], iHorL + iHorGuard,
-							iVerL + 42, "imgguard[1]");
-						if (iLoc == iSelected)
-							{ ShowImage (imgguard[2], iHorL + iHorGuard,
-							iVerL + 42, "imgguard[2]"); }
+					if (sounds[iVoiceLoop].dpos == sounds[iVoiceLoop].dlen)
+					{
+						sounds[iVoiceLoop].data = cmd->data;
+						sounds[iVoiceLoop].dlen = cmd->dlen;
+						sounds[iVoiceLoop].dpos = 0;
+						sounds[iVoiceLoop].iGain = cmd->iVolume;
+						if (sounds[iVoiceLoop].iGain < 0)
+							{ sounds[iVoiceLoop].iGain = 0; }
+						if (sounds[iVoiceLoop].iGain > SDL_MIX_MAXVOLUME)
+							{ sounds[iVoiceLoop].iGain = SDL_MIX_MAXVOLUME; }
+						arActive[iActive] = iVoiceLoop;
+						iActive++;
 						break;
+					}
 				}
-				switch (arGuardSkill[iCurLevel][iCurRoom])
-				{
-					case 10:
-						snprintf (sText, MAX_TEXT, "%s", "T:a"); break;
-					case 11:
-						snprintf (sText, MAX_TEXT, "%s", "T:b"); break;
-					default:
-						snprintf (sText, MAX_TEXT, "T:%i",
-							arGuardSkill[iCurLevel][iCurRoom]); break;
-				}
-				message = TTF_RenderText_Shaded (font2, sText, color_bl, color_wh);
-				messaget = SDL_CreateTextureFromSurface (ascreen, message);
-				offset.x = iHorL;
-				offset.y = iVerL + 125;
-				offset.w = message->w; offset.h = message->h;
-				CustomRenderCopy (messaget, NULL, &offset, "message");
-				SDL_DestroyTexture (messaget); SDL_FreeSurface (message);
-			}
+				break;
+			case AUDIO_VOLUME:
+				iVolume = cmd->iVolume;
+				if (iVolume < 0) { iVolume = 0; }
+				if (iVolume > SDL_MIX_MAXVOLUME) { iVolume = SDL_MIX_MAXVOLUME; }
+				break;
 		}
+		iTail = (iTail + 1) % AUDIO_COMMANDS;
+		SDL_MemoryBarrierRelease();
+		SDL_AtomicSet (&aCommandTail, iTail);
+	}
+}
+/*****************************************************************************/
+void PreLoadSounds (void)
+/*****************************************************************************/
+{
+	/* Converts all sounds up front, so that PlaySound() only has to claim
+	 * a voice. A file that is not listed here is converted on first use.
+	 */
 
-		/*** Above this room. ***/
-		for (iTileLoop = 1; iTileLoop <= (TILES / 3); iTileLoop++)
-		{
-			if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
-			{
-				GetTileMod (arRoomLinks[iCurLevel][iCurRoom][3], iTileLoop + 20,
-					&iTile, &iMod);
-			} else {
-				iTile = 0x01; iMod = 0x00; /*** Floor. ***/
-			}
-			snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iTile, iMod);
-			ShowImage (NULL, iHor[iTileLoop], iVer0, sInfo);
-		}
+	LoadSound ("wav/check_box.wav");
+	LoadSound ("wav/cross.wav");
+	LoadSound ("wav/emulator.wav");
+	LoadSound ("wav/extras.wav");
+	LoadSound ("wav/hum_adj.wav");
+	LoadSound ("wav/level_change.wav");
+	LoadSound ("wav/move_room.wav");
+	LoadSound ("wav/ok_close.wav");
+	LoadSound ("wav/plus_minus.wav");
+	LoadSound ("wav/popup.wav");
+	LoadSound ("wav/popup_close.wav");
+	LoadSound ("wav/popup_yn.wav");
+	LoadSound ("wav/save.wav");
+	LoadSound ("wav/screen2or3.wav");
+	LoadSound ("wav/scroll.wav");
+}
+/*****************************************************************************/
+struct sound *LoadSound (char *sFile)
+/*****************************************************************************/
+{
+	SDL_AudioSpec wave;
+	Uint8 *data;
+	Uint32 dlen;
+	SDL_AudioCVT cvt;
+	struct sound *snd;
+
+	if (iSounds == SOUNDS)
+	{
+		printf ("[FAILED] Too many sounds: %s!\n", sFile);
+		exit (EXIT_ERROR);
 	}
-	if (iScreen == 2) /*** R ***/
+	if (SDL_LoadWAV (sFile, &wave, &data, &dlen) == NULL)
 	{
-		if (arBrokenRoomLinks[iCurLevel] == 0)
-		{
-			InitRooms();
-			/*** room links ***/
-			ShowImage (imgrl, 25, 50, "imgrl");
-			/*** rooms broken on ***/
-			if (iDownAt == 11)
-			{
-				ShowImage (imgbroomson_1, 546, 66, "imgbroomson_1"); /*** down ***/
-			} else {
-				ShowImage (imgbroomson_0, 546, 66, "imgbroomson_0"); /*** up ***/
-			}
-			WhereToStart();
-			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-			{
-				arDone[iRoomLoop] = 0;
-			}
-			ShowRooms (arStartLocation[iCurLevel][1], iStartRoomsX, iStartRoomsY, 1);
-			iUnusedRooms = 0;
-			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-			{
-				if (arDone[iRoomLoop] != 1)
-				{
-					iUnusedRooms++;
-					ShowRooms (iRoomLoop, 25, iUnusedRooms, 0);
-				}
-			}
-			if (iMovingRoom != 0)
-			{
-				iX = (iXPos + 10) / iScale;
-				iY = (iYPos + 10) / iScale;
-				ShowImage (imgroom[iMovingRoom], iX, iY, "imgroom[...]");
-				if (iCurRoom == iMovingRoom)
-				{
-					ShowImage (imgsrc, iX, iY, "imgsrc"); /*** green stripes ***/
-				}
-				if (arStartLocation[iCurLevel][1] == iMovingRoom)
-				{
-					ShowImage (imgsrs, iX, iY, "imgsrs"); /*** blue border ***/
-				}
-				ShowImage (imgsrm, iX, iY, "imgsrm"); /*** red stripes ***/
-				ShowRooms (-1, iMovingNewX, iMovingNewY, 0);
-			}
-		} else {
-			/*** broken room links ***/
-			ShowImage (imgbrl, 25, 50, "imgbrl");
-			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-			{
-				/*** green stripes ***/
-				if (iCurRoom == iRoomLoop)
-				{
-					BrokenRoomChange (iRoomLoop, 0, &iX, &iY);
-					ShowImage (imgsrc, iX, iY, "imgsrc");
-				}
-
-				/*** blue border ***/
-				if (arStartLocation[iCurLevel][1] == iRoomLoop)
-				{
-					BrokenRoomChange (iRoomLoop, 0, &iX, &iY);
-					ShowImage (imgsrs, iX, iY, "imgsrs");
-				}
+		printf ("[FAILED] Could not load %s: %s!\n", sFile, SDL_GetError());
+		exit (EXIT_ERROR);
+	}
+	SDL_BuildAudioCVT (&cvt, wave.format, wave.channels, wave.freq,
+		AUDIO_S16SYS, 2, 44100);
+	/*** The "+ 1" is a workaround for SDL bug #2274. ***/
+	cvt.buf = (Uint8 *)malloc (dlen * (cvt.len_mult + 1));
+	if (cvt.buf == NULL)
+	{
+		printf ("[FAILED] Could not allocate sound: %s!\n", sFile);
+		exit (EXIT_ERROR);
+	}
+	memcpy (cvt.buf, data, dlen);
+	cvt.len = dlen;
+	SDL_ConvertAudio (&cvt);
+	SDL_FreeWAV (data);
 
-				for (iSideLoop = 1; iSideLoop <= 4; iSideLoop++)
-				{
-					if (arRoomLinks[iCurLevel][iRoomLoop][iSideLoop] != 0)
-					{
-						BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
-						iToRoom = arRoomLinks[iCurLevel][iRoomLoop][iSideLoop];
-						ShowImage (imgroom[iToRoom], iX, iY, "imgroom[...]");
+	snd = &arSound[iSounds];
+	snprintf (snd->sFile, MAX_PATHFILE, "%s", sFile);
+	snd->data = cvt.buf;
+	snd->dlen = cvt.len_cvt & ~3; /*** Whole stereo frames. ***/
+	iSounds++;
 
-						/*** blue square ***/
-						if (arRoomConnectionsBroken[iCurLevel][iRoomLoop][iSideLoop] == 1)
-						{
-							BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
-							ShowImage (imgsrb, iX, iY, "imgsrb");
-						}
-					}
+	return (snd);
+}
+/*****************************************************************************/
+void PreLoadTiles (char cTypeP)
+/*****************************************************************************/
+{
+	PreLoadSet (cTypeP, 0x00, 0x00);
+	PreLoadSet (cTypeP, 0x00, 0x01);
+	PreLoadSet (cTypeP, 0x00, 0x02);
+	PreLoadSet (cTypeP, 0x00, 0x03);
+	PreLoadSet (cTypeP, 0x00, 0xFF);
+	PreLoadSet (cTypeP, 0x01, 0x00);
+	PreLoadSet (cTypeP, 0x01, 0x01);
+	PreLoadSet (cTypeP, 0x01, 0x02);
+	PreLoadSet (cTypeP, 0x01, 0x03);
+	PreLoadSet (cTypeP, 0x01, 0xFF);
+	PreLoadSet (cTypeP, 0x02, 0x00);
+	PreLoadSet (cTypeP, 0x02, 0x01);
+	PreLoadSet (cTypeP, 0x02, 0x02);
+	PreLoadSet (cTypeP, 0x02, 0x03);
+	PreLoadSet (cTypeP, 0x02, 0x04);
+	PreLoadSet (cTypeP, 0x02, 0x05);
+	PreLoadSet (cTypeP, 0x02, 0x06);
+	PreLoadSet (cTypeP, 0x02, 0x07);
+	PreLoadSet (cTypeP, 0x02, 0x08);
+	PreLoadSet (cTypeP, 0x02, 0x09);
+	PreLoadSet (cTypeP, 0x03, 0x00);
+	PreLoadSet (cTypeP, 0x04, 0x01);
+	PreLoadSet (cTypeP, 0x04, 0x02);
+	PreLoadSet (cTypeP, 0x05, 0x00);
+	PreLoadSet (cTypeP, 0x06, 0x00);
+	PreLoadSet (cTypeP, 0x07, 0x00);
+	PreLoadSet (cTypeP, 0x07, 0x01);
+	PreLoadSet (cTypeP, 0x07, 0x02);
+	PreLoadSet (cTypeP, 0x07, 0x03);
+	PreLoadSet (cTypeP, 0x08, 0x00);
+	PreLoadSet (cTypeP, 0x09, 0x00);
+	PreLoadSet (cTypeP, 0x0A, 0x00);
+	PreLoadSet (cTypeP, 0x0A, 0x01);
+	PreLoadSet (cTypeP, 0x0A, 0x02);
+	PreLoadSet (cTypeP, 0x0A, 0x03);
+	PreLoadSet (cTypeP, 0x0A, 0x04);
+	PreLoadSet (cTypeP, 0x0A, 0x05);
+	PreLoadSet (cTypeP, 0x0A, 0x06);
+	PreLoadSet (cTypeP, 0x0B, 0x00);
+	PreLoadSet (cTypeP, 0x0C, 0x00);
+	PreLoadSet (cTypeP, 0x0C, 0x01);
+	PreLoadSet (cTypeP, 0x0C, 0x02);
+	PreLoadSet (cTypeP, 0x0C, 0x03);
+	PreLoadSet (cTypeP, 0x0C, 0x04);
+	PreLoadSet (cTypeP, 0x0C, 0x05);
+	PreLoadSet (cTypeP, 0x0C, 0x06);
+	PreLoadSet (cTypeP, 0x0C, 0x07);
+	PreLoadSet (cTypeP, 0x0D, 0x00);
+	PreLoadSet (cTypeP, 0x0E, 0x00);
+	PreLoadSet (cTypeP, 0x0F, 0x00);
+	PreLoadSet (cTypeP, 0x10, 0x00);
+	PreLoadSet (cTypeP, 0x11, 0x00);
+	PreLoadSet (cTypeP, 0x12, 0x00);
+	PreLoadSet (cTypeP, 0x12, 0x01);
+	PreLoadSet (cTypeP, 0x12, 0x02);
+	PreLoadSet (cTypeP, 0x12, 0x03);
+	PreLoadSet (cTypeP, 0x12, 0x04);
+	PreLoadSet (cTypeP, 0x12, 0x05);
+	PreLoadSet (cTypeP, 0x12, 0x80);
+	PreLoadSet (cTypeP, 0x12, 0x81);
+	PreLoadSet (cTypeP, 0x12, 0x82);
+	PreLoadSet (cTypeP, 0x12, 0x83);
+	PreLoadSet (cTypeP, 0x12, 0x84);
+	PreLoadSet (cTypeP, 0x12, 0x85);
+	PreLoadSet (cTypeP, 0x13, 0x00);
+	PreLoadSet (cTypeP, 0x14, 0x00);
+	PreLoadSet (cTypeP, 0x14, 0x01);
+	PreLoadSet (cTypeP, 0x15, 0x00);
+	PreLoadSet (cTypeP, 0x16, 0x00);
+	PreLoadSet (cTypeP, 0x17, 0x00);
+	PreLoadSet (cTypeP, 0x18, 0x00);
+	PreLoadSet (cTypeP, 0x19, 0x00);
+	PreLoadSet (cTypeP, 0x1A, 0x00);
+	PreLoadSet (cTypeP, 0x1B, 0x00);
+	PreLoadSet (cTypeP, 0x1C, 0x00);
+	PreLoadSet (cTypeP, 0x1D, 0x00);
+	PreLoadSet (cTypeP, 0x1E, 0x00);
+	PreLoadSet (cTypeP, 0x2B, 0x00);
+}
+/*****************************************************************************/
+void PreLoadSet (char cTypeP, int iTile, int iMod)
+/*****************************************************************************/
+{
+	char sDir[MAX_PATHFILE + 2];
+	char sImage[MAX_IMG + 2];
+	int iEntry;
 
-					/*** red stripes ***/
-					if ((iChangingBrokenRoom == iRoomLoop) &&
-						(iChangingBrokenSide == iSideLoop))
-					{
-						BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
-						ShowImage (imgsrm, iX, iY, "imgsrm");
-					}
-				}
-			}
+	/*** Both sets share the entry of a tile/mod pair. ***/
+	iEntry = TileEntry (iTile, iMod);
+	if (iEntry == 0)
+	{
+		if ((iTileEntries == TILE_ENTRIES) || (iTile > TILE_MAX))
+		{
+			printf ("[FAILED] No tile entry for %02x_%02x!\n", iTile, iMod);
+			exit (EXIT_ERROR);
 		}
+		iTileEntries++;
+		iEntry = iTileEntries;
+		arTileEntry[iTile][iMod] = iEntry;
 	}
-	if (iScreen == 3) /*** E ***/
-	{
-		iEventRoom = arEventsRoom[iCurLevel][iChangeEvent];
-		iEventTile = arEventsTile[iCurLevel][iChangeEvent];
-		iEventNext = arEventsNext[iCurLevel][iChangeEvent];
-		GetTileMod (iEventRoom, iEventTile, &iShowTile, &iShowMod);
 
-		iEventUnused = 0;
+	switch (cTypeP)
+	{
+		case 'd':
+			snprintf (sDir, MAX_PATHFILE, "png%sdungeon%s", SLASH, SLASH);
+			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
+			AtlasLoad (2, sImage, &arTileImg[1][iEntry][1],
+				&arTileImg[1][iEntry][2]);
+			break;
+		case 'p':
+			snprintf (sDir, MAX_PATHFILE, "png%spalace%s", SLASH, SLASH);
+			snprintf (sImage, MAX_IMG, "%s%02x_%02x.png", sDir, iTile, iMod);
+			AtlasLoad (3, sImage, &arTileImg[2][iEntry][1],
+				&arTileImg[2][iEntry][2]);
+			break;
+	}
+}
+/*****************************************************************************/
+int TileEntry (int iTile, int iMod)
+/*****************************************************************************/
+{
+	/*** Returns the entry of a tile/mod pair, or 0 if it has no image. ***/
 
-		/*** background ***/
-		ShowImage (imgevents, 25, 50, "imgevents");
+	if ((iTile < 0) || (iTile > TILE_MAX) || (iMod < 0) || (iMod > 0xFF))
+		{ return (0); }
+	return (arTileEntry[iTile][iMod]);
+}
+/*****************************************************************************/
+struct image *TileImage (int iEntry, int iGreen)
+/*****************************************************************************/
+{
+	int iEnv;
 
-		/*** edit this event ***/
-		CenterNumber (iChangeEvent, 291, 60, color_wh, 0);
+	switch (cCurType)
+	{
+		case 'p': iEnv = 2; break;
+		default: iEnv = 1; break;
+	}
+	if (arTileImg[iEnv][iEntry][iGreen] == NULL)
+	{
+		/*** The environment changed before its tiles were decoded. ***/
+		DecodeWait (iDecodes);
+		DecodePoll();
+	}
+	return (arTileImg[iEnv][iEntry][iGreen]);
+}
+/*****************************************************************************/
+void AtlasLoad (int iGroup, char *sImage, struct image **imgImage,
+	struct image **imgSelected)
+/*****************************************************************************/
+{
+	/* Sets *imgImage, and *imgSelected if not NULL, right away if sImage is in
+	 * the cache. Otherwise, a decode thread loads it, and DecodeWait() sets
+	 * them.
+	 */
 
-		/*** sel event, room ***/
-		if ((iEventRoom >= 1) && (iEventRoom <= 24))
-		{
-			ShowImage (imgsele, 217 + (15 * (iEventRoom - 1)), 115, "imgsele");
-		} else { iEventUnused = 1; }
+	char sSelected[MAX_IMG + 2];
+	struct image *img;
+	struct image *imgsel;
 
-		/*** sel event, tile ***/
-		if ((iEventTile >= 1) && (iEventTile <= 30))
-		{
-			if ((iEventTile >= 1) && (iEventTile <= 10))
-				{ ShowImage (imgsele, 367 + (iEventTile * 15), 155, "imgsele"); }
-			if ((iEventTile >= 11) && (iEventTile <= 20))
-				{ ShowImage (imgsele, 367 + ((iEventTile - 10) * 15), 170, "imgsele"); }
-			if ((iEventTile >= 21) && (iEventTile <= 30))
-				{ ShowImage (imgsele, 367 + ((iEventTile - 20) * 15), 185, "imgsele"); }
-		} else { iEventUnused = 1; }
+	img = AtlasCacheFind (sImage);
+	imgsel = NULL;
+	if ((img != NULL) && (imgSelected != NULL))
+	{
+		snprintf (sSelected, MAX_IMG, "%s%s", sImage, ATLAS_SELECTED);
+		imgsel = AtlasCacheFind (sSelected);
+	}
+	if ((img != NULL) && ((imgSelected == NULL) || (imgsel != NULL)))
+	{
+		*imgImage = img;
+		if (imgSelected != NULL) { *imgSelected = imgsel; }
+		if (iDecodeBackground == 0) { PreLoadBar(); }
+		return;
+	}
+	iAtlasCacheStale = 1;
+	DecodeQueue (iGroup, sImage, imgImage, imgSelected);
+}
+/*****************************************************************************/
+SDL_Surface *Highlight (SDL_Surface *surface, int iCell)
+/*****************************************************************************/
+{
+	/* Returns the selected look of surface: a green outline and diagonal
+	 * hatching of its shape, and, for tiles (iCell), of their cell. The shape
+	 * is everything that cannot be reached from the border through clear
+	 * pixels, so enclosed holes are hatched, not outlined. Pixels that are
+	 * pure green in surface stay green, and so does the stepped bottom right
+	 * of a cell, like in png/sdungeon/ and the other hand-made looks.
+	 * Called from the decode threads.
+	 */
 
-		/*** sel event, next ***/
-		switch (iEventNext)
-		{
-			case 0: ShowImage (imgsele, 502, 225, "imgsele"); break; /*** N ***/
-			case 1: ShowImage (imgsele, 517, 225, "imgsele"); break; /*** Y ***/
-		}
+	SDL_Surface *rgba;
+	SDL_Surface *selected;
+	unsigned char *arMask; /*** 1 is solid, 2 is outside. ***/
+	int *arFill;
+	int iFill;
+	Uint8 *pixel;
+	Uint8 *source;
+	int iW, iH;
+	int iPos;
+	int iGreen;
 
-		/*** Show target. ***/
-		if (iEventUnused == 0)
-		{
-			snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iShowTile, iShowMod);
-			ShowImage (NULL, 445, 264, sInfo);
-		} else {
-			ShowImage (imgeventu, 445, 264, "imgeventu");
+	/*** Used for looping. ***/
+	int iXLoop, iYLoop;
+
+	iW = surface->w;
+	iH = surface->h;
+	rgba = SDL_ConvertSurfaceFormat (surface, SDL_PIXELFORMAT_RGBA32, 0);
+	selected = SDL_CreateRGBSurfaceWithFormat (0, iW, iH, 32,
+		SDL_PIXELFORMAT_RGBA32);
+	arMask = malloc (iW * iH);
+	arFill = malloc (iW * iH * sizeof (int));
+	if ((rgba == NULL) || (selected == NULL) || (arMask == NULL) ||
+		(arFill == NULL))
+	{
+		if (rgba != NULL) { SDL_FreeSurface (rgba); }
+		if (selected != NULL) { SDL_FreeSurface (selected); }
+		free (arMask);
+		free (arFill);
+		return (NULL);
+	}
+	if ((iW != CELL_WIDTH) || (iH != CELL_HEIGHT)) { iCell = 0; }
+
+	iFill = 0;
+	for (iYLoop = 0; iYLoop < iH; iYLoop++)
+	{
+		pixel = (Uint8 *)rgba->pixels + (iYLoop * rgba->pitch);
+		for (iXLoop = 0; iXLoop < iW; iXLoop++)
+		{
+			iPos = (iYLoop * iW) + iXLoop;
+			arMask[iPos] = ((pixel[(iXLoop * 4) + 3] != 0) ||
+				((iCell == 1) && (InCell (iXLoop, iYLoop) == 1)));
+			if ((arMask[iPos] == 0) && ((iXLoop == 0) || (iYLoop == 0) ||
+				(iXLoop == iW - 1) || (iYLoop == iH - 1)))
+			{
+				arMask[iPos] = 2;
+				arFill[iFill] = iPos;
+				iFill++;
+			}
 		}
+	}
 
-		if (iMouse == 1) { ShowImage (imgmouse, 538, 73, "imgmouse"); }
+	/*** Spread outside from the border; each pixel is stacked once. ***/
+	while (iFill > 0)
+	{
+		iFill--;
+		iPos = arFill[iFill];
+		iXLoop = iPos % iW;
+		if ((iXLoop > 0) && (arMask[iPos - 1] == 0))
+			{ arMask[iPos - 1] = 2; arFill[iFill] = iPos - 1; iFill++; }
+		if ((iXLoop < iW - 1) && (arMask[iPos + 1] == 0))
+			{ arMask[iPos + 1] = 2; arFill[iFill] = iPos + 1; iFill++; }
+		if ((iPos >= iW) && (arMask[iPos - iW] == 0))
+			{ arMask[iPos - iW] = 2; arFill[iFill] = iPos - iW; iFill++; }
+		if ((iPos < (iH - 1) * iW) && (arMask[iPos + iW] == 0))
+			{ arMask[iPos + iW] = 2; arFill[iFill] = iPos + iW; iFill++; }
 	}
+	free (arFill);
 
-	/*** left ***/
-	if (arRoomLinks[iCurLevel][iCurRoom][1] != 0)
+	for (iYLoop = 0; iYLoop < iH; iYLoop++)
 	{
-		/*** yes ***/
-		if (iDownAt == 1)
+		source = (Uint8 *)rgba->pixels + (iYLoop * rgba->pitch);
+		pixel = (Uint8 *)selected->pixels + (iYLoop * selected->pitch);
+		for (iXLoop = 0; iXLoop < iW; iXLoop++)
 		{
-			ShowImage (imgleft_1, 0, 50, "imgleft_1"); /*** down ***/
-		} else {
-			ShowImage (imgleft_0, 0, 50, "imgleft_0"); /*** up ***/
+			iPos = (iYLoop * iW) + iXLoop;
+			iGreen = 0;
+			if (arMask[iPos] != 2)
+			{
+				if ((iXLoop == 0) || (iYLoop == 0) ||
+					(iXLoop == iW - 1) || (iYLoop == iH - 1) ||
+					(arMask[iPos - 1] == 2) || (arMask[iPos + 1] == 2) ||
+					(arMask[iPos - iW] == 2) || (arMask[iPos + iW] == 2) ||
+					((iXLoop + (2 * iYLoop)) % 3 == 1)) { iGreen = 1; }
+				if ((source[(iXLoop * 4) + 0] == 0x00) &&
+					(source[(iXLoop * 4) + 1] == 0xFF) &&
+					(source[(iXLoop * 4) + 2] == 0x00) &&
+					(source[(iXLoop * 4) + 3] == 0xFF)) { iGreen = 1; }
+				if ((iCell == 1) && (iYLoop >= 114) &&
+					(InCell (iXLoop, iYLoop) == 1) &&
+					(InCell (iXLoop + 1, iYLoop + 1) == 0)) { iGreen = 1; }
+			}
+			/*** RGBA32 is R, G, B, A in memory. ***/
+			pixel[(iXLoop * 4) + 0] = 0x00;
+			pixel[(iXLoop * 4) + 1] = (iGreen == 1) ? 0xFF : 0x00;
+			pixel[(iXLoop * 4) + 2] = 0x00;
+			pixel[(iXLoop * 4) + 3] = (iGreen == 1) ? 0xFF : 0x00;
 		}
-	} else {
-		/*** no ***/
-		ShowImage (imglrno, 0, 50, "imglrno");
 	}
+	SDL_FreeSurface (rgba);
+	free (arMask);
 
-	/*** right ***/
-	if (arRoomLinks[iCurLevel][iCurRoom][2] != 0)
-	{
-		/*** yes ***/
-		if (iDownAt == 2)
-		{
-			ShowImage (imgright_1, 587, 50, "imgright_1"); /*** down ***/
-		} else {
-			ShowImage (imgright_0, 587, 50, "imgright_0"); /*** up ***/
-		}
-	} else {
-		/*** no ***/
-		ShowImage (imglrno, 587, 50, "imglrno");
-	}
+	return (selected);
+}
+/*****************************************************************************/
+int InCell (int iX, int iY)
+/*****************************************************************************/
+{
+	/* Returns 1 if pixel iX,iY of a tile is in its cell: the top of the floor,
+	 * the part in front of the wall, and the bottom of the floor below it.
+	 */
 
-	/*** up ***/
-	if (arRoomLinks[iCurLevel][iCurRoom][3] != 0)
+	int iLeft, iRight;
+
+	if (iY < 20)
 	{
-		/*** yes ***/
-		if (iDownAt == 3)
-		{
-			ShowImage (imgup_1, 25, 25, "imgup_1"); /*** down ***/
-		} else {
-			ShowImage (imgup_0, 25, 25, "imgup_0"); /*** up ***/
-		}
+		iLeft = 91 - (4 * (iY / 2)) - (iY % 2);
+		iRight = 116;
+	} else if (iY < 114) {
+		iLeft = 52;
+		iRight = 116;
 	} else {
-		/*** no ***/
-		if (iScreen != 1)
-		{
-			ShowImage (imgudno, 25, 25, "imgudno"); /*** without info ***/
+		iLeft = 49 - (4 * ((iY - 114) / 2)) - ((iY - 114) % 2);
+		if (iY < 123) {
+			iRight = 106;
+		} else if (iY == 123) {
+			iRight = 105;
 		} else {
-			ShowImage (imgudnonfo, 25, 25, "imgudnonfo"); /*** with info ***/
+			iRight = 102 - (4 * ((iY - 124) / 2)) - ((iY - 124) % 2);
 		}
 	}
+	/*** The corners of the cell. ***/
+	if ((iY == 0) || (iY == 114)) { iRight = 115; }
+	if (iY == CELL_HEIGHT - 1) { iLeft = 1; }
 
-	/*** down ***/
-	if (arRoomLinks[iCurLevel][iCurRoom][4] != 0)
-	{
-		/*** yes ***/
-		if (iDownAt == 4)
-		{
-			ShowImage (imgdown_1, 25, 436, "imgdown_1"); /*** down ***/
-		} else {
-			ShowImage (imgdown_0, 25, 436, "imgdown_0"); /*** up ***/
-		}
-	} else {
-		/*** no ***/
-		ShowImage (imgudno, 25, 436, "imgudno");
-	}
+	return ((iX >= iLeft) && (iX <= iRight));
+}
+/*****************************************************************************/
+int SelectedPNG (char *sImage, char *sPNG)
+/*****************************************************************************/
+{
+	/* Sets sPNG to where a hand-made selected look of sImage would be, such as
+	 * png/sdungeon/ for png/dungeon/. These are only shipped for images that
+	 * Highlight() cannot derive. Returns 0 if sImage is not in a directory.
+	 */
 
-	switch (iScreen)
-	{
-		case 1:
-			if (arBrokenRoomLinks[iCurLevel] == 1)
-			{
-				/*** rooms broken on ***/
-				if (iDownAt == 11)
-				{
-					ShowImage (imgbroomson_1, 0, 25, "imgbroomson_1"); /*** down ***/
-				} else {
-					ShowImage (imgbroomson_0, 0, 25, "imgbroomson_0"); /*** up ***/
-				}
-			} else {
-				/*** rooms on ***/
-				if (iDownAt == 5)
-				{
-					ShowImage (imgroomson_1, 0, 25, "imgroomson_1"); /*** down ***/
-				} else {
-					ShowImage (imgroomson_0, 0, 25, "imgroomson_0"); /*** up ***/
-				}
-			}
-			/*** events on ***/
-			if (iDownAt == 6)
-			{
-				ShowImage (imgeventson_1, 587, 25, "imgeventson_1"); /*** down ***/
-			} else {
-				ShowImage (imgeventson_0, 587, 25, "imgeventson_0"); /*** up ***/
-			}
-			break;
-		case 2:
-			/*** rooms off ***/
-			if (arBrokenRoomLinks[iCurLevel] == 1)
-			{
-				ShowImage (imgbroomsoff, 0, 25, "imgbroomsoff"); /*** broken ***/
-			} else {
-				ShowImage (imgroomsoff, 0, 25, "imgroomsoff");
-			}
+	char *sDir;
 
-			/*** events on ***/
-			if (iDownAt == 6)
-			{
-				ShowImage (imgeventson_1, 587, 25, "imgeventson_1"); /*** down ***/
-			} else {
-				ShowImage (imgeventson_0, 587, 25, "imgeventson_0"); /*** up ***/
-			}
-			break;
-		case 3:
-			if (arBrokenRoomLinks[iCurLevel] == 1)
-			{
-				/*** rooms broken on ***/
-				if (iDownAt == 11)
-				{
-					ShowImage (imgbroomson_1, 0, 25, "imgbroomson_1"); /*** down ***/
-				} else {
-					ShowImage (imgbroomson_0, 0, 25, "imgbroomson_0"); /*** up ***/
-				}
-			} else {
-				/*** rooms on ***/
-				if (iDownAt == 5)
-				{
-					ShowImage (imgroomson_1, 0, 25, "imgroomson_1"); /*** down ***/
-				} else {
-					ShowImage (imgroomson_0, 0, 25, "imgroomson_0"); /*** up ***/
-				}
-			}
-			/*** events off ***/
-			ShowImage (imgeventsoff, 587, 25, "imgeventsoff");
-			break;
-	}
+	sDir = strstr (sImage, SLASH);
+	if (sDir == NULL) { return (0); }
+	snprintf (sPNG, MAX_IMG, "%.*ss%s", (int)(sDir - sImage + 1), sImage,
+		sDir + 1);
 
-	/*** save ***/
-	if (iChanged != 0)
+	return (1);
+}
+/*****************************************************************************/
+struct image *AtlasAdd (int iGroup, SDL_Surface *surface)
+/*****************************************************************************/
+{
+	/* Copies surface to the page of iGroup (1 = various, 2 = dungeon,
+	 * 3 = palace), left to right on shelves. Starts a new page if it is full.
+	 */
+
+	int iPage;
+	SDL_Rect dest;
+
+	if (iImages == IMAGES)
 	{
-		/*** on ***/
-		if (iDownAt == 7)
-		{
-			ShowImage (imgsaveon_1, 0, 436, "imgsaveon_1"); /*** down ***/
-		} else {
-			ShowImage (imgsaveon_0, 0, 436, "imgsaveon_0"); /*** up ***/
-		}
-	} else {
-		/*** off ***/
-		ShowImage (imgsaveoff, 0, 436, "imgsaveoff");
+		printf ("[FAILED] Too many images!\n");
+		exit (EXIT_ERROR);
 	}
-
-	/*** quit ***/
-	if (iDownAt == 8)
+	if ((surface->w > ATLAS_SIZE) || (surface->h > ATLAS_SIZE))
 	{
-		ShowImage (imgquit_1, 587, 436, "imgquit_1"); /*** down ***/
-	} else {
-		ShowImage (imgquit_0, 587, 436, "imgquit_0"); /*** up ***/
+		printf ("[FAILED] Image too large: %ix%i!\n", surface->w, surface->h);
+		exit (EXIT_ERROR);
 	}
 
-	/*** previous ***/
-	if (iCurLevel != 1)
+	iPage = arAtlasGroupPage[iGroup];
+	if (iPage != 0)
 	{
-		/*** on ***/
-		if (iDownAt == 9)
+		if (arAtlasX[iPage] + surface->w > ATLAS_SIZE) /*** next shelf ***/
 		{
-			ShowImage (imgprevon_1, 0, 0, "imgprevon_1"); /*** down ***/
-		} else {
-			ShowImage (imgprevon_0, 0, 0, "imgprevon_0"); /*** up ***/
+			arAtlasX[iPage] = 0;
+			arAtlasY[iPage]+=arAtlasShelf[iPage];
+			arAtlasShelf[iPage] = 0;
 		}
-	} else {
-		/*** off ***/
-		ShowImage (imgprevoff, 0, 0, "imgprevoff");
+		if (arAtlasY[iPage] + surface->h > ATLAS_SIZE) { iPage = 0; }
 	}
-
-	/*** next ***/
-	if (iCurLevel != LEVELS)
+	if (iPage == 0) /*** new page ***/
 	{
-		/*** on ***/
-		if (iDownAt == 10)
+		if (iAtlasPages == ATLAS_PAGES)
 		{
-			ShowImage (imgnexton_1, 587, 0, "imgnexton_1"); /*** down ***/
-		} else {
-			ShowImage (imgnexton_0, 587, 0, "imgnexton_0"); /*** up ***/
+			printf ("[FAILED] Too many atlas pages!\n");
+			exit (EXIT_ERROR);
 		}
-	} else {
-		/*** off ***/
-		ShowImage (imgnextoff, 587, 0, "imgnextoff");
+		iAtlasPages++;
+		iPage = iAtlasPages;
+		arAtlasSurface[iPage] = SDL_CreateRGBSurfaceWithFormat (0,
+			ATLAS_SIZE, ATLAS_SIZE, 32, SDL_PIXELFORMAT_RGBA32);
+		if (arAtlasSurface[iPage] == NULL)
+		{
+			printf ("[FAILED] Unable to create an atlas page: %s!\n",
+				SDL_GetError());
+			exit (EXIT_ERROR);
+		}
+		arAtlasX[iPage] = 0;
+		arAtlasY[iPage] = 0;
+		arAtlasShelf[iPage] = 0;
+		arAtlasGroupPage[iGroup] = iPage;
+		arAtlasGroup[iPage] = iGroup;
 	}
 
-	/*** level bar ***/
-	switch (iHomeComputer)
+	dest.x = arAtlasX[iPage];
+	dest.y = arAtlasY[iPage];
+	dest.w = surface->w;
+	dest.h = surface->h;
+	/*** Copy, including alpha, instead of blending. ***/
+	SDL_SetSurfaceBlendMode (surface, SDL_BLENDMODE_NONE);
+	if (SDL_BlitSurface (surface, NULL, arAtlasSurface[iPage], &dest) != 0)
 	{
-		case 1: ShowImage (imgbara, 25, 0, "imgbara"); break;
-		case 2: ShowImage (imgbarb, 25, 0, "imgbarb"); break;
-		case 3: ShowImage (imgbarc, 25, 0, "imgbarc"); break;
+		printf ("[FAILED] SDL_BlitSurface: %s!\n", SDL_GetError());
+		exit (EXIT_ERROR);
 	}
+	arAtlasX[iPage]+=surface->w;
+	if (surface->h > arAtlasShelf[iPage]) { arAtlasShelf[iPage] = surface->h; }
+	arAtlasDirty[iPage] = 1;
 
-	/*** Assemble level bar text. ***/
-	switch (iCurLevel)
+	iImages++;
+	arImages[iImages].iPage = iPage;
+	arImages[iImages].rect = dest;
+
+	return (&arImages[iImages]);
+}
+/*****************************************************************************/
+void AtlasUpload (int iPage)
+/*****************************************************************************/
+{
+	void *pixels;
+	int iPitch;
+
+	if (arAtlasSurface[iPage] != NULL)
 	{
-		case 1: snprintf (sLevelBar, MAX_TEXT, "level 1 (prison),"); break;
-		case 2: snprintf (sLevelBar, MAX_TEXT, "level 2 (guards),"); break;
-		case 3: snprintf (sLevelBar, MAX_TEXT, "level 3 (skeleton),"); break;
-		case 4: snprintf (sLevelBar, MAX_TEXT, "level 4 (mirror),"); break;
-		case 5: snprintf (sLevelBar, MAX_TEXT, "level 5 (thief),"); break;
-		case 6: snprintf (sLevelBar, MAX_TEXT, "level 6 (plunge),"); break;
-		case 7: snprintf (sLevelBar, MAX_TEXT, "level 7 (weightless),"); break;
-		case 8: snprintf (sLevelBar, MAX_TEXT, "level 8 (mouse),"); break;
-		case 9: snprintf (sLevelBar, MAX_TEXT, "level 9 (twisty),"); break;
-		case 10: snprintf (sLevelBar, MAX_TEXT, "level 10 (quad),"); break;
-		case 11: snprintf (sLevelBar, MAX_TEXT, "level 11 (fragile),"); break;
-		case 12: snprintf (sLevelBar, MAX_TEXT, "level 12 (12a; tower),"); break;
-		case 13: snprintf (sLevelBar, MAX_TEXT, "level 13 (12b; jaffar),"); break;
-		case 14: snprintf (sLevelBar, MAX_TEXT, "level 14 (rescue),"); break;
-		case 15: snprintf (sLevelBar, MAX_TEXT, "level 0 (demo),"); break;
+		pixels = arAtlasSurface[iPage]->pixels;
+		iPitch = arAtlasSurface[iPage]->pitch;
+	} else { /*** From the cache. ***/
+		pixels = arAtlasCache + ulAtlasCachePixels +
+			((unsigned long)(iPage - 1) * ATLAS_BYTES);
+		iPitch = ATLAS_SIZE * 4;
 	}
-	switch (iScreen)
+	if (arAtlasTex[iPage] == NULL)
 	{
-		case 1:
-			snprintf (sLevelBarF, MAX_TEXT, "%s room %i", sLevelBar, iCurRoom);
-			ShowImage (imgextras[iExtras], 530, 3, "imgextras[...]");
-			break;
-		case 2:
-			snprintf (sLevelBarF, MAX_TEXT, "%s room links", sLevelBar); break;
-		case 3:
-			snprintf (sLevelBarF, MAX_TEXT, "%s events", sLevelBar); break;
+		arAtlasTex[iPage] = SDL_CreateTexture (ascreen, SDL_PIXELFORMAT_RGBA32,
+			SDL_TEXTUREACCESS_STATIC, ATLAS_SIZE, ATLAS_SIZE);
+		if (arAtlasTex[iPage] == NULL)
+		{
+			printf ("[FAILED] Unable to create an atlas texture: %s!\n",
+				SDL_GetError());
+			exit (EXIT_ERROR);
+		}
+		SDL_SetTextureBlendMode (arAtlasTex[iPage], SDL_BLENDMODE_BLEND);
 	}
-
-	/*** Emulator information. ***/
-	if (iEmulator == 1) { ShowImage (imgemulator, 25, 50, "imgemulator"); }
-
-	/*** Home computer icon on level bar. ***/
-	switch (iHomeComputer)
+	if (SDL_UpdateTexture (arAtlasTex[iPage], NULL, pixels, iPitch) != 0)
 	{
-		case 1: ShowImage (imghcalb, 32, 7, "imghcalb"); break;
-		case 2: ShowImage (imghcblb, 32, 7, "imghcblb"); break;
-		case 3: ShowImage (imghcclb, 32, 7, "imghcclb"); break;
+		printf ("[ WARN ] SDL_UpdateTexture: %s!\n", SDL_GetError());
 	}
+	arAtlasDirty[iPage] = 0;
+}
+/*****************************************************************************/
+void AtlasDone (void)
+/*****************************************************************************/
+{
+	/* Ends the preload. Pages are uploaded when first drawn, by BatchImage().
+	 * Background images are added by DecodePoll(), from the main loop.
+	 */
 
-	/*** Display level bar text. ***/
-	message = TTF_RenderText_Shaded (font1, sLevelBarF, color_bl, color_wh);
-	messaget = SDL_CreateTextureFromSurface (ascreen, message);
-	offset.x = 48;
-	offset.y = 4;
-	offset.w = message->w; offset.h = message->h;
-	CustomRenderCopy (messaget, NULL, &offset, "message");
-	SDL_DestroyTexture (messaget); SDL_FreeSurface (message);
+	int iJobs;
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
+	/*** Background jobs were queued last. ***/
+	iJobs = iDecodes;
+	while ((iJobs > 0) && (arDecode[iJobs].iBackground == 1)) { iJobs--; }
+	DecodeWait (iJobs);
+	DecodePoll();
 }
 /*****************************************************************************/
-void InitPopUp (void)
+void AtlasComplete (void)
 /*****************************************************************************/
 {
-	int iPopUp;
-	SDL_Event event;
+	/* Called once all images are in the atlas. Updates the cache if PNGs had
+	 * to be decoded. The pages stay in memory, or mapped, for AtlasEvict().
+	 */
 
-	iPopUp = 1;
+	/*** Used for looping. ***/
+	int iGroupLoop;
 
-	PlaySound ("wav/popup.wav");
-	ShowPopUp();
-	while (iPopUp == 1)
+	DecodeStop();
+	if (iAtlasCacheStale == 1) { AtlasCacheWrite(); }
+	for (iGroupLoop = 1; iGroupLoop <= ATLAS_GROUPS; iGroupLoop++)
+		{ arAtlasGroupPage[iGroupLoop] = 0; }
+	if (iDebug == 1)
 	{
-		while (SDL_PollEvent (&event))
-		{
-			switch (event.type)
-			{
-				case SDL_CONTROLLERBUTTONDOWN:
-					/*** Nothing for now. ***/
-					break;
-				case SDL_CONTROLLERBUTTONUP:
-					switch (event.cbutton.button)
-					{
-						case SDL_CONTROLLER_BUTTON_A:
-							iPopUp = 0; break;
-					}
-					break;
-				case SDL_KEYDOWN:
-					switch (event.key.keysym.sym)
-					{
-						case SDLK_ESCAPE:
-						case SDLK_KP_ENTER:
-						case SDLK_RETURN:
-						case SDLK_SPACE:
-						case SDLK_o:
-							iPopUp = 0;
-						default: break;
-					}
-					break;
-				case SDL_MOUSEMOTION:
-					iXPos = event.motion.x;
-					iYPos = event.motion.y;
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					if (event.button.button == 1)
-					{
-						if (InArea (400, 320, 400 + 85, 320 + 32) == 1) /*** OK ***/
-						{
-							iOKOn = 1;
-							ShowPopUp();
-						}
-					}
-					break;
-				case SDL_MOUSEBUTTONUP:
-					iOKOn = 0;
-					if (event.button.button == 1)
-					{
-						if (InArea (400, 320, 400 + 85, 320 + 32) == 1) /*** OK ***/
-						{
-							iPopUp = 0;
-						}
-					}
-					ShowPopUp(); break;
-				case SDL_WINDOWEVENT:
-					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
-						{ ShowScreen(); ShowPopUp(); } break;
-				case SDL_QUIT:
-					Quit(); break;
-			}
-		}
+		printf ("[ INFO ] Atlas pages: %i (%i from the cache), images: %i\n",
+			iAtlasPages, iAtlasCachePages, iImages);
+	}
+	iAtlasComplete = 1;
+}
+/*****************************************************************************/
+void AtlasEvict (void)
+/*****************************************************************************/
+{
+	/* Frees the textures of tile pages of the other environment that have
+	 * not been drawn for a while. BatchImage() uploads them again if needed.
+	 */
 
-		/*** prevent CPU eating ***/
-		gamespeed = REFRESH_PROG;
-		while ((SDL_GetTicks() - looptime) < gamespeed)
-		{
-			SDL_Delay (10);
-		}
-		looptime = SDL_GetTicks();
+	int iOther;
+	Uint32 ulNow;
+
+	/*** Used for looping. ***/
+	int iPageLoop;
+
+	switch (cCurType)
+	{
+		case 'p': iOther = 2; break; /*** dungeon ***/
+		default: iOther = 3; break; /*** palace ***/
+	}
+	ulNow = SDL_GetTicks();
+	for (iPageLoop = 1; iPageLoop <= iAtlasPages; iPageLoop++)
+	{
+		if ((arAtlasTex[iPageLoop] == NULL) ||
+			(arAtlasGroup[iPageLoop] != iOther) ||
+			(ulNow - arAtlasUsed[iPageLoop] < ATLAS_EVICT)) { continue; }
+		if (iPageLoop == iBatchPage) { BatchFlush(); }
+		SDL_DestroyTexture (arAtlasTex[iPageLoop]);
+		arAtlasTex[iPageLoop] = NULL;
+		arAtlasDirty[iPageLoop] = 1;
+		PrIfDe ("[ INFO ] Evicted an atlas page.\n");
 	}
-	PlaySound ("wav/popup_close.wav");
-	ShowScreen();
 }
 /*****************************************************************************/
-void ShowPopUp (void)
+void AtlasCacheOpen (void)
 /*****************************************************************************/
 {
-	char arText[9 + 2][MAX_TEXT + 2];
+	/* Maps the atlas cache of an earlier start. If none of its PNGs changed,
+	 * its pages become the first atlas pages, and AtlasLoad() takes images
+	 * from it instead of decoding PNGs.
+	 *
+	 * The cache: magic, ATLAS_SIZE, pages and entries, each 4 bytes. Then
+	 * per entry: the PNG path, and its mtime (8 bytes), size, group, page,
+	 * x, y, w and h (4 bytes each). Then, from a multiple of 4096, the RGBA
+	 * pages. Numbers are big-endian.
+	 */
 
-	/*** faded background ***/
-	ShowImage (imgfadedl, 0, 0, "imgfadedl");
+	struct stat stStat;
+	int iFd;
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	unsigned long ulDone;
+	int iRead;
+#endif
 
-	/*** popup ***/
-	ShowImage (imgpopup, 61, 7, "imgpopup");
+	/*** Used for looping. ***/
+	int iPageLoop;
 
-	/*** OK ***/
-	switch (iOKOn)
+	iAtlasCacheStale = 1;
+	iFd = open (ATLAS_CACHE, O_RDONLY|O_BINARY);
+	if (iFd == -1)
 	{
-		case 0: ShowImage (imgok[1], 400, 320, "imgok[1]"); break; /*** off ***/
-		case 1: ShowImage (imgok[2], 400, 320, "imgok[2]"); break; /*** on ***/
+		PrIfDe ("[ INFO ] No atlas cache.\n");
+		return;
+	}
+	if (fstat (iFd, &stStat) == -1)
+	{
+		close (iFd);
+		return;
 	}
+	ulAtlasCacheSize = stStat.st_size;
 
-	snprintf (arText[0], MAX_TEXT, "%s %s", EDITOR_NAME, EDITOR_VERSION);
-	snprintf (arText[1], MAX_TEXT, "%s", COPYRIGHT);
-	snprintf (arText[2], MAX_TEXT, "%s", "");
-	if (iController != 1)
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	/*** No mmap(); keep a copy. ***/
+	arAtlasCache = malloc (ulAtlasCacheSize + 1);
+	if (arAtlasCache == NULL)
 	{
-		snprintf (arText[3], MAX_TEXT, "%s", "single tile (change or select)");
-		snprintf (arText[4], MAX_TEXT, "%s", "entire room (clear or fill)");
-		snprintf (arText[5], MAX_TEXT, "%s", "entire level (randomize or fill)");
-	} else {
-		snprintf (arText[3], MAX_TEXT, "%s", "The detected game controller:");
-		snprintf (arText[4], MAX_TEXT, "%s", sControllerName);
-		snprintf (arText[5], MAX_TEXT, "%s", "Have fun using it!");
+		close (iFd);
+		return;
 	}
-	snprintf (arText[6], MAX_TEXT, "%s", "");
-	snprintf (arText[7], MAX_TEXT, "%s", "You may use one guard per room.");
-	snprintf (arText[8], MAX_TEXT, "%s", "The tile behavior may differ per"
-		" level.");
+	ulDone = 0;
+	while (ulDone < ulAtlasCacheSize)
+	{
+		iRead = read (iFd, arAtlasCache + ulDone, ulAtlasCacheSize - ulDone);
+		if (iRead <= 0)
+		{
+			close (iFd);
+			AtlasCacheClose();
+			return;
+		}
+		ulDone+=iRead;
+	}
+#else
+	arAtlasCache = mmap (NULL, ulAtlasCacheSize, PROT_READ,
+		MAP_SHARED, iFd, 0);
+	if (arAtlasCache == MAP_FAILED)
+	{
+		arAtlasCache = NULL;
+		close (iFd);
+		return;
+	}
+#endif
+	close (iFd);
 
-	DisplayText (140, 121, FONT_SIZE_15, arText, 9, font1);
+	if (AtlasCacheValid() == 0)
+	{
+		PrIfDe ("[ INFO ] The atlas cache is outdated.\n");
+		AtlasCacheClose();
+		return;
+	}
+	for (iPageLoop = 1; iPageLoop <= iAtlasCachePages; iPageLoop++)
+		{ arAtlasDirty[iPageLoop] = 1; }
+	iAtlasPages = iAtlasCachePages;
+	iAtlasCacheNext = 0;
+	iAtlasCacheStale = 0;
+}
+/*****************************************************************************/
+int AtlasCacheValid (void)
+/*****************************************************************************/
+{
+	/*** Returns 1 if the mapped cache is complete and its PNGs unchanged. ***/
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
+	struct stat stStat;
+	unsigned char *sEntry;
+	unsigned long long ullMTime;
+
+	/*** Used for looping. ***/
+	int iEntryLoop;
+
+	if (ulAtlasCacheSize < 16) { return (0); }
+	if ((memcmp (arAtlasCache, ATLAS_MAGIC, 4) != 0) ||
+		(JournalNumber (arAtlasCache + 4) != ATLAS_SIZE)) { return (0); }
+	iAtlasCachePages = JournalNumber (arAtlasCache + 8);
+	iAtlasCacheEntries = JournalNumber (arAtlasCache + 12);
+	if ((iAtlasCachePages > ATLAS_PAGES) || (iAtlasCacheEntries > IMAGES))
+		{ return (0); }
+	ulAtlasCachePixels = 16 + (iAtlasCacheEntries * ATLAS_ENTRY);
+	ulAtlasCachePixels = (ulAtlasCachePixels + 4095) & ~4095UL;
+	if (ulAtlasCacheSize != ulAtlasCachePixels +
+		((unsigned long)iAtlasCachePages * ATLAS_BYTES)) { return (0); }
+
+	for (iEntryLoop = 0; iEntryLoop < iAtlasCacheEntries; iEntryLoop++)
+	{
+		sEntry = arAtlasCache + 16 + (iEntryLoop * ATLAS_ENTRY);
+		if (memchr (sEntry, '\0', ATLAS_PATH) == NULL) { return (0); }
+		if (AtlasStat ((char *)sEntry, &stStat) == -1) { return (0); }
+		ullMTime = (unsigned long long)stStat.st_mtime;
+		if ((JournalNumber (sEntry + ATLAS_PATH) != (ullMTime >> 32)) ||
+			(JournalNumber (sEntry + ATLAS_PATH + 4) !=
+			(ullMTime & 0xFFFFFFFF)) ||
+			(JournalNumber (sEntry + ATLAS_PATH + 8) !=
+			(unsigned long)stStat.st_size)) { return (0); }
+		if ((JournalNumber (sEntry + ATLAS_PATH + 16) < 1) ||
+			(JournalNumber (sEntry + ATLAS_PATH + 16) >
+			(unsigned long)iAtlasCachePages)) { return (0); }
+		if ((JournalNumber (sEntry + ATLAS_PATH + 20) +
+			JournalNumber (sEntry + ATLAS_PATH + 28) > ATLAS_SIZE) ||
+			(JournalNumber (sEntry + ATLAS_PATH + 24) +
+			JournalNumber (sEntry + ATLAS_PATH + 32) > ATLAS_SIZE))
+			{ return (0); }
+	}
+
+	return (1);
 }
 /*****************************************************************************/
-void Help (void)
+struct image *AtlasCacheFind (char *sImage)
 /*****************************************************************************/
 {
-	int iHelp;
-	SDL_Event event;
+	/*** Returns the cached image of sImage, or NULL. ***/
 
-	iHelp = 1;
+	unsigned char *sEntry;
+	int iEntry;
 
-	PlaySound ("wav/popup.wav");
-	ShowHelp();
-	while (iHelp == 1)
+	/*** Used for looping. ***/
+	int iEntryLoop;
+
+	if (arAtlasCache == NULL) { return (NULL); }
+
+	/*** Images are usually loaded in the same order as last time. ***/
+	for (iEntryLoop = 0; iEntryLoop < iAtlasCacheEntries; iEntryLoop++)
 	{
-		while (SDL_PollEvent (&event))
-		{
-			switch (event.type)
-			{
-				case SDL_CONTROLLERBUTTONDOWN:
-					/*** Nothing for now. ***/
-					break;
-				case SDL_CONTROLLERBUTTONUP:
-					switch (event.cbutton.button)
-					{
-						case SDL_CONTROLLER_BUTTON_A:
-							iHelp = 0; break;
-					}
-					break;
-				case SDL_KEYDOWN:
-					switch (event.key.keysym.sym)
-					{
-						case SDLK_ESCAPE:
-						case SDLK_KP_ENTER:
-						case SDLK_RETURN:
-						case SDLK_SPACE:
-						case SDLK_o:
-							iHelp = 0;
-						default: break;
-					}
-					break;
-				case SDL_MOUSEMOTION:
-					iXPos = event.motion.x;
-					iYPos = event.motion.y;
-					if (InArea (48, 322, 48 + 517, 322 + 20) == 1)
-					{
-						SDL_SetCursor (curHand);
-					} else {
-						SDL_SetCursor (curArrow);
-					}
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					if (event.button.button == 1)
-					{
-						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** OK ***/
-						{
-							iHelpOK = 1;
-							ShowHelp();
-						}
-					}
-					break;
-				case SDL_MOUSEBUTTONUP:
-					iHelpOK = 0;
-					if (event.button.button == 1) /*** left mouse button ***/
-					{
-						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** OK ***/
-							{ iHelp = 0; }
-						if (InArea (48, 322, 48 + 517, 322 + 20) == 1)
-							{ OpenURL ("https://github.com/EndeavourAccuracy/leapop"); }
-					}
-					ShowHelp(); break;
-				case SDL_WINDOWEVENT:
-					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
-						{ ShowHelp(); } break;
-				case SDL_QUIT:
-					Quit(); break;
-			}
-		}
+		iEntry = (iAtlasCacheNext + iEntryLoop) % iAtlasCacheEntries;
+		sEntry = arAtlasCache + 16 + (iEntry * ATLAS_ENTRY);
+		if (strcmp ((char *)sEntry, sImage) != 0) { continue; }
 
-		/*** prevent CPU eating ***/
-		gamespeed = REFRESH_PROG;
-		while ((SDL_GetTicks() - looptime) < gamespeed)
+		if (iImages == IMAGES)
 		{
-			SDL_Delay (10);
+			printf ("[FAILED] Too many images!\n");
+			exit (EXIT_ERROR);
 		}
-		looptime = SDL_GetTicks();
+		iImages++;
+		arImages[iImages].iPage = JournalNumber (sEntry + ATLAS_PATH + 16);
+		arAtlasGroup[arImages[iImages].iPage] =
+			JournalNumber (sEntry + ATLAS_PATH + 12);
+		arImages[iImages].rect.x = JournalNumber (sEntry + ATLAS_PATH + 20);
+		arImages[iImages].rect.y = JournalNumber (sEntry + ATLAS_PATH + 24);
+		arImages[iImages].rect.w = JournalNumber (sEntry + ATLAS_PATH + 28);
+		arImages[iImages].rect.h = JournalNumber (sEntry + ATLAS_PATH + 32);
+		iAtlasCacheNext = iEntry + 1;
+
+		return (&arImages[iImages]);
 	}
-	PlaySound ("wav/popup_close.wav");
-	ShowScreen();
+
+	return (NULL);
 }
 /*****************************************************************************/
-void ShowHelp (void)
+void AtlasCachePut (unsigned char *sBytes, unsigned long ulValue)
 /*****************************************************************************/
 {
-	/*** background ***/
-	ShowImage (imghelp, 0, 0, "imghelp");
+	/*** Big-endian; the reverse of JournalNumber(). ***/
 
-	/*** OK ***/
-	switch (iHelpOK)
+	sBytes[0] = (ulValue >> 24) & 0xFF;
+	sBytes[1] = (ulValue >> 16) & 0xFF;
+	sBytes[2] = (ulValue >> 8) & 0xFF;
+	sBytes[3] = ulValue & 0xFF;
+}
+/*****************************************************************************/
+void AtlasCacheWrite (void)
+/*****************************************************************************/
+{
+	/* Writes the cached entries that are still valid, plus every image that
+	 * was decoded, and all pages. Without a cache, leapop simply decodes the
+	 * PNGs again, so failures are only warnings.
+	 */
+
+	char sTemp[MAX_PATHFILE + 2];
+	unsigned char *sIndex;
+	unsigned char *sEntry;
+	unsigned long ulPixels;
+	unsigned char *pixels;
+	struct stat stStat;
+	int iEntries;
+	int iFd;
+	int iFailed;
+	int iPitch;
+
+	/*** Used for looping. ***/
+	int iImageLoop;
+	int iPageLoop;
+	int iRowLoop;
+
+	iEntries = iAtlasCacheEntries;
+	for (iImageLoop = 1; iImageLoop <= iImages; iImageLoop++)
+		{ if (arImageFile[iImageLoop][0] != '\0') { iEntries++; } }
+	ulPixels = 16 + (iEntries * ATLAS_ENTRY);
+	ulPixels = (ulPixels + 4095) & ~4095UL;
+	sIndex = calloc (ulPixels, 1);
+	if (sIndex == NULL)
+	{
+		printf ("[ WARN ] Could not write the atlas cache: %s!\n",
+			strerror (errno));
+		return;
+	}
+
+	memcpy (sIndex, ATLAS_MAGIC, 4);
+	AtlasCachePut (sIndex + 4, ATLAS_SIZE);
+	AtlasCachePut (sIndex + 8, iAtlasPages);
+	AtlasCachePut (sIndex + 12, iEntries);
+	if (iAtlasCacheEntries != 0)
+	{
+		memcpy (sIndex + 16, arAtlasCache + 16,
+			iAtlasCacheEntries * ATLAS_ENTRY);
+	}
+	sEntry = sIndex + 16 + (iAtlasCacheEntries * ATLAS_ENTRY);
+	for (iImageLoop = 1; iImageLoop <= iImages; iImageLoop++)
+	{
+		if (arImageFile[iImageLoop][0] == '\0') { continue; }
+		if ((strlen (arImageFile[iImageLoop]) >= ATLAS_PATH) ||
+			(AtlasStat (arImageFile[iImageLoop], &stStat) == -1))
+		{
+			printf ("[ WARN ] Could not write the atlas cache: %s!\n",
+				arImageFile[iImageLoop]);
+			free (sIndex);
+			return;
+		}
+		memcpy (sEntry, arImageFile[iImageLoop],
+			strlen (arImageFile[iImageLoop]) + 1);
+		AtlasCachePut (sEntry + ATLAS_PATH,
+			(unsigned long long)stStat.st_mtime >> 32);
+		AtlasCachePut (sEntry + ATLAS_PATH + 4,
+			(unsigned long long)stStat.st_mtime & 0xFFFFFFFF);
+		AtlasCachePut (sEntry + ATLAS_PATH + 8, stStat.st_size);
+		AtlasCachePut (sEntry + ATLAS_PATH + 12,
+			arAtlasGroup[arImages[iImageLoop].iPage]);
+		AtlasCachePut (sEntry + ATLAS_PATH + 16, arImages[iImageLoop].iPage);
+		AtlasCachePut (sEntry + ATLAS_PATH + 20, arImages[iImageLoop].rect.x);
+		AtlasCachePut (sEntry + ATLAS_PATH + 24, arImages[iImageLoop].rect.y);
+		AtlasCachePut (sEntry + ATLAS_PATH + 28, arImages[iImageLoop].rect.w);
+		AtlasCachePut (sEntry + ATLAS_PATH + 32, arImages[iImageLoop].rect.h);
+		sEntry+=ATLAS_ENTRY;
+	}
+
+	snprintf (sTemp, MAX_PATHFILE, "%s.tmp", ATLAS_CACHE);
+	iFd = open (sTemp, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0666);
+	if (iFd == -1)
 	{
-		case 0: ShowImage (imgok[1], 510, 411, "imgok[1]"); break; /*** off ***/
-		case 1: ShowImage (imgok[2], 510, 411, "imgok[2]"); break; /*** on ***/
+		printf ("[ WARN ] Could not create \"%s\": %s!\n",
+			sTemp, strerror (errno));
+		free (sIndex);
+		return;
+	}
+	iFailed = 0;
+	if (write (iFd, sIndex, ulPixels) != (int)ulPixels) { iFailed = 1; }
+	free (sIndex);
+	for (iPageLoop = 1; (iPageLoop <= iAtlasPages) && (iFailed == 0);
+		iPageLoop++)
+	{
+		if (arAtlasSurface[iPageLoop] != NULL)
+		{
+			pixels = arAtlasSurface[iPageLoop]->pixels;
+			iPitch = arAtlasSurface[iPageLoop]->pitch;
+		} else {
+			pixels = arAtlasCache + ulAtlasCachePixels +
+				((unsigned long)(iPageLoop - 1) * ATLAS_BYTES);
+			iPitch = ATLAS_SIZE * 4;
+		}
+		for (iRowLoop = 0; (iRowLoop < ATLAS_SIZE) && (iFailed == 0);
+			iRowLoop++)
+		{
+			if (write (iFd, pixels + (iRowLoop * iPitch), ATLAS_SIZE * 4) !=
+				ATLAS_SIZE * 4) { iFailed = 1; }
+		}
+	}
+	if (close (iFd) == -1) { iFailed = 1; }
+	if (iFailed == 0)
+	{
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+		unlink (ATLAS_CACHE);
+#endif
+		if (rename (sTemp, ATLAS_CACHE) == -1) { iFailed = 1; }
+	}
+	if (iFailed == 1)
+	{
+		printf ("[ WARN ] Could not write \"%s\": %s!\n",
+			ATLAS_CACHE, strerror (errno));
+		unlink (sTemp);
+	} else {
+		PrIfDe ("[  OK  ] Wrote the atlas cache.\n");
 	}
-
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void EXE (void)
+int AtlasStat (char *sImage, struct stat *stStat)
 /*****************************************************************************/
 {
-	int iEXE;
-	SDL_Event event;
-	int iOldXPos, iOldYPos;
-	int iRow;
-	int iUseL, iUseR;
-	int iTabMax;
-	int iMin;
+	/* stat() of the PNG of an image. For a selected look, that is the
+	 * hand-made PNG if there is one, so adding or removing it is noticed.
+	 */
 
-	iEXE = 1;
-	iEXETabS = iCurLevel;
-	if (iEXETabS == 15) { iEXETabS = 0; }
+	char sPNG[MAX_IMG + 2];
+	char sHand[MAX_IMG + 2];
+	int iLength;
 
-	EXELoad();
+	snprintf (sPNG, MAX_IMG, "%s", sImage);
+	iLength = strlen (sPNG);
+	if ((iLength > 0) && (sPNG[iLength - 1] == ATLAS_SELECTED[0]))
+	{
+		sPNG[iLength - 1] = '\0';
+		if ((SelectedPNG (sPNG, sHand) == 1) && (stat (sHand, stStat) == 0))
+			{ return (0); }
+	}
 
-	PlaySound ("wav/popup.wav");
-	ShowEXE();
-	while (iEXE == 1)
+	return (stat (sPNG, stStat));
+}
+/*****************************************************************************/
+void AtlasCacheClose (void)
+/*****************************************************************************/
+{
+	if (arAtlasCache != NULL)
 	{
-		while (SDL_PollEvent (&event))
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+		free (arAtlasCache);
+#else
+		munmap (arAtlasCache, ulAtlasCacheSize);
+#endif
+		arAtlasCache = NULL;
+	}
+	ulAtlasCacheSize = 0;
+	iAtlasCacheEntries = 0;
+	iAtlasCachePages = 0;
+}
+/*****************************************************************************/
+void DecodeStart (void)
+/*****************************************************************************/
+{
+	/* Starts one decode thread per core. They only run IMG_Load(); the atlas
+	 * and the renderer are used by the main thread, in DecodeWait().
+	 */
+
+	/*** Used for looping. ***/
+	int iThreadLoop;
+
+	/*** Do not let the threads race to initialize the PNG loader. ***/
+	IMG_Init (IMG_INIT_PNG);
+
+	decodemutex = SDL_CreateMutex();
+	decodejob = SDL_CreateCond();
+	decodedone = SDL_CreateCond();
+	if ((decodemutex == NULL) || (decodejob == NULL) || (decodedone == NULL))
+	{
+		printf ("[FAILED] Could not create a mutex: %s!\n", SDL_GetError());
+		exit (EXIT_ERROR);
+	}
+	iDecodeQuit = 0;
+
+	iDecodeThreads = SDL_GetCPUCount();
+	if (iDecodeThreads < 1) { iDecodeThreads = 1; }
+	if (iDecodeThreads > DECODE_THREADS) { iDecodeThreads = DECODE_THREADS; }
+	for (iThreadLoop = 1; iThreadLoop <= iDecodeThreads; iThreadLoop++)
+	{
+		arDecodeThread[iThreadLoop] = SDL_CreateThread (DecodeThread,
+			"DecodeThread", NULL);
+		if (arDecodeThread[iThreadLoop] == NULL)
 		{
-			switch (event.type)
-			{
-				case SDL_CONTROLLERBUTTONDOWN:
-					/*** Nothing for now. ***/
-					break;
-				case SDL_CONTROLLERBUTTONUP:
-					switch (event.cbutton.button)
-					{
-						case SDL_CONTROLLER_BUTTON_A:
-							EXESave(); iEXE = 0; break;
-					}
-					break;
-				case SDL_KEYDOWN:
-					switch (event.key.keysym.sym)
-					{
-						case SDLK_ESCAPE:
-							iEXE = 0; break;
-						case SDLK_KP_ENTER:
-						case SDLK_RETURN:
-						case SDLK_SPACE:
-						case SDLK_s:
-							EXESave(); iEXE = 0;
-							break;
-						default: break;
-					}
-					ShowEXE();
-					break;
-				case SDL_MOUSEMOTION:
-					iOldXPos = iXPos;
-					iOldYPos = iYPos;
-					iXPos = event.motion.x;
-					iYPos = event.motion.y;
-					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
+			printf ("[FAILED] Could not create thread!\n");
+			exit (EXIT_ERROR);
+		}
+	}
+	if (iDebug == 1)
+		{ printf ("[ INFO ] Decode threads: %i\n", iDecodeThreads); }
+}
+/*****************************************************************************/
+void DecodeQueue (int iGroup, char *sImage, struct image **imgImage,
+	struct image **imgSelected)
+/*****************************************************************************/
+{
+	if (iDecodeThreads == 0) { DecodeStart(); }
 
-					ShowEXE();
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					if (event.button.button == 1)
-					{
-						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** Save ***/
-						{
-							iEXESave = 1;
-							ShowEXE();
-						}
-					}
-					break;
-				case SDL_MOUSEBUTTONUP:
-					iEXESave = 0;
-					if (event.button.button == 1) /*** left mouse button ***/
-					{
-						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** Save ***/
-						{
-							EXESave(); iEXE = 0;
-						}
+	SDL_LockMutex (decodemutex);
+	if (iDecodes == IMAGES)
+	{
+		printf ("[FAILED] Too many images!\n");
+		exit (EXIT_ERROR);
+	}
+	snprintf (arDecode[iDecodes + 1].sImage, MAX_IMG, "%s", sImage);
+	arDecode[iDecodes + 1].iGroup = iGroup;
+	arDecode[iDecodes + 1].imgImage = imgImage;
+	arDecode[iDecodes + 1].imgSelected = imgSelected;
+	arDecode[iDecodes + 1].surface = NULL;
+	arDecode[iDecodes + 1].selected = NULL;
+	arDecode[iDecodes + 1].iBackground = iDecodeBackground;
+	arDecode[iDecodes + 1].iDone = 0;
+	iDecodes++;
+	SDL_CondSignal (decodejob);
+	SDL_UnlockMutex (decodemutex);
+}
+/*****************************************************************************/
+int DecodeThread (void *unused)
+/*****************************************************************************/
+{
+	SDL_Surface *surface;
+	SDL_Surface *selected;
+	char sPNG[MAX_IMG + 2];
+	int iDecode;
 
-						/*******************/
-						/* global settings */
-						/*******************/
+	if (unused != NULL) { } /*** To prevent warnings. ***/
 
-						/*** Prince HP. ***/
-						if (((iHomeComputer == 1) && (ulPrinceHPA[iDiskImageA] != 0x00)) ||
-							((iHomeComputer == 2) && (ulPrinceHPB[iDiskImageB] != 0x00)) ||
-							((iHomeComputer == 3) && (ulPrinceHPC[iDiskImageC] != 0x00)))
-						{
-							PlusMinus (&iEXEPrinceHP, 139, 58, 0, 255, -10, 0);
-							PlusMinus (&iEXEPrinceHP, 154, 58, 0, 255, -1, 0);
-							PlusMinus (&iEXEPrinceHP, 224, 58, 0, 255, +1, 0);
-							PlusMinus (&iEXEPrinceHP, 239, 58, 0, 255, +10, 0);
-						}
+	SDL_LockMutex (decodemutex);
+	while (1)
+	{
+		while ((iDecodeNext == iDecodes) && (iDecodeQuit == 0))
+			{ SDL_CondWait (decodejob, decodemutex); }
+		if (iDecodeNext == iDecodes) { break; } /*** quit ***/
+		iDecodeNext++;
+		iDecode = iDecodeNext;
+		SDL_UnlockMutex (decodemutex);
 
-						/*** Shadow HP. ***/
-						if (((iHomeComputer == 1) && (ulShadowHPA[iDiskImageA] != 0x00)) ||
-							((iHomeComputer == 2) && (ulShadowHPB[iDiskImageB] != 0x00)) ||
-							((iHomeComputer == 3) && (ulShadowHPC[iDiskImageC] != 0x00)))
-						{
-							PlusMinus (&iEXEShadowHP, 139, 82, 0, 255, -10, 0);
-							PlusMinus (&iEXEShadowHP, 154, 82, 0, 255, -1, 0);
-							PlusMinus (&iEXEShadowHP, 224, 82, 0, 255, +1, 0);
-							PlusMinus (&iEXEShadowHP, 239, 82, 0, 255, +10, 0);
-						}
+		surface = IMG_Load (arDecode[iDecode].sImage);
+		selected = NULL;
+		if ((surface != NULL) && (arDecode[iDecode].imgSelected != NULL))
+		{
+			if (SelectedPNG (arDecode[iDecode].sImage, sPNG) == 1)
+				{ selected = IMG_Load (sPNG); }
+			if (selected == NULL)
+			{
+				selected = Highlight (surface,
+					arDecode[iDecode].iGroup != 1);
+			}
+			if (selected == NULL)
+			{
+				SDL_FreeSurface (surface);
+				surface = NULL;
+			}
+		}
 
-						/*** Chomper delay. ***/
-						if (((iHomeComputer == 1) &&
-							(ulChomperDelayA[iDiskImageA] != 0x00)) ||
-							((iHomeComputer == 2) &&
-							(ulChomperDelayB[iDiskImageB] != 0x00)) ||
-							((iHomeComputer == 3) &&
-							(ulChomperDelayC[iDiskImageC] != 0x00)))
-						{
-							PlusMinus (&iEXEChomperDelay, 139, 106, 3, 255, -10, 0);
-							PlusMinus (&iEXEChomperDelay, 154, 106, 3, 255, -1, 0);
-							PlusMinus (&iEXEChomperDelay, 224, 106, 3, 255, +1, 0);
-							PlusMinus (&iEXEChomperDelay, 239, 106, 3, 255, +10, 0);
-						}
+		SDL_LockMutex (decodemutex);
+		arDecode[iDecode].surface = surface;
+		arDecode[iDecode].selected = selected;
+		if (surface == NULL)
+		{
+			/*** The error is per thread. ***/
+			snprintf (arDecode[iDecode].sError, MAX_ERROR, "%s", IMG_GetError());
+		}
+		arDecode[iDecode].iDone = 1;
+		SDL_CondSignal (decodedone);
+	}
+	SDL_UnlockMutex (decodemutex);
 
-						/*** Mouse delay. ***/
-						if (((iHomeComputer == 1) &&
-							(ulMouseDelayA[iDiskImageA] != 0x00)) ||
-							((iHomeComputer == 2) &&
-							(ulMouseDelayB[iDiskImageB] != 0x00)) ||
-							((iHomeComputer == 3) &&
-							(ulMouseDelayC[iDiskImageC] != 0x00)))
-						{
-							PlusMinus (&iEXEMouseDelay, 139, 130, 0, 255, -10, 0);
-							PlusMinus (&iEXEMouseDelay, 154, 130, 0, 255, -1, 0);
-							PlusMinus (&iEXEMouseDelay, 224, 130, 0, 255, +1, 0);
-							PlusMinus (&iEXEMouseDelay, 239, 130, 0, 255, +10, 0);
-						}
+	return (0);
+}
+/*****************************************************************************/
+void DecodeWait (int iJobs)
+/*****************************************************************************/
+{
+	/* Adds the first iJobs decoded images to the atlas, in the order they were
+	 * queued, so that the pages are always packed the same way.
+	 */
 
-						/******************/
-						/* guard settings */
-						/******************/
+	struct decode *decode;
 
-						/*** strike prob. ***/
-						if ((InArea (281, 188, 281 + 94, 188 + 19) == 1) && (iEXETab != 1))
-							{ iEXETab = 1; PlaySound ("wav/extras.wav"); }
-						/*** re-strike prob. ***/
-						if ((InArea (383, 188, 383 + 94, 188 + 19) == 1) && (iEXETab != 2))
-							{ iEXETab = 2; PlaySound ("wav/extras.wav"); }
-						/*** block prob. ***/
-						if ((InArea (485, 188, 485 + 94, 188 + 19) == 1) && (iEXETab != 3))
-							{ iEXETab = 3; PlaySound ("wav/extras.wav"); }
-						/*** imp. block prob. ***/
-						if ((InArea (281, 215, 281 + 94, 215 + 19) == 1) && (iEXETab != 4))
-							{ iEXETab = 4; PlaySound ("wav/extras.wav"); }
-						/*** advance prob. ***/
-						if ((InArea (383, 215, 383 + 94, 215 + 19) == 1) && (iEXETab != 5))
-							{ iEXETab = 5; PlaySound ("wav/extras.wav"); }
-						/*** refractory timer ***/
-						if ((InArea (485, 215, 485 + 94, 215 + 19) == 1) && (iEXETab != 6))
-							{ iEXETab = 6; PlaySound ("wav/extras.wav"); }
-						/*** special color ***/
-						if ((InArea (281, 242, 281 + 94, 242 + 19) == 1) && (iEXETab != 7))
-							{ iEXETab = 7; PlaySound ("wav/extras.wav"); }
-						/*** extra strength ***/
-						if ((InArea (383, 242, 383 + 94, 242 + 19) == 1) && (iEXETab != 8))
-							{ iEXETab = 8; PlaySound ("wav/extras.wav"); }
+	while (iDecodeAdded < iJobs)
+	{
+		decode = &arDecode[iDecodeAdded + 1];
+		SDL_LockMutex (decodemutex);
+		while (decode->iDone == 0) { SDL_CondWait (decodedone, decodemutex); }
+		SDL_UnlockMutex (decodemutex);
 
-						if (((iHomeComputer == 1) &&
-							(ulGuardA[iDiskImageA][iEXETab - 1] != 0x00)) ||
-							((iHomeComputer == 2) &&
-							(ulGuardB[iDiskImageB][iEXETab - 1] != 0x00)) ||
-							((iHomeComputer == 3) &&
-							(ulGuardC[iDiskImageC][iEXETab - 1] != 0x00)))
-						{
-							for (iRow = 1; iRow <= 6; iRow++)
-							{
-								iUseL = (iRow * 2) - 1;
-								iUseR = iUseL + 1;
-								switch (iEXETab)
-								{
-									case 6: iTabMax = 20; break;
-									case 7: iTabMax = 1; break;
-									case 8: iTabMax = 1; break;
-									default: iTabMax = 255; break;
-								}
+		if (decode->surface == NULL)
+		{
+			printf ("[FAILED] IMG_Load: %s!\n", decode->sError);
+			exit (EXIT_ERROR);
+		}
+		*decode->imgImage = AtlasAdd (decode->iGroup, decode->surface);
+		SDL_FreeSurface (decode->surface);
+		decode->surface = NULL;
+		snprintf (arImageFile[iImages], ATLAS_PATH + 2, "%s", decode->sImage);
+		if (decode->selected != NULL)
+		{
+			*decode->imgSelected = AtlasAdd (decode->iGroup, decode->selected);
+			SDL_FreeSurface (decode->selected);
+			decode->selected = NULL;
+			snprintf (arImageFile[iImages], ATLAS_PATH + 2, "%s%s",
+				decode->sImage, ATLAS_SELECTED);
+		}
+		iDecodeAdded++;
+		if (decode->iBackground == 0) { PreLoadBar(); }
+	}
+}
+/*****************************************************************************/
+void DecodePoll (void)
+/*****************************************************************************/
+{
+	/*** Adds the images that are decoded, without waiting. ***/
 
-								PlusMinus (&iEXEGuard[iEXETab][iUseL], 310,
-									10 + (iRow * 24), 0, iTabMax, -10, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseL], 325,
-									10 + (iRow * 24), 0, iTabMax, -1, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseL], 395,
-									10 + (iRow * 24), 0, iTabMax, +1, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseL], 410,
-									10 + (iRow * 24), 0, iTabMax, +10, 0);
+	int iJobs;
 
-								PlusMinus (&iEXEGuard[iEXETab][iUseR], 466,
-									10 + (iRow * 24), 0, iTabMax, -10, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseR], 481,
-									10 + (iRow * 24), 0, iTabMax, -1, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseR], 551,
-									10 + (iRow * 24), 0, iTabMax, +1, 0);
-								PlusMinus (&iEXEGuard[iEXETab][iUseR], 566,
-									10 + (iRow * 24), 0, iTabMax, +10, 0);
-							}
-						}
+	if (iAtlasComplete == 1) { return; }
 
-						/**********************/
-						/* per level settings */
-						/**********************/
+	if (iDecodeThreads != 0)
+	{
+		SDL_LockMutex (decodemutex);
+		iJobs = iDecodeAdded;
+		while ((iJobs < iDecodes) && (arDecode[iJobs + 1].iDone == 1))
+			{ iJobs++; }
+		SDL_UnlockMutex (decodemutex);
+		DecodeWait (iJobs);
+	}
+	if (iDecodeAdded == iDecodes) { AtlasComplete(); }
+}
+/*****************************************************************************/
+void DecodeStop (void)
+/*****************************************************************************/
+{
+	/*** Used for looping. ***/
+	int iThreadLoop;
+
+	if (iDecodeThreads == 0) { return; }
+
+	SDL_LockMutex (decodemutex);
+	iDecodeQuit = 1;
+	SDL_CondBroadcast (decodejob);
+	SDL_UnlockMutex (decodemutex);
+	for (iThreadLoop = 1; iThreadLoop <= iDecodeThreads; iThreadLoop++)
+		{ SDL_WaitThread (arDecodeThread[iThreadLoop], NULL); }
+	SDL_DestroyCond (decodejob);
+	SDL_DestroyCond (decodedone);
+	SDL_DestroyMutex (decodemutex);
+	iDecodeThreads = 0;
+	iDecodes = 0;
+	iDecodeNext = 0;
+	iDecodeAdded = 0;
+}
+/*****************************************************************************/
+void PreLoad (char *sPath, char *sPNG, struct image **imgImage)
+/*****************************************************************************/
+{
+	char sImage[MAX_IMG + 2];
 
-						/*** demo ***/
-						if ((InArea (267, 299, 267 + 56, 299 + 19) == 1) && (iEXETabS
-							!= 0)) { iEXETabS = 0; PlaySound ("wav/extras.wav"); }
-						/*** level 1 ***/
-						if ((InArea (331, 299, 331 + 56, 299 + 19) == 1) && (iEXETabS
-							!= 1)) { iEXETabS = 1; PlaySound ("wav/extras.wav"); }
-						/*** level 2 ***/
-						if ((InArea (395, 299, 395 + 56, 299 + 19) == 1) && (iEXETabS
-							!= 2)) { iEXETabS = 2; PlaySound ("wav/extras.wav"); }
-						/*** level 3 ***/
-						if ((InArea (459, 299, 459 + 56, 299 + 19) == 1) && (iEXETabS
-							!= 3)) { iEXETabS = 3; PlaySound ("wav/extras.wav"); }
-						/*** level 4 ***/
-						if ((InArea (523, 299, 523 + 56, 299 + 19) == 1) && (iEXETabS
-							!= 4)) { iEXETabS = 4; PlaySound ("wav/extras.wav"); }
-						/*** level 5 ***/
-						if ((InArea (267, 326, 267 + 56, 326 + 19) == 1) && (iEXETabS
-							!= 5)) { iEXETabS = 5; PlaySound ("wav/extras.wav"); }
-						/*** level 6 ***/
-						if ((InArea (331, 326, 331 + 56, 326 + 19) == 1) && (iEXETabS
-							!= 6)) { iEXETabS = 6; PlaySound ("wav/extras.wav"); }
-						/*** level 7 ***/
-						if ((InArea (395, 326, 395 + 56, 326 + 19) == 1) && (iEXETabS
-							!= 7)) { iEXETabS = 7; PlaySound ("wav/extras.wav"); }
-						/*** level 8 ***/
-						if ((InArea (459, 326, 459 + 56, 326 + 19) == 1) && (iEXETabS
-							!= 8)) { iEXETabS = 8; PlaySound ("wav/extras.wav"); }
-						/*** level 9 ***/
-						if ((InArea (523, 326, 523 + 56, 326 + 19) == 1) && (iEXETabS
-							!= 9)) { iEXETabS = 9; PlaySound ("wav/extras.wav"); }
-						/*** level 10 ***/
-						if ((InArea (267, 353, 267 + 56, 353 + 19) == 1) && (iEXETabS
-							!= 10)) { iEXETabS = 10; PlaySound ("wav/extras.wav"); }
-						/*** level 11 ***/
-						if ((InArea (331, 353, 331 + 56, 353 + 19) == 1) && (iEXETabS
-							!= 11)) { iEXETabS = 11; PlaySound ("wav/extras.wav"); }
-						/*** level 12 ***/
-						if ((InArea (395, 353, 395 + 56, 353 + 19) == 1) && (iEXETabS
-							!= 12)) { iEXETabS = 12; PlaySound ("wav/extras.wav"); }
-						/*** level 13 ***/
-						if ((InArea (459, 353, 459 + 56, 353 + 19) == 1) && (iEXETabS
-							!= 13)) { iEXETabS = 13; PlaySound ("wav/extras.wav"); }
-						/*** level 14 ***/
-						if ((InArea (523, 353, 523 + 56, 353 + 19) == 1) && (iEXETabS
-							!= 14)) { iEXETabS = 14; PlaySound ("wav/extras.wav"); }
-
-						if (iEXETabS != 14) /*** Level 14 has no guards. ***/
-						{
-							/*** Guard HP. ***/
-							if (((iHomeComputer == 1) &&
-								(ulGuardHPA[iDiskImageA] != 0x00)) ||
-								((iHomeComputer == 2) &&
-								(ulGuardHPB[iDiskImageB] != 0x00)) ||
-								((iHomeComputer == 3) &&
-								(ulGuardHPC[iDiskImageC] != 0x00)))
-							{
-								PlusMinus (&iEXEGuardHP[iEXETabS], 139, 236, 0, 255, -10, 0);
-								PlusMinus (&iEXEGuardHP[iEXETabS], 154, 236, 0, 255, -1, 0);
-								PlusMinus (&iEXEGuardHP[iEXETabS], 224, 236, 0, 255, 1, 0);
-								PlusMinus (&iEXEGuardHP[iEXETabS], 239, 236, 0, 255, 10, 0);
-							}
-
-							/*** Guard uniform. ***/
-							if (((iHomeComputer == 1) &&
-								(ulGuardUniformA[iDiskImageA] != 0x00)) ||
-								((iHomeComputer == 2) &&
-								(ulGuardUniformB[iDiskImageB] != 0x00)) ||
-								((iHomeComputer == 3) &&
-								(ulGuardUniformC[iDiskImageC] != 0x00)))
-							{
-								PlusMinus (&iEXEGuardU[iEXETabS], 139, 260, 0, 1, -10, 0);
-								PlusMinus (&iEXEGuardU[iEXETabS], 154, 260, 0, 1, -1, 0);
-								PlusMinus (&iEXEGuardU[iEXETabS], 224, 260, 0, 1, 1, 0);
-								PlusMinus (&iEXEGuardU[iEXETabS], 239, 260, 0, 1, 10, 0);
-							}
-
-							/*** Guard sprite. ***/
-							if (((iHomeComputer == 1) &&
-								(ulGuardSpriteA[iDiskImageA] != 0x00)) ||
-								((iHomeComputer == 2) &&
-								(ulGuardSpriteB[iDiskImageB] != 0x00)) ||
-								((iHomeComputer == 3) &&
-								(ulGuardSpriteC[iDiskImageC] != 0x00)))
-							{
-								if (iEXETabS > 2) /*** Levels 0, 1 and 2 must use 0x00. ***/
-								{
-									PlusMinus (&iEXEGuardS[iEXETabS], 139, 284, 1, 5, -10, 0);
-									PlusMinus (&iEXEGuardS[iEXETabS], 154, 284, 1, 5, -1, 0);
-									PlusMinus (&iEXEGuardS[iEXETabS], 224, 284, 1, 5, 1, 0);
-									PlusMinus (&iEXEGuardS[iEXETabS], 239, 284, 1, 5, 10, 0);
-								}
-							}
-						}
+	snprintf (sImage, MAX_IMG, "png%s%s%s%s", SLASH, sPath, SLASH, sPNG);
+	AtlasLoad (1, sImage, imgImage, NULL);
+}
+/*****************************************************************************/
+void PreLoadLiving (char *sPNG, struct living *liv,
+	int iHorL, int iHorR, int iVer)
+/*****************************************************************************/
+{
+	/* Sets liv->img[1], and its selected look liv->img[2], from sPNG (that
+	 * looks right). iHorL, iHorR and iVer are the offsets from the tile.
+	 */
 
-						if (iEXETabS > 2) /*** Levels 0, 1 and 2 must use 0x00. ***/
-						{
-							if (iEXETabS == 3) { iMin = 0; } else { iMin = 1; }
+	char sImage[MAX_IMG + 2];
 
-							if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
-								((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
-								((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
-							{
-								PlusMinus (&iEXEEnv1[iEXETabS], 139, 308, iMin, 2, -10, 0);
-								PlusMinus (&iEXEEnv1[iEXETabS], 154, 308, iMin, 2, -1, 0);
-								PlusMinus (&iEXEEnv1[iEXETabS], 224, 308, iMin, 2, 1, 0);
-								PlusMinus (&iEXEEnv1[iEXETabS], 239, 308, iMin, 2, 10, 0);
-							}
+	snprintf (sImage, MAX_IMG, "png%s%s%s%s", SLASH, PNG_LIVING, SLASH, sPNG);
+	AtlasLoad (1, sImage, &liv->img[1], &liv->img[2]);
+	liv->iHorL = iHorL;
+	liv->iHorR = iHorR;
+	liv->iVer = iVer;
+}
+/*****************************************************************************/
+void PreLoadBar (void)
+/*****************************************************************************/
+{
+	/*** Called per image that is ready. ***/
 
-							if (((iHomeComputer == 1) && (ulEnv2A[iDiskImageA] != 0x00)) ||
-								((iHomeComputer == 2) && (ulEnv2B[iDiskImageB] != 0x00)) ||
-								((iHomeComputer == 3) && (ulEnv2C[iDiskImageC] != 0x00)))
-							{
-								PlusMinus (&iEXEEnv2[iEXETabS], 139, 332, iMin, 2, -10, 0);
-								PlusMinus (&iEXEEnv2[iEXETabS], 154, 332, iMin, 2, -1, 0);
-								PlusMinus (&iEXEEnv2[iEXETabS], 224, 332, iMin, 2, 1, 0);
-								PlusMinus (&iEXEEnv2[iEXETabS], 239, 332, iMin, 2, 10, 0);
-							}
-						}
-					}
-					ShowEXE();
-					break;
-				case SDL_WINDOWEVENT:
-					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
-						{ ShowEXE(); } break;
-				case SDL_QUIT:
-					Quit(); break;
-			}
-		}
+	int iBarHeight;
 
-		/*** prevent CPU eating ***/
-		gamespeed = REFRESH_PROG;
-		while ((SDL_GetTicks() - looptime) < gamespeed)
-		{
-			SDL_Delay (10);
-		}
-		looptime = SDL_GetTicks();
-	}
-	PlaySound ("wav/popup_close.wav");
-	ShowScreen();
+	iPreLoaded++;
+	iBarHeight = (int)(((float)iPreLoaded/(float)iNrToPreLoad) * BAR_FULL);
+	if (iBarHeight >= iCurrentBarHeight + 10) { LoadingBar (iBarHeight); }
 }
 /*****************************************************************************/
-void ShowEXE (void)
+void ShowScreen (void)
 /*****************************************************************************/
 {
-	SDL_Color clr;
-	SDL_Color clrs[12 + 2];
-	int iTabX, iTabY;
-	int iLeft, iRight;
+	char sLevelBar[MAX_TEXT + 2];
+	char sLevelBarF[MAX_TEXT + 2];
+	int iUnusedRooms;
+	int iX, iY;
+	int iEventUnused;
+	int iToRoom;
+	int iEventRoom, iEventTile, iEventNext, iShowTile, iShowMod;
 
 	/*** Used for looping. ***/
-	int iSkillLoop;
-
-	/*** background ***/
-	ShowImage (imgexe, 0, 0, "imgexe");
+	int iRoomLoop;
+	int iSideLoop;
 
-	/*** save button ***/
-	switch (iEXESave)
-	{
-		case 0: /*** off ***/
-			ShowImage (imgsave[1], 510, 411, "imgsave[1]"); break;
-		case 1: /*** on ***/
-			ShowImage (imgsave[2], 510, 411, "imgsave[2]"); break;
-	}
+	FrameStart();
 
-	/*** Prince HP. ***/
-	if (((iHomeComputer == 1) && (ulPrinceHPA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulPrinceHPB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulPrinceHPC[iDiskImageC] != 0x00)))
-	{
-		if (iEXEPrinceHP == 0x03) { clr = color_bl; } else { clr = color_blue; }
-		CenterNumber (iEXEPrinceHP, 167, 58, clr, 0);
-	}
+	/*** black background ***/
+	ShowImage (imgblack, 0, 0, "imgblack");
 
-	/*** Shadow HP. ***/
-	if (((iHomeComputer == 1) && (ulShadowHPA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulShadowHPB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulShadowHPC[iDiskImageC] != 0x00)))
+	if (iScreen == 1) { RoomLayer(); }
+	if (iScreen == 2) /*** R ***/
 	{
-		if (iEXEShadowHP == 0x04) { clr = color_bl; } else { clr = color_blue; }
-		CenterNumber (iEXEShadowHP, 167, 82, clr, 0);
-	}
+		if (arBrokenRoomLinks[iCurLevel] == 0)
+		{
+			InitRooms();
+			/*** room links ***/
+			ShowImage (imgrl, 25, 50, "imgrl");
+			/*** rooms broken on ***/
+			if (iDownAt == 11)
+			{
+				ShowImage (imgbroomson_1, 546, 66, "imgbroomson_1"); /*** down ***/
+			} else {
+				ShowImage (imgbroomson_0, 546, 66, "imgbroomson_0"); /*** up ***/
+			}
+			WhereToStart();
+			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+			{
+				arDone[iRoomLoop] = 0;
+			}
+			ShowRooms (arLevels[iCurLevel].arStartLocation[1], iStartRoomsX,
+				iStartRoomsY, 1);
+			iUnusedRooms = 0;
+			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+			{
+				if (arDone[iRoomLoop] != 1)
+				{
+					iUnusedRooms++;
+					ShowRooms (iRoomLoop, 25, iUnusedRooms, 0);
+				}
+			}
+			if (iMovingRoom != 0)
+			{
+				iX = (iXPos + 10) / iScale;
+				iY = (iYPos + 10) / iScale;
+				ShowImage (imgroom[iMovingRoom], iX, iY, "imgroom[...]");
+				if (iCurRoom == iMovingRoom)
+				{
+					ShowImage (imgsrc, iX, iY, "imgsrc"); /*** green stripes ***/
+				}
+				if (arLevels[iCurLevel].arStartLocation[1] == iMovingRoom)
+				{
+					ShowImage (imgsrs, iX, iY, "imgsrs"); /*** blue border ***/
+				}
+				ShowImage (imgsrm, iX, iY, "imgsrm"); /*** red stripes ***/
+				ShowRooms (-1, iMovingNewX, iMovingNewY, 0);
+			}
+		} else {
+			/*** broken room links ***/
+			ShowImage (imgbrl, 25, 50, "imgbrl");
+			for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+			{
+				/*** green stripes ***/
+				if (iCurRoom == iRoomLoop)
+				{
+					BrokenRoomChange (iRoomLoop, 0, &iX, &iY);
+					ShowImage (imgsrc, iX, iY, "imgsrc");
+				}
 
-	/*** Chomper delay. ***/
-	if (((iHomeComputer == 1) && (ulChomperDelayA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulChomperDelayB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulChomperDelayC[iDiskImageC] != 0x00)))
-	{
-		if (iEXEChomperDelay == 0x10) { clr = color_bl; }
-			else { clr = color_blue; }
-		CenterNumber (iEXEChomperDelay, 167, 106, clr, 0);
-	}
+				/*** blue border ***/
+				if (arLevels[iCurLevel].arStartLocation[1] == iRoomLoop)
+				{
+					BrokenRoomChange (iRoomLoop, 0, &iX, &iY);
+					ShowImage (imgsrs, iX, iY, "imgsrs");
+				}
 
-	/*** Mouse delay. ***/
-	if (((iHomeComputer == 1) && (ulMouseDelayA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulMouseDelayB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulMouseDelayC[iDiskImageC] != 0x00)))
-	{
-		if (iEXEMouseDelay == 0x96) { clr = color_bl; } else { clr = color_blue; }
-		CenterNumber (iEXEMouseDelay, 167, 130, clr, 0);
-	}
+				for (iSideLoop = 1; iSideLoop <= 4; iSideLoop++)
+				{
+					if (arLevels[iCurLevel].arRoom[iRoomLoop].arLink[iSideLoop] != 0)
+					{
+						BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
+						iToRoom = arLevels[iCurLevel].arRoom[iRoomLoop].arLink[iSideLoop];
+						ShowImage (imgroom[iToRoom], iX, iY, "imgroom[...]");
 
-	/*** Guard tab. ***/
-	switch (iEXETab)
-	{
-		case 1: iTabX = 281; iTabY = 188; break; /*** strike prob. ***/
-		case 2: iTabX = 383; iTabY = 188; break; /*** re-strike prob. ***/
-		case 3: iTabX = 485; iTabY = 188; break; /*** block prob. ***/
-		case 4: iTabX = 281; iTabY = 215; break; /*** imp. block prob. ***/
-		case 5: iTabX = 383; iTabY = 215; break; /*** advance prob. ***/
-		case 6: iTabX = 485; iTabY = 215; break; /*** refractory timer ***/
-		case 7: iTabX = 281; iTabY = 242; break; /*** special color ***/
-		case 8: iTabX = 383; iTabY = 242; break; /*** extra strength ***/
-		default:
-			printf ("[ WARN ] Unknown guard tab: %i!\n", iEXETab);
-			iEXETab = 1; iTabX = 281; iTabY = 188; break;
-	}
-	ShowImage (imgexetab, iTabX, iTabY, "imgexetab");
+						/*** blue square ***/
+						if (arRoomConnectionsBroken[iCurLevel][iRoomLoop][iSideLoop] == 1)
+						{
+							BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
+							ShowImage (imgsrb, iX, iY, "imgsrb");
+						}
+					}
 
-	/*** Per level tab. ***/
-	switch (iEXETabS)
-	{
-		case 0: iTabX = 267; iTabY = 299; break; /*** demo ***/
-		case 1: iTabX = 331; iTabY = 299; break; /*** level 1 ***/
-		case 2: iTabX = 395; iTabY = 299; break; /*** level 2 ***/
-		case 3: iTabX = 459; iTabY = 299; break; /*** level 3 ***/
-		case 4: iTabX = 523; iTabY = 299; break; /*** level 4 ***/
-		case 5: iTabX = 267; iTabY = 326; break; /*** level 5 ***/
-		case 6: iTabX = 331; iTabY = 326; break; /*** level 6 ***/
-		case 7: iTabX = 395; iTabY = 326; break; /*** level 7 ***/
-		case 8: iTabX = 459; iTabY = 326; break; /*** level 8 ***/
-		case 9: iTabX = 523; iTabY = 326; break; /*** level 9 ***/
-		case 10: iTabX = 267; iTabY = 353; break; /*** level 10 ***/
-		case 11: iTabX = 331; iTabY = 353; break; /*** level 11 ***/
-		case 12: iTabX = 395; iTabY = 353; break; /*** level 12 ***/
-		case 13: iTabX = 459; iTabY = 353; break; /*** level 13 ***/
-		case 14: iTabX = 523; iTabY = 353; break; /*** level 14 ***/
-		default:
-			printf ("[ WARN ] Unknown per level tab: %i!\n", iEXETabS);
-			iEXETabS = 0; iTabX = 267; iTabY = 299; break;
+					/*** red stripes ***/
+					if ((iChangingBrokenRoom == iRoomLoop) &&
+						(iChangingBrokenSide == iSideLoop))
+					{
+						BrokenRoomChange (iRoomLoop, iSideLoop, &iX, &iY);
+						ShowImage (imgsrm, iX, iY, "imgsrm");
+					}
+				}
+			}
+		}
 	}
-	ShowImage (imgexetabs, iTabX, iTabY, "imgexetabs");
-
-	if (((iHomeComputer == 1) && (ulGuardA[iDiskImageA][iEXETab - 1] != 0x00)) ||
-		((iHomeComputer == 2) && (ulGuardB[iDiskImageB][iEXETab - 1] != 0x00)) ||
-		((iHomeComputer == 3) && (ulGuardC[iDiskImageC][iEXETab - 1] != 0x00)))
+	if (iScreen == 3) /*** E ***/
 	{
-		/* Use black.
-		 * Override with blue if the setting does not match the default.
-		 */
-		for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
+		iEventRoom = arLevels[iCurLevel].arEvent[iChangeEvent].cRoom;
+		iEventTile = arLevels[iCurLevel].arEvent[iChangeEvent].cTile;
+		iEventNext = arLevels[iCurLevel].arEvent[iChangeEvent].cNext;
+		GetTileMod (iEventRoom, iEventTile, &iShowTile, &iShowMod);
+
+		iEventUnused = 0;
+
+		/*** background ***/
+		ShowImage (imgevents, 25, 50, "imgevents");
+
+		/*** edit this event ***/
+		CenterNumber (iChangeEvent, 291, 60, color_wh, 0);
+
+		/*** sel event, room ***/
+		if ((iEventRoom >= 1) && (iEventRoom <= 24))
 		{
-			clrs[iSkillLoop] = color_bl;
-			if (iEXEGuard[iEXETab][iSkillLoop] !=
-				arDefaultGuard[iEXETab - 1][iSkillLoop - 1])
-				{ clrs[iSkillLoop] = color_blue; }
-		}
-		iLeft = 338; iRight = 494;
-		CenterNumber (iEXEGuard[iEXETab][1], iLeft, 10 + (1 * 24), clrs[1], 0);
-		CenterNumber (iEXEGuard[iEXETab][2], iRight, 10 + (1 * 24), clrs[2], 0);
-		CenterNumber (iEXEGuard[iEXETab][3], iLeft, 10 + (2 * 24), clrs[3], 0);
-		CenterNumber (iEXEGuard[iEXETab][4], iRight, 10 + (2 * 24), clrs[4], 0);
-		CenterNumber (iEXEGuard[iEXETab][5], iLeft, 10 + (3 * 24), clrs[5], 0);
-		CenterNumber (iEXEGuard[iEXETab][6], iRight, 10 + (3 * 24), clrs[6], 0);
-		CenterNumber (iEXEGuard[iEXETab][7], iLeft, 10 + (4 * 24), clrs[7], 0);
-		CenterNumber (iEXEGuard[iEXETab][8], iRight, 10 + (4 * 24), clrs[8], 0);
-		CenterNumber (iEXEGuard[iEXETab][9], iLeft, 10 + (5 * 24), clrs[9], 0);
-		CenterNumber (iEXEGuard[iEXETab][10], iRight, 10 + (5 * 24), clrs[10], 0);
-		CenterNumber (iEXEGuard[iEXETab][11], iLeft, 10 + (6 * 24), clrs[11], 0);
-		CenterNumber (iEXEGuard[iEXETab][12], iRight, 10 + (6 * 24), clrs[12], 0);
-	}
+			ShowImage (imgsele, 217 + (15 * (iEventRoom - 1)), 115, "imgsele");
+		} else { iEventUnused = 1; }
 
-	/*** Guard HP. ***/
-	if (((iHomeComputer == 1) && (ulGuardHPA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulGuardHPB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulGuardHPC[iDiskImageC] != 0x00)))
-	{
-		if (iEXETabS != 14)
+		/*** sel event, tile ***/
+		if ((iEventTile >= 1) && (iEventTile <= 30))
 		{
-			clr = color_bl;
-			if (iEXEGuardHP[iEXETabS] != arDefaultGuardHP[iEXETabS])
-				{ clr = color_blue; }
-			CenterNumber (iEXEGuardHP[iEXETabS], 167, 236, clr, 0);
+			if ((iEventTile >= 1) && (iEventTile <= 10))
+				{ ShowImage (imgsele, 367 + (iEventTile * 15), 155, "imgsele"); }
+			if ((iEventTile >= 11) && (iEventTile <= 20))
+				{ ShowImage (imgsele, 367 + ((iEventTile - 10) * 15), 170, "imgsele"); }
+			if ((iEventTile >= 21) && (iEventTile <= 30))
+				{ ShowImage (imgsele, 367 + ((iEventTile - 20) * 15), 185, "imgsele"); }
+		} else { iEventUnused = 1; }
+
+		/*** sel event, next ***/
+		switch (iEventNext)
+		{
+			case 0: ShowImage (imgsele, 502, 225, "imgsele"); break; /*** N ***/
+			case 1: ShowImage (imgsele, 517, 225, "imgsele"); break; /*** Y ***/
 		}
-	}
 
-	/*** Guard uniform. ***/
-	if (((iHomeComputer == 1) && (ulGuardUniformA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulGuardUniformB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulGuardUniformC[iDiskImageC] != 0x00)))
-	{
-		if (iEXETabS != 14)
+		/*** Show target. ***/
+		if (iEventUnused == 0)
 		{
-			clr = color_bl;
-			if (iEXEGuardU[iEXETabS] != arDefaultGuardU[iEXETabS])
-				{ clr = color_blue; }
-			CenterNumber (iEXEGuardU[iEXETabS], 167, 260, clr, 0);
+			ShowTile (iShowTile, iShowMod, 445, 264, 1);
+		} else {
+			ShowImage (imgeventu, 445, 264, "imgeventu");
 		}
+
+		if (iMouse == 1) { ShowImage (imgmouse, 538, 73, "imgmouse"); }
 	}
 
-	/*** Guard sprite. ***/
-	if (((iHomeComputer == 1) && (ulGuardSpriteA[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulGuardSpriteB[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulGuardSpriteC[iDiskImageC] != 0x00)))
+	/*** left ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 	{
-		if (iEXETabS != 14)
+		/*** yes ***/
+		if (iDownAt == 1)
 		{
-			if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
-			if (iEXEGuardS[iEXETabS] != arDefaultGuardS[iEXETabS])
-				{ clr = color_blue; }
-			CenterNumber (iEXEGuardS[iEXETabS], 167, 284, clr, 0);
+			ShowImage (imgleft_1, 0, 50, "imgleft_1"); /*** down ***/
+		} else {
+			ShowImage (imgleft_0, 0, 50, "imgleft_0"); /*** up ***/
 		}
+	} else {
+		/*** no ***/
+		ShowImage (imglrno, 0, 50, "imglrno");
 	}
 
-	/*** Env. 1 ***/
-	if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
+	/*** right ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[2] != 0)
 	{
-		if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
-		if (iEXEEnv1[iEXETabS] != arDefaultEnv1[iEXETabS])
-			{ clr = color_blue; }
-		CenterNumber (iEXEEnv1[iEXETabS], 167, 308, clr, 0);
+		/*** yes ***/
+		if (iDownAt == 2)
+		{
+			ShowImage (imgright_1, 587, 50, "imgright_1"); /*** down ***/
+		} else {
+			ShowImage (imgright_0, 587, 50, "imgright_0"); /*** up ***/
+		}
+	} else {
+		/*** no ***/
+		ShowImage (imglrno, 587, 50, "imglrno");
 	}
 
-	/*** Env. 2 ***/
-	if (((iHomeComputer == 1) && (ulEnv2A[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulEnv2B[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulEnv2C[iDiskImageC] != 0x00)))
+	/*** up ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
 	{
-		if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
-		if (iEXEEnv2[iEXETabS] != arDefaultEnv2[iEXETabS])
-			{ clr = color_blue; }
-		CenterNumber (iEXEEnv2[iEXETabS], 167, 332, clr, 0);
+		/*** yes ***/
+		if (iDownAt == 3)
+		{
+			ShowImage (imgup_1, 25, 25, "imgup_1"); /*** down ***/
+		} else {
+			ShowImage (imgup_0, 25, 25, "imgup_0"); /*** up ***/
+		}
+	} else {
+		/*** no ***/
+		if (iScreen != 1)
+		{
+			ShowImage (imgudno, 25, 25, "imgudno"); /*** without info ***/
+		} else {
+			ShowImage (imgudnonfo, 25, 25, "imgudnonfo"); /*** with info ***/
+		}
 	}
 
-	/*** Environment image. ***/
-	if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00) &&
-		(ulEnv2A[iDiskImageA] != 0x00)) ||
-		((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00) &&
-		(ulEnv2B[iDiskImageB] != 0x00)) ||
-		((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00) &&
-		(ulEnv2C[iDiskImageC] != 0x00)))
+	/*** down ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 	{
-		if (iEXEEnv1[iEXETabS] == iEXEEnv2[iEXETabS])
+		/*** yes ***/
+		if (iDownAt == 4)
 		{
-			ShowImage (imgexeenvok, 53, 321, "imgexeenvok");
+			ShowImage (imgdown_1, 25, 436, "imgdown_1"); /*** down ***/
 		} else {
-			ShowImage (imgexeenvwarn, 53, 321, "imgexeenvwarn");
+			ShowImage (imgdown_0, 25, 436, "imgdown_0"); /*** up ***/
 		}
+	} else {
+		/*** no ***/
+		ShowImage (imgudno, 25, 436, "imgudno");
 	}
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
-}
-/*****************************************************************************/
-void InitScreenAction (char *sAction)
-/*****************************************************************************/
-{
-	int iEventTile;
-	int iEventRoom;
-
-	if (strcmp (sAction, "left") == 0)
+	switch (iScreen)
 	{
-		switch (iScreen)
-		{
-			case 1:
-				iSelected--;
-				switch (iSelected)
+		case 1:
+			if (arBrokenRoomLinks[iCurLevel] == 1)
+			{
+				/*** rooms broken on ***/
+				if (iDownAt == 11)
 				{
-					case 0: iSelected = 10; break;
-					case 10: iSelected = 20; break;
-					case 20: iSelected = 30; break;
-				}
-				break;
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					if (iMovingRoom != 0)
-					{
-						if (iMovingNewX != 1) { iMovingNewX--; }
-							else { iMovingNewX = 25; }
-						PlaySound ("wav/cross.wav");
-					}
+					ShowImage (imgbroomson_1, 0, 25, "imgbroomson_1"); /*** down ***/
 				} else {
-					if (iChangingBrokenSide != 1)
-					{
-						iChangingBrokenSide = 1;
-					} else {
-						switch (iChangingBrokenRoom)
-						{
-							case 1: iChangingBrokenRoom = 4; break;
-							case 5: iChangingBrokenRoom = 8; break;
-							case 9: iChangingBrokenRoom = 12; break;
-							case 13: iChangingBrokenRoom = 16; break;
-							case 17: iChangingBrokenRoom = 20; break;
-							case 21: iChangingBrokenRoom = 24; break;
-							default: iChangingBrokenRoom--; break;
-						}
-					}
+					ShowImage (imgbroomson_0, 0, 25, "imgbroomson_0"); /*** up ***/
 				}
-				break;
-			case 3:
-				iEventTile = arEventsTile[iCurLevel][iChangeEvent];
-				switch (iEventTile)
+			} else {
+				/*** rooms on ***/
+				if (iDownAt == 5)
 				{
-					case 1: iEventTile = 10; break;
-					case 11: iEventTile = 20; break;
-					case 21: iEventTile = 30; break;
-					default: iEventTile--; break;
+					ShowImage (imgroomson_1, 0, 25, "imgroomson_1"); /*** down ***/
+				} else {
+					ShowImage (imgroomson_0, 0, 25, "imgroomson_0"); /*** up ***/
 				}
-				arEventsTile[iCurLevel][iChangeEvent] = iEventTile;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
-		}
-	}
+			}
+			/*** events on ***/
+			if (iDownAt == 6)
+			{
+				ShowImage (imgeventson_1, 587, 25, "imgeventson_1"); /*** down ***/
+			} else {
+				ShowImage (imgeventson_0, 587, 25, "imgeventson_0"); /*** up ***/
+			}
+			break;
+		case 2:
+			/*** rooms off ***/
+			if (arBrokenRoomLinks[iCurLevel] == 1)
+			{
+				ShowImage (imgbroomsoff, 0, 25, "imgbroomsoff"); /*** broken ***/
+			} else {
+				ShowImage (imgroomsoff, 0, 25, "imgroomsoff");
+			}
 
-	if (strcmp (sAction, "right") == 0)
-	{
-		switch (iScreen)
-		{
-			case 1:
-				iSelected++;
-				switch (iSelected)
-				{
-					case 11: iSelected = 1; break;
-					case 21: iSelected = 11; break;
-					case 31: iSelected = 21; break;
-				}
-				break;
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
+			/*** events on ***/
+			if (iDownAt == 6)
+			{
+				ShowImage (imgeventson_1, 587, 25, "imgeventson_1"); /*** down ***/
+			} else {
+				ShowImage (imgeventson_0, 587, 25, "imgeventson_0"); /*** up ***/
+			}
+			break;
+		case 3:
+			if (arBrokenRoomLinks[iCurLevel] == 1)
+			{
+				/*** rooms broken on ***/
+				if (iDownAt == 11)
 				{
-					if (iMovingRoom != 0)
-					{
-						if (iMovingNewX != 25) { iMovingNewX++; }
-							else { iMovingNewX = 1; }
-						PlaySound ("wav/cross.wav");
-					}
+					ShowImage (imgbroomson_1, 0, 25, "imgbroomson_1"); /*** down ***/
 				} else {
-					if (iChangingBrokenSide != 2)
-					{
-						iChangingBrokenSide = 2;
-					} else {
-						switch (iChangingBrokenRoom)
-						{
-							case 4: iChangingBrokenRoom = 1; break;
-							case 8: iChangingBrokenRoom = 5; break;
-							case 12: iChangingBrokenRoom = 9; break;
-							case 16: iChangingBrokenRoom = 13; break;
-							case 20: iChangingBrokenRoom = 17; break;
-							case 24: iChangingBrokenRoom = 21; break;
-							default: iChangingBrokenRoom++; break;
-						}
-					}
+					ShowImage (imgbroomson_0, 0, 25, "imgbroomson_0"); /*** up ***/
 				}
-				break;
-			case 3:
-				iEventTile = arEventsTile[iCurLevel][iChangeEvent];
-				switch (iEventTile)
+			} else {
+				/*** rooms on ***/
+				if (iDownAt == 5)
 				{
-					case 10: iEventTile = 1; break;
-					case 20: iEventTile = 11; break;
-					case 30: iEventTile = 21; break;
-					default: iEventTile++; break;
+					ShowImage (imgroomson_1, 0, 25, "imgroomson_1"); /*** down ***/
+				} else {
+					ShowImage (imgroomson_0, 0, 25, "imgroomson_0"); /*** up ***/
 				}
-				arEventsTile[iCurLevel][iChangeEvent] = iEventTile;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
-		}
+			}
+			/*** events off ***/
+			ShowImage (imgeventsoff, 587, 25, "imgeventsoff");
+			break;
 	}
 
-	if (strcmp (sAction, "up") == 0)
+	/*** save ***/
+	if (iChanged != 0)
 	{
-		switch (iScreen)
+		/*** on ***/
+		if (iDownAt == 7)
 		{
-			case 1:
-				if (iSelected > 10) { iSelected-=10; }
-					else { iSelected+=20; }
-				break;
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					if (iMovingRoom != 0)
-					{
-						if (iMovingNewY != 1) { iMovingNewY--; }
-							else { iMovingNewY = 24; }
-						PlaySound ("wav/cross.wav");
-					}
-				} else {
-					if (iChangingBrokenSide != 3)
-					{
-						iChangingBrokenSide = 3;
-					} else {
-						switch (iChangingBrokenRoom)
-						{
-							case 1: iChangingBrokenRoom = 21; break;
-							case 2: iChangingBrokenRoom = 22; break;
-							case 3: iChangingBrokenRoom = 23; break;
-							case 4: iChangingBrokenRoom = 24; break;
-							default: iChangingBrokenRoom -= 4; break;
-						}
-					}
-				}
-				break;
-			case 3:
-				iEventTile = arEventsTile[iCurLevel][iChangeEvent];
-				if (iEventTile > 10) { iEventTile-=10; }
-					else { iEventTile+=20; }
-				arEventsTile[iCurLevel][iChangeEvent] = iEventTile;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
+			ShowImage (imgsaveon_1, 0, 436, "imgsaveon_1"); /*** down ***/
+		} else {
+			ShowImage (imgsaveon_0, 0, 436, "imgsaveon_0"); /*** up ***/
 		}
+	} else {
+		/*** off ***/
+		ShowImage (imgsaveoff, 0, 436, "imgsaveoff");
 	}
 
-	if (strcmp (sAction, "down") == 0)
+	/*** quit ***/
+	if (iDownAt == 8)
 	{
-		switch (iScreen)
-		{
-			case 1:
-				if (iSelected <= 20) { iSelected+=10; }
-					else { iSelected-=20; }
-				break;
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					if (iMovingRoom != 0)
-					{
-						if (iMovingNewY != 24) { iMovingNewY++; }
-							else { iMovingNewY = 1; }
-						PlaySound ("wav/cross.wav");
-					}
-				} else {
-					if (iChangingBrokenSide != 4)
-					{
-						iChangingBrokenSide = 4;
-					} else {
-						switch (iChangingBrokenRoom)
-						{
-							case 21: iChangingBrokenRoom = 1; break;
-							case 22: iChangingBrokenRoom = 2; break;
-							case 23: iChangingBrokenRoom = 3; break;
-							case 24: iChangingBrokenRoom = 4; break;
-							default: iChangingBrokenRoom += 4; break;
-						}
-					}
-				}
-				break;
-			case 3:
-				iEventTile = arEventsTile[iCurLevel][iChangeEvent];
-				if (iEventTile <= 20) { iEventTile+=10; }
-					else { iEventTile-=20; }
-				arEventsTile[iCurLevel][iChangeEvent] = iEventTile;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
-		}
+		ShowImage (imgquit_1, 587, 436, "imgquit_1"); /*** down ***/
+	} else {
+		ShowImage (imgquit_0, 587, 436, "imgquit_0"); /*** up ***/
 	}
 
-	if (strcmp (sAction, "left bracket") == 0)
+	/*** previous ***/
+	if (iCurLevel != 1)
 	{
-		switch (iScreen)
+		/*** on ***/
+		if (iDownAt == 9)
 		{
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					iMovingNewBusy = 0;
-					switch (iMovingRoom)
-					{
-						case 0: iMovingRoom = ROOMS; break; /*** If disabled. ***/
-						case 1: iMovingRoom = ROOMS; break;
-						default: iMovingRoom--; break;
-					}
-				}
-				break;
-			case 3:
-				iEventRoom = arEventsRoom[iCurLevel][iChangeEvent];
-				if ((iEventRoom >= 2) && (iEventRoom <= 24))
-				{
-					iEventRoom--;
-				} else {
-					iEventRoom = 24;
-				}
-				arEventsRoom[iCurLevel][iChangeEvent] = iEventRoom;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
+			ShowImage (imgprevon_1, 0, 0, "imgprevon_1"); /*** down ***/
+		} else {
+			ShowImage (imgprevon_0, 0, 0, "imgprevon_0"); /*** up ***/
 		}
+	} else {
+		/*** off ***/
+		ShowImage (imgprevoff, 0, 0, "imgprevoff");
 	}
 
-	if (strcmp (sAction, "right bracket") == 0)
+	/*** next ***/
+	if (iCurLevel != LEVELS)
 	{
-		switch (iScreen)
+		/*** on ***/
+		if (iDownAt == 10)
 		{
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					iMovingNewBusy = 0;
-					switch (iMovingRoom)
-					{
-						case 0: iMovingRoom = 1; break; /*** If disabled. ***/
-						case 24: iMovingRoom = 1; break;
-						default: iMovingRoom++; break;
-					}
-				}
-				break;
-			case 3:
-				iEventRoom = arEventsRoom[iCurLevel][iChangeEvent];
-				if ((iEventRoom >= 1) & (iEventRoom <= 23))
-				{
-					iEventRoom++;
-				} else {
-					iEventRoom = 1;
-				}
-				arEventsRoom[iCurLevel][iChangeEvent] = iEventRoom;
-				PlaySound ("wav/check_box.wav");
-				iChanged++;
-				break;
+			ShowImage (imgnexton_1, 587, 0, "imgnexton_1"); /*** down ***/
+		} else {
+			ShowImage (imgnexton_0, 587, 0, "imgnexton_0"); /*** up ***/
 		}
+	} else {
+		/*** off ***/
+		ShowImage (imgnextoff, 587, 0, "imgnextoff");
 	}
 
-	if (strcmp (sAction, "enter") == 0)
+	/*** level bar ***/
+	switch (iHomeComputer)
 	{
-		switch (iScreen)
-		{
-			case 1:
-				ChangePos();
-				break;
-			case 2:
-				if (arBrokenRoomLinks[iCurLevel] == 0)
-				{
-					if (iMovingRoom != 0)
-					{
-						if (arMovingRooms[iMovingNewX][iMovingNewY] == 0)
-						{
-							RemoveOldRoom();
-							AddNewRoom (iMovingNewX, iMovingNewY, iMovingRoom);
-							iChanged++;
-						}
-						iMovingRoom = 0; iMovingNewBusy = 0;
-					}
-				} else {
-					LinkPlus();
-				}
-				break;
-		}
+		case 1: ShowImage (imgbara, 25, 0, "imgbara"); break;
+		case 2: ShowImage (imgbarb, 25, 0, "imgbarb"); break;
+		case 3: ShowImage (imgbarc, 25, 0, "imgbarc"); break;
 	}
 
-	if (strcmp (sAction, "env") == 0)
+	/*** Assemble level bar text. ***/
+	switch (iCurLevel)
 	{
-		if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
-			((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
-			((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
-		{
-			if ((iCurLevel >= 3) && (iCurLevel <= 14))
-			{
-				EXELoad();
-				switch (cCurType)
-				{
-					case 'd':
-						cCurType = 'p';
-						iEXEEnv1[iCurLevel] = 0x01;
-						iEXEEnv2[iCurLevel] = 0x01;
-						break;
-					case 'p':
-						cCurType = 'd';
-						iEXEEnv1[iCurLevel] = 0x02;
-						iEXEEnv2[iCurLevel] = 0x02;
-						break;
-				}
-				EXESave();
-				PlaySound ("wav/extras.wav");
-			} else {
-				printf ("[ INFO ] The environment of levels 1 and 2 (and 0) cannot be"
-					" changed.\n");
-			}
-		} else {
-			printf ("[ INFO ] Unknown environment offset.\n");
-		}
+		case 1: snprintf (sLevelBar, MAX_TEXT, "level 1 (prison),"); break;
+		case 2: snprintf (sLevelBar, MAX_TEXT, "level 2 (guards),"); break;
+		case 3: snprintf (sLevelBar, MAX_TEXT, "level 3 (skeleton),"); break;
+		case 4: snprintf (sLevelBar, MAX_TEXT, "level 4 (mirror),"); break;
+		case 5: snprintf (sLevelBar, MAX_TEXT, "level 5 (thief),"); break;
+		case 6: snprintf (sLevelBar, MAX_TEXT, "level 6 (plunge),"); break;
+		case 7: snprintf (sLevelBar, MAX_TEXT, "level 7 (weightless),"); break;
+		case 8: snprintf (sLevelBar, MAX_TEXT, "level 8 (mouse),"); break;
+		case 9: snprintf (sLevelBar, MAX_TEXT, "level 9 (twisty),"); break;
+		case 10: snprintf (sLevelBar, MAX_TEXT, "level 10 (quad),"); break;
+		case 11: snprintf (sLevelBar, MAX_TEXT, "level 11 (fragile),"); break;
+		case 12: snprintf (sLevelBar, MAX_TEXT, "level 12 (12a; tower),"); break;
+		case 13: snprintf (sLevelBar, MAX_TEXT, "level 13 (12b; jaffar),"); break;
+		case 14: snprintf (sLevelBar, MAX_TEXT, "level 14 (rescue),"); break;
+		case 15: snprintf (sLevelBar, MAX_TEXT, "level 0 (demo),"); break;
 	}
-}
-/*****************************************************************************/
-void RunLevel (int iLevel)
-/*****************************************************************************/
-{
-	SDL_Thread *princethread;
-
-	if (iDebug == 1)
+	switch (iScreen)
 	{
-		printf ("[  OK  ] Starting the game in level %i.\n", iLevel);
+		case 1:
+			snprintf (sLevelBarF, MAX_TEXT, "%s room %i", sLevelBar, iCurRoom);
+			ShowImage (imgextras[iExtras], 530, 3, "imgextras[...]");
+			break;
+		case 2:
+			snprintf (sLevelBarF, MAX_TEXT, "%s room links", sLevelBar); break;
+		case 3:
+			snprintf (sLevelBarF, MAX_TEXT, "%s events", sLevelBar); break;
 	}
 
-	PlaytestStart (iLevel);
+	/*** Emulator information. ***/
+	if (iEmulator == 1) { ShowImage (imgemulator, 25, 50, "imgemulator"); }
 
-	princethread = SDL_CreateThread (StartGame, "StartGame", NULL);
-	if (princethread == NULL)
+	/*** Home computer icon on level bar. ***/
+	switch (iHomeComputer)
 	{
-		printf ("[FAILED] Could not create thread!\n");
-		exit (EXIT_ERROR);
+		case 1: ShowImage (imghcalb, 32, 7, "imghcalb"); break;
+		case 2: ShowImage (imghcblb, 32, 7, "imghcblb"); break;
+		case 3: ShowImage (imghcclb, 32, 7, "imghcclb"); break;
 	}
+
+	/*** Display level bar text. ***/
+	ShowText (&glyphs1, sLevelBarF, 48, 4, color_bl, &color_wh);
+
+	/*** refresh screen ***/
+	FrameEnd();
 }
 /*****************************************************************************/
-int StartGame (void *unused)
+void ShowRoom (void)
 /*****************************************************************************/
 {
-	char sSystem[200 + 2];
-	char sWine[200 + 2];
+	/* Shows the room, with the tiles of its neighbours, for iScreen 1. The
+	 * location iRoomSelected is shown selected.
+	 */
 
-	if (unused != NULL) { } /*** To prevent warnings. ***/
+	int iTile;
+	int iMod;
+	int iLoc;
+	int iHorL, iVerL;
+	struct living *liv;
+	char sText[MAX_TEXT + 2];
 
-	PlaySound ("wav/emulator.wav");
+	/*** Used for looping. ***/
+	int iTileLoop;
 
-	switch (iHomeComputer)
+	/*** One tile: 'top' row, room left down. ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0) /*** left ***/
 	{
-		case 1: /*** AppleWin ***/
-#if defined WIN32 || _WIN32 || WIN64 || _WIN64
-snprintf (sWine, 200, "%s", "");
-#else
-snprintf (sWine, 200, "%s", "wine ");
-#endif
-
-			snprintf (sSystem, 200, "%sAppleWin%sAppleWin.exe -model %s -h1 %s > %s",
-				sWine, SLASH, "apple2ee", sPathFile, DEVNULL);
-			break;
-		case 2: /*** B-em ***/
-			snprintf (sSystem, 200, "b-em -m10 -fasttape %s > %s",
-				sPathFile, DEVNULL);
-			break;
-		case 3: /*** VICE ***/
-			snprintf (sSystem, 200, "x64sc %s > %s",
-				sPathFile, DEVNULL);
-			break;
+		if (arLevels[iCurLevel].arRoom[arLevels[iCurLevel].arRoom[iCurRoom]
+			.arLink[1]].arLink[4] != 0) /*** down ***/
+		{
+			GetTileMod (arLevels[iCurLevel].arRoom[arLevels[iCurLevel]
+				.arRoom[iCurRoom].arLink[1]].arLink[4], 10, &iTile, &iMod);
+		} else {
+			iTile = 0x14;
+			iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
+		}
+	} else {
+		iTile = 0x14;
+		iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
 	}
-	if (system (sSystem) == -1)
-		{ printf ("[ WARN ] Could not execute emulator!\n"); }
-	if (iModified == 1) { PlaytestStop(); }
-
-	return (EXIT_NORMAL);
-}
-/*****************************************************************************/
-void ClearRoom (void)
-/*****************************************************************************/
-{
-	int iTileLoop;
+	ShowTile (iTile, iMod, iHor[0], iVer4, 1);
+	ShowImage (imgfadeds, iHor[0], iVer4, "imgfadeds");
 
-	/*** Remove tiles. ***/
-	for (iTileLoop = 1; iTileLoop <= 30; iTileLoop++)
+	/*** One tile: bottom row, room left. ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 	{
-		SetLocation (iCurRoom, iTileLoop, 0x00, 0x00);
+		GetTileMod (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1], 30,
+			&iTile, &iMod);
+	} else {
+		iTile = 0x14;
+		iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
 	}
+	ShowTile (iTile, iMod, iHor[0], iVer3, 1);
+	ShowImage (imgfadeds, iHor[0], iVer3, "imgfadeds");
 
-	/*** Remove guard. ***/
-	arGuardTile[iCurLevel][iCurRoom] = TILES + 1;
-
-	PlaySound ("wav/ok_close.wav");
-	iChanged++;
-}
-/*****************************************************************************/
-void UseTile (int iTile, int iLocation, int iRoom)
-/*****************************************************************************/
-{
-	/*** Do not use iSelected in this function. ***/
-
-	int iDir;
-	int iGetTile, iGetMod;
-
-	/*** Random tile. ***/
-	if (iTile == -1)
+	/*** One tile: middle row, room left. ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 	{
-		do {
-			iTile = 1 + (int) (78.0 * rand() / (RAND_MAX + 1.0));
-		} while (Unused (iTile) == 1);
+		GetTileMod (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1], 20,
+			&iTile, &iMod);
+	} else {
+		iTile = 0x14;
+		iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
 	}
+	ShowTile (iTile, iMod, iHor[0], iVer2, 1);
+	ShowImage (imgfadeds, iHor[0], iVer2, "imgfadeds");
 
-	/*** Custom tile. ***/
-	if (iTile == -2)
+	/*** One tile: top row, room left. ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1] != 0)
 	{
-		SetLocation (iRoom, iLocation,
-			(32 * iCustomX) + iCustomTile, iCustomMod);
+		GetTileMod (arLevels[iCurLevel].arRoom[iCurRoom].arLink[1], 10,
+			&iTile, &iMod);
+	} else {
+		iTile = 0x14;
+		iMod = 0x01; /*** Yes, 0x01. Palace without wall pattern. ***/
 	}
+	ShowTile (iTile, iMod, iHor[0], iVer1, 1);
+	ShowImage (imgfadeds, iHor[0], iVer1, "imgfadeds");
 
-	/*** Make sure the disabled living can't be used. ***/
-	if ((iCurGuard != 0x01) && ((iTile == 83) || (iTile == 84))) { return; }
-	if ((iCurGuard != 0x03) && ((iTile == 85) || (iTile == 86))) { return; }
-	if ((iCurGuard != 0x04) && ((iTile == 87) || (iTile == 88))) { return; }
-	if ((iCurGuard != 0x05) && ((iTile == 89) || (iTile == 90))) { return; }
-	if ((((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14)) &&
-		((iTile == 81) || (iTile == 82))) { return; }
-
-	if ((iTile >= 1) && (iTile <= 78))
+	/*** Under this room. ***/
+	if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4] != 0)
 	{
-		GetTileModChange (iTile, &iGetTile, &iGetMod);
-		SetLocation (iRoom, iLocation, iGetTile, iGetMod);
+		for (iTileLoop = 1; iTileLoop <= (TILES / 3); iTileLoop++)
+		{
+			GetTileMod (arLevels[iCurLevel].arRoom[iCurRoom].arLink[4], iTileLoop,
+				&iTile, &iMod);
+			ShowTile (iTile, iMod, iHor[iTileLoop], iVer4, 1);
+		}
 	}
 
-	switch (iTile)
+	/*** Inside the room. ***/
+	for (iTileLoop = 1; iTileLoop <= 30; iTileLoop++)
 	{
+		iLoc = 0;
+		iHorL = iHor[0]; /*** To prevent warnings. ***/
+		iVerL = iVer0; /*** To prevent warnings. ***/
+		if ((iTileLoop >= 1) && (iTileLoop <= 10))
+		{
+			iLoc = 20 + iTileLoop;
+			iHorL = iHor[iTileLoop];
+			iVerL = iVer3;
+		}
+		if ((iTileLoop >= 11) && (iTileLoop <= 20))
+		{
+			iLoc = iTileLoop;
+			iHorL = iHor[iTileLoop - 10];
+			iVerL = iVer2;
+		}
+		if ((iTileLoop >= 21) && (iTileLoop <= 30))
+		{
+			iLoc = -20 + iTileLoop;
+			iHorL = iHor[iTileLoop - 20];
+			iVerL = iVer1;
+		}
+		GetTileMod (iCurRoom, iLoc, &iTile, &iMod);
+		iTrack = 1;
+		track.w = 0;
+		ShowTile (iTile, iMod, iHorL, iVerL, 1);
+		if (iLoc == iRoomSelected)
+		{
+			ShowTile (iTile, iMod, iHorL, iVerL, 2);
+		}
+
 		/*** prince ***/
-		case 79: /*** turned right ***/
-			if ((arStartLocation[iCurLevel][1] != iCurRoom) ||
-				(arStartLocation[iCurLevel][2] != iLocation) ||
-				(arStartLocation[iCurLevel][3] != 0x00))
-			{
-				arStartLocation[iCurLevel][1] = iCurRoom;
-				arStartLocation[iCurLevel][2] = iLocation;
-				arStartLocation[iCurLevel][3] = 0x00;
-				PlaySound ("wav/hum_adj.wav");
-			}
-			break;
-		case 80: /*** turned left ***/
-			if ((arStartLocation[iCurLevel][1] != iCurRoom) ||
-				(arStartLocation[iCurLevel][2] != iLocation) ||
-				(arStartLocation[iCurLevel][3] != 0xFF))
+		if ((iCurRoom == arLevels[iCurLevel].arStartLocation[1]) &&
+			(iLoc == arLevels[iCurLevel].arStartLocation[2]))
+		{
+			switch (arLevels[iCurLevel].arStartLocation[3])
 			{
-				arStartLocation[iCurLevel][1] = iCurRoom;
-				arStartLocation[iCurLevel][2] = iLocation;
-				arStartLocation[iCurLevel][3] = 0xFF;
-				PlaySound ("wav/hum_adj.wav");
+				case 0x00: /*** looks right ***/
+				case 0xFF: /*** looks left ***/
+					ShowLiving (&livprince, iHorL, iVerL,
+						arLevels[iCurLevel].arStartLocation[3], (iRoomSelected == iLoc)
+						? 2 : 1, "prince");
+					break;
+				default:
+					printf ("[ WARN ] Strange prince direction: 0x%02x!\n",
+						arLevels[iCurLevel].arStartLocation[3]);
 			}
-			break;
+		}
 
-		/*** guards ***/
-		case 81: case 82: /*** guard ***/
-		case 83: case 84: /*** skel ***/
-		case 85: case 86: /*** fat ***/
-		case 87: case 88: /*** shadow ***/
-		case 89: case 90: /*** Jaffar ***/
-			switch (iTile)
+		/*** guard ***/
+		if (arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile == iLoc)
+		{
+			switch (arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir)
 			{
-				case 81: case 83: case 85: case 87: case 89:
-					iDir = 0x00; break;
-				case 82: case 84: case 86: case 88: case 90:
-				default: /*** To prevent warnings. ***/
-					iDir = 0xFF; break;
+				case 0xFF: /*** l ***/
+				case 0x00: /*** r ***/
+					break;
+				default:
+					printf ("[FAILED] Incorrect guard direction: 0x%02x!\n",
+						arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir);
+					exit (EXIT_ERROR);
 			}
-			if ((arGuardTile[iCurLevel][iCurRoom] == iLocation) &&
-				(arGuardDir[iCurLevel][iCurRoom] == iDir))
+			switch (iCurGuard)
 			{
-				arGuardTile[iCurLevel][iCurRoom] = TILES + 1;
-			} else {
-				arGuardTile[iCurLevel][iCurRoom] = iLocation;
-				arGuardDir[iCurLevel][iCurRoom] = iDir;
-				arGuardSkill[iCurLevel][iCurRoom] = iGuardType;
-				/*** arGuardC[iCurLevel][iCurRoom] = ; ***/
-				PlaySound ("wav/hum_adj.wav");
+				case 0x01: liv = &livskel; break; /*** skeleton ***/
+				case 0x03: liv = &livfat; break; /*** fat ***/
+				case 0x04: liv = &livshadow; break; /*** shadow ***/
+				case 0x05: liv = &livjaffar; break; /*** Jaffar ***/
+				default: liv = &livguard; break; /*** guard; 0x00 and 0x02 ***/
 			}
-			break;
+			ShowLiving (liv, iHorL, iVerL,
+				arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir,
+				(iLoc == iRoomSelected) ? 2 : 1, "guard");
+			switch (arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill)
+			{
+				case 10:
+					snprintf (sText, MAX_TEXT, "%s", "T:a"); break;
+				case 11:
+					snprintf (sText, MAX_TEXT, "%s", "T:b"); break;
+				default:
+					snprintf (sText, MAX_TEXT, "T:%i",
+						arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill); break;
+			}
+			ShowText (&glyphs2, sText, iHorL, iVerL + 125, color_bl, &color_wh);
+		}
+		iTrack = 0;
+		arRoomBox[iLoc] = track;
+	}
+
+	/*** Above this room. ***/
+	for (iTileLoop = 1; iTileLoop <= (TILES / 3); iTileLoop++)
+	{
+		if (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3] != 0)
+		{
+			GetTileMod (arLevels[iCurLevel].arRoom[iCurRoom].arLink[3],
+				iTileLoop + 20,
+				&iTile, &iMod);
+		} else {
+			iTile = 0x01; iMod = 0x00; /*** Floor. ***/
+		}
+		ShowTile (iTile, iMod, iHor[iTileLoop], iVer0, 1);
 	}
 }
 /*****************************************************************************/
-void Zoom (int iToggleFull)
+void RoomLayer (void)
 /*****************************************************************************/
 {
-	if (iToggleFull == 1)
+	/* Shows the room. It is drawn once in roomtex, without flames or the
+	 * selected location, until it changes. Only those two are drawn again,
+	 * each from the background up, to keep the tiles that overlap them.
+	 */
+
+	int iW, iH;
+	int iDamageOld;
+
+	iW = (WINDOW_WIDTH) * iScale;
+	iH = (WINDOW_HEIGHT) * iScale;
+	if ((frametex != NULL) && ((iRoomW != iW) || (iRoomH != iH)))
 	{
-		if (iFullscreen == 0)
-		{ iFullscreen = SDL_WINDOW_FULLSCREEN_DESKTOP; }
-			else { iFullscreen = 0; }
-	} else {
-		if (iFullscreen == SDL_WINDOW_FULLSCREEN_DESKTOP)
+		if (roomtex != NULL) { SDL_DestroyTexture (roomtex); }
+		roomtex = SDL_CreateTexture (ascreen, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_TARGET, iW, iH);
+		if (roomtex == NULL)
 		{
-			iFullscreen = 0;
-			iScale = 1;
-		} else if (iScale == 1) {
-			iScale = 2;
-		} else if (iScale == 2) {
-			iFullscreen = SDL_WINDOW_FULLSCREEN_DESKTOP;
+			PrIfDe ("[ INFO ] No room texture, drawing the room each time.\n");
 		} else {
-			printf ("[ WARN ] Unknown window state!\n");
+			SDL_SetTextureBlendMode (roomtex, SDL_BLENDMODE_NONE);
 		}
+		iRoomW = iW;
+		iRoomH = iH;
+		iRoomValid = 0;
+	}
+	if ((frametex == NULL) || (roomtex == NULL))
+	{
+		iRoomSelected = iSelected;
+		ShowRoom();
+		return;
 	}
 
-	SDL_SetWindowFullscreen (window, iFullscreen);
-	SDL_SetWindowSize (window, (WINDOW_WIDTH) * iScale,
-		(WINDOW_HEIGHT) * iScale);
-	SDL_RenderSetLogicalSize (ascreen, (WINDOW_WIDTH) * iScale,
-		(WINDOW_HEIGHT) * iScale);
-	SDL_SetWindowPosition (window, SDL_WINDOWPOS_CENTERED,
-		SDL_WINDOWPOS_CENTERED);
-	TTF_CloseFont (font1);
-	TTF_CloseFont (font2);
-	TTF_CloseFont (font3);
-	LoadFonts();
+	if ((RoomChanged() == 1) || (iRoomValid == 0))
+	{
+		BatchFlush();
+		SDL_SetRenderTarget (ascreen, roomtex);
+		SDL_RenderSetClipRect (ascreen, NULL);
+		iDamageOld = iDamage;
+		iDamage = 0;
+		iFlames = 0;
+		ShowImage (imgblack, 0, 0, "imgblack");
+		iRoomSelected = 0;
+		ShowRoom();
+		BatchFlush();
+		roomflames = flames;
+		iRoomFlames = iFlames;
+		iDamage = iDamageOld;
+		SDL_SetRenderTarget (ascreen, frametex);
+		if (iDamage == 1) { SDL_RenderSetClipRect (ascreen, &damage); }
+		iRoomValid = 1;
+	}
+	BatchFlush();
+	if (SDL_RenderCopy (ascreen, roomtex, NULL, NULL) != 0)
+	{
+		printf ("[ WARN ] SDL_RenderCopy (roomtex): %s!\n", SDL_GetError());
+	}
+	flames = roomflames;
+	iFlames = iRoomFlames;
+
+	if ((iSelected >= 1) && (iSelected <= TILES))
+		{ RoomBox (&arRoomBox[iSelected]); }
+	if (iRoomFlames != 0) { RoomBox (&roomflames); }
 }
 /*****************************************************************************/
-void LinkMinus (void)
+int RoomChanged (void)
 /*****************************************************************************/
 {
-	int iCurrent, iNew;
-
-	iCurrent = arRoomLinks[iCurLevel][iChangingBrokenRoom][iChangingBrokenSide];
-	if (iCurrent == 0) {
-		iNew = ROOMS;
-	} else {
-		iNew = iCurrent - 1;
-	}
-	arRoomLinks[iCurLevel][iChangingBrokenRoom][iChangingBrokenSide] = iNew;
-	iChanged++;
-	arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
-	PlaySound ("wav/hum_adj.wav");
+	/*** Returns 1 if roomtex no longer shows the current room. ***/
+
+	if ((memcmp (&stRoomLevel, &arLevels[iCurLevel],
+		sizeof (struct level)) == 0) &&
+		(iRoomLevel == iCurLevel) && (iRoomRoom == iCurRoom) &&
+		(iRoomGuard == iCurGuard) && (iRoomInfo == iInfo) &&
+		(cRoomType == cCurType)) { return (0); }
+
+	memcpy (&stRoomLevel, &arLevels[iCurLevel], sizeof (struct level));
+	iRoomLevel = iCurLevel;
+	iRoomRoom = iCurRoom;
+	iRoomGuard = iCurGuard;
+	iRoomInfo = iInfo;
+	cRoomType = cCurType;
+
+	return (1);
 }
 /*****************************************************************************/
-int BrokenRoomLinks (int iPrint)
+void RoomBox (SDL_Rect *box)
 /*****************************************************************************/
 {
-	int iBroken;
-	int iRoomLoop;
+	/*** Draws the room again, with what changes, inside (scaled) box. ***/
 
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-	{
-		arDone[iRoomLoop] = 0;
-		arRoomConnectionsBroken[iCurLevel][iRoomLoop][1] = 0;
-		arRoomConnectionsBroken[iCurLevel][iRoomLoop][2] = 0;
-		arRoomConnectionsBroken[iCurLevel][iRoomLoop][3] = 0;
-		arRoomConnectionsBroken[iCurLevel][iRoomLoop][4] = 0;
-	}
-	CheckSides (arStartLocation[iCurLevel][1], 0, 0);
-	iBroken = 0;
+	SDL_Rect inside;
+	SDL_Rect damageold;
+	int iDamageOld;
 
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	if (iDamage == 1)
 	{
-		/*** If the room is in use... ***/
-		if (arDone[iRoomLoop] == 1)
-		{
-			/*** check left ***/
-			if (arRoomLinks[iCurLevel][iRoomLoop][1] != 0)
-			{
-				if ((arRoomLinks[iCurLevel][iRoomLoop][1] == iRoomLoop) ||
-					(arRoomLinks[iCurLevel][arRoomLinks[iCurLevel][iRoomLoop][1]][2]
-					!= iRoomLoop) ||
-					(arRoomLinks[iCurLevel][iRoomLoop][1] > ROOMS))
-				{
-					arRoomConnectionsBroken[iCurLevel][iRoomLoop][1] = 1;
-					iBroken = 1;
-					if ((iDebug == 1) && (iPrint == 1))
-					{
-						printf ("[ INFO ] The left of room %i has a broken link.\n",
-							iRoomLoop);
-					}
-				}
-			}
-			/*** check right ***/
-			if (arRoomLinks[iCurLevel][iRoomLoop][2] != 0)
-			{
-				if ((arRoomLinks[iCurLevel][iRoomLoop][2] == iRoomLoop) ||
-					(arRoomLinks[iCurLevel][arRoomLinks[iCurLevel][iRoomLoop][2]][1]
-					!= iRoomLoop) ||
-					(arRoomLinks[iCurLevel][iRoomLoop][2] > ROOMS))
-				{
-					arRoomConnectionsBroken[iCurLevel][iRoomLoop][2] = 1;
-					iBroken = 1;
-					if ((iDebug == 1) && (iPrint == 1))
-					{
-						printf ("[ INFO ] The right of room %i has a broken link.\n",
-							iRoomLoop);
-					}
-				}
-			}
-			/*** check up ***/
-			if (arRoomLinks[iCurLevel][iRoomLoop][3] != 0)
-			{
-				if ((arRoomLinks[iCurLevel][iRoomLoop][3] == iRoomLoop) ||
-					(arRoomLinks[iCurLevel][arRoomLinks[iCurLevel][iRoomLoop][3]][4]
-					!= iRoomLoop) ||
-					(arRoomLinks[iCurLevel][iRoomLoop][3] > ROOMS))
-				{
-					arRoomConnectionsBroken[iCurLevel][iRoomLoop][3] = 1;
-					iBroken = 1;
-					if ((iDebug == 1) && (iPrint == 1))
-					{
-						printf ("[ INFO ] The top of room %i has a broken link.\n",
-							iRoomLoop);
-					}
-				}
-			}
-			/*** check down ***/
-			if (arRoomLinks[iCurLevel][iRoomLoop][4] != 0)
-			{
-				if ((arRoomLinks[iCurLevel][iRoomLoop][4] == iRoomLoop) ||
-					(arRoomLinks[iCurLevel][arRoomLinks[iCurLevel][iRoomLoop][4]][3]
-					!= iRoomLoop) ||
-					(arRoomLinks[iCurLevel][iRoomLoop][4] > ROOMS))
-				{
-					arRoomConnectionsBroken[iCurLevel][iRoomLoop][4] = 1;
-					iBroken = 1;
-					if ((iDebug == 1) && (iPrint == 1))
-					{
-						printf ("[ INFO ] The bottom of room %i has a broken link.\n",
-							iRoomLoop);
-					}
-				}
-			}
-		}
+		if (SDL_IntersectRect (box, &damage, &inside) == SDL_FALSE)
+			{ return; }
+	} else {
+		inside = *box;
+	}
+	BatchFlush();
+	damageold = damage;
+	iDamageOld = iDamage;
+	damage = inside;
+	iDamage = 1;
+	SDL_RenderSetClipRect (ascreen, &damage);
+	ShowImage (imgblack, 0, 0, "imgblack");
+	iRoomSelected = iSelected;
+	ShowRoom();
+	BatchFlush();
+	damage = damageold;
+	iDamage = iDamageOld;
+	if (iDamage == 1)
+	{
+		SDL_RenderSetClipRect (ascreen, &damage);
+	} else {
+		SDL_RenderSetClipRect (ascreen, NULL);
 	}
-
-	return (iBroken);
 }
 /*****************************************************************************/
-void ChangeEvent (int iAmount, int iChangePos)
+void ShowFlames (void)
 /*****************************************************************************/
 {
-	int iTile;
-
-	if (((iAmount > 0) && (iChangeEvent < EVENTS)) ||
-		((iAmount < 0) && (iChangeEvent > 1)))
-	{
-		/*** Modify the event number. ***/
-		iChangeEvent+=iAmount;
-		if (iChangeEvent < 1) { iChangeEvent = 1; }
-		if (iChangeEvent > EVENTS) { iChangeEvent = EVENTS; }
+	/* Called for the game animation, instead of ShowScreen(). Only the
+	 * flames change, so only the part of the screen around them is drawn
+	 * again, and nothing at all if no flames are shown.
+	 */
 
-		/*** If necessary, apply the event number to the selected tile. ***/
-		if (iChangePos == 1)
-		{
-			iTile = arRoomTiles[iCurLevel][iCurRoom][iSelected];
-			if ((iTile == 0x06) || (iTile == 0x0F)) /*** drop or raise ***/
-			{
-				arRoomMod[iCurLevel][iCurRoom][iSelected] = iChangeEvent - 1;
-				iChanged++;
-			}
-		}
+	if (iFlames == 0) { return; }
+	if (frametex == NULL) { ShowScreen(); return; }
 
-		PlaySound ("wav/plus_minus.wav");
-	}
+	damage = flames;
+	iDamage = 1;
+	ShowScreen();
+	iDamage = 0;
 }
 /*****************************************************************************/
-void ChangeCustom (int iAmount, int iType)
+void FrameStart (void)
 /*****************************************************************************/
 {
-	if (iType == 1)
+	/* Makes the drawing go to frametex, which keeps the screen between
+	 * frames. With iDamage, everything outside damage is left as is.
+	 */
+
+	int iW, iH;
+
+	BatchFlush();
+	iW = (WINDOW_WIDTH) * iScale;
+	iH = (WINDOW_HEIGHT) * iScale;
+	if ((iFrameW != iW) || (iFrameH != iH))
 	{
-		/*** Modify the custom tile. ***/
-		if (((iAmount > 0) && (iCustomTile < 0x1F)) ||
-			((iAmount < 0) && (iCustomTile > 0x00)))
+		if (frametex != NULL) { SDL_DestroyTexture (frametex); }
+		frametex = NULL;
+		if (SDL_RenderTargetSupported (ascreen) == SDL_TRUE)
 		{
-			iCustomTile+=iAmount;
-			if (iCustomTile < 0x00) { iCustomTile = 0x00; }
-			if (iCustomTile > 0x1F) { iCustomTile = 0x1F; }
-
-			PlaySound ("wav/plus_minus.wav");
+			frametex = SDL_CreateTexture (ascreen, SDL_PIXELFORMAT_ARGB8888,
+				SDL_TEXTUREACCESS_TARGET, iW, iH);
 		}
-	} else {
-		/*** Modify the custom mod. ***/
-		if (((iAmount > 0) && (iCustomMod < 0xFF)) ||
-			((iAmount < 0) && (iCustomMod > 0x00)))
+		if (frametex == NULL)
 		{
-			iCustomMod+=iAmount;
-			if (iCustomMod < 0x00) { iCustomMod = 0x00; }
-			if (iCustomMod > 0xFF) { iCustomMod = 0xFF; }
-
-			PlaySound ("wav/plus_minus.wav");
+			PrIfDe ("[ INFO ] No frame texture, drawing on the window.\n");
+		} else {
+			SDL_SetTextureBlendMode (frametex, SDL_BLENDMODE_NONE);
 		}
+		iFrameW = iW;
+		iFrameH = iH;
+		iDamage = 0;
 	}
+	iFlames = 0;
+	if (frametex == NULL) { iDamage = 0; return; }
+
+	SDL_SetRenderTarget (ascreen, frametex);
+	if (iDamage == 1) { SDL_RenderSetClipRect (ascreen, &damage); }
 }
 /*****************************************************************************/
-void Prev (void)
-/*****************************************************************************/
-{
-	if (iCurLevel != 1)
-	{
-		iCurLevel--;
-		LoadLevels (iCurLevel); iChanged = 0; /*** Discard changes. ***/
-		iCurRoom = arStartLocation[iCurLevel][1];
-		PlaySound ("wav/level_change.wav");
-	}
-}
-/*****************************************************************************/
-void Next (void)
+void FrameEnd (void)
 /*****************************************************************************/
 {
-	if (iCurLevel != LEVELS)
+	BatchFlush();
+	if (frametex != NULL)
 	{
-		iCurLevel++;
-		LoadLevels (iCurLevel); iChanged = 0; /*** Discard changes. ***/
-		iCurRoom = arStartLocation[iCurLevel][1];
-		PlaySound ("wav/level_change.wav");
+		SDL_RenderSetClipRect (ascreen, NULL);
+		SDL_SetRenderTarget (ascreen, NULL);
+		SDL_RenderCopy (ascreen, frametex, NULL, NULL);
 	}
+	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void CallSave (void)
+int Damaged (SDL_Rect *rect)
 /*****************************************************************************/
 {
-	CreateBAK();
-	SaveLevels();
+	/*** Returns 1 if (scaled) rect needs to be drawn. ***/
+
+	if (iDamage == 0) { return (1); }
+
+	return (SDL_HasIntersection (rect, &damage) == SDL_TRUE);
 }
 /*****************************************************************************/
-void Sprinkle (void)
+void InitPopUp (void)
 /*****************************************************************************/
 {
-	int iRandom;
-	int iTile, iMod;
+	int iPopUp;
+	SDL_Event event;
 
-	/*** Used for looping. ***/
-	int iRoomLoop;
-	int iTileLoop;
+	iPopUp = 1;
 
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	PlaySound ("wav/popup.wav");
+	ShowPopUp();
+	while (iPopUp == 1)
 	{
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		while (SDL_PollEvent (&event))
 		{
-			iTile = arRoomTiles[iCurLevel][iRoomLoop][iTileLoop];
-			iMod = arRoomMod[iCurLevel][iRoomLoop][iTileLoop];
-
-			/*** d: space? add wall shadow ***/
-			/*** p: wall pattern? add variant pattern ***/
-			if ((iTile == 0x00) && ((((iMod == 0x00) || (iMod == 0xFF)) &&
-				(cCurType == 'd')) || ((iMod == 0x01) && (cCurType == 'p'))))
+			switch (event.type)
 			{
-				/*** 1-4 ***/
-				iRandom = 1 + (int) (4.0 * rand() / (RAND_MAX + 1.0));
-				switch (iRandom)
-				{
-					case 1:
-						/*** arRoomTiles unchanged. ***/
-						if (cCurType == 'd')
+				case SDL_CONTROLLERBUTTONDOWN:
+					/*** Nothing for now. ***/
+					break;
+				case SDL_CONTROLLERBUTTONUP:
+					switch (event.cbutton.button)
+					{
+						case SDL_CONTROLLER_BUTTON_A:
+							iPopUp = 0; break;
+					}
+					break;
+				case SDL_KEYDOWN:
+					switch (event.key.keysym.sym)
+					{
+						case SDLK_ESCAPE:
+						case SDLK_KP_ENTER:
+						case SDLK_RETURN:
+						case SDLK_SPACE:
+						case SDLK_o:
+							iPopUp = 0;
+						default: break;
+					}
+					break;
+				case SDL_MOUSEMOTION:
+					iXPos = event.motion.x;
+					iYPos = event.motion.y;
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					if (event.button.button == 1)
+					{
+						if (InArea (400, 320, 400 + 85, 320 + 32) == 1) /*** OK ***/
 						{
-							arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x01;
-						}
-						break;
-					case 2:
-						/*** arRoomTiles unchanged. ***/
-						arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x02;
-						break;
-				}
-			}
-
-			/*** d: empty floor? add wall shadow (2x), rubble, torch, skeleton ***/
-			/*** p: empty floor? add variant pattern, rubble, torch ***/
-			if ((iTile == 0x01) && ((iMod == 0x00) || (iMod == 0xFF)))
-			{
-				/*** 1-10 ***/
-				iRandom = 1 + (int) (10.0 * rand() / (RAND_MAX + 1.0));
-				switch (iRandom)
-				{
-					case 1: /*** wall shadow ***/
-						/*** arRoomTiles unchanged. ***/
-						if (cCurType == 'd')
-						{
-							arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x01;
+							iOKOn = 1;
+							ShowPopUp();
 						}
-						break;
-					case 2: /*** wall shadow / variant pattern ***/
-						/*** arRoomTiles unchanged. ***/
-						arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x02;
-						break;
-					case 3: /*** rubble ***/
-						arRoomTiles[iCurLevel][iRoomLoop][iTileLoop] = 0x0E;
-						arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x00;
-						break;
-					case 4: /*** torch ***/
-						arRoomTiles[iCurLevel][iRoomLoop][iTileLoop] = 0x13;
-						arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x00;
-						break;
-					case 5: /*** skeleton ***/
-						if (cCurType == 'd')
+					}
+					break;
+				case SDL_MOUSEBUTTONUP:
+					iOKOn = 0;
+					if (event.button.button == 1)
+					{
+						if (InArea (400, 320, 400 + 85, 320 + 32) == 1) /*** OK ***/
 						{
-							arRoomTiles[iCurLevel][iRoomLoop][iTileLoop] = 0x15;
-							arRoomMod[iCurLevel][iRoomLoop][iTileLoop] = 0x00;
+							iPopUp = 0;
 						}
-						break;
-				}
+					}
+					ShowPopUp(); break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+						{ ShowScreen(); ShowPopUp(); } break;
+				case SDL_QUIT:
+					Quit(); break;
 			}
 		}
+
+		/*** prevent CPU eating ***/
+		gamespeed = REFRESH_PROG;
+		while ((SDL_GetTicks() - looptime) < gamespeed)
+		{
+			SDL_Delay (10);
+		}
+		looptime = SDL_GetTicks();
 	}
+	PlaySound ("wav/popup_close.wav");
+	ShowScreen();
 }
 /*****************************************************************************/
-void SetLocation (int iRoom, int iLocation, int iTile, int iMod)
+void ShowPopUp (void)
 /*****************************************************************************/
 {
-	if (iTile >= 32)
+	char arText[9 + 2][MAX_TEXT + 2];
+
+	/*** faded background ***/
+	ShowImage (imgfadedl, 0, 0, "imgfadedl");
+
+	/*** popup ***/
+	ShowImage (imgpopup, 61, 7, "imgpopup");
+
+	/*** OK ***/
+	switch (iOKOn)
 	{
-		iTile-=32;
-		arRoomX[iCurLevel][iRoom][iLocation] = 1;
-		iLastX = 1;
+		case 0: ShowImage (imgok[1], 400, 320, "imgok[1]"); break; /*** off ***/
+		case 1: ShowImage (imgok[2], 400, 320, "imgok[2]"); break; /*** on ***/
+	}
+
+	snprintf (arText[0], MAX_TEXT, "%s %s", EDITOR_NAME, EDITOR_VERSION);
+	snprintf (arText[1], MAX_TEXT, "%s", COPYRIGHT);
+	snprintf (arText[2], MAX_TEXT, "%s", "");
+	if (iController != 1)
+	{
+		snprintf (arText[3], MAX_TEXT, "%s", "single tile (change or select)");
+		snprintf (arText[4], MAX_TEXT, "%s", "entire room (clear or fill)");
+		snprintf (arText[5], MAX_TEXT, "%s", "entire level (randomize or fill)");
 	} else {
-		arRoomX[iCurLevel][iRoom][iLocation] = 0;
-		iLastX = 0;
+		snprintf (arText[3], MAX_TEXT, "%s", "The detected game controller:");
+		snprintf (arText[4], MAX_TEXT, "%s", sControllerName);
+		snprintf (arText[5], MAX_TEXT, "%s", "Have fun using it!");
 	}
-	arRoomTiles[iCurLevel][iRoom][iLocation] = iTile;
-	arRoomMod[iCurLevel][iRoom][iLocation] = iMod;
-	iLastTile = iTile;
-	iLastMod = iMod;
+	snprintf (arText[6], MAX_TEXT, "%s", "");
+	snprintf (arText[7], MAX_TEXT, "%s", "You may use one guard per room.");
+	snprintf (arText[8], MAX_TEXT, "%s", "The tile behavior may differ per"
+		" level.");
+
+	DisplayText (140, 121, FONT_SIZE_15, arText, 9, &glyphs1);
+
+	/*** refresh screen ***/
+	BatchFlush();
+	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void FlipRoom (int iAxis)
+void Help (void)
 /*****************************************************************************/
 {
-	int arRoomXTemp[TILES + 2];
-	unsigned char arRoomTilesTemp[TILES + 2];
-	unsigned char arRoomModTemp[TILES + 2];
-	int iTileUse;
-	int iTile;
-
-	/*** Used for looping. ***/
-	int iTileLoop;
+	int iHelp;
+	SDL_Event event;
 
-	/*** Storing tiles for later use. ***/
-	for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-	{
-		arRoomXTemp[iTileLoop] = arRoomX[iCurLevel][iCurRoom][iTileLoop];
-		arRoomTilesTemp[iTileLoop] = arRoomTiles[iCurLevel][iCurRoom][iTileLoop];
-		arRoomModTemp[iTileLoop] = arRoomMod[iCurLevel][iCurRoom][iTileLoop];
-	}
+	iHelp = 1;
 
-	if (iAxis == 1) /*** horizontal ***/
+	PlaySound ("wav/popup.wav");
+	ShowHelp();
+	while (iHelp == 1)
 	{
-		/*** tiles ***/
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-		{
-			iTileUse = 0; /*** To prevent warnings. ***/
-			if ((iTileLoop >= 1) && (iTileLoop <= 10))
-				{ iTileUse = 11 - iTileLoop; }
-			if ((iTileLoop >= 11) && (iTileLoop <= 20))
-				{ iTileUse = 31 - iTileLoop; }
-			if ((iTileLoop >= 21) && (iTileLoop <= 30))
-				{ iTileUse = 51 - iTileLoop; }
-			arRoomX[iCurLevel][iCurRoom][iTileLoop] = arRoomXTemp[iTileUse];
-			arRoomTiles[iCurLevel][iCurRoom][iTileLoop] = arRoomTilesTemp[iTileUse];
-			arRoomMod[iCurLevel][iCurRoom][iTileLoop] = arRoomModTemp[iTileUse];
-		}
-
-		/*** prince ***/
-		if (arStartLocation[iCurLevel][1] == iCurRoom)
-		{
-			/*** direction ***/
-			if (arStartLocation[iCurLevel][3] == 0x00)
-				{ arStartLocation[iCurLevel][3] = 0xFF; }
-					else { arStartLocation[iCurLevel][3] = 0x00; }
-			/*** tile ***/
-			iTile = arStartLocation[iCurLevel][2];
-			if ((iTile >= 1) && (iTile <= 10))
-				{ arStartLocation[iCurLevel][2] = 11 - iTile; }
-			if ((iTile >= 11) && (iTile <= 20))
-				{ arStartLocation[iCurLevel][2] = 31 - iTile; }
-			if ((iTile >= 21) && (iTile <= 30))
-				{ arStartLocation[iCurLevel][2] = 51 - iTile; }
-		}
-
-		/*** guard ***/
-		if (arGuardTile[iCurLevel][iCurRoom] <= TILES + 1)
-		{
-			/*** direction ***/
-			if (arGuardDir[iCurLevel][iCurRoom] == 0x00)
-				{ arGuardDir[iCurLevel][iCurRoom] = 0xFF; }
-					else { arGuardDir[iCurLevel][iCurRoom] = 0x00; }
-			/*** tile ***/
-			iTile = arGuardTile[iCurLevel][iCurRoom];
-			if ((iTile >= 1) && (iTile <= 10))
-				{ arGuardTile[iCurLevel][iCurRoom] = 11 - iTile; }
-			if ((iTile >= 11) && (iTile <= 20))
-				{ arGuardTile[iCurLevel][iCurRoom] = 31 - iTile; }
-			if ((iTile >= 21) && (iTile <= 30))
-				{ arGuardTile[iCurLevel][iCurRoom] = 51 - iTile; }
-		}
-	} else { /*** vertical ***/
-		/*** tiles ***/
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-		{
-			iTileUse = 0; /*** To prevent warnings. ***/
-			if ((iTileLoop >= 1) && (iTileLoop <= 10))
-				{ iTileUse = iTileLoop + 20; }
-			if ((iTileLoop >= 11) && (iTileLoop <= 20))
-				{ iTileUse = iTileLoop; }
-			if ((iTileLoop >= 21) && (iTileLoop <= 30))
-				{ iTileUse = iTileLoop - 20; }
-			arRoomX[iCurLevel][iCurRoom][iTileLoop] = arRoomXTemp[iTileUse];
-			arRoomTiles[iCurLevel][iCurRoom][iTileLoop] =
-				arRoomTilesTemp[iTileUse];
-			arRoomMod[iCurLevel][iCurRoom][iTileLoop] = arRoomModTemp[iTileUse];
-		}
-
-		/*** prince ***/
-		if (arStartLocation[iCurLevel][1] == iCurRoom)
+		while (SDL_PollEvent (&event))
 		{
-			/*** tile ***/
-			iTile = arStartLocation[iCurLevel][2];
-			if ((iTile >= 1) && (iTile <= 10))
-				{ arStartLocation[iCurLevel][2] = iTile + 20; }
-			if ((iTile >= 21) && (iTile <= 30))
-				{ arStartLocation[iCurLevel][2] = iTile - 20; }
+			switch (event.type)
+			{
+				case SDL_CONTROLLERBUTTONDOWN:
+					/*** Nothing for now. ***/
+					break;
+				case SDL_CONTROLLERBUTTONUP:
+					switch (event.cbutton.button)
+					{
+						case SDL_CONTROLLER_BUTTON_A:
+							iHelp = 0; break;
+					}
+					break;
+				case SDL_KEYDOWN:
+					switch (event.key.keysym.sym)
+					{
+						case SDLK_ESCAPE:
+						case SDLK_KP_ENTER:
+						case SDLK_RETURN:
+						case SDLK_SPACE:
+						case SDLK_o:
+							iHelp = 0;
+						default: break;
+					}
+					break;
+				case SDL_MOUSEMOTION:
+					iXPos = event.motion.x;
+					iYPos = event.motion.y;
+					if (InArea (48, 322, 48 + 517, 322 + 20) == 1)
+					{
+						SDL_SetCursor (curHand);
+					} else {
+						SDL_SetCursor (curArrow);
+					}
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					if (event.button.button == 1)
+					{
+						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** OK ***/
+						{
+							iHelpOK = 1;
+							ShowHelp();
+						}
+					}
+					break;
+				case SDL_MOUSEBUTTONUP:
+					iHelpOK = 0;
+					if (event.button.button == 1) /*** left mouse button ***/
+					{
+						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** OK ***/
+							{ iHelp = 0; }
+						if (InArea (48, 322, 48 + 517, 322 + 20) == 1)
+							{ OpenURL ("https://github.com/EndeavourAccuracy/leapop"); }
+					}
+					ShowHelp(); break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+						{ ShowHelp(); } break;
+				case SDL_QUIT:
+					Quit(); break;
+			}
 		}
 
-		/*** guard ***/
-		if (arGuardTile[iCurLevel][iCurRoom] <= TILES + 1)
+		/*** prevent CPU eating ***/
+		gamespeed = REFRESH_PROG;
+		while ((SDL_GetTicks() - looptime) < gamespeed)
 		{
-			/*** tile ***/
-			iTile = arGuardTile[iCurLevel][iCurRoom];
-			if ((iTile >= 1) && (iTile <= 10))
-				{ arGuardTile[iCurLevel][iCurRoom] = iTile + 20; }
-			if ((iTile >= 21) && (iTile <= 30))
-				{ arGuardTile[iCurLevel][iCurRoom] = iTile - 20; }
+			SDL_Delay (10);
 		}
+		looptime = SDL_GetTicks();
 	}
+	PlaySound ("wav/popup_close.wav");
+	ShowScreen();
 }
 /*****************************************************************************/
-void CopyPaste (int iAction)
+void ShowHelp (void)
 /*****************************************************************************/
 {
-	/*** Used for looping. ***/
-	int iTileLoop;
+	/*** background ***/
+	ShowImage (imghelp, 0, 0, "imghelp");
 
-	if (iAction == 1) /*** copy ***/
+	/*** OK ***/
+	switch (iHelpOK)
 	{
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-		{
-			arCopyPasteX[iTileLoop] = arRoomX[iCurLevel][iCurRoom][iTileLoop];
-			arCopyPasteTile[iTileLoop] = arRoomTiles[iCurLevel][iCurRoom][iTileLoop];
-			arCopyPasteMod[iTileLoop] = arRoomMod[iCurLevel][iCurRoom][iTileLoop];
-		}
-		cCopyPasteGuardTile = arGuardTile[iCurLevel][iCurRoom];
-		cCopyPasteGuardDir = arGuardDir[iCurLevel][iCurRoom];
-		cCopyPasteGuardSkill = arGuardSkill[iCurLevel][iCurRoom];
-		cCopyPasteGuardC = arGuardC[iCurLevel][iCurRoom];
-		iCopied = 1;
-	} else { /*** paste ***/
-		if (iCopied == 1)
-		{
-			for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-			{
-				arRoomX[iCurLevel][iCurRoom][iTileLoop] = arCopyPasteX[iTileLoop];
-				arRoomTiles[iCurLevel][iCurRoom][iTileLoop] =
-					arCopyPasteTile[iTileLoop];
-				arRoomMod[iCurLevel][iCurRoom][iTileLoop] = arCopyPasteMod[iTileLoop];
-			}
-			arGuardTile[iCurLevel][iCurRoom] = cCopyPasteGuardTile;
-			arGuardDir[iCurLevel][iCurRoom] = cCopyPasteGuardDir;
-			arGuardSkill[iCurLevel][iCurRoom] = cCopyPasteGuardSkill;
-			arGuardC[iCurLevel][iCurRoom] = cCopyPasteGuardC;
-		} else {
-			for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-			{
-				arRoomX[iCurLevel][iCurRoom][iTileLoop] = 0;
-				arRoomTiles[iCurLevel][iCurRoom][iTileLoop] = 0x00;
-				arRoomMod[iCurLevel][iCurRoom][iTileLoop] = 0x00;
-			}
-			arGuardTile[iCurLevel][iCurRoom] = TILES + 1;
-		}
-	}
-}
-/*****************************************************************************/
-int InArea (int iUpperLeftX, int iUpperLeftY,
-	int iLowerRightX, int iLowerRightY)
-/*****************************************************************************/
-{
-	if ((iUpperLeftX * iScale <= iXPos) &&
-		(iLowerRightX * iScale >= iXPos) &&
-		(iUpperLeftY * iScale <= iYPos) &&
-		(iLowerRightY * iScale >= iYPos))
-	{
-		return (1);
-	} else {
-		return (0);
-	}
-}
-/*****************************************************************************/
-int MouseSelectAdj (void)
-/*****************************************************************************/
-{
-	/* On the broken room links screen, if you click one of the adjacent
-	 * rooms, this function sets iOnAdj to 1, and also sets both
-	 * iChangingBrokenRoom and iChangingBrokenSide.
-	 */
-
-	int iOnAdj;
-	int iRoomLoop;
-	int iAdjBaseX;
-	int iAdjBaseY;
-
-	iOnAdj = 0;
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-	{
-		switch (iRoomLoop)
-		{
-			case 1: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
-			case 2: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
-			case 3: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
-			case 4: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
-			case 5: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
-			case 6: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
-			case 7: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
-			case 8: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
-			case 9: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
-			case 10: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
-			case 11: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
-			case 12: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
-			case 13: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
-			case 14: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
-			case 15: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
-			case 16: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
-			case 17: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
-			case 18: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
-			case 19: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
-			case 20: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
-			case 21: iAdjBaseX = ADJ_BASE_X + (63 * 0);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
-			case 22: iAdjBaseX = ADJ_BASE_X + (63 * 1);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
-			case 23: iAdjBaseX = ADJ_BASE_X + (63 * 2);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
-			case 24: iAdjBaseX = ADJ_BASE_X + (63 * 3);
-				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
-			default:
-				printf ("[FAILED] iRoomLoop is not in the 1-24 range!\n");
-				exit (EXIT_ERROR);
-		}
-		if (InArea (iAdjBaseX + 1, iAdjBaseY + 16,
-			iAdjBaseX + 15, iAdjBaseY + 30) == 1)
-		{
-			iChangingBrokenRoom = iRoomLoop;
-			iChangingBrokenSide = 1; /*** left ***/
-			iOnAdj = 1;
-		}
-		if (InArea (iAdjBaseX + 31, iAdjBaseY + 16,
-			iAdjBaseX + 45, iAdjBaseY + 30) == 1)
-		{
-			iChangingBrokenRoom = iRoomLoop;
-			iChangingBrokenSide = 2; /*** right ***/
-			iOnAdj = 1;
-		}
-		if (InArea (iAdjBaseX + 16, iAdjBaseY + 1,
-			iAdjBaseX + 30, iAdjBaseY + 14) == 1)
-		{
-			iChangingBrokenRoom = iRoomLoop;
-			iChangingBrokenSide = 3; /*** up ***/
-			iOnAdj = 1;
-		}
-		if (InArea (iAdjBaseX + 16, iAdjBaseY + 31,
-			iAdjBaseX + 30, iAdjBaseY + 45) == 1)
-		{
-			iChangingBrokenRoom = iRoomLoop;
-			iChangingBrokenSide = 4; /*** down ***/
-			iOnAdj = 1;
-		}
+		case 0: ShowImage (imgok[1], 510, 411, "imgok[1]"); break; /*** off ***/
+		case 1: ShowImage (imgok[2], 510, 411, "imgok[2]"); break; /*** on ***/
 	}
 
-	return (iOnAdj);
-}
-/*****************************************************************************/
-int OnLevelBar (void)
-/*****************************************************************************/
-{
-	if (InArea (28, 3, 522, 22) == 1) { return (1); } else { return (0); }
+	/*** refresh screen ***/
+	BatchFlush();
+	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void ChangePos (void)
+void EXE (void)
 /*****************************************************************************/
 {
-	int iChanging;
+	int iEXE;
 	SDL_Event event;
 	int iOldXPos, iOldYPos;
-	int iUseTile;
-	int iNowOn;
-	int iSkillChange;
+	int iRow;
+	int iUseL, iUseR;
+	int iTabMax;
+	int iMin;
 
-	/*** Used for looping. ***/
-	int iRoomLoop;
-	int iTileLoop;
+	iEXE = 1;
+	iEXETabS = iCurLevel;
+	if (iEXETabS == 15) { iEXETabS = 0; }
 
-	iChanging = 1;
-	iCustomHover = 0;
-	iGuardType = 0;
-	ontile = SDL_GetTicks();
+	EXELoad();
 
-	ShowChange();
-	while (iChanging == 1)
+	PlaySound ("wav/popup.wav");
+	ShowEXE();
+	while (iEXE == 1)
 	{
-		/*** This is for the large preview. ***/
-		newticks = SDL_GetTicks();
-		if (newticks > oldticks + REFRESH_PROG)
-		{
-			ShowChange();
-			oldticks = newticks;
-		}
-
 		while (SDL_PollEvent (&event))
 		{
 			switch (event.type)
@@ -6629,2703 +6805,5800 @@ void ChangePos (void)
 					switch (event.cbutton.button)
 					{
 						case SDL_CONTROLLER_BUTTON_A:
-							if (iOnTile != 0)
-							{
-								UseTile (iOnTile, iSelected, iCurRoom);
-								if (iOnTile <= 78) { iChanging = 0; }
-								iChanged++;
-							}
-							break;
-						case SDL_CONTROLLER_BUTTON_B:
-							iChanging = 0; break;
-						case SDL_CONTROLLER_BUTTON_X:
-							if (iGuardType < 11) { iGuardType++; }
-								else { iGuardType = 0; }
-							ApplySkillIfNecessary (iSelected);
-							PlaySound ("wav/check_box.wav");
-							break;
-						case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-							ChangePosAction ("left"); break;
-						case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-							ChangePosAction ("right"); break;
-						case SDL_CONTROLLER_BUTTON_DPAD_UP:
-							ChangePosAction ("up"); break;
-						case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
-							ChangePosAction ("down"); break;
+							EXESave(); iEXE = 0; break;
 					}
-					ShowChange();
 					break;
-				case SDL_CONTROLLERAXISMOTION: /*** triggers and analog sticks ***/
-					iXJoy1 = SDL_JoystickGetAxis (joystick, 0);
-					iYJoy1 = SDL_JoystickGetAxis (joystick, 1);
-					iXJoy2 = SDL_JoystickGetAxis (joystick, 3);
-					iYJoy2 = SDL_JoystickGetAxis (joystick, 4);
-					if ((iXJoy1 < -30000) || (iXJoy2 < -30000)) /*** left ***/
+				case SDL_KEYDOWN:
+					switch (event.key.keysym.sym)
 					{
-						if ((SDL_GetTicks() - joyleft) > 300)
-						{
-							ChangeEvent (-1, 1);
-							joyleft = SDL_GetTicks();
-						}
+						case SDLK_ESCAPE:
+							iEXE = 0; break;
+						case SDLK_KP_ENTER:
+						case SDLK_RETURN:
+						case SDLK_SPACE:
+						case SDLK_s:
+							EXESave(); iEXE = 0;
+							break;
+						default: break;
 					}
-					if ((iXJoy1 > 30000) || (iXJoy2 > 30000)) /*** right ***/
+					ShowEXE();
+					break;
+				case SDL_MOUSEMOTION:
+					iOldXPos = iXPos;
+					iOldYPos = iYPos;
+					iXPos = event.motion.x;
+					iYPos = event.motion.y;
+					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
+
+					ShowEXE();
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					if (event.button.button == 1)
 					{
-						if ((SDL_GetTicks() - joyright) > 300)
+						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** Save ***/
 						{
-							ChangeEvent (1, 1);
-							joyright = SDL_GetTicks();
+							iEXESave = 1;
+							ShowEXE();
 						}
 					}
-					if ((iYJoy1 < -30000) || (iYJoy2 < -30000)) /*** up ***/
+					break;
+				case SDL_MOUSEBUTTONUP:
+					iEXESave = 0;
+					if (event.button.button == 1) /*** left mouse button ***/
 					{
-						if ((SDL_GetTicks() - joyup) > 300)
+						if (InArea (510, 411, 510 + 85, 411 + 32) == 1) /*** Save ***/
 						{
-							ChangeEvent (10, 1);
-							joyup = SDL_GetTicks();
+							EXESave(); iEXE = 0;
 						}
-					}
-					if ((iYJoy1 > 30000) || (iYJoy2 > 30000)) /*** down ***/
-					{
-						if ((SDL_GetTicks() - joydown) > 300)
+
+						/*******************/
+						/* global settings */
+						/*******************/
+
+						/*** Prince HP. ***/
+						if (((iHomeComputer == 1) && (ulPrinceHPA[iDiskImageA] != 0x00)) ||
+							((iHomeComputer == 2) && (ulPrinceHPB[iDiskImageB] != 0x00)) ||
+							((iHomeComputer == 3) && (ulPrinceHPC[iDiskImageC] != 0x00)))
 						{
-							ChangeEvent (-10, 1);
-							joydown = SDL_GetTicks();
+							PlusMinus (&iEXEPrinceHP, 139, 58, 0, 255, -10, 0);
+							PlusMinus (&iEXEPrinceHP, 154, 58, 0, 255, -1, 0);
+							PlusMinus (&iEXEPrinceHP, 224, 58, 0, 255, +1, 0);
+							PlusMinus (&iEXEPrinceHP, 239, 58, 0, 255, +10, 0);
 						}
-					}
-					ShowChange();
-					break;
-				case SDL_KEYDOWN:
-					iSkillChange = 0;
-					switch (event.key.keysym.sym)
-					{
-						case SDLK_KP_ENTER:
-						case SDLK_RETURN:
-						case SDLK_SPACE:
-							if (event.key.keysym.mod & KMOD_CTRL)
-							{
-								if ((iOnTile >= 1) && (iOnTile <= 78))
-								{
-									for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-									{
-										for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-											{ UseTile (iOnTile, iTileLoop, iRoomLoop); }
-									}
-									iChanging = 0;
-									iChanged++;
-								}
-							} else if (event.key.keysym.mod & KMOD_SHIFT) {
-								if ((iOnTile >= 1) && (iOnTile <= 78))
-								{
-									for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-										{ UseTile (iOnTile, iTileLoop, iCurRoom); }
-									iChanging = 0;
-									iChanged++;
-								}
-							} else if (iOnTile != 0) {
-								UseTile (iOnTile, iSelected, iCurRoom);
-								if (iOnTile <= 78) { iChanging = 0; }
-								iChanged++;
-							}
-							break;
-						case SDLK_ESCAPE:
-						case SDLK_q:
-						case SDLK_c:
-							iChanging = 0; break;
-						case SDLK_0:
-						case SDLK_KP_0:
-							if (iGuardType != 0) { iGuardType = 0; iSkillChange = 1; }
-							break;
-						case SDLK_1:
-						case SDLK_KP_1:
-							if (iGuardType != 1) { iGuardType = 1; iSkillChange = 1; }
-							break;
-						case SDLK_2:
-						case SDLK_KP_2:
-							if (iGuardType != 2) { iGuardType = 2; iSkillChange = 1; }
-							break;
-						case SDLK_3:
-						case SDLK_KP_3:
-							if (iGuardType != 3) { iGuardType = 3; iSkillChange = 1; }
-							break;
-						case SDLK_4:
-						case SDLK_KP_4:
-							if (iGuardType != 4) { iGuardType = 4; iSkillChange = 1; }
-							break;
-						case SDLK_5:
-						case SDLK_KP_5:
-							if (iGuardType != 5) { iGuardType = 5; iSkillChange = 1; }
-							break;
-						case SDLK_6:
-						case SDLK_KP_6:
-							if (iGuardType != 6) { iGuardType = 6; iSkillChange = 1; }
-							break;
-						case SDLK_7:
-						case SDLK_KP_7:
-							if (iGuardType != 7) { iGuardType = 7; iSkillChange = 1; }
-							break;
-						case SDLK_8:
-						case SDLK_KP_8:
-							if (iGuardType != 8) { iGuardType = 8; iSkillChange = 1; }
-							break;
-						case SDLK_9:
-						case SDLK_KP_9:
-							if (iGuardType != 9) { iGuardType = 9; iSkillChange = 1; }
-							break;
-						case SDLK_a:
-							if (iGuardType != 10) { iGuardType = 10; iSkillChange = 1; }
-							break;
-						case SDLK_b:
-							if (iGuardType != 11) { iGuardType = 11; iSkillChange = 1; }
-							break;
-						case SDLK_LEFT:
-							if (event.key.keysym.mod & KMOD_CTRL)
-							{
-								ChangeEvent (-10, 1);
-							} else if (event.key.keysym.mod & KMOD_SHIFT) {
-								ChangeEvent (-1, 1);
-							} else {
-								ChangePosAction ("left");
-							}
-							break;
-						case SDLK_RIGHT:
-							if (event.key.keysym.mod & KMOD_CTRL)
-							{
-								ChangeEvent (10, 1);
-							} else if (event.key.keysym.mod & KMOD_SHIFT) {
-								ChangeEvent (1, 1);
-							} else {
-								ChangePosAction ("right");
-							}
-							break;
-						case SDLK_UP: ChangePosAction ("up"); break;
-						case SDLK_DOWN: ChangePosAction ("down"); break;
-						default: break;
-					}
-					if (iSkillChange == 1)
-					{
-						ApplySkillIfNecessary (iSelected);
-						PlaySound ("wav/check_box.wav");
-					}
-					ShowChange();
-					break;
-				case SDL_MOUSEMOTION:
-					iOldXPos = iXPos;
-					iOldYPos = iYPos;
-					iXPos = event.motion.x;
-					iYPos = event.motion.y;
-					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
-
-					/*** custom hover ***/
-					iCustomHoverOld = iCustomHover;
-					if (InArea (3, 383, 3 + 304, 383 + 43) == 1)
-						{ iCustomHover = 1; } else { iCustomHover = 0; }
-					if (iCustomHover != iCustomHoverOld) { ShowChange(); }
-
-					if (InArea (311, 427, 311 + 128, 427 + 29) == 1)
-					{
-						if (iGuardTooltip == 0) { iGuardTooltip = 1; ShowChange(); }
-					} else {
-						if (iGuardTooltip == 1) { iGuardTooltip = 0; ShowChange(); }
-					}
 
-					if (InArea (443, 427, 443 + 128, 427 + 29) == 1)
-					{
-						if (iEventHover == 0) { iEventHover = 1; ShowChange(); }
-					} else {
-						if (iEventHover == 1) { iEventHover = 0; ShowChange(); }
-					}
+						/*** Shadow HP. ***/
+						if (((iHomeComputer == 1) && (ulShadowHPA[iDiskImageA] != 0x00)) ||
+							((iHomeComputer == 2) && (ulShadowHPB[iDiskImageB] != 0x00)) ||
+							((iHomeComputer == 3) && (ulShadowHPC[iDiskImageC] != 0x00)))
+						{
+							PlusMinus (&iEXEShadowHP, 139, 82, 0, 255, -10, 0);
+							PlusMinus (&iEXEShadowHP, 154, 82, 0, 255, -1, 0);
+							PlusMinus (&iEXEShadowHP, 224, 82, 0, 255, +1, 0);
+							PlusMinus (&iEXEShadowHP, 239, 82, 0, 255, +10, 0);
+						}
 
-					iNowOn = OnTile();
-					if ((iOnTile != iNowOn) && (iNowOn != 0))
-					{
-						if (IsDisabled (iNowOn) == 0)
+						/*** Chomper delay. ***/
+						if (((iHomeComputer == 1) &&
+							(ulChomperDelayA[iDiskImageA] != 0x00)) ||
+							((iHomeComputer == 2) &&
+							(ulChomperDelayB[iDiskImageB] != 0x00)) ||
+							((iHomeComputer == 3) &&
+							(ulChomperDelayC[iDiskImageC] != 0x00)))
 						{
-							iOnTile = iNowOn;
-							ShowChange();
+							PlusMinus (&iEXEChomperDelay, 139, 106, 3, 255, -10, 0);
+							PlusMinus (&iEXEChomperDelay, 154, 106, 3, 255, -1, 0);
+							PlusMinus (&iEXEChomperDelay, 224, 106, 3, 255, +1, 0);
+							PlusMinus (&iEXEChomperDelay, 239, 106, 3, 255, +10, 0);
 						}
-					}
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					if (event.button.button == 1) /*** left mouse button ***/
-					{
-						if (InArea (576, 0, 576 + 36, 0 + 461) == 1) /*** close ***/
+
+						/*** Mouse delay. ***/
+						if (((iHomeComputer == 1) &&
+							(ulMouseDelayA[iDiskImageA] != 0x00)) ||
+							((iHomeComputer == 2) &&
+							(ulMouseDelayB[iDiskImageB] != 0x00)) ||
+							((iHomeComputer == 3) &&
+							(ulMouseDelayC[iDiskImageC] != 0x00)))
 						{
-							iCloseOn = 1;
-							ShowChange();
+							PlusMinus (&iEXEMouseDelay, 139, 130, 0, 255, -10, 0);
+							PlusMinus (&iEXEMouseDelay, 154, 130, 0, 255, -1, 0);
+							PlusMinus (&iEXEMouseDelay, 224, 130, 0, 255, +1, 0);
+							PlusMinus (&iEXEMouseDelay, 239, 130, 0, 255, +10, 0);
 						}
-					}
-					break;
-				case SDL_MOUSEBUTTONUP:
-					iCloseOn = 0;
 
-					/*** On tile or living. ***/
-					iUseTile = 0;
-					if (InArea (0, 2, 0 + 574, 2 + 380) == 1) { iUseTile = 1; }
+						/******************/
+						/* guard settings */
+						/******************/
 
-					/*** On the custom tile area. ***/
-					if (InArea (3, 383, 3 + 304, 383 + 43) == 1)
-					{
-						iOnTile = -2;
-						iUseTile = 1;
-					}
+						/*** strike prob. ***/
+						if ((InArea (281, 188, 281 + 94, 188 + 19) == 1) && (iEXETab != 1))
+							{ iEXETab = 1; PlaySound ("wav/extras.wav"); }
+						/*** re-strike prob. ***/
+						if ((InArea (383, 188, 383 + 94, 188 + 19) == 1) && (iEXETab != 2))
+							{ iEXETab = 2; PlaySound ("wav/extras.wav"); }
+						/*** block prob. ***/
+						if ((InArea (485, 188, 485 + 94, 188 + 19) == 1) && (iEXETab != 3))
+							{ iEXETab = 3; PlaySound ("wav/extras.wav"); }
+						/*** imp. block prob. ***/
+						if ((InArea (281, 215, 281 + 94, 215 + 19) == 1) && (iEXETab != 4))
+							{ iEXETab = 4; PlaySound ("wav/extras.wav"); }
+						/*** advance prob. ***/
+						if ((InArea (383, 215, 383 + 94, 215 + 19) == 1) && (iEXETab != 5))
+							{ iEXETab = 5; PlaySound ("wav/extras.wav"); }
+						/*** refractory timer ***/
+						if ((InArea (485, 215, 485 + 94, 215 + 19) == 1) && (iEXETab != 6))
+							{ iEXETab = 6; PlaySound ("wav/extras.wav"); }
+						/*** special color ***/
+						if ((InArea (281, 242, 281 + 94, 242 + 19) == 1) && (iEXETab != 7))
+							{ iEXETab = 7; PlaySound ("wav/extras.wav"); }
+						/*** extra strength ***/
+						if ((InArea (383, 242, 383 + 94, 242 + 19) == 1) && (iEXETab != 8))
+							{ iEXETab = 8; PlaySound ("wav/extras.wav"); }
+
+						if (((iHomeComputer == 1) &&
+							(ulGuardA[iDiskImageA][iEXETab - 1] != 0x00)) ||
+							((iHomeComputer == 2) &&
+							(ulGuardB[iDiskImageB][iEXETab - 1] != 0x00)) ||
+							((iHomeComputer == 3) &&
+							(ulGuardC[iDiskImageC][iEXETab - 1] != 0x00)))
+						{
+							for (iRow = 1; iRow <= 6; iRow++)
+							{
+								iUseL = (iRow * 2) - 1;
+								iUseR = iUseL + 1;
+								switch (iEXETab)
+								{
+									case 6: iTabMax = 20; break;
+									case 7: iTabMax = 1; break;
+									case 8: iTabMax = 1; break;
+									default: iTabMax = 255; break;
+								}
+
+								PlusMinus (&iEXEGuard[iEXETab][iUseL], 310,
+									10 + (iRow * 24), 0, iTabMax, -10, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseL], 325,
+									10 + (iRow * 24), 0, iTabMax, -1, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseL], 395,
+									10 + (iRow * 24), 0, iTabMax, +1, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseL], 410,
+									10 + (iRow * 24), 0, iTabMax, +10, 0);
+
+								PlusMinus (&iEXEGuard[iEXETab][iUseR], 466,
+									10 + (iRow * 24), 0, iTabMax, -10, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseR], 481,
+									10 + (iRow * 24), 0, iTabMax, -1, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseR], 551,
+									10 + (iRow * 24), 0, iTabMax, +1, 0);
+								PlusMinus (&iEXEGuard[iEXETab][iUseR], 566,
+									10 + (iRow * 24), 0, iTabMax, +10, 0);
+							}
+						}
+
+						/**********************/
+						/* per level settings */
+						/**********************/
+
+						/*** demo ***/
+						if ((InArea (267, 299, 267 + 56, 299 + 19) == 1) && (iEXETabS
+							!= 0)) { iEXETabS = 0; PlaySound ("wav/extras.wav"); }
+						/*** level 1 ***/
+						if ((InArea (331, 299, 331 + 56, 299 + 19) == 1) && (iEXETabS
+							!= 1)) { iEXETabS = 1; PlaySound ("wav/extras.wav"); }
+						/*** level 2 ***/
+						if ((InArea (395, 299, 395 + 56, 299 + 19) == 1) && (iEXETabS
+							!= 2)) { iEXETabS = 2; PlaySound ("wav/extras.wav"); }
+						/*** level 3 ***/
+						if ((InArea (459, 299, 459 + 56, 299 + 19) == 1) && (iEXETabS
+							!= 3)) { iEXETabS = 3; PlaySound ("wav/extras.wav"); }
+						/*** level 4 ***/
+						if ((InArea (523, 299, 523 + 56, 299 + 19) == 1) && (iEXETabS
+							!= 4)) { iEXETabS = 4; PlaySound ("wav/extras.wav"); }
+						/*** level 5 ***/
+						if ((InArea (267, 326, 267 + 56, 326 + 19) == 1) && (iEXETabS
+							!= 5)) { iEXETabS = 5; PlaySound ("wav/extras.wav"); }
+						/*** level 6 ***/
+						if ((InArea (331, 326, 331 + 56, 326 + 19) == 1) && (iEXETabS
+							!= 6)) { iEXETabS = 6; PlaySound ("wav/extras.wav"); }
+						/*** level 7 ***/
+						if ((InArea (395, 326, 395 + 56, 326 + 19) == 1) && (iEXETabS
+							!= 7)) { iEXETabS = 7; PlaySound ("wav/extras.wav"); }
+						/*** level 8 ***/
+						if ((InArea (459, 326, 459 + 56, 326 + 19) == 1) && (iEXETabS
+							!= 8)) { iEXETabS = 8; PlaySound ("wav/extras.wav"); }
+						/*** level 9 ***/
+						if ((InArea (523, 326, 523 + 56, 326 + 19) == 1) && (iEXETabS
+							!= 9)) { iEXETabS = 9; PlaySound ("wav/extras.wav"); }
+						/*** level 10 ***/
+						if ((InArea (267, 353, 267 + 56, 353 + 19) == 1) && (iEXETabS
+							!= 10)) { iEXETabS = 10; PlaySound ("wav/extras.wav"); }
+						/*** level 11 ***/
+						if ((InArea (331, 353, 331 + 56, 353 + 19) == 1) && (iEXETabS
+							!= 11)) { iEXETabS = 11; PlaySound ("wav/extras.wav"); }
+						/*** level 12 ***/
+						if ((InArea (395, 353, 395 + 56, 353 + 19) == 1) && (iEXETabS
+							!= 12)) { iEXETabS = 12; PlaySound ("wav/extras.wav"); }
+						/*** level 13 ***/
+						if ((InArea (459, 353, 459 + 56, 353 + 19) == 1) && (iEXETabS
+							!= 13)) { iEXETabS = 13; PlaySound ("wav/extras.wav"); }
+						/*** level 14 ***/
+						if ((InArea (523, 353, 523 + 56, 353 + 19) == 1) && (iEXETabS
+							!= 14)) { iEXETabS = 14; PlaySound ("wav/extras.wav"); }
+
+						if (iEXETabS != 14) /*** Level 14 has no guards. ***/
+						{
+							/*** Guard HP. ***/
+							if (((iHomeComputer == 1) &&
+								(ulGuardHPA[iDiskImageA] != 0x00)) ||
+								((iHomeComputer == 2) &&
+								(ulGuardHPB[iDiskImageB] != 0x00)) ||
+								((iHomeComputer == 3) &&
+								(ulGuardHPC[iDiskImageC] != 0x00)))
+							{
+								PlusMinus (&iEXEGuardHP[iEXETabS], 139, 236, 0, 255, -10, 0);
+								PlusMinus (&iEXEGuardHP[iEXETabS], 154, 236, 0, 255, -1, 0);
+								PlusMinus (&iEXEGuardHP[iEXETabS], 224, 236, 0, 255, 1, 0);
+								PlusMinus (&iEXEGuardHP[iEXETabS], 239, 236, 0, 255, 10, 0);
+							}
+
+							/*** Guard uniform. ***/
+							if (((iHomeComputer == 1) &&
+								(ulGuardUniformA[iDiskImageA] != 0x00)) ||
+								((iHomeComputer == 2) &&
+								(ulGuardUniformB[iDiskImageB] != 0x00)) ||
+								((iHomeComputer == 3) &&
+								(ulGuardUniformC[iDiskImageC] != 0x00)))
+							{
+								PlusMinus (&iEXEGuardU[iEXETabS], 139, 260, 0, 1, -10, 0);
+								PlusMinus (&iEXEGuardU[iEXETabS], 154, 260, 0, 1, -1, 0);
+								PlusMinus (&iEXEGuardU[iEXETabS], 224, 260, 0, 1, 1, 0);
+								PlusMinus (&iEXEGuardU[iEXETabS], 239, 260, 0, 1, 10, 0);
+							}
+
+							/*** Guard sprite. ***/
+							if (((iHomeComputer == 1) &&
+								(ulGuardSpriteA[iDiskImageA] != 0x00)) ||
+								((iHomeComputer == 2) &&
+								(ulGuardSpriteB[iDiskImageB] != 0x00)) ||
+								((iHomeComputer == 3) &&
+								(ulGuardSpriteC[iDiskImageC] != 0x00)))
+							{
+								if (iEXETabS > 2) /*** Levels 0, 1 and 2 must use 0x00. ***/
+								{
+									PlusMinus (&iEXEGuardS[iEXETabS], 139, 284, 1, 5, -10, 0);
+									PlusMinus (&iEXEGuardS[iEXETabS], 154, 284, 1, 5, -1, 0);
+									PlusMinus (&iEXEGuardS[iEXETabS], 224, 284, 1, 5, 1, 0);
+									PlusMinus (&iEXEGuardS[iEXETabS], 239, 284, 1, 5, 10, 0);
+								}
+							}
+						}
+
+						if (iEXETabS > 2) /*** Levels 0, 1 and 2 must use 0x00. ***/
+						{
+							if (iEXETabS == 3) { iMin = 0; } else { iMin = 1; }
+
+							if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
+								((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
+								((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
+							{
+								PlusMinus (&iEXEEnv1[iEXETabS], 139, 308, iMin, 2, -10, 0);
+								PlusMinus (&iEXEEnv1[iEXETabS], 154, 308, iMin, 2, -1, 0);
+								PlusMinus (&iEXEEnv1[iEXETabS], 224, 308, iMin, 2, 1, 0);
+								PlusMinus (&iEXEEnv1[iEXETabS], 239, 308, iMin, 2, 10, 0);
+							}
+
+							if (((iHomeComputer == 1) && (ulEnv2A[iDiskImageA] != 0x00)) ||
+								((iHomeComputer == 2) && (ulEnv2B[iDiskImageB] != 0x00)) ||
+								((iHomeComputer == 3) && (ulEnv2C[iDiskImageC] != 0x00)))
+							{
+								PlusMinus (&iEXEEnv2[iEXETabS], 139, 332, iMin, 2, -10, 0);
+								PlusMinus (&iEXEEnv2[iEXETabS], 154, 332, iMin, 2, -1, 0);
+								PlusMinus (&iEXEEnv2[iEXETabS], 224, 332, iMin, 2, 1, 0);
+								PlusMinus (&iEXEEnv2[iEXETabS], 239, 332, iMin, 2, 10, 0);
+							}
+						}
+					}
+					ShowEXE();
+					break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+						{ ShowEXE(); } break;
+				case SDL_QUIT:
+					Quit(); break;
+			}
+		}
+
+		/*** prevent CPU eating ***/
+		gamespeed = REFRESH_PROG;
+		while ((SDL_GetTicks() - looptime) < gamespeed)
+		{
+			SDL_Delay (10);
+		}
+		looptime = SDL_GetTicks();
+	}
+	PlaySound ("wav/popup_close.wav");
+	ShowScreen();
+}
+/*****************************************************************************/
+void ShowEXE (void)
+/*****************************************************************************/
+{
+	SDL_Color clr;
+	SDL_Color clrs[12 + 2];
+	int iTabX, iTabY;
+	int iLeft, iRight;
+
+	/*** Used for looping. ***/
+	int iSkillLoop;
+
+	/*** background ***/
+	ShowImage (imgexe, 0, 0, "imgexe");
+
+	/*** save button ***/
+	switch (iEXESave)
+	{
+		case 0: /*** off ***/
+			ShowImage (imgsave[1], 510, 411, "imgsave[1]"); break;
+		case 1: /*** on ***/
+			ShowImage (imgsave[2], 510, 411, "imgsave[2]"); break;
+	}
+
+	/*** Prince HP. ***/
+	if (((iHomeComputer == 1) && (ulPrinceHPA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulPrinceHPB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulPrinceHPC[iDiskImageC] != 0x00)))
+	{
+		if (iEXEPrinceHP == 0x03) { clr = color_bl; } else { clr = color_blue; }
+		CenterNumber (iEXEPrinceHP, 167, 58, clr, 0);
+	}
+
+	/*** Shadow HP. ***/
+	if (((iHomeComputer == 1) && (ulShadowHPA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulShadowHPB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulShadowHPC[iDiskImageC] != 0x00)))
+	{
+		if (iEXEShadowHP == 0x04) { clr = color_bl; } else { clr = color_blue; }
+		CenterNumber (iEXEShadowHP, 167, 82, clr, 0);
+	}
+
+	/*** Chomper delay. ***/
+	if (((iHomeComputer == 1) && (ulChomperDelayA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulChomperDelayB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulChomperDelayC[iDiskImageC] != 0x00)))
+	{
+		if (iEXEChomperDelay == 0x10) { clr = color_bl; }
+			else { clr = color_blue; }
+		CenterNumber (iEXEChomperDelay, 167, 106, clr, 0);
+	}
+
+	/*** Mouse delay. ***/
+	if (((iHomeComputer == 1) && (ulMouseDelayA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulMouseDelayB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulMouseDelayC[iDiskImageC] != 0x00)))
+	{
+		if (iEXEMouseDelay == 0x96) { clr = color_bl; } else { clr = color_blue; }
+		CenterNumber (iEXEMouseDelay, 167, 130, clr, 0);
+	}
+
+	/*** Guard tab. ***/
+	switch (iEXETab)
+	{
+		case 1: iTabX = 281; iTabY = 188; break; /*** strike prob. ***/
+		case 2: iTabX = 383; iTabY = 188; break; /*** re-strike prob. ***/
+		case 3: iTabX = 485; iTabY = 188; break; /*** block prob. ***/
+		case 4: iTabX = 281; iTabY = 215; break; /*** imp. block prob. ***/
+		case 5: iTabX = 383; iTabY = 215; break; /*** advance prob. ***/
+		case 6: iTabX = 485; iTabY = 215; break; /*** refractory timer ***/
+		case 7: iTabX = 281; iTabY = 242; break; /*** special color ***/
+		case 8: iTabX = 383; iTabY = 242; break; /*** extra strength ***/
+		default:
+			printf ("[ WARN ] Unknown guard tab: %i!\n", iEXETab);
+			iEXETab = 1; iTabX = 281; iTabY = 188; break;
+	}
+	ShowImage (imgexetab, iTabX, iTabY, "imgexetab");
+
+	/*** Per level tab. ***/
+	switch (iEXETabS)
+	{
+		case 0: iTabX = 267; iTabY = 299; break; /*** demo ***/
+		case 1: iTabX = 331; iTabY = 299; break; /*** level 1 ***/
+		case 2: iTabX = 395; iTabY = 299; break; /*** level 2 ***/
+		case 3: iTabX = 459; iTabY = 299; break; /*** level 3 ***/
+		case 4: iTabX = 523; iTabY = 299; break; /*** level 4 ***/
+		case 5: iTabX = 267; iTabY = 326; break; /*** level 5 ***/
+		case 6: iTabX = 331; iTabY = 326; break; /*** level 6 ***/
+		case 7: iTabX = 395; iTabY = 326; break; /*** level 7 ***/
+		case 8: iTabX = 459; iTabY = 326; break; /*** level 8 ***/
+		case 9: iTabX = 523; iTabY = 326; break; /*** level 9 ***/
+		case 10: iTabX = 267; iTabY = 353; break; /*** level 10 ***/
+		case 11: iTabX = 331; iTabY = 353; break; /*** level 11 ***/
+		case 12: iTabX = 395; iTabY = 353; break; /*** level 12 ***/
+		case 13: iTabX = 459; iTabY = 353; break; /*** level 13 ***/
+		case 14: iTabX = 523; iTabY = 353; break; /*** level 14 ***/
+		default:
+			printf ("[ WARN ] Unknown per level tab: %i!\n", iEXETabS);
+			iEXETabS = 0; iTabX = 267; iTabY = 299; break;
+	}
+	ShowImage (imgexetabs, iTabX, iTabY, "imgexetabs");
+
+	if (((iHomeComputer == 1) && (ulGuardA[iDiskImageA][iEXETab - 1] != 0x00)) ||
+		((iHomeComputer == 2) && (ulGuardB[iDiskImageB][iEXETab - 1] != 0x00)) ||
+		((iHomeComputer == 3) && (ulGuardC[iDiskImageC][iEXETab - 1] != 0x00)))
+	{
+		/* Use black.
+		 * Override with blue if the setting does not match the default.
+		 */
+		for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
+		{
+			clrs[iSkillLoop] = color_bl;
+			if (iEXEGuard[iEXETab][iSkillLoop] !=
+				arDefaultGuard[iEXETab - 1][iSkillLoop - 1])
+				{ clrs[iSkillLoop] = color_blue; }
+		}
+		iLeft = 338; iRight = 494;
+		CenterNumber (iEXEGuard[iEXETab][1], iLeft, 10 + (1 * 24), clrs[1], 0);
+		CenterNumber (iEXEGuard[iEXETab][2], iRight, 10 + (1 * 24), clrs[2], 0);
+		CenterNumber (iEXEGuard[iEXETab][3], iLeft, 10 + (2 * 24), clrs[3], 0);
+		CenterNumber (iEXEGuard[iEXETab][4], iRight, 10 + (2 * 24), clrs[4], 0);
+		CenterNumber (iEXEGuard[iEXETab][5], iLeft, 10 + (3 * 24), clrs[5], 0);
+		CenterNumber (iEXEGuard[iEXETab][6], iRight, 10 + (3 * 24), clrs[6], 0);
+		CenterNumber (iEXEGuard[iEXETab][7], iLeft, 10 + (4 * 24), clrs[7], 0);
+		CenterNumber (iEXEGuard[iEXETab][8], iRight, 10 + (4 * 24), clrs[8], 0);
+		CenterNumber (iEXEGuard[iEXETab][9], iLeft, 10 + (5 * 24), clrs[9], 0);
+		CenterNumber (iEXEGuard[iEXETab][10], iRight, 10 + (5 * 24), clrs[10], 0);
+		CenterNumber (iEXEGuard[iEXETab][11], iLeft, 10 + (6 * 24), clrs[11], 0);
+		CenterNumber (iEXEGuard[iEXETab][12], iRight, 10 + (6 * 24), clrs[12], 0);
+	}
+
+	/*** Guard HP. ***/
+	if (((iHomeComputer == 1) && (ulGuardHPA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulGuardHPB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulGuardHPC[iDiskImageC] != 0x00)))
+	{
+		if (iEXETabS != 14)
+		{
+			clr = color_bl;
+			if (iEXEGuardHP[iEXETabS] != arDefaultGuardHP[iEXETabS])
+				{ clr = color_blue; }
+			CenterNumber (iEXEGuardHP[iEXETabS], 167, 236, clr, 0);
+		}
+	}
+
+	/*** Guard uniform. ***/
+	if (((iHomeComputer == 1) && (ulGuardUniformA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulGuardUniformB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulGuardUniformC[iDiskImageC] != 0x00)))
+	{
+		if (iEXETabS != 14)
+		{
+			clr = color_bl;
+			if (iEXEGuardU[iEXETabS] != arDefaultGuardU[iEXETabS])
+				{ clr = color_blue; }
+			CenterNumber (iEXEGuardU[iEXETabS], 167, 260, clr, 0);
+		}
+	}
+
+	/*** Guard sprite. ***/
+	if (((iHomeComputer == 1) && (ulGuardSpriteA[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulGuardSpriteB[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulGuardSpriteC[iDiskImageC] != 0x00)))
+	{
+		if (iEXETabS != 14)
+		{
+			if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
+			if (iEXEGuardS[iEXETabS] != arDefaultGuardS[iEXETabS])
+				{ clr = color_blue; }
+			CenterNumber (iEXEGuardS[iEXETabS], 167, 284, clr, 0);
+		}
+	}
+
+	/*** Env. 1 ***/
+	if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
+	{
+		if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
+		if (iEXEEnv1[iEXETabS] != arDefaultEnv1[iEXETabS])
+			{ clr = color_blue; }
+		CenterNumber (iEXEEnv1[iEXETabS], 167, 308, clr, 0);
+	}
+
+	/*** Env. 2 ***/
+	if (((iHomeComputer == 1) && (ulEnv2A[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulEnv2B[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulEnv2C[iDiskImageC] != 0x00)))
+	{
+		if (iEXETabS > 2) { clr = color_bl; } else { clr = color_gray; }
+		if (iEXEEnv2[iEXETabS] != arDefaultEnv2[iEXETabS])
+			{ clr = color_blue; }
+		CenterNumber (iEXEEnv2[iEXETabS], 167, 332, clr, 0);
+	}
+
+	/*** Environment image. ***/
+	if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00) &&
+		(ulEnv2A[iDiskImageA] != 0x00)) ||
+		((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00) &&
+		(ulEnv2B[iDiskImageB] != 0x00)) ||
+		((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00) &&
+		(ulEnv2C[iDiskImageC] != 0x00)))
+	{
+		if (iEXEEnv1[iEXETabS] == iEXEEnv2[iEXETabS])
+		{
+			ShowImage (imgexeenvok, 53, 321, "imgexeenvok");
+		} else {
+			ShowImage (imgexeenvwarn, 53, 321, "imgexeenvwarn");
+		}
+	}
+
+	/*** refresh screen ***/
+	BatchFlush();
+	SDL_RenderPresent (ascreen);
+}
+/*****************************************************************************/
+void InitScreenAction (char *sAction)
+/*****************************************************************************/
+{
+	int iEventTile;
+	int iEventRoom;
+
+	if (strcmp (sAction, "left") == 0)
+	{
+		switch (iScreen)
+		{
+			case 1:
+				iSelected--;
+				switch (iSelected)
+				{
+					case 0: iSelected = 10; break;
+					case 10: iSelected = 20; break;
+					case 20: iSelected = 30; break;
+				}
+				break;
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					if (iMovingRoom != 0)
+					{
+						if (iMovingNewX != 1) { iMovingNewX--; }
+							else { iMovingNewX = 25; }
+						PlaySound ("wav/cross.wav");
+					}
+				} else {
+					if (iChangingBrokenSide != 1)
+					{
+						iChangingBrokenSide = 1;
+					} else {
+						switch (iChangingBrokenRoom)
+						{
+							case 1: iChangingBrokenRoom = 4; break;
+							case 5: iChangingBrokenRoom = 8; break;
+							case 9: iChangingBrokenRoom = 12; break;
+							case 13: iChangingBrokenRoom = 16; break;
+							case 17: iChangingBrokenRoom = 20; break;
+							case 21: iChangingBrokenRoom = 24; break;
+							default: iChangingBrokenRoom--; break;
+						}
+					}
+				}
+				break;
+			case 3:
+				iEventTile = arLevels[iCurLevel].arEvent[iChangeEvent].cTile;
+				switch (iEventTile)
+				{
+					case 1: iEventTile = 10; break;
+					case 11: iEventTile = 20; break;
+					case 21: iEventTile = 30; break;
+					default: iEventTile--; break;
+				}
+				arLevels[iCurLevel].arEvent[iChangeEvent].cTile = iEventTile;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "right") == 0)
+	{
+		switch (iScreen)
+		{
+			case 1:
+				iSelected++;
+				switch (iSelected)
+				{
+					case 11: iSelected = 1; break;
+					case 21: iSelected = 11; break;
+					case 31: iSelected = 21; break;
+				}
+				break;
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					if (iMovingRoom != 0)
+					{
+						if (iMovingNewX != 25) { iMovingNewX++; }
+							else { iMovingNewX = 1; }
+						PlaySound ("wav/cross.wav");
+					}
+				} else {
+					if (iChangingBrokenSide != 2)
+					{
+						iChangingBrokenSide = 2;
+					} else {
+						switch (iChangingBrokenRoom)
+						{
+							case 4: iChangingBrokenRoom = 1; break;
+							case 8: iChangingBrokenRoom = 5; break;
+							case 12: iChangingBrokenRoom = 9; break;
+							case 16: iChangingBrokenRoom = 13; break;
+							case 20: iChangingBrokenRoom = 17; break;
+							case 24: iChangingBrokenRoom = 21; break;
+							default: iChangingBrokenRoom++; break;
+						}
+					}
+				}
+				break;
+			case 3:
+				iEventTile = arLevels[iCurLevel].arEvent[iChangeEvent].cTile;
+				switch (iEventTile)
+				{
+					case 10: iEventTile = 1; break;
+					case 20: iEventTile = 11; break;
+					case 30: iEventTile = 21; break;
+					default: iEventTile++; break;
+				}
+				arLevels[iCurLevel].arEvent[iChangeEvent].cTile = iEventTile;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "up") == 0)
+	{
+		switch (iScreen)
+		{
+			case 1:
+				if (iSelected > 10) { iSelected-=10; }
+					else { iSelected+=20; }
+				break;
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					if (iMovingRoom != 0)
+					{
+						if (iMovingNewY != 1) { iMovingNewY--; }
+							else { iMovingNewY = 24; }
+						PlaySound ("wav/cross.wav");
+					}
+				} else {
+					if (iChangingBrokenSide != 3)
+					{
+						iChangingBrokenSide = 3;
+					} else {
+						switch (iChangingBrokenRoom)
+						{
+							case 1: iChangingBrokenRoom = 21; break;
+							case 2: iChangingBrokenRoom = 22; break;
+							case 3: iChangingBrokenRoom = 23; break;
+							case 4: iChangingBrokenRoom = 24; break;
+							default: iChangingBrokenRoom -= 4; break;
+						}
+					}
+				}
+				break;
+			case 3:
+				iEventTile = arLevels[iCurLevel].arEvent[iChangeEvent].cTile;
+				if (iEventTile > 10) { iEventTile-=10; }
+					else { iEventTile+=20; }
+				arLevels[iCurLevel].arEvent[iChangeEvent].cTile = iEventTile;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "down") == 0)
+	{
+		switch (iScreen)
+		{
+			case 1:
+				if (iSelected <= 20) { iSelected+=10; }
+					else { iSelected-=20; }
+				break;
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					if (iMovingRoom != 0)
+					{
+						if (iMovingNewY != 24) { iMovingNewY++; }
+							else { iMovingNewY = 1; }
+						PlaySound ("wav/cross.wav");
+					}
+				} else {
+					if (iChangingBrokenSide != 4)
+					{
+						iChangingBrokenSide = 4;
+					} else {
+						switch (iChangingBrokenRoom)
+						{
+							case 21: iChangingBrokenRoom = 1; break;
+							case 22: iChangingBrokenRoom = 2; break;
+							case 23: iChangingBrokenRoom = 3; break;
+							case 24: iChangingBrokenRoom = 4; break;
+							default: iChangingBrokenRoom += 4; break;
+						}
+					}
+				}
+				break;
+			case 3:
+				iEventTile = arLevels[iCurLevel].arEvent[iChangeEvent].cTile;
+				if (iEventTile <= 20) { iEventTile+=10; }
+					else { iEventTile-=20; }
+				arLevels[iCurLevel].arEvent[iChangeEvent].cTile = iEventTile;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "left bracket") == 0)
+	{
+		switch (iScreen)
+		{
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					iMovingNewBusy = 0;
+					switch (iMovingRoom)
+					{
+						case 0: iMovingRoom = ROOMS; break; /*** If disabled. ***/
+						case 1: iMovingRoom = ROOMS; break;
+						default: iMovingRoom--; break;
+					}
+				}
+				break;
+			case 3:
+				iEventRoom = arLevels[iCurLevel].arEvent[iChangeEvent].cRoom;
+				if ((iEventRoom >= 2) && (iEventRoom <= 24))
+				{
+					iEventRoom--;
+				} else {
+					iEventRoom = 24;
+				}
+				arLevels[iCurLevel].arEvent[iChangeEvent].cRoom = iEventRoom;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "right bracket") == 0)
+	{
+		switch (iScreen)
+		{
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					iMovingNewBusy = 0;
+					switch (iMovingRoom)
+					{
+						case 0: iMovingRoom = 1; break; /*** If disabled. ***/
+						case 24: iMovingRoom = 1; break;
+						default: iMovingRoom++; break;
+					}
+				}
+				break;
+			case 3:
+				iEventRoom = arLevels[iCurLevel].arEvent[iChangeEvent].cRoom;
+				if ((iEventRoom >= 1) & (iEventRoom <= 23))
+				{
+					iEventRoom++;
+				} else {
+					iEventRoom = 1;
+				}
+				arLevels[iCurLevel].arEvent[iChangeEvent].cRoom = iEventRoom;
+				PlaySound ("wav/check_box.wav");
+				LevelChanged();
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "enter") == 0)
+	{
+		switch (iScreen)
+		{
+			case 1:
+				ChangePos();
+				break;
+			case 2:
+				if (arBrokenRoomLinks[iCurLevel] == 0)
+				{
+					if (iMovingRoom != 0)
+					{
+						if (arMovingRooms[iMovingNewX][iMovingNewY] == 0)
+						{
+							RemoveOldRoom();
+							AddNewRoom (iMovingNewX, iMovingNewY, iMovingRoom);
+							LevelChanged();
+						}
+						iMovingRoom = 0; iMovingNewBusy = 0;
+					}
+				} else {
+					LinkPlus();
+				}
+				break;
+		}
+	}
+
+	if (strcmp (sAction, "env") == 0)
+	{
+		if (((iHomeComputer == 1) && (ulEnv1A[iDiskImageA] != 0x00)) ||
+			((iHomeComputer == 2) && (ulEnv1B[iDiskImageB] != 0x00)) ||
+			((iHomeComputer == 3) && (ulEnv1C[iDiskImageC] != 0x00)))
+		{
+			if ((iCurLevel >= 3) && (iCurLevel <= 14))
+			{
+				EXELoad();
+				switch (cCurType)
+				{
+					case 'd':
+						cCurType = 'p';
+						iEXEEnv1[iCurLevel] = 0x01;
+						iEXEEnv2[iCurLevel] = 0x01;
+						break;
+					case 'p':
+						cCurType = 'd';
+						iEXEEnv1[iCurLevel] = 0x02;
+						iEXEEnv2[iCurLevel] = 0x02;
+						break;
+				}
+				EXESave();
+				PlaySound ("wav/extras.wav");
+			} else {
+				printf ("[ INFO ] The environment of levels 1 and 2 (and 0) cannot be"
+					" changed.\n");
+			}
+		} else {
+			printf ("[ INFO ] Unknown environment offset.\n");
+		}
+	}
+}
+/*****************************************************************************/
+void RunLevel (int iLevel)
+/*****************************************************************************/
+{
+	SDL_Thread *princethread;
+
+	if (iDebug == 1)
+	{
+		printf ("[  OK  ] Starting the game in level %i.\n", iLevel);
+	}
+
+	PlaytestStart (iLevel);
+
+	/*** Not in StartGame(); only this thread may send sounds. ***/
+	PlaySound ("wav/emulator.wav");
+
+	princethread = SDL_CreateThread (StartGame, "StartGame", NULL);
+	if (princethread == NULL)
+	{
+		printf ("[FAILED] Could not create thread!\n");
+		exit (EXIT_ERROR);
+	}
+}
+/*****************************************************************************/
+int StartGame (void *unused)
+/*****************************************************************************/
+{
+	char sSystem[200 + 2];
+	char sWine[200 + 2];
+
+	if (unused != NULL) { } /*** To prevent warnings. ***/
+
+	switch (iHomeComputer)
+	{
+		case 1: /*** AppleWin ***/
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+snprintf (sWine, 200, "%s", "");
+#else
+snprintf (sWine, 200, "%s", "wine ");
+#endif
+
+			snprintf (sSystem, 200, "%sAppleWin%sAppleWin.exe -model %s -h1 %s > %s",
+				sWine, SLASH, "apple2ee", sPathFile, DEVNULL);
+			break;
+		case 2: /*** B-em ***/
+			snprintf (sSystem, 200, "b-em -m10 -fasttape %s > %s",
+				sPathFile, DEVNULL);
+			break;
+		case 3: /*** VICE ***/
+			snprintf (sSystem, 200, "x64sc %s > %s",
+				sPathFile, DEVNULL);
+			break;
+	}
+	if (system (sSystem) == -1)
+		{ printf ("[ WARN ] Could not execute emulator!\n"); }
+
+	/*** Not PlaytestStop(); only the main thread uses the journal. ***/
+	SDL_AtomicSet (&aGameDone, 1);
+
+	return (EXIT_NORMAL);
+}
+/*****************************************************************************/
+void GameDone (void)
+/*****************************************************************************/
+{
+	/* Called from the main loop. Undoes the bytes that PlaytestStart() wrote
+	 * once the emulator has exited, on this thread, so that the journal and
+	 * the mapping of the disk image are never used by two threads.
+	 */
+
+	if (SDL_AtomicGet (&aGameDone) == 0) { return; }
+	SDL_AtomicSet (&aGameDone, 0);
+	if (iModified == 1) { PlaytestStop(); }
+}
+/*****************************************************************************/
+void ClearRoom (void)
+/*****************************************************************************/
+{
+	int iTileLoop;
+
+	/*** Remove tiles. ***/
+	for (iTileLoop = 1; iTileLoop <= 30; iTileLoop++)
+	{
+		SetLocation (iCurRoom, iTileLoop, 0x00, 0x00);
+	}
+
+	/*** Remove guard. ***/
+	arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = TILES + 1;
+
+	PlaySound ("wav/ok_close.wav");
+	LevelChanged();
+}
+/*****************************************************************************/
+void UseTile (int iTile, int iLocation, int iRoom)
+/*****************************************************************************/
+{
+	/*** Do not use iSelected in this function. ***/
+
+	int iDir;
+	int iGetTile, iGetMod;
+
+	/*** Random tile. ***/
+	if (iTile == -1)
+	{
+		do {
+			iTile = 1 + (int) (78.0 * rand() / (RAND_MAX + 1.0));
+		} while (Unused (iTile) == 1);
+	}
+
+	/*** Custom tile. ***/
+	if (iTile == -2)
+	{
+		SetLocation (iRoom, iLocation,
+			(32 * iCustomX) + iCustomTile, iCustomMod);
+	}
+
+	/*** Make sure the disabled living can't be used. ***/
+	if ((iCurGuard != 0x01) && ((iTile == 83) || (iTile == 84))) { return; }
+	if ((iCurGuard != 0x03) && ((iTile == 85) || (iTile == 86))) { return; }
+	if ((iCurGuard != 0x04) && ((iTile == 87) || (iTile == 88))) { return; }
+	if ((iCurGuard != 0x05) && ((iTile == 89) || (iTile == 90))) { return; }
+	if ((((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14)) &&
+		((iTile == 81) || (iTile == 82))) { return; }
+
+	if ((iTile >= 1) && (iTile <= 78))
+	{
+		GetTileModChange (iTile, &iGetTile, &iGetMod);
+		SetLocation (iRoom, iLocation, iGetTile, iGetMod);
+	}
+
+	switch (iTile)
+	{
+		/*** prince ***/
+		case 79: /*** turned right ***/
+			if ((arLevels[iCurLevel].arStartLocation[1] != iCurRoom) ||
+				(arLevels[iCurLevel].arStartLocation[2] != iLocation) ||
+				(arLevels[iCurLevel].arStartLocation[3] != 0x00))
+			{
+				arLevels[iCurLevel].arStartLocation[1] = iCurRoom;
+				arLevels[iCurLevel].arStartLocation[2] = iLocation;
+				arLevels[iCurLevel].arStartLocation[3] = 0x00;
+				PlaySound ("wav/hum_adj.wav");
+			}
+			break;
+		case 80: /*** turned left ***/
+			if ((arLevels[iCurLevel].arStartLocation[1] != iCurRoom) ||
+				(arLevels[iCurLevel].arStartLocation[2] != iLocation) ||
+				(arLevels[iCurLevel].arStartLocation[3] != 0xFF))
+			{
+				arLevels[iCurLevel].arStartLocation[1] = iCurRoom;
+				arLevels[iCurLevel].arStartLocation[2] = iLocation;
+				arLevels[iCurLevel].arStartLocation[3] = 0xFF;
+				PlaySound ("wav/hum_adj.wav");
+			}
+			break;
+
+		/*** guards ***/
+		case 81: case 82: /*** guard ***/
+		case 83: case 84: /*** skel ***/
+		case 85: case 86: /*** fat ***/
+		case 87: case 88: /*** shadow ***/
+		case 89: case 90: /*** Jaffar ***/
+			switch (iTile)
+			{
+				case 81: case 83: case 85: case 87: case 89:
+					iDir = 0x00; break;
+				case 82: case 84: case 86: case 88: case 90:
+				default: /*** To prevent warnings. ***/
+					iDir = 0xFF; break;
+			}
+			if ((arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile == iLocation) &&
+				(arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir == iDir))
+			{
+				arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = TILES + 1;
+			} else {
+				arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = iLocation;
+				arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir = iDir;
+				arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill = iGuardType;
+				/*** arLevels[iCurLevel].arRoom[iCurRoom].cGuardC = ; ***/
+				PlaySound ("wav/hum_adj.wav");
+			}
+			break;
+	}
+}
+/*****************************************************************************/
+void Zoom (int iToggleFull)
+/*****************************************************************************/
+{
+	if (iToggleFull == 1)
+	{
+		if (iFullscreen == 0)
+		{ iFullscreen = SDL_WINDOW_FULLSCREEN_DESKTOP; }
+			else { iFullscreen = 0; }
+	} else {
+		if (iFullscreen == SDL_WINDOW_FULLSCREEN_DESKTOP)
+		{
+			iFullscreen = 0;
+			iScale = 1;
+		} else if (iScale == 1) {
+			iScale = 2;
+		} else if (iScale == 2) {
+			iFullscreen = SDL_WINDOW_FULLSCREEN_DESKTOP;
+		} else {
+			printf ("[ WARN ] Unknown window state!\n");
+		}
+	}
+
+	SDL_SetWindowFullscreen (window, iFullscreen);
+	SDL_SetWindowSize (window, (WINDOW_WIDTH) * iScale,
+		(WINDOW_HEIGHT) * iScale);
+	SDL_RenderSetLogicalSize (ascreen, (WINDOW_WIDTH) * iScale,
+		(WINDOW_HEIGHT) * iScale);
+	SDL_SetWindowPosition (window, SDL_WINDOWPOS_CENTERED,
+		SDL_WINDOWPOS_CENTERED);
+	TTF_CloseFont (font1);
+	TTF_CloseFont (font2);
+	TTF_CloseFont (font3);
+	LoadFonts();
+}
+/*****************************************************************************/
+void LinkMinus (void)
+/*****************************************************************************/
+{
+	int iCurrent, iNew;
+
+	iCurrent = arLevels[iCurLevel].arRoom[iChangingBrokenRoom]
+		.arLink[iChangingBrokenSide];
+	if (iCurrent == 0) {
+		iNew = ROOMS;
+	} else {
+		iNew = iCurrent - 1;
+	}
+	arLevels[iCurLevel].arRoom[iChangingBrokenRoom]
+		.arLink[iChangingBrokenSide] = iNew;
+	LevelChanged();
+	arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
+	PlaySound ("wav/hum_adj.wav");
+}
+/*****************************************************************************/
+int BrokenRoomLinks (int iLevel, int iPrint)
+/*****************************************************************************/
+{
+	int iBroken;
+	int iRoomLoop;
+
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	{
+		arDone[iRoomLoop] = 0;
+		arRoomConnectionsBroken[iLevel][iRoomLoop][1] = 0;
+		arRoomConnectionsBroken[iLevel][iRoomLoop][2] = 0;
+		arRoomConnectionsBroken[iLevel][iRoomLoop][3] = 0;
+		arRoomConnectionsBroken[iLevel][iRoomLoop][4] = 0;
+	}
+	CheckSides (iLevel, arLevels[iLevel].arStartLocation[1], 0, 0);
+	iBroken = 0;
+
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	{
+		/*** If the room is in use... ***/
+		if (arDone[iRoomLoop] == 1)
+		{
+			/*** check left ***/
+			if (arLevels[iLevel].arRoom[iRoomLoop].arLink[1] != 0)
+			{
+				if ((arLevels[iLevel].arRoom[iRoomLoop].arLink[1] == iRoomLoop) ||
+					(arLevels[iLevel].arRoom[arLevels[iLevel].arRoom[iRoomLoop]
+					.arLink[1]].arLink[2] != iRoomLoop) ||
+					(arLevels[iLevel].arRoom[iRoomLoop].arLink[1] > ROOMS))
+				{
+					arRoomConnectionsBroken[iLevel][iRoomLoop][1] = 1;
+					iBroken = 1;
+					if ((iDebug == 1) && (iPrint == 1))
+					{
+						printf ("[ INFO ] The left of room %i has a broken link.\n",
+							iRoomLoop);
+					}
+				}
+			}
+			/*** check right ***/
+			if (arLevels[iLevel].arRoom[iRoomLoop].arLink[2] != 0)
+			{
+				if ((arLevels[iLevel].arRoom[iRoomLoop].arLink[2] == iRoomLoop) ||
+					(arLevels[iLevel].arRoom[arLevels[iLevel].arRoom[iRoomLoop]
+					.arLink[2]].arLink[1] != iRoomLoop) ||
+					(arLevels[iLevel].arRoom[iRoomLoop].arLink[2] > ROOMS))
+				{
+					arRoomConnectionsBroken[iLevel][iRoomLoop][2] = 1;
+					iBroken = 1;
+					if ((iDebug == 1) && (iPrint == 1))
+					{
+						printf ("[ INFO ] The right of room %i has a broken link.\n",
+							iRoomLoop);
+					}
+				}
+			}
+			/*** check up ***/
+			if (arLevels[iLevel].arRoom[iRoomLoop].arLink[3] != 0)
+			{
+				if ((arLevels[iLevel].arRoom[iRoomLoop].arLink[3] == iRoomLoop) ||
+					(arLevels[iLevel].arRoom[arLevels[iLevel].arRoom[iRoomLoop]
+					.arLink[3]].arLink[4] != iRoomLoop) ||
+					(arLevels[iLevel].arRoom[iRoomLoop].arLink[3] > ROOMS))
+				{
+					arRoomConnectionsBroken[iLevel][iRoomLoop][3] = 1;
+					iBroken = 1;
+					if ((iDebug == 1) && (iPrint == 1))
+					{
+						printf ("[ INFO ] The top of room %i has a broken link.\n",
+							iRoomLoop);
+					}
+				}
+			}
+			/*** check down ***/
+			if (arLevels[iLevel].arRoom[iRoomLoop].arLink[4] != 0)
+			{
+				if ((arLevels[iLevel].arRoom[iRoomLoop].arLink[4] == iRoomLoop) ||
+					(arLevels[iLevel].arRoom[arLevels[iLevel].arRoom[iRoomLoop]
+					.arLink[4]].arLink[3] != iRoomLoop) ||
+					(arLevels[iLevel].arRoom[iRoomLoop].arLink[4] > ROOMS))
+				{
+					arRoomConnectionsBroken[iLevel][iRoomLoop][4] = 1;
+					iBroken = 1;
+					if ((iDebug == 1) && (iPrint == 1))
+					{
+						printf ("[ INFO ] The bottom of room %i has a broken link.\n",
+							iRoomLoop);
+					}
+				}
+			}
+		}
+	}
+
+	return (iBroken);
+}
+/*****************************************************************************/
+void ChangeEvent (int iAmount, int iChangePos)
+/*****************************************************************************/
+{
+	int iTile;
+
+	if (((iAmount > 0) && (iChangeEvent < EVENTS)) ||
+		((iAmount < 0) && (iChangeEvent > 1)))
+	{
+		/*** Modify the event number. ***/
+		iChangeEvent+=iAmount;
+		if (iChangeEvent < 1) { iChangeEvent = 1; }
+		if (iChangeEvent > EVENTS) { iChangeEvent = EVENTS; }
+
+		/*** If necessary, apply the event number to the selected tile. ***/
+		if (iChangePos == 1)
+		{
+			iTile = arLevels[iCurLevel].arRoom[iCurRoom].arTile[iSelected] & 0x1F;
+			if ((iTile == 0x06) || (iTile == 0x0F)) /*** drop or raise ***/
+			{
+				arLevels[iCurLevel].arRoom[iCurRoom].arMod[iSelected] =
+					iChangeEvent - 1;
+				LevelChanged();
+			}
+		}
+
+		PlaySound ("wav/plus_minus.wav");
+	}
+}
+/*****************************************************************************/
+void ChangeCustom (int iAmount, int iType)
+/*****************************************************************************/
+{
+	if (iType == 1)
+	{
+		/*** Modify the custom tile. ***/
+		if (((iAmount > 0) && (iCustomTile < 0x1F)) ||
+			((iAmount < 0) && (iCustomTile > 0x00)))
+		{
+			iCustomTile+=iAmount;
+			if (iCustomTile < 0x00) { iCustomTile = 0x00; }
+			if (iCustomTile > 0x1F) { iCustomTile = 0x1F; }
+
+			PlaySound ("wav/plus_minus.wav");
+		}
+	} else {
+		/*** Modify the custom mod. ***/
+		if (((iAmount > 0) && (iCustomMod < 0xFF)) ||
+			((iAmount < 0) && (iCustomMod > 0x00)))
+		{
+			iCustomMod+=iAmount;
+			if (iCustomMod < 0x00) { iCustomMod = 0x00; }
+			if (iCustomMod > 0xFF) { iCustomMod = 0xFF; }
+
+			PlaySound ("wav/plus_minus.wav");
+		}
+	}
+}
+/*****************************************************************************/
+void Prev (void)
+/*****************************************************************************/
+{
+	if (iCurLevel != 1)
+	{
+		iCurLevel--;
+		DiscardChanges (iCurLevel);
+		iCurRoom = arLevels[iCurLevel].arStartLocation[1];
+		PlaySound ("wav/level_change.wav");
+	}
+}
+/*****************************************************************************/
+void Next (void)
+/*****************************************************************************/
+{
+	if (iCurLevel != LEVELS)
+	{
+		iCurLevel++;
+		DiscardChanges (iCurLevel);
+		iCurRoom = arLevels[iCurLevel].arStartLocation[1];
+		PlaySound ("wav/level_change.wav");
+	}
+}
+/*****************************************************************************/
+void CallSave (void)
+/*****************************************************************************/
+{
+	/*** BackupVersion() has what changed; disk.bak is a plain copy for ***/
+	/*** tools that cannot read the backup store. Only on request. ***/
+	if (iFullBAK == 1) { CreateBAK(); }
+	BackupVersion();
+	SaveLevels();
+}
+/*****************************************************************************/
+void Sprinkle (void)
+/*****************************************************************************/
+{
+	int iRandom;
+	int iTile, iMod;
+	int iX;
+
+	/*** Used for looping. ***/
+	int iRoomLoop;
+	int iTileLoop;
+
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	{
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		{
+			iTile = arLevels[iCurLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x1F;
+			iX = arLevels[iCurLevel].arRoom[iRoomLoop].arTile[iTileLoop] & 0x20;
+			iMod = arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop];
+
+			/*** d: space? add wall shadow ***/
+			/*** p: wall pattern? add variant pattern ***/
+			if ((iTile == 0x00) && ((((iMod == 0x00) || (iMod == 0xFF)) &&
+				(cCurType == 'd')) || ((iMod == 0x01) && (cCurType == 'p'))))
+			{
+				/*** 1-4 ***/
+				iRandom = 1 + (int) (4.0 * rand() / (RAND_MAX + 1.0));
+				switch (iRandom)
+				{
+					case 1:
+						/*** Tile unchanged. ***/
+						if (cCurType == 'd')
+						{
+							arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x01;
+						}
+						break;
+					case 2:
+						/*** Tile unchanged. ***/
+						arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x02;
+						break;
+				}
+			}
+
+			/*** d: empty floor? add wall shadow (2x), rubble, torch, skeleton ***/
+			/*** p: empty floor? add variant pattern, rubble, torch ***/
+			if ((iTile == 0x01) && ((iMod == 0x00) || (iMod == 0xFF)))
+			{
+				/*** 1-10 ***/
+				iRandom = 1 + (int) (10.0 * rand() / (RAND_MAX + 1.0));
+				switch (iRandom)
+				{
+					case 1: /*** wall shadow ***/
+						/*** Tile unchanged. ***/
+						if (cCurType == 'd')
+						{
+							arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x01;
+						}
+						break;
+					case 2: /*** wall shadow / variant pattern ***/
+						/*** Tile unchanged. ***/
+						arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x02;
+						break;
+					case 3: /*** rubble ***/
+						arLevels[iCurLevel].arRoom[iRoomLoop].arTile[iTileLoop] = iX | 0x0E;
+						arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x00;
+						break;
+					case 4: /*** torch ***/
+						arLevels[iCurLevel].arRoom[iRoomLoop].arTile[iTileLoop] = iX | 0x13;
+						arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x00;
+						break;
+					case 5: /*** skeleton ***/
+						if (cCurType == 'd')
+						{
+							arLevels[iCurLevel].arRoom[iRoomLoop].arTile[iTileLoop] =
+								iX | 0x15;
+							arLevels[iCurLevel].arRoom[iRoomLoop].arMod[iTileLoop] = 0x00;
+						}
+						break;
+				}
+			}
+		}
+	}
+}
+/*****************************************************************************/
+void SetLocation (int iRoom, int iLocation, int iTile, int iMod)
+/*****************************************************************************/
+{
+	arLevels[iCurLevel].arRoom[iRoom].arTile[iLocation] = iTile;
+	if (iTile >= 32)
+	{
+		iTile-=32;
+		iLastX = 1;
+	} else {
+		iLastX = 0;
+	}
+	arLevels[iCurLevel].arRoom[iRoom].arMod[iLocation] = iMod;
+	iLastTile = iTile;
+	iLastMod = iMod;
+}
+/*****************************************************************************/
+void FlipRoom (int iAxis)
+/*****************************************************************************/
+{
+	unsigned char arRoomTilesTemp[TILES + 2];
+	unsigned char arRoomModTemp[TILES + 2];
+	int iTileUse;
+	int iTile;
+
+	/*** Used for looping. ***/
+	int iTileLoop;
+
+	/*** Storing tiles for later use. ***/
+	for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+	{
+		arRoomTilesTemp[iTileLoop] =
+			arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop];
+		arRoomModTemp[iTileLoop] =
+			arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop];
+	}
+
+	if (iAxis == 1) /*** horizontal ***/
+	{
+		/*** tiles ***/
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		{
+			iTileUse = 0; /*** To prevent warnings. ***/
+			if ((iTileLoop >= 1) && (iTileLoop <= 10))
+				{ iTileUse = 11 - iTileLoop; }
+			if ((iTileLoop >= 11) && (iTileLoop <= 20))
+				{ iTileUse = 31 - iTileLoop; }
+			if ((iTileLoop >= 21) && (iTileLoop <= 30))
+				{ iTileUse = 51 - iTileLoop; }
+			arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop] =
+				arRoomTilesTemp[iTileUse];
+			arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop] =
+				arRoomModTemp[iTileUse];
+		}
+
+		/*** prince ***/
+		if (arLevels[iCurLevel].arStartLocation[1] == iCurRoom)
+		{
+			/*** direction ***/
+			if (arLevels[iCurLevel].arStartLocation[3] == 0x00)
+				{ arLevels[iCurLevel].arStartLocation[3] = 0xFF; }
+					else { arLevels[iCurLevel].arStartLocation[3] = 0x00; }
+			/*** tile ***/
+			iTile = arLevels[iCurLevel].arStartLocation[2];
+			if ((iTile >= 1) && (iTile <= 10))
+				{ arLevels[iCurLevel].arStartLocation[2] = 11 - iTile; }
+			if ((iTile >= 11) && (iTile <= 20))
+				{ arLevels[iCurLevel].arStartLocation[2] = 31 - iTile; }
+			if ((iTile >= 21) && (iTile <= 30))
+				{ arLevels[iCurLevel].arStartLocation[2] = 51 - iTile; }
+		}
+
+		/*** guard ***/
+		if (arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile <= TILES + 1)
+		{
+			/*** direction ***/
+			if (arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir == 0x00)
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir = 0xFF; }
+					else { arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir = 0x00; }
+			/*** tile ***/
+			iTile = arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile;
+			if ((iTile >= 1) && (iTile <= 10))
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = 11 - iTile; }
+			if ((iTile >= 11) && (iTile <= 20))
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = 31 - iTile; }
+			if ((iTile >= 21) && (iTile <= 30))
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = 51 - iTile; }
+		}
+	} else { /*** vertical ***/
+		/*** tiles ***/
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		{
+			iTileUse = 0; /*** To prevent warnings. ***/
+			if ((iTileLoop >= 1) && (iTileLoop <= 10))
+				{ iTileUse = iTileLoop + 20; }
+			if ((iTileLoop >= 11) && (iTileLoop <= 20))
+				{ iTileUse = iTileLoop; }
+			if ((iTileLoop >= 21) && (iTileLoop <= 30))
+				{ iTileUse = iTileLoop - 20; }
+			arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop] =
+				arRoomTilesTemp[iTileUse];
+			arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop] =
+				arRoomModTemp[iTileUse];
+		}
+
+		/*** prince ***/
+		if (arLevels[iCurLevel].arStartLocation[1] == iCurRoom)
+		{
+			/*** tile ***/
+			iTile = arLevels[iCurLevel].arStartLocation[2];
+			if ((iTile >= 1) && (iTile <= 10))
+				{ arLevels[iCurLevel].arStartLocation[2] = iTile + 20; }
+			if ((iTile >= 21) && (iTile <= 30))
+				{ arLevels[iCurLevel].arStartLocation[2] = iTile - 20; }
+		}
+
+		/*** guard ***/
+		if (arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile <= TILES + 1)
+		{
+			/*** tile ***/
+			iTile = arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile;
+			if ((iTile >= 1) && (iTile <= 10))
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = iTile + 20; }
+			if ((iTile >= 21) && (iTile <= 30))
+				{ arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = iTile - 20; }
+		}
+	}
+}
+/*****************************************************************************/
+void CopyPaste (int iAction)
+/*****************************************************************************/
+{
+	/*** Used for looping. ***/
+	int iTileLoop;
+
+	if (iAction == 1) /*** copy ***/
+	{
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		{
+			arCopyPasteTile[iTileLoop] =
+				arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop];
+			arCopyPasteMod[iTileLoop] =
+				arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop];
+		}
+		cCopyPasteGuardTile = arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile;
+		cCopyPasteGuardDir = arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir;
+		cCopyPasteGuardSkill = arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill;
+		cCopyPasteGuardC = arLevels[iCurLevel].arRoom[iCurRoom].cGuardC;
+		iCopied = 1;
+	} else { /*** paste ***/
+		if (iCopied == 1)
+		{
+			for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+			{
+				arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop] =
+					arCopyPasteTile[iTileLoop];
+				arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop] =
+					arCopyPasteMod[iTileLoop];
+			}
+			arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = cCopyPasteGuardTile;
+			arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir = cCopyPasteGuardDir;
+			arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill = cCopyPasteGuardSkill;
+			arLevels[iCurLevel].arRoom[iCurRoom].cGuardC = cCopyPasteGuardC;
+		} else {
+			for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+			{
+				arLevels[iCurLevel].arRoom[iCurRoom].arTile[iTileLoop] = 0x00;
+				arLevels[iCurLevel].arRoom[iCurRoom].arMod[iTileLoop] = 0x00;
+			}
+			arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile = TILES + 1;
+		}
+	}
+}
+/*****************************************************************************/
+int InArea (int iUpperLeftX, int iUpperLeftY,
+	int iLowerRightX, int iLowerRightY)
+/*****************************************************************************/
+{
+	if ((iUpperLeftX * iScale <= iXPos) &&
+		(iLowerRightX * iScale >= iXPos) &&
+		(iUpperLeftY * iScale <= iYPos) &&
+		(iLowerRightY * iScale >= iYPos))
+	{
+		return (1);
+	} else {
+		return (0);
+	}
+}
+/*****************************************************************************/
+int MouseSelectAdj (void)
+/*****************************************************************************/
+{
+	/* On the broken room links screen, if you click one of the adjacent
+	 * rooms, this function sets iOnAdj to 1, and also sets both
+	 * iChangingBrokenRoom and iChangingBrokenSide.
+	 */
+
+	int iOnAdj;
+	int iRoomLoop;
+	int iAdjBaseX;
+	int iAdjBaseY;
+
+	iOnAdj = 0;
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	{
+		switch (iRoomLoop)
+		{
+			case 1: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
+			case 2: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
+			case 3: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
+			case 4: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 0); break;
+			case 5: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
+			case 6: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
+			case 7: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
+			case 8: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 1); break;
+			case 9: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
+			case 10: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
+			case 11: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
+			case 12: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 2); break;
+			case 13: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
+			case 14: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
+			case 15: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
+			case 16: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 3); break;
+			case 17: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
+			case 18: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
+			case 19: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
+			case 20: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 4); break;
+			case 21: iAdjBaseX = ADJ_BASE_X + (63 * 0);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
+			case 22: iAdjBaseX = ADJ_BASE_X + (63 * 1);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
+			case 23: iAdjBaseX = ADJ_BASE_X + (63 * 2);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
+			case 24: iAdjBaseX = ADJ_BASE_X + (63 * 3);
+				iAdjBaseY = ADJ_BASE_Y + (63 * 5); break;
+			default:
+				printf ("[FAILED] iRoomLoop is not in the 1-24 range!\n");
+				exit (EXIT_ERROR);
+		}
+		if (InArea (iAdjBaseX + 1, iAdjBaseY + 16,
+			iAdjBaseX + 15, iAdjBaseY + 30) == 1)
+		{
+			iChangingBrokenRoom = iRoomLoop;
+			iChangingBrokenSide = 1; /*** left ***/
+			iOnAdj = 1;
+		}
+		if (InArea (iAdjBaseX + 31, iAdjBaseY + 16,
+			iAdjBaseX + 45, iAdjBaseY + 30) == 1)
+		{
+			iChangingBrokenRoom = iRoomLoop;
+			iChangingBrokenSide = 2; /*** right ***/
+			iOnAdj = 1;
+		}
+		if (InArea (iAdjBaseX + 16, iAdjBaseY + 1,
+			iAdjBaseX + 30, iAdjBaseY + 14) == 1)
+		{
+			iChangingBrokenRoom = iRoomLoop;
+			iChangingBrokenSide = 3; /*** up ***/
+			iOnAdj = 1;
+		}
+		if (InArea (iAdjBaseX + 16, iAdjBaseY + 31,
+			iAdjBaseX + 30, iAdjBaseY + 45) == 1)
+		{
+			iChangingBrokenRoom = iRoomLoop;
+			iChangingBrokenSide = 4; /*** down ***/
+			iOnAdj = 1;
+		}
+	}
+
+	return (iOnAdj);
+}
+/*****************************************************************************/
+int OnLevelBar (void)
+/*****************************************************************************/
+{
+	if (InArea (28, 3, 522, 22) == 1) { return (1); } else { return (0); }
+}
+/*****************************************************************************/
+void ChangePos (void)
+/*****************************************************************************/
+{
+	int iChanging;
+	SDL_Event event;
+	int iOldXPos, iOldYPos;
+	int iUseTile;
+	int iNowOn;
+	int iSkillChange;
+
+	/*** Used for looping. ***/
+	int iRoomLoop;
+	int iTileLoop;
+
+	iChanging = 1;
+	iCustomHover = 0;
+	iGuardType = 0;
+	ontile = SDL_GetTicks();
+
+	ShowChange();
+	while (iChanging == 1)
+	{
+		/*** This is for the large preview. ***/
+		newticks = SDL_GetTicks();
+		if (newticks > oldticks + REFRESH_PROG)
+		{
+			ShowChange();
+			oldticks = newticks;
+		}
+
+		while (SDL_PollEvent (&event))
+		{
+			switch (event.type)
+			{
+				case SDL_CONTROLLERBUTTONDOWN:
+					UndoStep();
+					break;
+				case SDL_CONTROLLERBUTTONUP:
+					switch (event.cbutton.button)
+					{
+						case SDL_CONTROLLER_BUTTON_A:
+							if (iOnTile != 0)
+							{
+								UseTile (iOnTile, iSelected, iCurRoom);
+								if (iOnTile <= 78) { iChanging = 0; }
+								LevelChanged();
+							}
+							break;
+						case SDL_CONTROLLER_BUTTON_B:
+							iChanging = 0; break;
+						case SDL_CONTROLLER_BUTTON_X:
+							if (iGuardType < 11) { iGuardType++; }
+								else { iGuardType = 0; }
+							ApplySkillIfNecessary (iSelected);
+							PlaySound ("wav/check_box.wav");
+							break;
+						case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
+							ChangePosAction ("left"); break;
+						case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
+							ChangePosAction ("right"); break;
+						case SDL_CONTROLLER_BUTTON_DPAD_UP:
+							ChangePosAction ("up"); break;
+						case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
+							ChangePosAction ("down"); break;
+					}
+					ShowChange();
+					break;
+				case SDL_CONTROLLERAXISMOTION: /*** triggers and analog sticks ***/
+					iXJoy1 = SDL_JoystickGetAxis (joystick, 0);
+					iYJoy1 = SDL_JoystickGetAxis (joystick, 1);
+					iXJoy2 = SDL_JoystickGetAxis (joystick, 3);
+					iYJoy2 = SDL_JoystickGetAxis (joystick, 4);
+					if ((iXJoy1 < -30000) || (iXJoy2 < -30000)) /*** left ***/
+					{
+						if ((SDL_GetTicks() - joyleft) > 300)
+						{
+							ChangeEvent (-1, 1);
+							joyleft = SDL_GetTicks();
+						}
+					}
+					if ((iXJoy1 > 30000) || (iXJoy2 > 30000)) /*** right ***/
+					{
+						if ((SDL_GetTicks() - joyright) > 300)
+						{
+							ChangeEvent (1, 1);
+							joyright = SDL_GetTicks();
+						}
+					}
+					if ((iYJoy1 < -30000) || (iYJoy2 < -30000)) /*** up ***/
+					{
+						if ((SDL_GetTicks() - joyup) > 300)
+						{
+							ChangeEvent (10, 1);
+							joyup = SDL_GetTicks();
+						}
+					}
+					if ((iYJoy1 > 30000) || (iYJoy2 > 30000)) /*** down ***/
+					{
+						if ((SDL_GetTicks() - joydown) > 300)
+						{
+							ChangeEvent (-10, 1);
+							joydown = SDL_GetTicks();
+						}
+					}
+					ShowChange();
+					break;
+				case SDL_KEYDOWN:
+					UndoStep();
+					iSkillChange = 0;
+					switch (event.key.keysym.sym)
+					{
+						case SDLK_KP_ENTER:
+						case SDLK_RETURN:
+						case SDLK_SPACE:
+							if (event.key.keysym.mod & KMOD_CTRL)
+							{
+								if ((iOnTile >= 1) && (iOnTile <= 78))
+								{
+									for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+									{
+										for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+											{ UseTile (iOnTile, iTileLoop, iRoomLoop); }
+									}
+									iChanging = 0;
+									LevelChanged();
+								}
+							} else if (event.key.keysym.mod & KMOD_SHIFT) {
+								if ((iOnTile >= 1) && (iOnTile <= 78))
+								{
+									for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+										{ UseTile (iOnTile, iTileLoop, iCurRoom); }
+									iChanging = 0;
+									LevelChanged();
+								}
+							} else if (iOnTile != 0) {
+								UseTile (iOnTile, iSelected, iCurRoom);
+								if (iOnTile <= 78) { iChanging = 0; }
+								LevelChanged();
+							}
+							break;
+						case SDLK_ESCAPE:
+						case SDLK_q:
+						case SDLK_c:
+							iChanging = 0; break;
+						case SDLK_0:
+						case SDLK_KP_0:
+							if (iGuardType != 0) { iGuardType = 0; iSkillChange = 1; }
+							break;
+						case SDLK_1:
+						case SDLK_KP_1:
+							if (iGuardType != 1) { iGuardType = 1; iSkillChange = 1; }
+							break;
+						case SDLK_2:
+						case SDLK_KP_2:
+							if (iGuardType != 2) { iGuardType = 2; iSkillChange = 1; }
+							break;
+						case SDLK_3:
+						case SDLK_KP_3:
+							if (iGuardType != 3) { iGuardType = 3; iSkillChange = 1; }
+							break;
+						case SDLK_4:
+						case SDLK_KP_4:
+							if (iGuardType != 4) { iGuardType = 4; iSkillChange = 1; }
+							break;
+						case SDLK_5:
+						case SDLK_KP_5:
+							if (iGuardType != 5) { iGuardType = 5; iSkillChange = 1; }
+							break;
+						case SDLK_6:
+						case SDLK_KP_6:
+							if (iGuardType != 6) { iGuardType = 6; iSkillChange = 1; }
+							break;
+						case SDLK_7:
+						case SDLK_KP_7:
+							if (iGuardType != 7) { iGuardType = 7; iSkillChange = 1; }
+							break;
+						case SDLK_8:
+						case SDLK_KP_8:
+							if (iGuardType != 8) { iGuardType = 8; iSkillChange = 1; }
+							break;
+						case SDLK_9:
+						case SDLK_KP_9:
+							if (iGuardType != 9) { iGuardType = 9; iSkillChange = 1; }
+							break;
+						case SDLK_a:
+							if (iGuardType != 10) { iGuardType = 10; iSkillChange = 1; }
+							break;
+						case SDLK_b:
+							if (iGuardType != 11) { iGuardType = 11; iSkillChange = 1; }
+							break;
+						case SDLK_LEFT:
+							if (event.key.keysym.mod & KMOD_CTRL)
+							{
+								ChangeEvent (-10, 1);
+							} else if (event.key.keysym.mod & KMOD_SHIFT) {
+								ChangeEvent (-1, 1);
+							} else {
+								ChangePosAction ("left");
+							}
+							break;
+						case SDLK_RIGHT:
+							if (event.key.keysym.mod & KMOD_CTRL)
+							{
+								ChangeEvent (10, 1);
+							} else if (event.key.keysym.mod & KMOD_SHIFT) {
+								ChangeEvent (1, 1);
+							} else {
+								ChangePosAction ("right");
+							}
+							break;
+						case SDLK_UP: ChangePosAction ("up"); break;
+						case SDLK_DOWN: ChangePosAction ("down"); break;
+						default: break;
+					}
+					if (iSkillChange == 1)
+					{
+						ApplySkillIfNecessary (iSelected);
+						PlaySound ("wav/check_box.wav");
+					}
+					ShowChange();
+					break;
+				case SDL_MOUSEMOTION:
+					iOldXPos = iXPos;
+					iOldYPos = iYPos;
+					iXPos = event.motion.x;
+					iYPos = event.motion.y;
+					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
+
+					/*** custom hover ***/
+					iCustomHoverOld = iCustomHover;
+					if (InArea (3, 383, 3 + 304, 383 + 43) == 1)
+						{ iCustomHover = 1; } else { iCustomHover = 0; }
+					if (iCustomHover != iCustomHoverOld) { ShowChange(); }
+
+					if (InArea (311, 427, 311 + 128, 427 + 29) == 1)
+					{
+						if (iGuardTooltip == 0) { iGuardTooltip = 1; ShowChange(); }
+					} else {
+						if (iGuardTooltip == 1) { iGuardTooltip = 0; ShowChange(); }
+					}
+
+					if (InArea (443, 427, 443 + 128, 427 + 29) == 1)
+					{
+						if (iEventHover == 0) { iEventHover = 1; ShowChange(); }
+					} else {
+						if (iEventHover == 1) { iEventHover = 0; ShowChange(); }
+					}
+
+					iNowOn = OnTile();
+					if ((iOnTile != iNowOn) && (iNowOn != 0))
+					{
+						if (IsDisabled (iNowOn) == 0)
+						{
+							iOnTile = iNowOn;
+							ShowChange();
+						}
+					}
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					UndoStep();
+					if (event.button.button == 1) /*** left mouse button ***/
+					{
+						if (InArea (576, 0, 576 + 36, 0 + 461) == 1) /*** close ***/
+						{
+							iCloseOn = 1;
+							ShowChange();
+						}
+					}
+					break;
+				case SDL_MOUSEBUTTONUP:
+					iCloseOn = 0;
+
+					/*** On tile or living. ***/
+					iUseTile = 0;
+					if (InArea (0, 2, 0 + 574, 2 + 380) == 1) { iUseTile = 1; }
+
+					/*** On the custom tile area. ***/
+					if (InArea (3, 383, 3 + 304, 383 + 43) == 1)
+					{
+						iOnTile = -2;
+						iUseTile = 1;
+					}
+
+					if (event.button.button == 1) /*** left mouse button ***/
+					{
+						iSkillChange = 0;
+						if (InArea (315, 427, 315 + 14, 427 + 14) == 1)
+							if (iGuardType != 0) { iGuardType = 0; iSkillChange = 1; }
+						if (InArea (330, 427, 330 + 14, 427 + 14) == 1)
+							if (iGuardType != 1) { iGuardType = 1; iSkillChange = 1; }
+						if (InArea (345, 427, 345 + 14, 427 + 14) == 1)
+							if (iGuardType != 2) { iGuardType = 2; iSkillChange = 1; }
+						if (InArea (360, 427, 360 + 14, 427 + 14) == 1)
+							if (iGuardType != 3) { iGuardType = 3; iSkillChange = 1; }
+						if (InArea (375, 427, 375 + 14, 427 + 14) == 1)
+							if (iGuardType != 4) { iGuardType = 4; iSkillChange = 1; }
+						if (InArea (390, 427, 390 + 14, 427 + 14) == 1)
+							if (iGuardType != 5) { iGuardType = 5; iSkillChange = 1; }
+						if (InArea (405, 427, 405 + 14, 427 + 14) == 1)
+							if (iGuardType != 6) { iGuardType = 6; iSkillChange = 1; }
+						if (InArea (420, 427, 420 + 14, 427 + 14) == 1)
+							if (iGuardType != 7) { iGuardType = 7; iSkillChange = 1; }
+						if (InArea (345, 442, 345 + 14, 442 + 14) == 1)
+							if (iGuardType != 8) { iGuardType = 8; iSkillChange = 1; }
+						if (InArea (360, 442, 360 + 14, 442 + 14) == 1)
+							if (iGuardType != 9) { iGuardType = 9; iSkillChange = 1; }
+						if (InArea (375, 442, 375 + 14, 442 + 14) == 1)
+							if (iGuardType != 10) { iGuardType = 10; iSkillChange = 1; }
+						if (InArea (390, 442, 390 + 14, 442 + 14) == 1)
+							if (iGuardType != 11) { iGuardType = 11; iSkillChange = 1; }
+						if (iSkillChange == 1)
+						{
+							ApplySkillIfNecessary (iSelected);
+							PlaySound ("wav/check_box.wav");
+						}
+
+						/*** Changing the custom x. ***/
+						if (InArea (11, 434, 11 + 14, 434 + 14) == 1)
+						{
+							if (iCustomX == 1) { iCustomX = 0; } else { iCustomX = 1; }
+							PlaySound ("wav/check_box.wav");
+						}
+
+						/*** Changing the custom tile. ***/
+						if (InArea (57, 431, 57 + 13, 431 + 20) == 1)
+							{ ChangeCustom (-16, 1); }
+						if (InArea (72, 431, 72 + 13, 431 + 20) == 1)
+							{ ChangeCustom (-1, 1); }
+						if (InArea (142, 431, 142 + 13, 431 + 20) == 1)
+							{ ChangeCustom (1, 1); }
+						if (InArea (157, 431, 157 + 13, 431 + 20) == 1)
+							{ ChangeCustom (16, 1); }
+
+						/*** Changing the custom mod. ***/
+						if (InArea (186, 431, 186 + 13, 431 + 20) == 1)
+							{ ChangeCustom (-16, 2); }
+						if (InArea (201, 431, 201 + 13, 431 + 20) == 1)
+							{ ChangeCustom (-1, 2); }
+						if (InArea (271, 431, 271 + 13, 431 + 20) == 1)
+							{ ChangeCustom (1, 2); }
+						if (InArea (286, 431, 286 + 13, 431 + 20) == 1)
+							{ ChangeCustom (16, 2); }
+
+						/*** Changing the event number. ***/
+						if (InArea (450, 431, 450 + 13, 431 + 20) == 1)
+							{ ChangeEvent (-10, 1); }
+						if (InArea (465, 431, 465 + 13, 431 + 20) == 1)
+							{ ChangeEvent (-1, 1); }
+						if (InArea (535, 431, 535 + 13, 431 + 20) == 1)
+							{ ChangeEvent (1, 1); }
+						if (InArea (550, 431, 550 + 13, 431 + 20) == 1)
+							{ ChangeEvent (10, 1); }
+
+						/*** On close. ***/
+						if (InArea (576, 0, 576 + 36, 0 + 461) == 1) { iChanging = 0; }
+
+						if (iUseTile == 1)
+						{
+							UseTile (iOnTile, iSelected, iCurRoom);
+							if (iOnTile <= 78) { iChanging = 0; }
+							LevelChanged();
+						}
+					}
+
+					if (event.button.button == 2)
+					{
+						if ((iUseTile == 1) && (iOnTile != 0) && (iOnTile <= 78))
+						{
+							for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+							{
+								UseTile (iOnTile, iTileLoop, iCurRoom);
+							}
+							iChanging = 0;
+							LevelChanged();
+						}
+					}
+
+					if (event.button.button == 3)
+					{
+						if ((iUseTile == 1) && (iOnTile != 0) && (iOnTile <= 78))
+						{
+							for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+							{
+								for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+								{
+									UseTile (iOnTile, iTileLoop, iRoomLoop);
+								}
+							}
+							iChanging = 0;
+							LevelChanged();
+						}
+					}
+
+					ShowChange();
+					break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+						{ ShowChange(); } break;
+				case SDL_QUIT:
+					Quit(); break;
+			}
+		}
+
+		/*** prevent CPU eating ***/
+		gamespeed = REFRESH_PROG;
+		while ((SDL_GetTicks() - looptime) < gamespeed)
+		{
+			SDL_Delay (10);
+		}
+		looptime = SDL_GetTicks();
+	}
+	PlaySound ("wav/ok_close.wav");
+}
+/*****************************************************************************/
+void RemoveOldRoom (void)
+/*****************************************************************************/
+{
+	arMovingRooms[iMovingOldX][iMovingOldY] = 0;
+
+	/* Change the links of the rooms around
+	 * the removed room.
+	 */
+
+	/*** left of removed ***/
+	if ((iMovingOldX >= 2) && (iMovingOldX <= 24))
+	{
+		if (arMovingRooms[iMovingOldX - 1][iMovingOldY] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iMovingOldX - 1]
+				[iMovingOldY]].arLink[2] = 0; /*** remove right ***/
+		}
+	}
+
+	/*** right of removed ***/
+	if ((iMovingOldX >= 1) && (iMovingOldX <= 23))
+	{
+		if (arMovingRooms[iMovingOldX + 1][iMovingOldY] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iMovingOldX + 1]
+				[iMovingOldY]].arLink[1] = 0; /*** remove left ***/
+		}
+	}
+
+	/*** above removed ***/
+	if ((iMovingOldY >= 2) && (iMovingOldY <= 24))
+	{
+		if (arMovingRooms[iMovingOldX][iMovingOldY - 1] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iMovingOldX]
+				[iMovingOldY - 1]].arLink[4] = 0; /*** remove below ***/
+		}
+	}
+
+	/*** below removed ***/
+	if ((iMovingOldY >= 1) && (iMovingOldY <= 23))
+	{
+		if (arMovingRooms[iMovingOldX][iMovingOldY + 1] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iMovingOldX]
+				[iMovingOldY + 1]].arLink[3] = 0; /*** remove above ***/
+		}
+	}
+}
+/*****************************************************************************/
+void AddNewRoom (int iX, int iY, int iRoom)
+/*****************************************************************************/
+{
+	arMovingRooms[iX][iY] = iRoom;
+
+	/* Change the links of the rooms around
+	 * the new room and the room itself.
+	 */
+
+	arLevels[iCurLevel].arRoom[iRoom].arLink[1] = 0;
+	arLevels[iCurLevel].arRoom[iRoom].arLink[2] = 0;
+	arLevels[iCurLevel].arRoom[iRoom].arLink[3] = 0;
+	arLevels[iCurLevel].arRoom[iRoom].arLink[4] = 0;
+
+	if ((iX >= 2) && (iX <= 24)) /*** left of added ***/
+	{
+		if (arMovingRooms[iX - 1][iY] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iX - 1]
+				[iY]].arLink[2] = iRoom; /*** add room right ***/
+			arLevels[iCurLevel].arRoom[iRoom].arLink[1] = arMovingRooms[iX - 1][iY];
+		}
+	}
+
+	if ((iX >= 1) && (iX <= 23)) /*** right of added ***/
+	{
+		if (arMovingRooms[iX + 1][iY] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iX + 1]
+				[iY]].arLink[1] = iRoom; /*** add room left ***/
+			arLevels[iCurLevel].arRoom[iRoom].arLink[2] = arMovingRooms[iX + 1][iY];
+		}
+	}
+
+	if ((iY >= 2) && (iY <= 24)) /*** above added ***/
+	{
+		if (arMovingRooms[iX][iY - 1] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iX]
+				[iY - 1]].arLink[4] = iRoom; /*** add room below ***/
+			arLevels[iCurLevel].arRoom[iRoom].arLink[3] = arMovingRooms[iX][iY - 1];
+		}
+	}
+
+	if ((iY >= 1) && (iY <= 23)) /*** below added ***/
+	{
+		if (arMovingRooms[iX][iY + 1] != 0)
+		{
+			arLevels[iCurLevel].arRoom[arMovingRooms[iX]
+				[iY + 1]].arLink[3] = iRoom; /*** add room above ***/
+			arLevels[iCurLevel].arRoom[iRoom].arLink[4] = arMovingRooms[iX][iY + 1];
+		}
+	}
+
+	PlaySound ("wav/move_room.wav");
+}
+/*****************************************************************************/
+void LinkPlus (void)
+/*****************************************************************************/
+{
+	int iCurrent, iNew;
+
+	iCurrent = arLevels[iCurLevel].arRoom[iChangingBrokenRoom]
+		.arLink[iChangingBrokenSide];
+	if (iCurrent == ROOMS) {
+		iNew = 0;
+	} else {
+		iNew = iCurrent + 1;
+	}
+	arLevels[iCurLevel].arRoom[iChangingBrokenRoom]
+		.arLink[iChangingBrokenSide] = iNew;
+	LevelChanged();
+	arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0);
+	PlaySound ("wav/hum_adj.wav");
+}
+/*****************************************************************************/
+void ShowImage (struct image *img, int iX, int iY, char *sImageInfo)
+/*****************************************************************************/
+{
+	SDL_Rect dest;
+	SDL_Rect loc;
+
+	if (img == NULL)
+	{
+		printf ("[ WARN ] Image not loaded: %s!\n", sImageInfo);
+		return;
+	}
+	loc.x = 0;
+	loc.y = 0;
+	loc.w = img->rect.w;
+	loc.h = img->rect.h;
+	dest.x = iX;
+	dest.y = iY;
+	dest.w = img->rect.w;
+	dest.h = img->rect.h;
+	BatchImage (img, &loc, &dest, 0);
+}
+/*****************************************************************************/
+void ShowTile (int iTile, int iMod, int iX, int iY, int iGreen)
+/*****************************************************************************/
+{
+	/* Shows tile iTile (with the X-bit) and modifier iMod. If iGreen is 2,
+	 * the tile is shown selected.
+	 */
+
+	struct image *img;
+	SDL_Rect dest;
+	SDL_Rect loc;
+	SDL_Rect flame;
+	int iInfoC;
+	char arText[9 + 2][MAX_TEXT + 2];
+	char cXValue;
+	int iTileImg;
+	int iEntry;
+
+	iInfoC = 0;
+
+	if (iTile >= 32)
+	{
+		iTile-=32;
+		cXValue = 'Y';
+	} else {
+		cXValue = 'N';
+	}
+	iTileImg = iTile;
+	if (iTileImg == 0x0B)
+	{
+		if (cXValue == 'Y') { iTileImg+=32; }
+	}
+	iEntry = TileEntry (iTileImg, iMod);
+
+	if (iInfo == 1)
+	{
+		snprintf (arText[0], MAX_TEXT, "%c%02X/%02X", cXValue, iTile, iMod);
+	}
+
+	switch (iTile)
+	{
+		case 0x0F: /*** raise ***/
+		case 0x06: /*** drop ***/
+			/*** The modifier is the event. ***/
+			iEntry = TileEntry (iTile, 0x00);
+			if (iInfo != 1)
+				{ snprintf (arText[0], MAX_TEXT, "E:%i", iMod + 1); }
+			iInfoC = 1;
+			break;
+	}
+	img = TileImage (iEntry, iGreen);
+
+	/*** Custom tile. ***/
+	if ((iInfoC == 0) && (iEntry == 0))
+	{
+		snprintf (arText[0], MAX_TEXT, "%c%02X/%02X", cXValue, iTile, iMod);
+		iInfoC = 1;
+	}
+
+	if ((iNoAnim == 0) && (iGreen == 1) &&
+		(iTile == 0x13) && (iMod == 0x00))
+	{
+		switch (cCurType)
+		{
+			case 'd': img = imgspriteflamed; break;
+			case 'p': img = imgspriteflamep; break;
+		}
+	}
+	loc.x = 0;
+	loc.y = 0;
+	loc.w = img->rect.w;
+	loc.h = img->rect.h;
+	dest.x = iX;
+	dest.y = iY;
+	dest.w = img->rect.w;
+	dest.h = img->rect.h;
+	/*** This is for the game animation. ***/
+	if (iNoAnim == 0)
+	{
+		if (newticks > oldticks + REFRESH_GAME)
+		{
+			/*** 1-9 ***/
+			iFlameFrame = 1 + (int) (9.0 * rand() / (RAND_MAX + 1.0));
+		}
+		if (iGreen == 1)
+		{
+			if ((iTile == 0x13) && (iMod == 0x00))
+			{
+				loc.x = (iFlameFrame - 1) * 117;
+				loc.w = loc.w / 9;
+				dest.w = dest.w / 9;
+				flame.x = (dest.x + FLAME_X) * iScale;
+				flame.y = (dest.y + FLAME_Y) * iScale;
+				flame.w = FLAME_WIDTH * iScale;
+				flame.h = FLAME_HEIGHT * iScale;
+				if (iFlames == 0) { flames = flame; }
+					else { SDL_UnionRect (&flames, &flame, &flames); }
+				iFlames++;
+			}
+		}
+	}
+	BatchImage (img, &loc, &dest, 0);
+
+	/*** Info ("i"). ***/
+	if ((iInfo == 1) || (iInfoC == 1))
+	{
+		DisplayText (dest.x, dest.y + 136 - FONT_SIZE_11,
+			FONT_SIZE_11, arText, 1, &glyphs2);
+	}
+}
+/*****************************************************************************/
+void ShowLiving (struct living *liv, int iX, int iY, int iDir, int iGreen,
+	char *sImageInfo)
+/*****************************************************************************/
+{
+	/* Shows liv on the tile at iX,iY, looking right (iDir 0x00) or left
+	 * (0xFF). If iGreen is 2, it is also shown selected.
+	 */
+
+	SDL_Rect dest;
+	SDL_Rect loc;
+	int iFlip;
+
+	/*** Used for looping. ***/
+	int iGreenLoop;
+
+	iFlip = (iDir == 0xFF) ? 1 : 0;
+	for (iGreenLoop = 1; iGreenLoop <= iGreen; iGreenLoop++)
+	{
+		if (liv->img[iGreenLoop] == NULL)
+		{
+			printf ("[ WARN ] Image not loaded: %s[%i]!\n",
+				sImageInfo, iGreenLoop);
+			return;
+		}
+		loc.x = 0;
+		loc.y = 0;
+		loc.w = liv->img[iGreenLoop]->rect.w;
+		loc.h = liv->img[iGreenLoop]->rect.h;
+		dest.x = iX + ((iFlip == 1) ? liv->iHorL : liv->iHorR);
+		dest.y = iY + liv->iVer;
+		dest.w = loc.w;
+		dest.h = loc.h;
+		BatchImage (liv->img[iGreenLoop], &loc, &dest, iFlip);
+	}
+}
+/*****************************************************************************/
+void BatchImage (struct image *img, SDL_Rect *loc, SDL_Rect *dest,
+	int iFlip)
+/*****************************************************************************/
+{
+	/* Queues part loc of img for dest, mirrored if iFlip is 1. Quads are
+	 * drawn by BatchFlush(), all at once for each atlas page.
+	 */
+
+	if (arAtlasDirty[img->iPage] == 1)
+	{
+		BatchFlush();
+		AtlasUpload (img->iPage);
+	}
+	if ((img->iPage != iBatchPage) || (iBatchQuads == BATCH_QUADS))
+	{
+		BatchFlush();
+		iBatchPage = img->iPage;
+	}
+	arBatchSrc[iBatchQuads].x = img->rect.x + loc->x;
+	arBatchSrc[iBatchQuads].y = img->rect.y + loc->y;
+	arBatchSrc[iBatchQuads].w = loc->w;
+	arBatchSrc[iBatchQuads].h = loc->h;
+	arBatchDst[iBatchQuads].x = dest->x * iScale;
+	arBatchDst[iBatchQuads].y = dest->y * iScale;
+	arBatchDst[iBatchQuads].w = dest->w * iScale;
+	arBatchDst[iBatchQuads].h = dest->h * iScale;
+	arBatchFlip[iBatchQuads] = iFlip;
+	if (iTrack == 1)
+	{
+		if (track.w == 0) { track = arBatchDst[iBatchQuads]; }
+			else { SDL_UnionRect (&track, &arBatchDst[iBatchQuads], &track); }
+	}
+	if (Damaged (&arBatchDst[iBatchQuads]) == 1) { iBatchQuads++; }
+}
+/*****************************************************************************/
+void BatchFlush (void)
+/*****************************************************************************/
+{
+	/*** Call this before anything that does not draw via BatchImage(). ***/
+
+	/*** Used for looping. ***/
+	int iQuadLoop;
+
+	if (iBatchQuads == 0) { return; }
+	arAtlasUsed[iBatchPage] = SDL_GetTicks();
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+	for (iQuadLoop = 0; iQuadLoop < iBatchQuads; iQuadLoop++)
+	{
+		BatchQuad (iQuadLoop, &arBatchSrc[iQuadLoop], &arBatchDst[iQuadLoop],
+			ATLAS_SIZE, ATLAS_SIZE, arBatchFlip[iQuadLoop], color_wh);
+	}
+	if (SDL_RenderGeometry (ascreen, arAtlasTex[iBatchPage], arBatchVertex,
+		iBatchQuads * 4, arBatchIndex, iBatchQuads * 6) != 0)
+	{
+		printf ("[ WARN ] SDL_RenderGeometry: %s!\n", SDL_GetError());
+	}
+#else
+	for (iQuadLoop = 0; iQuadLoop < iBatchQuads; iQuadLoop++)
+	{
+		if (SDL_RenderCopyEx (ascreen, arAtlasTex[iBatchPage],
+			&arBatchSrc[iQuadLoop], &arBatchDst[iQuadLoop], 0, NULL,
+			(arBatchFlip[iQuadLoop] == 1) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE)
+			!= 0)
+		{
+			printf ("[ WARN ] SDL_RenderCopyEx: %s!\n", SDL_GetError());
+		}
+	}
+#endif
+	iBatchQuads = 0;
+}
+#if SDL_VERSION_ATLEAST(2,0,18)
+/*****************************************************************************/
+void BatchQuad (int iQuad, SDL_Rect *src, SDL_Rect *dst, int iTexW,
+	int iTexH, int iFlip, SDL_Color color)
+/*****************************************************************************/
+{
+	/* Sets the vertices and indices of quad iQuad, for part src of a
+	 * texture that is iTexW by iTexH, at dst, tinted with color.
+	 */
+
+	SDL_Vertex *vertex;
+	int *iIndex;
+	float fLeft, fTop, fRight, fBottom, fFlip;
+
+	vertex = &arBatchVertex[iQuad * 4];
+	fLeft = (float)src->x / iTexW;
+	fTop = (float)src->y / iTexH;
+	fRight = (float)(src->x + src->w) / iTexW;
+	fBottom = (float)(src->y + src->h) / iTexH;
+	if (iFlip == 1)
+	{
+		fFlip = fLeft;
+		fLeft = fRight;
+		fRight = fFlip;
+	}
+	vertex[0].position.x = dst->x;
+	vertex[0].position.y = dst->y;
+	vertex[0].tex_coord.x = fLeft;
+	vertex[0].tex_coord.y = fTop;
+	vertex[1].position.x = dst->x + dst->w;
+	vertex[1].position.y = dst->y;
+	vertex[1].tex_coord.x = fRight;
+	vertex[1].tex_coord.y = fTop;
+	vertex[2].position.x = dst->x + dst->w;
+	vertex[2].position.y = dst->y + dst->h;
+	vertex[2].tex_coord.x = fRight;
+	vertex[2].tex_coord.y = fBottom;
+	vertex[3].position.x = dst->x;
+	vertex[3].position.y = dst->y + dst->h;
+	vertex[3].tex_coord.x = fLeft;
+	vertex[3].tex_coord.y = fBottom;
+	vertex[0].color = color;
+	vertex[1].color = color;
+	vertex[2].color = color;
+	vertex[3].color = color;
+
+	iIndex = &arBatchIndex[iQuad * 6];
+	iIndex[0] = (iQuad * 4) + 0;
+	iIndex[1] = (iQuad * 4) + 1;
+	iIndex[2] = (iQuad * 4) + 2;
+	iIndex[3] = (iQuad * 4) + 0;
+	iIndex[4] = (iQuad * 4) + 2;
+	iIndex[5] = (iQuad * 4) + 3;
+}
+#endif
+/*****************************************************************************/
+void CustomRenderCopy (SDL_Texture* src, SDL_Rect* srcrect,
+	SDL_Rect *dstrect, char *sImageInfo)
+/*****************************************************************************/
+{
+	SDL_Rect stuff;
+
+	BatchFlush();
+	stuff.x = dstrect->x * iScale;
+	stuff.y = dstrect->y * iScale;
+	if (srcrect != NULL) /*** image ***/
+	{
+		stuff.w = dstrect->w * iScale;
+		stuff.h = dstrect->h * iScale;
+	} else { /*** font ***/
+		stuff.w = dstrect->w;
+		stuff.h = dstrect->h;
+	}
+	if (Damaged (&stuff) == 0) { return; }
+	if (SDL_RenderCopy (ascreen, src, srcrect, &stuff) != 0)
+	{
+		printf ("[ WARN ] SDL_RenderCopy (%s): %s!\n",
+			sImageInfo, SDL_GetError());
+	}
+}
+/*****************************************************************************/
+void CreateBAK (void)
+/*****************************************************************************/
+{
+	char sBackup[MAX_PATHFILE + 2];
+	char sWarning[MAX_WARNING + 2];
+	int iFdDAT;
+	int iFdBAK;
+
+	switch (iHomeComputer)
+	{
+		case 1: snprintf (sBackup, MAX_PATHFILE, "%s", BACKUP_A); break;
+		case 2: snprintf (sBackup, MAX_PATHFILE, "%s", BACKUP_B); break;
+		case 3: snprintf (sBackup, MAX_PATHFILE, "%s", BACKUP_C); break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+	}
+
+	snprintf (sWarning, MAX_WARNING, "%s", "");
+	iFdDAT = open (sPathFile, O_RDONLY|O_BINARY);
+	if (iFdDAT == -1)
+	{
+		snprintf (sWarning, MAX_WARNING, "Could not open \"%s\": %s!",
+			sPathFile, strerror (errno));
+	} else {
+		iFdBAK = open (sBackup, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0666);
+		if (iFdBAK == -1)
+		{
+			snprintf (sWarning, MAX_WARNING, "Could not open \"%s\": %s!",
+				sBackup, strerror (errno));
+		} else {
+			if (CopyDiskImage (iFdDAT, iFdBAK) == 0)
+			{
+				snprintf (sWarning, MAX_WARNING, "Could not write \"%s\": %s!",
+					sBackup, strerror (errno));
+			}
+			if ((close (iFdBAK) == -1) && (sWarning[0] == '\0'))
+			{
+				snprintf (sWarning, MAX_WARNING, "Could not write \"%s\": %s!",
+					sBackup, strerror (errno));
+			}
+		}
+		close (iFdDAT);
+	}
+
+	if (sWarning[0] != '\0')
+	{
+		printf ("[ WARN ] No backup was made. %s\n", sWarning);
+		SDL_ShowSimpleMessageBox (SDL_MESSAGEBOX_ERROR,
+			"Warning", sWarning, NULL);
+	}
+}
+/*****************************************************************************/
+int CopyDiskImage (int iFdFrom, int iFdTo)
+/*****************************************************************************/
+{
+	/* Copies all of iFdFrom to iFdTo, the cheapest way available.
+	 * Returns 0 on failure, with errno set.
+	 */
+
+	unsigned char *sBuffer;
+	int iRead;
+	int iWritten;
+	int iDone;
+	int iErrno;
+#if defined __linux__
+	struct stat stStat;
+	off_t oLeft;
+	ssize_t sSent;
+#endif
+
+#if defined __linux__
+#ifdef FICLONE
+	/*** Btrfs, XFS, ...: share the data blocks; nothing is copied. ***/
+	if (ioctl (iFdTo, FICLONE, iFdFrom) == 0) { return (1); }
+#endif
+
+	/*** Let the kernel copy, without going through user space. ***/
+	if (fstat (iFdFrom, &stStat) == 0)
+	{
+		oLeft = stStat.st_size;
+		while (oLeft > 0)
+		{
+			sSent = sendfile (iFdTo, iFdFrom, NULL, oLeft);
+			if (sSent <= 0) { break; }
+			oLeft-=sSent;
+		}
+		if (oLeft == 0) { return (1); }
+		/*** Start over below. ***/
+		lseek (iFdFrom, 0, SEEK_SET);
+		lseek (iFdTo, 0, SEEK_SET);
+	}
+#endif
+
+	sBuffer = malloc (COPY_BUFFER);
+	if (sBuffer == NULL) { errno = ENOMEM; return (0); }
+	while ((iRead = read (iFdFrom, sBuffer, COPY_BUFFER)) > 0)
+	{
+		iDone = 0;
+		while (iDone < iRead)
+		{
+			iWritten = write (iFdTo, sBuffer + iDone, iRead - iDone);
+			if (iWritten <= 0)
+			{
+				iErrno = errno;
+				free (sBuffer);
+				errno = iErrno;
+				return (0);
+			}
+			iDone+=iWritten;
+		}
+	}
+	iErrno = errno;
+	free (sBuffer);
+	errno = iErrno;
+
+	return ((iRead == 0) ? 1 : 0);
+}
+/*****************************************************************************/
+void DisplayText (int iStartX, int iStartY, int iFontSize,
+	char arText[9 + 2][MAX_TEXT + 2], int iLines, struct glyphs *gly)
+/*****************************************************************************/
+{
+	int iTemp;
+
+	for (iTemp = 0; iTemp <= (iLines - 1); iTemp++)
+	{
+		if (strcmp (arText[iTemp], "") != 0)
+		{
+			if ((strcmp (arText[iTemp], "single tile (change or select)") == 0) ||
+				(strcmp (arText[iTemp], "entire room (clear or fill)") == 0) ||
+				(strcmp (arText[iTemp], "entire level (randomize or fill)") == 0))
+			{
+				offset.x = iStartX + 20;
+			} else {
+				offset.x = iStartX;
+			}
+			offset.y = iStartY + (iTemp * (iFontSize + 4));
+			ShowText (gly, arText[iTemp], offset.x, offset.y,
+				color_bl, &color_wh);
+		}
+	}
+}
+/*****************************************************************************/
+void ShowText (struct glyphs *gly, char *sText, int iX, int iY,
+	SDL_Color fore, SDL_Color *back)
+/*****************************************************************************/
+{
+	/* Shows sText in color fore, on a box of color back unless that is NULL,
+	 * using the glyphs that LoadGlyphs() prepared. All of it is drawn with
+	 * one SDL_RenderGeometry() call. The quads are laid out on every call;
+	 * that is a few additions per character, and keeping them per string
+	 * would cost as much to look up.
+	 */
+
+	SDL_Rect arSrc[MAX_TEXT + 2];
+	SDL_Rect arDst[MAX_TEXT + 2];
+	SDL_Color arColor[MAX_TEXT + 2];
+	SDL_Rect box;
+	int iQuads;
+	int iGlyph, iPrev;
+	int iPen, iRight;
+
+	/*** Used for looping. ***/
+	int iCharLoop;
+
+	/*** The background first; its size follows from the glyphs. ***/
+	iQuads = 1;
+	iPrev = -1;
+	iPen = iX * iScale;
+	iRight = iPen;
+	for (iCharLoop = 0; (sText[iCharLoop] != '\0') &&
+		(iCharLoop < MAX_TEXT); iCharLoop++)
+	{
+		iGlyph = (unsigned char)sText[iCharLoop] - GLYPH_FIRST;
+		if ((iGlyph < 0) || (iGlyph >= GLYPHS)) { iGlyph = '?' - GLYPH_FIRST; }
+		if (iPrev != -1) { iPen+=gly->arKern[iPrev][iGlyph]; }
+		arSrc[iQuads] = gly->arGlyph[iGlyph];
+		arDst[iQuads].x = iPen + gly->arShift[iGlyph];
+		arDst[iQuads].y = iY * iScale;
+		arDst[iQuads].w = gly->arGlyph[iGlyph].w;
+		arDst[iQuads].h = gly->arGlyph[iGlyph].h;
+		arColor[iQuads] = fore;
+		if (arDst[iQuads].x + arDst[iQuads].w > iRight)
+			{ iRight = arDst[iQuads].x + arDst[iQuads].w; }
+		iPen+=gly->arAdvance[iGlyph];
+		iPrev = iGlyph;
+		iQuads++;
+	}
+	box.x = iX * iScale;
+	box.y = iY * iScale;
+	box.w = iRight - box.x;
+	box.h = gly->iHeight;
+	if ((box.w == 0) || (Damaged (&box) == 0)) { return; }
+	arSrc[0] = gly->arGlyph[GLYPHS];
+	arDst[0] = box;
+	if (back != NULL) { arColor[0] = *back; }
+
+	BatchFlush();
+	if (back == NULL) { iCharLoop = 1; } else { iCharLoop = 0; }
+#if SDL_VERSION_ATLEAST(2,0,18)
+	/*** After BatchFlush(), its arrays are free to use. ***/
+	for (iGlyph = iCharLoop; iGlyph < iQuads; iGlyph++)
+	{
+		BatchQuad (iGlyph - iCharLoop, &arSrc[iGlyph], &arDst[iGlyph],
+			gly->iW, gly->iH, 0, arColor[iGlyph]);
+	}
+	if (SDL_RenderGeometry (ascreen, gly->tex, arBatchVertex,
+		(iQuads - iCharLoop) * 4, arBatchIndex, (iQuads - iCharLoop) * 6) != 0)
+	{
+		printf ("[ WARN ] SDL_RenderGeometry: %s!\n", SDL_GetError());
+	}
+#else
+	for (iGlyph = iCharLoop; iGlyph < iQuads; iGlyph++)
+	{
+		SDL_SetTextureColorMod (gly->tex, arColor[iGlyph].r,
+			arColor[iGlyph].g, arColor[iGlyph].b);
+		if (SDL_RenderCopy (ascreen, gly->tex, &arSrc[iGlyph], &arDst[iGlyph])
+			!= 0)
+		{
+			printf ("[ WARN ] SDL_RenderCopy (text): %s!\n", SDL_GetError());
+		}
+	}
+	SDL_SetTextureColorMod (gly->tex, 255, 255, 255);
+#endif
+}
+/*****************************************************************************/
+void InitRooms (void)
+/*****************************************************************************/
+{
+	int iRoomLoop;
+	int iRoomLoop2;
+
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS + 1; iRoomLoop++) /*** x ***/
+	{
+		for (iRoomLoop2 = 1; iRoomLoop2 <= ROOMS; iRoomLoop2++) /*** y ***/
+		{
+			arMovingRooms[iRoomLoop][iRoomLoop2] = 0;
+		}
+	}
+}
+/*****************************************************************************/
+void WhereToStart (void)
+/*****************************************************************************/
+{
+	int iRoomLoop;
+
+	iMinX = 0;
+	iMaxX = 0;
+	iMinY = 0;
+	iMaxY = 0;
+
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	{
+		arDone[iRoomLoop] = 0;
+	}
+	CheckSides (iCurLevel, arLevels[iCurLevel].arStartLocation[1], 0, 0);
+
+	iStartRoomsX = round (12 - (((float)iMinX + (float)iMaxX) / 2));
+	iStartRoomsY = round (12 - (((float)iMinY + (float)iMaxY) / 2));
+}
+/*****************************************************************************/
+void CheckSides (int iLevel, int iRoom, int iX, int iY)
+/*****************************************************************************/
+{
+	if (iX < iMinX) { iMinX = iX; }
+	if (iY < iMinY) { iMinY = iY; }
+	if (iX > iMaxX) { iMaxX = iX; }
+	if (iY > iMaxY) { iMaxY = iY; }
+
+	arDone[iRoom] = 1;
+
+	if ((arLevels[iLevel].arRoom[iRoom].arLink[1] != 0) &&
+		(arDone[arLevels[iLevel].arRoom[iRoom].arLink[1]] != 1))
+		{ CheckSides (iLevel, arLevels[iLevel].arRoom[iRoom].arLink[1], iX - 1, iY); }
+
+	if ((arLevels[iLevel].arRoom[iRoom].arLink[2] != 0) &&
+		(arDone[arLevels[iLevel].arRoom[iRoom].arLink[2]] != 1))
+		{ CheckSides (iLevel, arLevels[iLevel].arRoom[iRoom].arLink[2], iX + 1, iY); }
+
+	if ((arLevels[iLevel].arRoom[iRoom].arLink[3] != 0) &&
+		(arDone[arLevels[iLevel].arRoom[iRoom].arLink[3]] != 1))
+		{ CheckSides (iLevel, arLevels[iLevel].arRoom[iRoom].arLink[3], iX, iY - 1); }
+
+	if ((arLevels[iLevel].arRoom[iRoom].arLink[4] != 0) &&
+		(arDone[arLevels[iLevel].arRoom[iRoom].arLink[4]] != 1))
+		{ CheckSides (iLevel, arLevels[iLevel].arRoom[iRoom].arLink[4], iX, iY + 1); }
+}
+/*****************************************************************************/
+void ShowRooms (int iRoom, int iX, int iY, int iNext)
+/*****************************************************************************/
+{
+	int iShowX, iShowY;
+
+	if (iX == 25) /*** side pane ***/
+	{
+		iShowX = 189;
+	} else {
+		iShowX = 199 + (iX * 15); /*** grid, 24x24 ***/
+	}
+	iShowY = 49 + (iY * 15); /*** grid, 24x24 & pane ***/
+
+	if (iRoom != -1)
+	{
+		ShowImage (imgroom[iRoom], iShowX, iShowY, "imgroom[...]");
+		arMovingRooms[iX][iY] = iRoom; /*** save room location ***/
+		if (iCurRoom == iRoom)
+		{
+			ShowImage (imgsrc, iShowX, iShowY, "imgsrc"); /*** green stripes ***/
+		}
+		if (arLevels[iCurLevel].arStartLocation[1] == iRoom)
+		{
+			ShowImage (imgsrs, iShowX, iShowY, "imgsrs"); /*** blue border ***/
+		}
+		if (iMovingRoom == iRoom)
+		{
+			ShowImage (imgsrm, iShowX, iShowY, "imgsrm"); /*** red stripes ***/
+		}
+	} else {
+		ShowImage (imgsrp, iShowX, iShowY, "imgsrp"); /*** white cross ***/
+	}
+	if (iRoom == iMovingRoom)
+	{
+		iMovingOldX = iX;
+		iMovingOldY = iY;
+		if (iMovingNewBusy == 0)
+		{
+			iMovingNewX = iMovingOldX;
+			iMovingNewY = iMovingOldY;
+			iMovingNewBusy = 1;
+		}
+	}
+
+	arDone[iRoom] = 1;
+
+	if (iNext == 1)
+	{
+		if ((arLevels[iCurLevel].arRoom[iRoom].arLink[1] != 0) &&
+			(arDone[arLevels[iCurLevel].arRoom[iRoom].arLink[1]] != 1))
+			{ ShowRooms (arLevels[iCurLevel].arRoom[iRoom].arLink[1],
+				iX - 1, iY, 1); }
+
+		if ((arLevels[iCurLevel].arRoom[iRoom].arLink[2] != 0) &&
+			(arDone[arLevels[iCurLevel].arRoom[iRoom].arLink[2]] != 1))
+			{ ShowRooms (arLevels[iCurLevel].arRoom[iRoom].arLink[2],
+				iX + 1, iY, 1); }
+
+		if ((arLevels[iCurLevel].arRoom[iRoom].arLink[3] != 0) &&
+			(arDone[arLevels[iCurLevel].arRoom[iRoom].arLink[3]] != 1))
+			{ ShowRooms (arLevels[iCurLevel].arRoom[iRoom].arLink[3],
+				iX, iY - 1, 1); }
+
+		if ((arLevels[iCurLevel].arRoom[iRoom].arLink[4] != 0) &&
+			(arDone[arLevels[iCurLevel].arRoom[iRoom].arLink[4]] != 1))
+			{ ShowRooms (arLevels[iCurLevel].arRoom[iRoom].arLink[4],
+				iX, iY + 1, 1); }
+	}
+}
+/*****************************************************************************/
+void BrokenRoomChange (int iRoom, int iSide, int *iX, int *iY)
+/*****************************************************************************/
+{
+	switch (iSide)
+	{
+		case 0:
+			*iX = BROKEN_ROOM_X;
+			*iY = BROKEN_ROOM_Y;
+			break;
+		case 1:
+			*iX = BROKEN_LEFT_X;
+			*iY = BROKEN_LEFT_Y;
+			break;
+		case 2:
+			*iX = BROKEN_RIGHT_X;
+			*iY = BROKEN_RIGHT_Y;
+			break;
+		case 3:
+			*iX = BROKEN_UP_X;
+			*iY = BROKEN_UP_Y;
+			break;
+		case 4:
+			*iX = BROKEN_DOWN_X;
+			*iY = BROKEN_DOWN_Y;
+			break;
+	}
+
+	switch (iRoom)
+	{
+		case 1: *iX += (63 * 0); *iY += (63 * 0); break;
+		case 2: *iX += (63 * 1); *iY += (63 * 0); break;
+		case 3: *iX += (63 * 2); *iY += (63 * 0); break;
+		case 4: *iX += (63 * 3); *iY += (63 * 0); break;
+		case 5: *iX += (63 * 0); *iY += (63 * 1); break;
+		case 6: *iX += (63 * 1); *iY += (63 * 1); break;
+		case 7: *iX += (63 * 2); *iY += (63 * 1); break;
+		case 8: *iX += (63 * 3); *iY += (63 * 1); break;
+		case 9: *iX += (63 * 0); *iY += (63 * 2); break;
+		case 10: *iX += (63 * 1); *iY += (63 * 2); break;
+		case 11: *iX += (63 * 2); *iY += (63 * 2); break;
+		case 12: *iX += (63 * 3); *iY += (63 * 2); break;
+		case 13: *iX += (63 * 0); *iY += (63 * 3); break;
+		case 14: *iX += (63 * 1); *iY += (63 * 3); break;
+		case 15: *iX += (63 * 2); *iY += (63 * 3); break;
+		case 16: *iX += (63 * 3); *iY += (63 * 3); break;
+		case 17: *iX += (63 * 0); *iY += (63 * 4); break;
+		case 18: *iX += (63 * 1); *iY += (63 * 4); break;
+		case 19: *iX += (63 * 2); *iY += (63 * 4); break;
+		case 20: *iX += (63 * 3); *iY += (63 * 4); break;
+		case 21: *iX += (63 * 0); *iY += (63 * 5); break;
+		case 22: *iX += (63 * 1); *iY += (63 * 5); break;
+		case 23: *iX += (63 * 2); *iY += (63 * 5); break;
+		case 24: *iX += (63 * 3); *iY += (63 * 5); break;
+	}
+}
+/*****************************************************************************/
+void ShowChange (void)
+/*****************************************************************************/
+{
+	int iX, iY;
+	int iOldTile, iOldM;
+	int iGetTile, iGetMod;
+
+	/*** background ***/
+	switch (cCurType)
+	{
+		case 'd': ShowImage (imgdungeon, 0, 0, "imgdungeon"); break;
+		case 'p': ShowImage (imgpalace, 0, 0, "imgpalace"); break;
+	}
+
+	/*** close button ***/
+	switch (iCloseOn)
+	{
+		case 0: /*** off ***/
+			ShowImage (imgclosebig_0, 576, 0, "imgclosebig_0"); break;
+		case 1: /*** on ***/
+			ShowImage (imgclosebig_1, 576, 0, "imgclosebig_1"); break;
+	}
+
+	DisableSome();
+
+	/*** old tile ***/
+	iOldTile = arLevels[iCurLevel].arRoom[iCurRoom].arTile[iSelected] & 0x1F;
+	if (iOldTile == 0x0B)
+	{
+		if ((arLevels[iCurLevel].arRoom[iCurRoom].arTile[iSelected] & 0x20) != 0)
+			{ iOldTile+=32; }
+	}
+	iOldM = arLevels[iCurLevel].arRoom[iCurRoom].arMod[iSelected];
+	if ((iOldTile == 0x06) || (iOldTile == 0x0F)) /*** drop or raise ***/
+		{ iChangeEvent = iOldM + 1; }
+	iX = -1; iY = -1;
+
+	/*** Row 1. ***/
+	if ((iOldTile == 0x00) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX1; }
+	if ((iOldTile == 0x00) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX2; }
+	if ((iOldTile == 0x00) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX3; }
+	if ((iOldTile == 0x00) && (iOldM == 0x03)) { iY = TILESY1; iX = TILESX4; }
+	if ((iOldTile == 0x00) && (iOldM == 0xFF)) { iY = TILESY1; iX = TILESX5; }
+	if ((iOldTile == 0x01) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX6; }
+	if ((iOldTile == 0x01) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX7; }
+	if ((iOldTile == 0x01) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX8; }
+	if ((iOldTile == 0x01) && (iOldM == 0x03)) { iY = TILESY1; iX = TILESX9; }
+	if ((iOldTile == 0x01) && (iOldM == 0xFF)) { iY = TILESY1; iX = TILESX10; }
+	if ((iOldTile == 0x02) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX11; }
+	if ((iOldTile == 0x02) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX12; }
+	if ((iOldTile == 0x02) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX13; }
+
+	/*** Row 2. ***/
+	if ((iOldTile == 0x02) && (iOldM == 0x03)) { iY = TILESY2; iX = TILESX1; }
+	if ((iOldTile == 0x02) && (iOldM == 0x04)) { iY = TILESY2; iX = TILESX2; }
+	if ((iOldTile == 0x02) && (iOldM == 0x05)) { iY = TILESY2; iX = TILESX3; }
+	if ((iOldTile == 0x02) && (iOldM == 0x06)) { iY = TILESY2; iX = TILESX4; }
+	if ((iOldTile == 0x02) && (iOldM == 0x07)) { iY = TILESY2; iX = TILESX5; }
+	if ((iOldTile == 0x02) && (iOldM == 0x08)) { iY = TILESY2; iX = TILESX6; }
+	if ((iOldTile == 0x02) && (iOldM == 0x09)) { iY = TILESY2; iX = TILESX7; }
+	if ((iOldTile == 0x03) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX8; }
+	if ((iOldTile == 0x04) && (iOldM == 0x02)) { iY = TILESY2; iX = TILESX9; }
+	if ((iOldTile == 0x04) && (iOldM == 0x01)) { iY = TILESY2; iX = TILESX10; }
+	if ((iOldTile == 0x05) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX11; }
+	if (iOldTile == 0x06) { iY = TILESY2; iX = TILESX12; }
+	if ((iOldTile == 0x07) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX13; }
+
+	/*** Row 3. ***/
+	if ((iOldTile == 0x07) && (iOldM == 0x01)) { iY = TILESY3; iX = TILESX1; }
+	if ((iOldTile == 0x07) && (iOldM == 0x02)) { iY = TILESY3; iX = TILESX2; }
+	if ((iOldTile == 0x07) && (iOldM == 0x03)) { iY = TILESY3; iX = TILESX3; }
+	if ((iOldTile == 0x08) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX4; }
+	if ((iOldTile == 0x09) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX5; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX6; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x01)) { iY = TILESY3; iX = TILESX7; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x02)) { iY = TILESY3; iX = TILESX8; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x03)) { iY = TILESY3; iX = TILESX9; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x04)) { iY = TILESY3; iX = TILESX10; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x05)) { iY = TILESY3; iX = TILESX11; }
+	if ((iOldTile == 0x0A) && (iOldM == 0x06)) { iY = TILESY3; iX = TILESX12; }
+	if ((iOldTile == 0x0B) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX13; }
+
+	/*** Row 4. ***/
+	if ((iOldTile == 0x0C) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX1; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x01)) { iY = TILESY4; iX = TILESX2; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x02)) { iY = TILESY4; iX = TILESX3; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x03)) { iY = TILESY4; iX = TILESX4; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x04)) { iY = TILESY4; iX = TILESX5; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x05)) { iY = TILESY4; iX = TILESX6; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x06)) { iY = TILESY4; iX = TILESX7; }
+	if ((iOldTile == 0x0C) && (iOldM == 0x07)) { iY = TILESY4; iX = TILESX8; }
+	if ((iOldTile == 0x0D) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX9; }
+	if ((iOldTile == 0x0E) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX10; }
+	if (iOldTile == 0x0F) { iY = TILESY4; iX = TILESX11; }
+	if ((iOldTile == 0x10) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX12; }
+	if ((iOldTile == 0x11) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX13; }
+
+	/*** Row 5. ***/
+	if ((iOldTile == 0x12) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX1; }
+	if ((iOldTile == 0x12) && (iOldM == 0x01)) { iY = TILESY5; iX = TILESX2; }
+	if ((iOldTile == 0x12) && (iOldM == 0x02)) { iY = TILESY5; iX = TILESX3; }
+	if ((iOldTile == 0x12) && (iOldM == 0x03)) { iY = TILESY5; iX = TILESX4; }
+	if ((iOldTile == 0x12) && (iOldM == 0x04)) { iY = TILESY5; iX = TILESX5; }
+	if ((iOldTile == 0x12) && (iOldM == 0x05)) { iY = TILESY5; iX = TILESX6; }
+	if ((iOldTile == 0x13) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX7; }
+	if ((iOldTile == 0x14) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX8; }
+	if ((iOldTile == 0x14) && (iOldM == 0x01)) { iY = TILESY5; iX = TILESX9; }
+	if ((iOldTile == 0x15) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX10; }
+	if ((iOldTile == 0x16) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX11; }
+	if ((iOldTile == 0x17) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX12; }
+	if ((iOldTile == 0x18) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX13; }
+
+	/*** Row 6. ***/
+	if ((iOldTile == 0x19) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX1; }
+	if ((iOldTile == 0x1A) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX2; }
+	if ((iOldTile == 0x1B) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX3; }
+	if ((iOldTile == 0x1C) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX4; }
+	if ((iOldTile == 0x1D) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX5; }
+	if ((iOldTile == 0x1E) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX6; }
+	if ((iOldTile == 0x2B) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX7; }
+	if ((iOldTile == 0x12) && (iOldM == 0x80)) { iY = TILESY6; iX = TILESX8; }
+	if ((iOldTile == 0x12) && (iOldM == 0x81)) { iY = TILESY6; iX = TILESX9; }
+	if ((iOldTile == 0x12) && (iOldM == 0x82)) { iY = TILESY6; iX = TILESX10; }
+	if ((iOldTile == 0x12) && (iOldM == 0x83)) { iY = TILESY6; iX = TILESX11; }
+	if ((iOldTile == 0x12) && (iOldM == 0x84)) { iY = TILESY6; iX = TILESX12; }
+	if ((iOldTile == 0x12) && (iOldM == 0x85)) { iY = TILESY6; iX = TILESX13; }
+
+	if ((iX != -1) && (iY != -1))
+	{
+		ShowImage (imgborderbl, iX, iY, "imgborderbl");
+	}
+
+	/*** prince ***/
+	if ((iCurRoom == arLevels[iCurLevel].arStartLocation[1]) &&
+		(iSelected == arLevels[iCurLevel].arStartLocation[2]))
+	{
+		switch (arLevels[iCurLevel].arStartLocation[3])
+		{
+			case 0x00: /*** r ***/
+				ShowImage (imgbordersl, 0, 326, "imgbordersl"); break;
+			case 0xFF: /*** l ***/
+				ShowImage (imgbordersl, 22, 326, "imgbordersl"); break;
+		}
+	}
+
+	/*** guard ***/
+	if (iSelected == arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile)
+	{
+		iGuardType = arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill;
+		iY = 326;
+		switch (arLevels[iCurLevel].arRoom[iCurRoom].cGuardDir)
+		{
+			case 0x00: /*** r ***/
+				switch (iCurGuard)
+				{
+					case 0x01: iX = 88; break; /*** skeleton ***/
+					case 0x03: iX = 132; break; /*** fat ***/
+					case 0x04: iX = 176; break; /*** shadow ***/
+					case 0x05: iX = 220; break; /*** Jaffar ***/
+					default: iX = 44; break; /*** guard; 0x00 and 0x02 ***/
+				}
+				break;
+			case 0xFF: /*** l ***/
+				switch (iCurGuard)
+				{
+					case 0x01: iX = 110; break; /*** skeleton ***/
+					case 0x03: iX = 154; break; /*** fat ***/
+					case 0x04: iX = 198; break; /*** shadow ***/
+					case 0x05: iX = 242; break; /*** Jaffar ***/
+					default: iX = 66; break; /*** guard; 0x00 and 0x02 ***/
+				}
+				break;
+		}
+		ShowImage (imgbordersl, iX, iY, "imgbordersl");
+	}
+
+	/*** selected (new) tile ***/
+	if (iOnTile != iOnTileOld)
+	{
+		ontile = SDL_GetTicks();
+		iOnTileOld = iOnTile;
+	}
+	if ((iOnTile != 0) && (IsDisabled (iOnTile) == 0))
+	{
+		if (iOnTile <= 78) /*** (large) tiles ***/
+		{
+			iX = (((iOnTile - 1) % 13) * (TILEWIDTH + 2));
+			iY = 2 + (((int)((iOnTile - 1) / 13)) * (TILEHEIGHT + 2));
+			ShowImage (imgborderb, iX, iY, "imgborderb");
+
+			/*** large preview ***/
+			if ((SDL_GetTicks() > ontile + 1000) && (iEventHover == 0))
+			{
+				GetTileModChange (iOnTile, &iGetTile, &iGetMod);
+				if (((iOnTile >= 1) && (iOnTile <= 7)) ||
+					((iOnTile >= 14) && (iOnTile <= 20)) ||
+					((iOnTile >= 27) && (iOnTile <= 33)) ||
+					((iOnTile >= 40) && (iOnTile <= 46)) ||
+					((iOnTile >= 53) && (iOnTile <= 59)) ||
+					((iOnTile >= 66) && (iOnTile <= 72)))
+				{ /*** show right ***/
+					ShowImage (imgpreviewb, 356, 76, "imgpreviewb");
+					ShowTile (iGetTile, iGetMod, 371, 91, 1);
+				} else { /*** show left ***/
+					ShowImage (imgpreviewb, 71, 76, "imgpreviewb");
+					ShowTile (iGetTile, iGetMod, 86, 91, 1);
+				}
+			}
+		} else { /*** living ***/
+			iX = 0 + (22 * (iOnTile - 79));
+			iY = 326;
+			ShowImage (imgborders, iX, iY, "imgborders");
+		}
+	}
+
+	/*** guard skill ***/
+	switch (iGuardType)
+	{
+		case 0: iX = 315; iY = 427; break;
+		case 1: iX = 330; iY = 427; break;
+		case 2: iX = 345; iY = 427; break;
+		case 3: iX = 360; iY = 427; break;
+		case 4: iX = 375; iY = 427; break;
+		case 5: iX = 390; iY = 427; break;
+		case 6: iX = 405; iY = 427; break;
+		case 7: iX = 420; iY = 427; break;
+		case 8: iX = 345; iY = 442; break;
+		case 9: iX = 360; iY = 442; break;
+		case 10: iX = 375; iY = 442; break;
+		case 11: iX = 390; iY = 442; break;
+	}
+	ShowImage (imgsell, iX, iY, "imgsell");
+
+	/*** custom tile ***/
+	if (iCustomX == 1) { ShowImage (imgsell, 11, 434, "imgsell"); }
+	CenterNumber (iCustomTile, 85, 431, color_bl, 1);
+	CenterNumber (iCustomMod, 214, 431, color_bl, 1);
+
+	/*** event number ***/
+	CenterNumber (iChangeEvent, 478, 431, color_bl, 0);
+
+	if (iCustomHover == 1)
+		{ ShowImage (imgchover, 3, 383, "imgchover"); }
+
+	if (iGuardTooltip == 1)
+		{ ShowImage (imgtooltipg, 311, 383, "imgtooltipg"); }
+
+	if (iEventHover == 1)
+		{ ShowImage (imgeventh, 440, 56, "imgeventh"); }
+
+	/*** refresh screen ***/
+	BatchFlush();
+	SDL_RenderPresent (ascreen);
+}
+/*****************************************************************************/
+int OnTile (void)
+/*****************************************************************************/
+{
+	int iTempX;
+	int iTempY;
+	int iTempOn;
+
+	/*** (large) tiles ***/
+	for (iTempY = 0; iTempY < 6; iTempY++)
+	{
+		for (iTempX = 0; iTempX < 13; iTempX++)
+		{
+			if (InArea (2 + (iTempX * (TILEWIDTH + 2)),
+				4 + (iTempY * (TILEHEIGHT + 2)),
+				2 + (iTempX * (TILEWIDTH + 2)) + TILEWIDTH,
+				4 + (iTempY * (TILEHEIGHT + 2)) + TILEHEIGHT) == 1)
+			{
+				iTempOn = (iTempY * 13) + iTempX + 1;
+				if ((iTempOn >= 1) && (iTempOn <= 78)) { return (iTempOn); }
+			}
+		}
+	}
+
+	/*** living ***/
+	for (iTempX = 0; iTempX < 26; iTempX++)
+	{
+		if (InArea (2 + (22 * iTempX), 328,
+			2 + (22 * iTempX) + 20, 328 + 52) == 1)
+		{ return (79 + iTempX); }
+	}
+
+	return (0);
+}
+/*****************************************************************************/
+void ChangePosAction (char *sAction)
+/*****************************************************************************/
+{
+	if (strcmp (sAction, "left") == 0)
+	{
+		do {
+			switch (iOnTile)
+			{
+				case 1: iOnTile = 13; break;
+				case 14: iOnTile = 26; break;
+				case 27: iOnTile = 39; break;
+				case 40: iOnTile = 52; break;
+				case 53: iOnTile = 65; break;
+				case 66: iOnTile = 78; break;
+				case 79: iOnTile = 104; break;
+				default: iOnTile--; break;
+			}
+		} while (IsDisabled (iOnTile) == 1);
+	}
+
+	if (strcmp (sAction, "right") == 0)
+	{
+		do {
+			switch (iOnTile)
+			{
+				case 13: iOnTile = 1; break;
+				case 26: iOnTile = 14; break;
+				case 39: iOnTile = 27; break;
+				case 52: iOnTile = 40; break;
+				case 65: iOnTile = 53; break;
+				case 78: iOnTile = 66; break;
+				case 104: iOnTile = 79; break;
+				default: iOnTile++; break;
+			}
+		} while (IsDisabled (iOnTile) == 1);
+	}
+
+	if (strcmp (sAction, "up") == 0)
+	{
+		do {
+			switch (iOnTile)
+			{
+				case 1: iOnTile = 79; break;
+				case 2: iOnTile = 81; break;
+				case 3: iOnTile = 83; break;
+				case 4: iOnTile = 85; break;
+				case 5: iOnTile = 87; break;
+				case 6: iOnTile = 89; break;
+				case 7: iOnTile = 91; break;
+				case 8: iOnTile = 93; break;
+				case 9: iOnTile = 95; break;
+				case 10: iOnTile = 97; break;
+				case 11: iOnTile = 99; break;
+				case 12: iOnTile = 101; break;
+				case 13: iOnTile = 103; break;
+				case 79: case 80: iOnTile = 66; break;
+				case 81: case 82: iOnTile = 67; break;
+				case 83: case 84: iOnTile = 68; break;
+				case 85: case 86: iOnTile = 69; break;
+				case 87: case 88: iOnTile = 70; break;
+				case 89: case 90: iOnTile = 71; break;
+				case 91: case 92: iOnTile = 72; break;
+				case 93: case 94: iOnTile = 73; break;
+				case 95: case 96: iOnTile = 74; break;
+				case 97: case 98: iOnTile = 75; break;
+				case 99: case 100: iOnTile = 76; break;
+				case 101: case 102: iOnTile = 77; break;
+				case 103: case 104: iOnTile = 78; break;
+				default: iOnTile-=13; break;
+			}
+		} while (IsDisabled (iOnTile) == 1);
+	}
+
+	if (strcmp (sAction, "down") == 0)
+	{
+		do {
+			switch (iOnTile)
+			{
+				case 66: iOnTile = 79; break;
+				case 67: iOnTile = 81; break;
+				case 68: iOnTile = 83; break;
+				case 69: iOnTile = 85; break;
+				case 70: iOnTile = 87; break;
+				case 71: iOnTile = 89; break;
+				case 72: iOnTile = 91; break;
+				case 73: iOnTile = 93; break;
+				case 74: iOnTile = 95; break;
+				case 75: iOnTile = 97; break;
+				case 76: iOnTile = 99; break;
+				case 77: iOnTile = 101; break;
+				case 78: iOnTile = 103; break;
+				case 79: case 80: iOnTile = 1; break;
+				case 81: case 82: iOnTile = 2; break;
+				case 83: case 84: iOnTile = 3; break;
+				case 85: case 86: iOnTile = 4; break;
+				case 87: case 88: iOnTile = 5; break;
+				case 89: case 90: iOnTile = 6; break;
+				case 91: case 92: iOnTile = 7; break;
+				case 93: case 94: iOnTile = 8; break;
+				case 95: case 96: iOnTile = 9; break;
+				case 97: case 98: iOnTile = 10; break;
+				case 99: case 100: iOnTile = 11; break;
+				case 101: case 102: iOnTile = 12; break;
+				case 103: case 104: iOnTile = 13; break;
+				default: iOnTile+=13; break;
+			}
+		} while (IsDisabled (iOnTile) == 1);
+	}
+}
+/*****************************************************************************/
+void DisableSome (void)
+/*****************************************************************************/
+{
+	if (iCurGuard != 0x01)
+	{
+		/*** disable skeleton ***/
+		ShowImage (imgdisabled, 88, 326, "imgdisabled");
+	}
 
-					if (event.button.button == 1) /*** left mouse button ***/
-					{
-						iSkillChange = 0;
-						if (InArea (315, 427, 315 + 14, 427 + 14) == 1)
-							if (iGuardType != 0) { iGuardType = 0; iSkillChange = 1; }
-						if (InArea (330, 427, 330 + 14, 427 + 14) == 1)
-							if (iGuardType != 1) { iGuardType = 1; iSkillChange = 1; }
-						if (InArea (345, 427, 345 + 14, 427 + 14) == 1)
-							if (iGuardType != 2) { iGuardType = 2; iSkillChange = 1; }
-						if (InArea (360, 427, 360 + 14, 427 + 14) == 1)
-							if (iGuardType != 3) { iGuardType = 3; iSkillChange = 1; }
-						if (InArea (375, 427, 375 + 14, 427 + 14) == 1)
-							if (iGuardType != 4) { iGuardType = 4; iSkillChange = 1; }
-						if (InArea (390, 427, 390 + 14, 427 + 14) == 1)
-							if (iGuardType != 5) { iGuardType = 5; iSkillChange = 1; }
-						if (InArea (405, 427, 405 + 14, 427 + 14) == 1)
-							if (iGuardType != 6) { iGuardType = 6; iSkillChange = 1; }
-						if (InArea (420, 427, 420 + 14, 427 + 14) == 1)
-							if (iGuardType != 7) { iGuardType = 7; iSkillChange = 1; }
-						if (InArea (345, 442, 345 + 14, 442 + 14) == 1)
-							if (iGuardType != 8) { iGuardType = 8; iSkillChange = 1; }
-						if (InArea (360, 442, 360 + 14, 442 + 14) == 1)
-							if (iGuardType != 9) { iGuardType = 9; iSkillChange = 1; }
-						if (InArea (375, 442, 375 + 14, 442 + 14) == 1)
-							if (iGuardType != 10) { iGuardType = 10; iSkillChange = 1; }
-						if (InArea (390, 442, 390 + 14, 442 + 14) == 1)
-							if (iGuardType != 11) { iGuardType = 11; iSkillChange = 1; }
-						if (iSkillChange == 1)
-						{
-							ApplySkillIfNecessary (iSelected);
-							PlaySound ("wav/check_box.wav");
-						}
+	if (iCurGuard != 0x03)
+	{
+		/*** disable fat ***/
+		ShowImage (imgdisabled, 132, 326, "imgdisabled");
+	}
 
-						/*** Changing the custom x. ***/
-						if (InArea (11, 434, 11 + 14, 434 + 14) == 1)
-						{
-							if (iCustomX == 1) { iCustomX = 0; } else { iCustomX = 1; }
-							PlaySound ("wav/check_box.wav");
-						}
+	if (iCurGuard != 0x04)
+	{
+		/*** disable shadow ***/
+		ShowImage (imgdisabled, 176, 326, "imgdisabled");
+	}
 
-						/*** Changing the custom tile. ***/
-						if (InArea (57, 431, 57 + 13, 431 + 20) == 1)
-							{ ChangeCustom (-16, 1); }
-						if (InArea (72, 431, 72 + 13, 431 + 20) == 1)
-							{ ChangeCustom (-1, 1); }
-						if (InArea (142, 431, 142 + 13, 431 + 20) == 1)
-							{ ChangeCustom (1, 1); }
-						if (InArea (157, 431, 157 + 13, 431 + 20) == 1)
-							{ ChangeCustom (16, 1); }
+	if (iCurGuard != 0x05)
+	{
+		/*** disable Jaffar ***/
+		ShowImage (imgdisabled, 220, 326, "imgdisabled");
+	}
 
-						/*** Changing the custom mod. ***/
-						if (InArea (186, 431, 186 + 13, 431 + 20) == 1)
-							{ ChangeCustom (-16, 2); }
-						if (InArea (201, 431, 201 + 13, 431 + 20) == 1)
-							{ ChangeCustom (-1, 2); }
-						if (InArea (271, 431, 271 + 13, 431 + 20) == 1)
-							{ ChangeCustom (1, 2); }
-						if (InArea (286, 431, 286 + 13, 431 + 20) == 1)
-							{ ChangeCustom (16, 2); }
+	if (((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14))
+	{
+		/*** disable guard ***/
+		ShowImage (imgdisabled, 44, 326, "imgdisabled");
+	}
+}
+/*****************************************************************************/
+int IsDisabled (int iTile)
+/*****************************************************************************/
+{
+	/*** skeleton ***/
+	if ((iCurGuard != 0x01) && ((iTile == 83) || (iTile == 84)))
+		{ return (1); }
 
-						/*** Changing the event number. ***/
-						if (InArea (450, 431, 450 + 13, 431 + 20) == 1)
-							{ ChangeEvent (-10, 1); }
-						if (InArea (465, 431, 465 + 13, 431 + 20) == 1)
-							{ ChangeEvent (-1, 1); }
-						if (InArea (535, 431, 535 + 13, 431 + 20) == 1)
-							{ ChangeEvent (1, 1); }
-						if (InArea (550, 431, 550 + 13, 431 + 20) == 1)
-							{ ChangeEvent (10, 1); }
+	/*** fat ***/
+	if ((iCurGuard != 0x03) && ((iTile == 85) || (iTile == 86)))
+		{ return (1); }
 
-						/*** On close. ***/
-						if (InArea (576, 0, 576 + 36, 0 + 461) == 1) { iChanging = 0; }
+	/*** shadow ***/
+	if ((iCurGuard != 0x04) && ((iTile == 87) || (iTile == 88)))
+		{ return (1); }
 
-						if (iUseTile == 1)
-						{
-							UseTile (iOnTile, iSelected, iCurRoom);
-							if (iOnTile <= 78) { iChanging = 0; }
-							iChanged++;
-						}
-					}
+	/*** Jaffar ***/
+	if ((iCurGuard != 0x05) && ((iTile == 89) || (iTile == 90)))
+		{ return (1); }
 
-					if (event.button.button == 2)
-					{
-						if ((iUseTile == 1) && (iOnTile != 0) && (iOnTile <= 78))
-						{
-							for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-							{
-								UseTile (iOnTile, iTileLoop, iCurRoom);
-							}
-							iChanging = 0;
-							iChanged++;
-						}
-					}
+	/*** guard ***/
+	if ((((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14)) &&
+		((iTile == 81) || (iTile == 82))) { return (1); }
 
-					if (event.button.button == 3)
-					{
-						if ((iUseTile == 1) && (iOnTile != 0) && (iOnTile <= 78))
-						{
-							for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-							{
-								for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-								{
-									UseTile (iOnTile, iTileLoop, iRoomLoop);
-								}
-							}
-							iChanging = 0;
-							iChanged++;
-						}
-					}
+	if (Unused (iTile) == 1) { return (1); }
 
-					ShowChange();
-					break;
-				case SDL_WINDOWEVENT:
-					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
-						{ ShowChange(); } break;
-				case SDL_QUIT:
-					Quit(); break;
-			}
-		}
+	return (0);
+}
+/*****************************************************************************/
+void CenterNumber (int iNumber, int iX, int iY,
+	SDL_Color fore, int iHex)
+/*****************************************************************************/
+{
+	char sText[MAX_TEXT + 2];
 
-		/*** prevent CPU eating ***/
-		gamespeed = REFRESH_PROG;
-		while ((SDL_GetTicks() - looptime) < gamespeed)
+	if (iHex == 0)
+	{
+		snprintf (sText, MAX_TEXT, "%i", iNumber);
+	} else {
+		snprintf (sText, MAX_TEXT, "%02x", iNumber);
+	}
+	if (iHex == 0)
+	{
+		if ((iNumber >= -9) && (iNumber <= -1))
 		{
-			SDL_Delay (10);
+			offset.x = iX + 16;
+		} else if ((iNumber >= 0) && (iNumber <= 9)) {
+			offset.x = iX + 21;
+		} else if ((iNumber >= 10) && (iNumber <= 99)) {
+			offset.x = iX + 14;
+		} else {
+			offset.x = iX + 7;
 		}
-		looptime = SDL_GetTicks();
+	} else {
+		offset.x = iX + 14;
 	}
-	PlaySound ("wav/ok_close.wav");
+	offset.y = iY - 1;
+	ShowText (&glyphs3, sText, offset.x, offset.y, fore, NULL);
 }
 /*****************************************************************************/
-void RemoveOldRoom (void)
+int Unused (int iTile)
 /*****************************************************************************/
 {
-	arMovingRooms[iMovingOldX][iMovingOldY] = 0;
+	if ((iTile >= 91) && (iTile <= 104)) { return (1); }
 
-	/* Change the links of the rooms around
-	 * the removed room.
-	 */
+	return (0);
+}
+/*****************************************************************************/
+void OpenURL (char *sURL)
+/*****************************************************************************/
+{
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+ShellExecute (NULL, "open", sURL, NULL, NULL, SW_SHOWNORMAL);
+#else
+pid_t pid;
+pid = fork();
+if (pid == 0)
+{
+	execl ("/usr/bin/xdg-open", "xdg-open", sURL, (char *)NULL);
+	exit (EXIT_NORMAL);
+}
+#endif
+}
+/*****************************************************************************/
+void EXELoad (void)
+/*****************************************************************************/
+{
+	int iTab;
+	int iHCSwitch;
+	unsigned long ulOffset;
+
+	/*** Used for looping. ***/
+	int iSkillLoop;
 
-	/*** left of removed ***/
-	if ((iMovingOldX >= 2) && (iMovingOldX <= 24))
+	switch (iHomeComputer)
 	{
-		if (arMovingRooms[iMovingOldX - 1][iMovingOldY] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iMovingOldX - 1]
-				[iMovingOldY]][2] = 0; /*** remove right ***/
-		}
+		case 1: iHCSwitch = 1; break;
+		case 2: iHCSwitch = 2; break;
+		case 3: iHCSwitch = 3; break;
+		default:
+			printf ("[FAILED] Strange iHomeComputer: %i!\n", iHomeComputer);
+			exit (EXIT_ERROR); break;
 	}
 
-	/*** right of removed ***/
-	if ((iMovingOldX >= 1) && (iMovingOldX <= 23))
+	if (DiskImageOpen (sPathFile) == 0)
 	{
-		if (arMovingRooms[iMovingOldX + 1][iMovingOldY] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iMovingOldX + 1]
-				[iMovingOldY]][1] = 0; /*** remove left ***/
-		}
+		printf ("[FAILED] Error opening %s: %s!\n",
+			sPathFile, strerror (errno));
+		exit (EXIT_ERROR);
 	}
 
-	/*** above removed ***/
-	if ((iMovingOldY >= 2) && (iMovingOldY <= 24))
+	/*** Prince HP. ***/
+	switch (iHCSwitch)
 	{
-		if (arMovingRooms[iMovingOldX][iMovingOldY - 1] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iMovingOldX]
-				[iMovingOldY - 1]][4] = 0; /*** remove below ***/
-		}
+		case 1: ulOffset = ulPrinceHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulPrinceHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulPrinceHPC[iDiskImageC]; break;
 	}
-
-	/*** below removed ***/
-	if ((iMovingOldY >= 1) && (iMovingOldY <= 23))
+	if (ulOffset != 0x00)
 	{
-		if (arMovingRooms[iMovingOldX][iMovingOldY + 1] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iMovingOldX]
-				[iMovingOldY + 1]][3] = 0; /*** remove above ***/
-		}
+		iEXEPrinceHP = DiskImageRead (ulOffset);
 	}
-}
-/*****************************************************************************/
-void AddNewRoom (int iX, int iY, int iRoom)
-/*****************************************************************************/
-{
-	arMovingRooms[iX][iY] = iRoom;
-
-	/* Change the links of the rooms around
-	 * the new room and the room itself.
-	 */
 
-	arRoomLinks[iCurLevel][iRoom][1] = 0;
-	arRoomLinks[iCurLevel][iRoom][2] = 0;
-	arRoomLinks[iCurLevel][iRoom][3] = 0;
-	arRoomLinks[iCurLevel][iRoom][4] = 0;
-
-	if ((iX >= 2) && (iX <= 24)) /*** left of added ***/
+	/*** Shadow HP. ***/
+	switch (iHCSwitch)
 	{
-		if (arMovingRooms[iX - 1][iY] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iX - 1]
-				[iY]][2] = iRoom; /*** add room right ***/
-			arRoomLinks[iCurLevel][iRoom][1] = arMovingRooms[iX - 1][iY];
-		}
+		case 1: ulOffset = ulShadowHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulShadowHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulShadowHPC[iDiskImageC]; break;
 	}
-
-	if ((iX >= 1) && (iX <= 23)) /*** right of added ***/
+	if (ulOffset != 0x00)
 	{
-		if (arMovingRooms[iX + 1][iY] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iX + 1]
-				[iY]][1] = iRoom; /*** add room left ***/
-			arRoomLinks[iCurLevel][iRoom][2] = arMovingRooms[iX + 1][iY];
-		}
+		iEXEShadowHP = DiskImageRead (ulOffset);
 	}
 
-	if ((iY >= 2) && (iY <= 24)) /*** above added ***/
+	/*** Chomper delay. ***/
+	switch (iHCSwitch)
 	{
-		if (arMovingRooms[iX][iY - 1] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iX]
-				[iY - 1]][4] = iRoom; /*** add room below ***/
-			arRoomLinks[iCurLevel][iRoom][3] = arMovingRooms[iX][iY - 1];
-		}
+		case 1: ulOffset = ulChomperDelayA[iDiskImageA]; break;
+		case 2: ulOffset = ulChomperDelayB[iDiskImageB]; break;
+		case 3: ulOffset = ulChomperDelayC[iDiskImageC]; break;
 	}
-
-	if ((iY >= 1) && (iY <= 23)) /*** below added ***/
+	if (ulOffset != 0x00)
 	{
-		if (arMovingRooms[iX][iY + 1] != 0)
-		{
-			arRoomLinks[iCurLevel][arMovingRooms[iX]
-				[iY + 1]][3] = iRoom; /*** add room above ***/
-			arRoomLinks[iCurLevel][iRoom][4] = arMovingRooms[iX][iY + 1];
-		}
+		iEXEChomperDelay = DiskImageRead (ulOffset);
 	}
 
-	PlaySound ("wav/move_room.wav");
-}
-/*****************************************************************************/
-void LinkPlus (void)
-/*****************************************************************************/
-{
-	int iCurrent, iNew;
-
-	iCurrent = arRoomLinks[iCurLevel][iChangingBrokenRoom][iChangingBrokenSide];
-	if (iCurrent == ROOMS) {
-		iNew = 0;
-	} else {
-		iNew = iCurrent + 1;
+	/*** Mouse delay. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulMouseDelayA[iDiskImageA]; break;
+		case 2: ulOffset = ulMouseDelayB[iDiskImageB]; break;
+		case 3: ulOffset = ulMouseDelayC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		iEXEMouseDelay = DiskImageRead (ulOffset);
 	}
-	arRoomLinks[iCurLevel][iChangingBrokenRoom][iChangingBrokenSide] = iNew;
-	iChanged++;
-	arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (0);
-	PlaySound ("wav/hum_adj.wav");
-}
-/*****************************************************************************/
-void ShowImage (SDL_Texture *img, int iX, int iY, char *sImageInfo)
-/*****************************************************************************/
-{
-	SDL_Rect dest;
-	SDL_Rect loc;
-	int iWidth, iHeight;
-	int iInfoC;
-	char arText[9 + 2][MAX_TEXT + 2];
-	char cXValue;
-	int iTileValue;
-	int iModValue;
-	int iGreen;
-	char sValueTile[MAX_OPTION + 2];
-	char sValueMod[MAX_OPTION + 2];
-	int iTileImg;
-
-	iInfoC = 0;
 
-	iGreen = 1;
-	if ((strncmp (sImageInfo, "tile=", 5) == 0) ||
-		(strncmp (sImageInfo, "high=", 5) == 0))
+	/*** Guard settings. ***/
+	for (iTab = 1; iTab <= TABS_GUARD; iTab++)
 	{
-		if (strncmp (sImageInfo, "tile=", 5) != 0) { iGreen = 2; }
-		snprintf (sValueTile, MAX_OPTION, "%c%c", sImageInfo[5], sImageInfo[6]);
-		iTileValue = (int)strtol (sValueTile, NULL, 16);
-		snprintf (sValueMod, MAX_OPTION, "%c%c", sImageInfo[8], sImageInfo[9]);
-		iModValue = (int)strtol (sValueMod, NULL, 16);
-		if (iTileValue >= 32)
-		{
-			iTileValue-=32;
-			cXValue = 'Y';
-		} else {
-			cXValue = 'N';
-		}
-		iTileImg = iTileValue;
-		if (iTileImg == 0x0B)
+		switch (iHCSwitch)
 		{
-			if (cXValue == 'Y') { iTileImg+=32; }
+			case 1: ulOffset = ulGuardA[iDiskImageA][iTab - 1]; break;
+			case 2: ulOffset = ulGuardB[iDiskImageB][iTab - 1]; break;
+			case 3: ulOffset = ulGuardC[iDiskImageC][iTab - 1]; break;
 		}
-		if (imgd[iTileImg][iModValue][1] == NULL)
+		if (ulOffset != 0x00)
 		{
-			img = imgunk[iGreen];
-		} else {
-			switch (cCurType)
+			for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
 			{
-				case 'd': img = imgd[iTileImg][iModValue][iGreen]; break;
-				case 'p': img = imgp[iTileImg][iModValue][iGreen]; break;
+				iEXEGuard[iTab][iSkillLoop] =
+					DiskImageRead (ulOffset + iSkillLoop - 1);
 			}
 		}
-	} else {
-		iTileValue = -1;
-		iModValue = -1;
-		iTileImg = -1;
-		cXValue = 'N';
 	}
 
-	if (iInfo == 1)
+	/*** Guard HP. ***/
+	switch (iHCSwitch)
 	{
-		snprintf (arText[0], MAX_TEXT, "%c%02X/%02X",
-			cXValue, iTileValue, iModValue);
+		case 1: ulOffset = ulGuardHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardHPC[iDiskImageC]; break;
 	}
-
-	switch (iTileValue)
+	if (ulOffset != 0x00)
 	{
-		case 0x0F: /*** raise ***/
-			switch (cCurType)
-			{
-				case 'd': img = imgd[0x0F][0x00][iGreen]; break;
-				case 'p': img = imgp[0x0F][0x00][iGreen]; break;
-			}
-			if (iInfo != 1)
-				{ snprintf (arText[0], MAX_TEXT, "E:%i", iModValue + 1); }
-			iInfoC = 1;
-			break;
-		case 0x06: /*** drop ***/
-			switch (cCurType)
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+		{
+			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
 			{
-				case 'd': img = imgd[0x06][0x00][iGreen]; break;
-				case 'p': img = imgp[0x06][0x00][iGreen]; break;
+				iEXEGuardHP[iTab - 1] = DiskImageRead (ulOffset + iTab - 1);
 			}
-			if (iInfo != 1)
-				{ snprintf (arText[0], MAX_TEXT, "E:%i", iModValue + 1); }
-			iInfoC = 1;
-			break;
+		}
 	}
 
-	/*** Custom tile. ***/
-	if ((iInfoC == 0) && (imgd[iTileImg][iModValue][1] == NULL))
+	/*** Guard uniform. ***/
+	switch (iHCSwitch)
 	{
-		snprintf (arText[0], MAX_TEXT, "%c%02X/%02X",
-			cXValue, iTileValue, iModValue);
-		iInfoC = 1;
+		case 1: ulOffset = ulGuardUniformA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardUniformB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardUniformC[iDiskImageC]; break;
 	}
-
-	if ((iNoAnim == 0) && (iGreen == 1) &&
-		(iTileValue == 0x13) && (iModValue == 0x00))
+	if (ulOffset != 0x00)
 	{
-		switch (cCurType)
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
 		{
-			case 'd': img = imgspriteflamed; break;
-			case 'p': img = imgspriteflamep; break;
+			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
+			{
+				iEXEGuardU[iTab - 1] = DiskImageRead (ulOffset + iTab - 1);
+			}
 		}
 	}
-	SDL_QueryTexture (img, NULL, NULL, &iWidth, &iHeight);
-	loc.x = 0;
-	loc.y = 0;
-	loc.w = iWidth;
-	loc.h = iHeight;
-	dest.x = iX;
-	dest.y = iY;
-	dest.w = iWidth;
-	dest.h = iHeight;
-	/*** This is for the game animation. ***/
-	if (iNoAnim == 0)
+
+	/*** Guard sprite. ***/
+	switch (iHCSwitch)
 	{
-		if (newticks > oldticks + REFRESH_GAME)
+		case 1: ulOffset = ulGuardSpriteA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardSpriteB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardSpriteC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
 		{
-			/*** 1-9 ***/
-			iFlameFrame = 1 + (int) (9.0 * rand() / (RAND_MAX + 1.0));
+			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
+			{
+				iEXEGuardS[iTab - 1] = DiskImageRead (ulOffset + iTab - 1);
+			}
 		}
-		if (iGreen == 1)
+	} else {
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
 		{
-			if ((iTileValue == 0x13) && (iModValue == 0x00))
+			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
 			{
-				loc.x = (iFlameFrame - 1) * 117;
-				loc.w = loc.w / 9;
-				dest.w = dest.w / 9;
+				iEXEGuardS[iTab - 1] = arDefaultGuardS[iTab - 1];
 			}
 		}
 	}
-	CustomRenderCopy (img, &loc, &dest, sImageInfo);
-
-	/*** Info ("i"). ***/
-	if ((iTileValue != -1) && ((iInfo == 1) || (iInfoC == 1)))
-	{
-		DisplayText (dest.x, dest.y + 136 - FONT_SIZE_11,
-			FONT_SIZE_11, arText, 1, font2);
-	}
-}
-/*****************************************************************************/
-void CustomRenderCopy (SDL_Texture* src, SDL_Rect* srcrect,
-	SDL_Rect *dstrect, char *sImageInfo)
-/*****************************************************************************/
-{
-	SDL_Rect stuff;
-
-	stuff.x = dstrect->x * iScale;
-	stuff.y = dstrect->y * iScale;
-	if (srcrect != NULL) /*** image ***/
-	{
-		stuff.w = dstrect->w * iScale;
-		stuff.h = dstrect->h * iScale;
-	} else { /*** font ***/
-		stuff.w = dstrect->w;
-		stuff.h = dstrect->h;
-	}
-	if (SDL_RenderCopy (ascreen, src, srcrect, &stuff) != 0)
-	{
-		printf ("[ WARN ] SDL_RenderCopy (%s): %s!\n",
-			sImageInfo, SDL_GetError());
-	}
-}
-/*****************************************************************************/
-void CreateBAK (void)
-/*****************************************************************************/
-{
-	FILE *fDAT;
-	FILE *fBAK;
-	int iData;
-
-	fDAT = fopen (sPathFile, "rb");
-	if (fDAT == NULL)
-		{ printf ("[FAILED] Could not open %s: %s!\n",
-			sPathFile, strerror (errno)); }
-
-	switch (iHomeComputer)
-	{
-		case 1: fBAK = fopen (BACKUP_A, "wb"); break;
-		case 2: fBAK = fopen (BACKUP_B, "wb"); break;
-		case 3: fBAK = fopen (BACKUP_C, "wb"); break;
-		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
-	}
-	if (fBAK == NULL)
-		{ printf ("[FAILED] Could not open backup: %s!\n", strerror (errno)); }
 
-	while (1)
+	/*** Env. 1 ***/
+	switch (iHCSwitch)
 	{
-		iData = fgetc (fDAT);
-		if (iData == EOF) { break; }
-			else { putc (iData, fBAK); }
+		case 1: ulOffset = ulEnv1A[iDiskImageA]; break;
+		case 2: ulOffset = ulEnv1B[iDiskImageB]; break;
+		case 3: ulOffset = ulEnv1C[iDiskImageC]; break;
 	}
-
-	fclose (fDAT);
-	fclose (fBAK);
-}
-/*****************************************************************************/
-void DisplayText (int iStartX, int iStartY, int iFontSize,
-	char arText[9 + 2][MAX_TEXT + 2], int iLines, TTF_Font *font)
-/*****************************************************************************/
-{
-	int iTemp;
-
-	for (iTemp = 0; iTemp <= (iLines - 1); iTemp++)
+	if (ulOffset != 0x00)
 	{
-		if (strcmp (arText[iTemp], "") != 0)
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
 		{
-			message = TTF_RenderText_Shaded (font,
-				arText[iTemp], color_bl, color_wh);
-			messaget = SDL_CreateTextureFromSurface (ascreen, message);
-			if ((strcmp (arText[iTemp], "single tile (change or select)") == 0) ||
-				(strcmp (arText[iTemp], "entire room (clear or fill)") == 0) ||
-				(strcmp (arText[iTemp], "entire level (randomize or fill)") == 0))
-			{
-				offset.x = iStartX + 20;
-			} else {
-				offset.x = iStartX;
-			}
-			offset.y = iStartY + (iTemp * (iFontSize + 4));
-			offset.w = message->w; offset.h = message->h;
-			CustomRenderCopy (messaget, NULL, &offset, "message");
-			SDL_DestroyTexture (messaget); SDL_FreeSurface (message);
+			iEXEEnv1[iTab - 1] = DiskImageRead (ulOffset + iTab - 1);
+		}
+	} else {
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+		{
+			iEXEEnv1[iTab - 1] = arDefaultEnv1[iTab - 1];
 		}
 	}
-}
-/*****************************************************************************/
-void InitRooms (void)
-/*****************************************************************************/
-{
-	int iRoomLoop;
-	int iRoomLoop2;
 
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS + 1; iRoomLoop++) /*** x ***/
+	/*** Env. 2 ***/
+	switch (iHCSwitch)
 	{
-		for (iRoomLoop2 = 1; iRoomLoop2 <= ROOMS; iRoomLoop2++) /*** y ***/
+		case 1: ulOffset = ulEnv2A[iDiskImageA]; break;
+		case 2: ulOffset = ulEnv2B[iDiskImageB]; break;
+		case 3: ulOffset = ulEnv2C[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
 		{
-			arMovingRooms[iRoomLoop][iRoomLoop2] = 0;
+			iEXEEnv2[iTab - 1] = DiskImageRead (ulOffset + iTab - 1);
+		}
+	} else {
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+		{
+			iEXEEnv2[iTab - 1] = arDefaultEnv2[iTab - 1];
 		}
 	}
 }
 /*****************************************************************************/
-void WhereToStart (void)
+void EXESave (void)
 /*****************************************************************************/
 {
-	int iRoomLoop;
+	unsigned char sToWrite[MAX_TOWRITE + 2];
+	int iTab;
+	int iHCSwitch;
+	unsigned long ulOffset;
 
-	iMinX = 0;
-	iMaxX = 0;
-	iMinY = 0;
-	iMaxY = 0;
+	/*** Used for looping. ***/
+	int iSkillLoop;
 
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	switch (iHomeComputer)
 	{
-		arDone[iRoomLoop] = 0;
+		case 1: iHCSwitch = 1; break;
+		case 2: iHCSwitch = 2; break;
+		case 3: iHCSwitch = 3; break;
+		default:
+			printf ("[FAILED] Strange iHomeComputer: %i!\n", iHomeComputer);
+			exit (EXIT_ERROR); break;
 	}
-	CheckSides (arStartLocation[iCurLevel][1], 0, 0);
-
-	iStartRoomsX = round (12 - (((float)iMinX + (float)iMaxX) / 2));
-	iStartRoomsY = round (12 - (((float)iMinY + (float)iMaxY) / 2));
-}
-/*****************************************************************************/
-void CheckSides (int iRoom, int iX, int iY)
-/*****************************************************************************/
-{
-	if (iX < iMinX) { iMinX = iX; }
-	if (iY < iMinY) { iMinY = iY; }
-	if (iX > iMaxX) { iMaxX = iX; }
-	if (iY > iMaxY) { iMaxY = iY; }
 
-	arDone[iRoom] = 1;
+	BackupVersion();
 
-	if ((arRoomLinks[iCurLevel][iRoom][1] != 0) &&
-		(arDone[arRoomLinks[iCurLevel][iRoom][1]] != 1))
-		{ CheckSides (arRoomLinks[iCurLevel][iRoom][1], iX - 1, iY); }
+	/*** Nothing is written before JournalCommit(). ***/
+	JournalStart();
 
-	if ((arRoomLinks[iCurLevel][iRoom][2] != 0) &&
-		(arDone[arRoomLinks[iCurLevel][iRoom][2]] != 1))
-		{ CheckSides (arRoomLinks[iCurLevel][iRoom][2], iX + 1, iY); }
+	/*** Prince HP. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulPrinceHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulPrinceHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulPrinceHPC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		sToWrite[0] = iEXEPrinceHP;
+		JournalAdd (ulOffset, sToWrite, 1);
+	}
 
-	if ((arRoomLinks[iCurLevel][iRoom][3] != 0) &&
-		(arDone[arRoomLinks[iCurLevel][iRoom][3]] != 1))
-		{ CheckSides (arRoomLinks[iCurLevel][iRoom][3], iX, iY - 1); }
+	/*** Shadow HP. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulShadowHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulShadowHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulShadowHPC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		sToWrite[0] = iEXEShadowHP;
+		JournalAdd (ulOffset, sToWrite, 1);
+	}
 
-	if ((arRoomLinks[iCurLevel][iRoom][4] != 0) &&
-		(arDone[arRoomLinks[iCurLevel][iRoom][4]] != 1))
-		{ CheckSides (arRoomLinks[iCurLevel][iRoom][4], iX, iY + 1); }
-}
-/*****************************************************************************/
-void ShowRooms (int iRoom, int iX, int iY, int iNext)
-/*****************************************************************************/
-{
-	int iShowX, iShowY;
+	/*** Chomper delay. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulChomperDelayA[iDiskImageA]; break;
+		case 2: ulOffset = ulChomperDelayB[iDiskImageB]; break;
+		case 3: ulOffset = ulChomperDelayC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		sToWrite[0] = iEXEChomperDelay;
+		JournalAdd (ulOffset, sToWrite, 1);
+	}
 
-	if (iX == 25) /*** side pane ***/
+	/*** Mouse delay. ***/
+	switch (iHCSwitch)
 	{
-		iShowX = 189;
-	} else {
-		iShowX = 199 + (iX * 15); /*** grid, 24x24 ***/
+		case 1: ulOffset = ulMouseDelayA[iDiskImageA]; break;
+		case 2: ulOffset = ulMouseDelayB[iDiskImageB]; break;
+		case 3: ulOffset = ulMouseDelayC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		sToWrite[0] = iEXEMouseDelay;
+		JournalAdd (ulOffset, sToWrite, 1);
 	}
-	iShowY = 49 + (iY * 15); /*** grid, 24x24 & pane ***/
 
-	if (iRoom != -1)
+	/*** Guard settings. ***/
+	for (iTab = 1; iTab <= TABS_GUARD; iTab++)
 	{
-		ShowImage (imgroom[iRoom], iShowX, iShowY, "imgroom[...]");
-		arMovingRooms[iX][iY] = iRoom; /*** save room location ***/
-		if (iCurRoom == iRoom)
-		{
-			ShowImage (imgsrc, iShowX, iShowY, "imgsrc"); /*** green stripes ***/
-		}
-		if (arStartLocation[iCurLevel][1] == iRoom)
+		switch (iHCSwitch)
 		{
-			ShowImage (imgsrs, iShowX, iShowY, "imgsrs"); /*** blue border ***/
+			case 1: ulOffset = ulGuardA[iDiskImageA][iTab - 1]; break;
+			case 2: ulOffset = ulGuardB[iDiskImageB][iTab - 1]; break;
+			case 3: ulOffset = ulGuardC[iDiskImageC][iTab - 1]; break;
 		}
-		if (iMovingRoom == iRoom)
+		if (ulOffset != 0x00)
 		{
-			ShowImage (imgsrm, iShowX, iShowY, "imgsrm"); /*** red stripes ***/
+			for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
+				{ sToWrite[iSkillLoop - 1] = iEXEGuard[iTab][iSkillLoop]; }
+			JournalAdd (ulOffset, sToWrite, 12);
 		}
-	} else {
-		ShowImage (imgsrp, iShowX, iShowY, "imgsrp"); /*** white cross ***/
 	}
-	if (iRoom == iMovingRoom)
+
+	/*** Guard HP. ***/
+	switch (iHCSwitch)
 	{
-		iMovingOldX = iX;
-		iMovingOldY = iY;
-		if (iMovingNewBusy == 0)
-		{
-			iMovingNewX = iMovingOldX;
-			iMovingNewY = iMovingOldY;
-			iMovingNewBusy = 1;
-		}
+		case 1: ulOffset = ulGuardHPA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardHPB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardHPC[iDiskImageC]; break;
 	}
-
-	arDone[iRoom] = 1;
-
-	if (iNext == 1)
+	if (ulOffset != 0x00)
 	{
-		if ((arRoomLinks[iCurLevel][iRoom][1] != 0) &&
-			(arDone[arRoomLinks[iCurLevel][iRoom][1]] != 1))
-			{ ShowRooms (arRoomLinks[iCurLevel][iRoom][1], iX - 1, iY, 1); }
-
-		if ((arRoomLinks[iCurLevel][iRoom][2] != 0) &&
-			(arDone[arRoomLinks[iCurLevel][iRoom][2]] != 1))
-			{ ShowRooms (arRoomLinks[iCurLevel][iRoom][2], iX + 1, iY, 1); }
+		/*** Level 14 has no guards. ***/
+		for (iTab = 1; iTab < TABS_LEVEL; iTab++)
+			{ sToWrite[iTab - 1] = iEXEGuardHP[iTab - 1]; }
+		JournalAdd (ulOffset, sToWrite, TABS_LEVEL - 1);
+	}
 
-		if ((arRoomLinks[iCurLevel][iRoom][3] != 0) &&
-			(arDone[arRoomLinks[iCurLevel][iRoom][3]] != 1))
-			{ ShowRooms (arRoomLinks[iCurLevel][iRoom][3], iX, iY - 1, 1); }
+	/*** Guard uniform. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulGuardUniformA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardUniformB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardUniformC[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		/*** Level 14 has no guards. ***/
+		for (iTab = 1; iTab < TABS_LEVEL; iTab++)
+			{ sToWrite[iTab - 1] = iEXEGuardU[iTab - 1]; }
+		JournalAdd (ulOffset, sToWrite, TABS_LEVEL - 1);
+	}
 
-		if ((arRoomLinks[iCurLevel][iRoom][4] != 0) &&
-			(arDone[arRoomLinks[iCurLevel][iRoom][4]] != 1))
-			{ ShowRooms (arRoomLinks[iCurLevel][iRoom][4], iX, iY + 1, 1); }
+	/*** Guard sprite. ***/
+	switch (iHCSwitch)
+	{
+		case 1: ulOffset = ulGuardSpriteA[iDiskImageA]; break;
+		case 2: ulOffset = ulGuardSpriteB[iDiskImageB]; break;
+		case 3: ulOffset = ulGuardSpriteC[iDiskImageC]; break;
 	}
-}
-/*****************************************************************************/
-void BrokenRoomChange (int iRoom, int iSide, int *iX, int *iY)
-/*****************************************************************************/
-{
-	switch (iSide)
+	if (ulOffset != 0x00)
 	{
-		case 0:
-			*iX = BROKEN_ROOM_X;
-			*iY = BROKEN_ROOM_Y;
-			break;
-		case 1:
-			*iX = BROKEN_LEFT_X;
-			*iY = BROKEN_LEFT_Y;
-			break;
-		case 2:
-			*iX = BROKEN_RIGHT_X;
-			*iY = BROKEN_RIGHT_Y;
-			break;
-		case 3:
-			*iX = BROKEN_UP_X;
-			*iY = BROKEN_UP_Y;
-			break;
-		case 4:
-			*iX = BROKEN_DOWN_X;
-			*iY = BROKEN_DOWN_Y;
-			break;
+		/*** Level 14 has no guards. ***/
+		for (iTab = 1; iTab < TABS_LEVEL; iTab++)
+			{ sToWrite[iTab - 1] = iEXEGuardS[iTab - 1]; }
+		JournalAdd (ulOffset, sToWrite, TABS_LEVEL - 1);
 	}
 
-	switch (iRoom)
+	/*** Update iCurGuard if necessary. ***/
+	if (iCurGuard != iEXEGuardS[iCurLevel])
+		{ iCurGuard = iEXEGuardS[iCurLevel]; }
+
+	/*** Env. 1 ***/
+	switch (iHCSwitch)
 	{
-		case 1: *iX += (63 * 0); *iY += (63 * 0); break;
-		case 2: *iX += (63 * 1); *iY += (63 * 0); break;
-		case 3: *iX += (63 * 2); *iY += (63 * 0); break;
-		case 4: *iX += (63 * 3); *iY += (63 * 0); break;
-		case 5: *iX += (63 * 0); *iY += (63 * 1); break;
-		case 6: *iX += (63 * 1); *iY += (63 * 1); break;
-		case 7: *iX += (63 * 2); *iY += (63 * 1); break;
-		case 8: *iX += (63 * 3); *iY += (63 * 1); break;
-		case 9: *iX += (63 * 0); *iY += (63 * 2); break;
-		case 10: *iX += (63 * 1); *iY += (63 * 2); break;
-		case 11: *iX += (63 * 2); *iY += (63 * 2); break;
-		case 12: *iX += (63 * 3); *iY += (63 * 2); break;
-		case 13: *iX += (63 * 0); *iY += (63 * 3); break;
-		case 14: *iX += (63 * 1); *iY += (63 * 3); break;
-		case 15: *iX += (63 * 2); *iY += (63 * 3); break;
-		case 16: *iX += (63 * 3); *iY += (63 * 3); break;
-		case 17: *iX += (63 * 0); *iY += (63 * 4); break;
-		case 18: *iX += (63 * 1); *iY += (63 * 4); break;
-		case 19: *iX += (63 * 2); *iY += (63 * 4); break;
-		case 20: *iX += (63 * 3); *iY += (63 * 4); break;
-		case 21: *iX += (63 * 0); *iY += (63 * 5); break;
-		case 22: *iX += (63 * 1); *iY += (63 * 5); break;
-		case 23: *iX += (63 * 2); *iY += (63 * 5); break;
-		case 24: *iX += (63 * 3); *iY += (63 * 5); break;
+		case 1: ulOffset = ulEnv1A[iDiskImageA]; break;
+		case 2: ulOffset = ulEnv1B[iDiskImageB]; break;
+		case 3: ulOffset = ulEnv1C[iDiskImageC]; break;
+	}
+	if (ulOffset != 0x00)
+	{
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+			{ sToWrite[iTab - 1] = iEXEEnv1[iTab - 1]; }
+		JournalAdd (ulOffset, sToWrite, TABS_LEVEL);
 	}
-}
-/*****************************************************************************/
-void ShowChange (void)
-/*****************************************************************************/
-{
-	int iX, iY;
-	int iOldTile, iOldM;
-	int iGetTile, iGetMod;
 
-	/*** background ***/
-	switch (cCurType)
+	/*** Env. 2 ***/
+	switch (iHCSwitch)
 	{
-		case 'd': ShowImage (imgdungeon, 0, 0, "imgdungeon"); break;
-		case 'p': ShowImage (imgpalace, 0, 0, "imgpalace"); break;
+		case 1: ulOffset = ulEnv2A[iDiskImageA]; break;
+		case 2: ulOffset = ulEnv2B[iDiskImageB]; break;
+		case 3: ulOffset = ulEnv2C[iDiskImageC]; break;
 	}
-
-	/*** close button ***/
-	switch (iCloseOn)
+	if (ulOffset != 0x00)
 	{
-		case 0: /*** off ***/
-			ShowImage (imgclosebig_0, 576, 0, "imgclosebig_0"); break;
-		case 1: /*** on ***/
-			ShowImage (imgclosebig_1, 576, 0, "imgclosebig_1"); break;
+		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+			{ sToWrite[iTab - 1] = iEXEEnv2[iTab - 1]; }
+		JournalAdd (ulOffset, sToWrite, TABS_LEVEL);
 	}
 
-	DisableSome();
+	/*** Update cCurType if necessary. ***/
+	if ((iEXEEnv1[iCurLevel] == 0x01) && (iEXEEnv2[iCurLevel] == 0x01) &&
+		(cCurType == 'd')) { cCurType = 'p'; }
+	if ((iEXEEnv1[iCurLevel] == 0x02) && (iEXEEnv2[iCurLevel] == 0x02) &&
+		(cCurType == 'p')) { cCurType = 'd'; }
 
-	/*** old tile ***/
-	iOldTile = arRoomTiles[iCurLevel][iCurRoom][iSelected];
-	if (iOldTile == 0x0B)
-	{
-		if (arRoomX[iCurLevel][iCurRoom][iSelected] == 1)
-			{ iOldTile+=32; }
-	}
-	iOldM = arRoomMod[iCurLevel][iCurRoom][iSelected];
-	if ((iOldTile == 0x06) || (iOldTile == 0x0F)) /*** drop or raise ***/
-		{ iChangeEvent = iOldM + 1; }
-	iX = -1; iY = -1;
+	JournalCommit();
 
-	/*** Row 1. ***/
-	if ((iOldTile == 0x00) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX1; }
-	if ((iOldTile == 0x00) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX2; }
-	if ((iOldTile == 0x00) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX3; }
-	if ((iOldTile == 0x00) && (iOldM == 0x03)) { iY = TILESY1; iX = TILESX4; }
-	if ((iOldTile == 0x00) && (iOldM == 0xFF)) { iY = TILESY1; iX = TILESX5; }
-	if ((iOldTile == 0x01) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX6; }
-	if ((iOldTile == 0x01) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX7; }
-	if ((iOldTile == 0x01) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX8; }
-	if ((iOldTile == 0x01) && (iOldM == 0x03)) { iY = TILESY1; iX = TILESX9; }
-	if ((iOldTile == 0x01) && (iOldM == 0xFF)) { iY = TILESY1; iX = TILESX10; }
-	if ((iOldTile == 0x02) && (iOldM == 0x00)) { iY = TILESY1; iX = TILESX11; }
-	if ((iOldTile == 0x02) && (iOldM == 0x01)) { iY = TILESY1; iX = TILESX12; }
-	if ((iOldTile == 0x02) && (iOldM == 0x02)) { iY = TILESY1; iX = TILESX13; }
+	/*** The next reader maps the file again, including these bytes. ***/
+	DiskImageClose();
 
-	/*** Row 2. ***/
-	if ((iOldTile == 0x02) && (iOldM == 0x03)) { iY = TILESY2; iX = TILESX1; }
-	if ((iOldTile == 0x02) && (iOldM == 0x04)) { iY = TILESY2; iX = TILESX2; }
-	if ((iOldTile == 0x02) && (iOldM == 0x05)) { iY = TILESY2; iX = TILESX3; }
-	if ((iOldTile == 0x02) && (iOldM == 0x06)) { iY = TILESY2; iX = TILESX4; }
-	if ((iOldTile == 0x02) && (iOldM == 0x07)) { iY = TILESY2; iX = TILESX5; }
-	if ((iOldTile == 0x02) && (iOldM == 0x08)) { iY = TILESY2; iX = TILESX6; }
-	if ((iOldTile == 0x02) && (iOldM == 0x09)) { iY = TILESY2; iX = TILESX7; }
-	if ((iOldTile == 0x03) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX8; }
-	if ((iOldTile == 0x04) && (iOldM == 0x02)) { iY = TILESY2; iX = TILESX9; }
-	if ((iOldTile == 0x04) && (iOldM == 0x01)) { iY = TILESY2; iX = TILESX10; }
-	if ((iOldTile == 0x05) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX11; }
-	if (iOldTile == 0x06) { iY = TILESY2; iX = TILESX12; }
-	if ((iOldTile == 0x07) && (iOldM == 0x00)) { iY = TILESY2; iX = TILESX13; }
+	PlaySound ("wav/save.wav");
+}
+/*****************************************************************************/
+int PlusMinus (int *iWhat, int iX, int iY,
+	int iMin, int iMax, int iChange, int iAddChanged)
+/*****************************************************************************/
+{
+	if ((InArea (iX, iY, iX + 13, iY + 20) == 1) &&
+		(((iChange < 0) && (*iWhat > iMin)) ||
+		((iChange > 0) && (*iWhat < iMax))))
+	{
+		*iWhat = *iWhat + iChange;
+		if ((iChange < 0) && (*iWhat < iMin)) { *iWhat = iMin; }
+		if ((iChange > 0) && (*iWhat > iMax)) { *iWhat = iMax; }
+		if (iAddChanged == 1) { LevelChanged(); }
+		PlaySound ("wav/plus_minus.wav");
+		return (1);
+	} else { return (0); }
+}
+/*****************************************************************************/
+void GetOptionValue (char *sArgv, char *sValue)
+/*****************************************************************************/
+{
+	int iTemp;
+	char sTemp[MAX_OPTION + 2];
 
-	/*** Row 3. ***/
-	if ((iOldTile == 0x07) && (iOldM == 0x01)) { iY = TILESY3; iX = TILESX1; }
-	if ((iOldTile == 0x07) && (iOldM == 0x02)) { iY = TILESY3; iX = TILESX2; }
-	if ((iOldTile == 0x07) && (iOldM == 0x03)) { iY = TILESY3; iX = TILESX3; }
-	if ((iOldTile == 0x08) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX4; }
-	if ((iOldTile == 0x09) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX5; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX6; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x01)) { iY = TILESY3; iX = TILESX7; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x02)) { iY = TILESY3; iX = TILESX8; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x03)) { iY = TILESY3; iX = TILESX9; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x04)) { iY = TILESY3; iX = TILESX10; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x05)) { iY = TILESY3; iX = TILESX11; }
-	if ((iOldTile == 0x0A) && (iOldM == 0x06)) { iY = TILESY3; iX = TILESX12; }
-	if ((iOldTile == 0x0B) && (iOldM == 0x00)) { iY = TILESY3; iX = TILESX13; }
+	iTemp = strlen (sArgv) - 1;
+	snprintf (sValue, MAX_OPTION, "%s", "");
+	while (sArgv[iTemp] != '=')
+	{
+		snprintf (sTemp, MAX_OPTION, "%c%s", sArgv[iTemp], sValue);
+		snprintf (sValue, MAX_OPTION, "%s", sTemp);
+		iTemp--;
+	}
+}
+/*****************************************************************************/
+void BytesToEvent (int iLevel, int iEvent,
+	unsigned char cFDoors, unsigned char cSDoors)
+/*****************************************************************************/
+{
+	/* An event is stored in two bytes:
+	 * FDoors: !next (1 bit), room (low 2 bits), tile - 1 (5 bits)
+	 * SDoors: room (high 3 bits), timer (5 bits)
+	 */
 
-	/*** Row 4. ***/
-	if ((iOldTile == 0x0C) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX1; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x01)) { iY = TILESY4; iX = TILESX2; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x02)) { iY = TILESY4; iX = TILESX3; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x03)) { iY = TILESY4; iX = TILESX4; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x04)) { iY = TILESY4; iX = TILESX5; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x05)) { iY = TILESY4; iX = TILESX6; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x06)) { iY = TILESY4; iX = TILESX7; }
-	if ((iOldTile == 0x0C) && (iOldM == 0x07)) { iY = TILESY4; iX = TILESX8; }
-	if ((iOldTile == 0x0D) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX9; }
-	if ((iOldTile == 0x0E) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX10; }
-	if (iOldTile == 0x0F) { iY = TILESY4; iX = TILESX11; }
-	if ((iOldTile == 0x10) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX12; }
-	if ((iOldTile == 0x11) && (iOldM == 0x00)) { iY = TILESY4; iX = TILESX13; }
+	arLevels[iLevel].arEvent[iEvent].cRoom = ((cSDoors >> 3) & 0x1C) |
+		((cFDoors >> 5) & 0x03);
+	arLevels[iLevel].arEvent[iEvent].cTile = (cFDoors & 0x1F) + 1;
+	arLevels[iLevel].arEvent[iEvent].cNext = (cFDoors & 0x80) ? 0 : 1;
+	arLevels[iLevel].arEvent[iEvent].cTimer = cSDoors & 0x1F;
+}
+/*****************************************************************************/
+void EventToBytes (int iLevel, int iEvent,
+	unsigned char *cFDoors, unsigned char *cSDoors)
+/*****************************************************************************/
+{
+	/*** The reverse of BytesToEvent(). ***/
 
-	/*** Row 5. ***/
-	if ((iOldTile == 0x12) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX1; }
-	if ((iOldTile == 0x12) && (iOldM == 0x01)) { iY = TILESY5; iX = TILESX2; }
-	if ((iOldTile == 0x12) && (iOldM == 0x02)) { iY = TILESY5; iX = TILESX3; }
-	if ((iOldTile == 0x12) && (iOldM == 0x03)) { iY = TILESY5; iX = TILESX4; }
-	if ((iOldTile == 0x12) && (iOldM == 0x04)) { iY = TILESY5; iX = TILESX5; }
-	if ((iOldTile == 0x12) && (iOldM == 0x05)) { iY = TILESY5; iX = TILESX6; }
-	if ((iOldTile == 0x13) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX7; }
-	if ((iOldTile == 0x14) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX8; }
-	if ((iOldTile == 0x14) && (iOldM == 0x01)) { iY = TILESY5; iX = TILESX9; }
-	if ((iOldTile == 0x15) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX10; }
-	if ((iOldTile == 0x16) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX11; }
-	if ((iOldTile == 0x17) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX12; }
-	if ((iOldTile == 0x18) && (iOldM == 0x00)) { iY = TILESY5; iX = TILESX13; }
+	*cFDoors = ((arLevels[iLevel].arEvent[iEvent].cRoom & 0x03) << 5) |
+		((arLevels[iLevel].arEvent[iEvent].cTile - 1) & 0x1F);
+	if (arLevels[iLevel].arEvent[iEvent].cNext == 0) { *cFDoors|=0x80; }
+	*cSDoors = ((arLevels[iLevel].arEvent[iEvent].cRoom & 0x1C) << 3) |
+		(arLevels[iLevel].arEvent[iEvent].cTimer & 0x1F);
+}
+/*****************************************************************************/
+int LevelToBytes (int iLevel, unsigned char *sBytes)
+/*****************************************************************************/
+{
+	/* Encodes level iLevel into the LEVEL_SIZE bytes of sBytes, including
+	 * the checksum (the last byte), which is also returned.
+	 */
 
-	/*** Row 6. ***/
-	if ((iOldTile == 0x19) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX1; }
-	if ((iOldTile == 0x1A) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX2; }
-	if ((iOldTile == 0x1B) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX3; }
-	if ((iOldTile == 0x1C) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX4; }
-	if ((iOldTile == 0x1D) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX5; }
-	if ((iOldTile == 0x1E) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX6; }
-	if ((iOldTile == 0x2B) && (iOldM == 0x00)) { iY = TILESY6; iX = TILESX7; }
-	if ((iOldTile == 0x12) && (iOldM == 0x80)) { iY = TILESY6; iX = TILESX8; }
-	if ((iOldTile == 0x12) && (iOldM == 0x81)) { iY = TILESY6; iX = TILESX9; }
-	if ((iOldTile == 0x12) && (iOldM == 0x82)) { iY = TILESY6; iX = TILESX10; }
-	if ((iOldTile == 0x12) && (iOldM == 0x83)) { iY = TILESY6; iX = TILESX11; }
-	if ((iOldTile == 0x12) && (iOldM == 0x84)) { iY = TILESY6; iX = TILESX12; }
-	if ((iOldTile == 0x12) && (iOldM == 0x85)) { iY = TILESY6; iX = TILESX13; }
+	unsigned long ulSum;
+	int iByte;
+	int iSC;
+	unsigned char cStartDir;
 
-	if ((iX != -1) && (iY != -1))
-	{
-		ShowImage (imgborderbl, iX, iY, "imgborderbl");
-	}
+	/*** Used for looping. ***/
+	int iRoomLoop;
+	int iTileLoop;
+	int iSideLoop;
+	int iByteLoop;
 
-	/*** prince ***/
-	if ((iCurRoom == arStartLocation[iCurLevel][1]) &&
-		(iSelected == arStartLocation[iCurLevel][2]))
+	iByte = 0;
+
+	/*** Tiles. ***/
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
 	{
-		switch (arStartLocation[iCurLevel][3])
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
 		{
-			case 0x00: /*** r ***/
-				ShowImage (imgbordersl, 0, 326, "imgbordersl"); break;
-			case 0xFF: /*** l ***/
-				ShowImage (imgbordersl, 22, 326, "imgbordersl"); break;
+			sBytes[iByte] = arLevels[iLevel].arRoom[iRoomLoop].arTile[iTileLoop];
+			iByte++;
 		}
 	}
 
-	/*** guard ***/
-	if (iSelected == arGuardTile[iCurLevel][iCurRoom])
+	/*** Mods. ***/
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
 	{
-		iGuardType = arGuardSkill[iCurLevel][iCurRoom];
-		iY = 326;
-		switch (arGuardDir[iCurLevel][iCurRoom])
+		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
 		{
-			case 0x00: /*** r ***/
-				switch (iCurGuard)
-				{
-					case 0x01: iX = 88; break; /*** skeleton ***/
-					case 0x03: iX = 132; break; /*** fat ***/
-					case 0x04: iX = 176; break; /*** shadow ***/
-					case 0x05: iX = 220; break; /*** Jaffar ***/
-					default: iX = 44; break; /*** guard; 0x00 and 0x02 ***/
-				}
-				break;
-			case 0xFF: /*** l ***/
-				switch (iCurGuard)
-				{
-					case 0x01: iX = 110; break; /*** skeleton ***/
-					case 0x03: iX = 154; break; /*** fat ***/
-					case 0x04: iX = 198; break; /*** shadow ***/
-					case 0x05: iX = 242; break; /*** Jaffar ***/
-					default: iX = 66; break; /*** guard; 0x00 and 0x02 ***/
-				}
-				break;
+			sBytes[iByte++] = arLevels[iLevel].arRoom[iRoomLoop].arMod[iTileLoop];
 		}
-		ShowImage (imgbordersl, iX, iY, "imgbordersl");
 	}
 
-	/*** selected (new) tile ***/
-	if (iOnTile != iOnTileOld)
-	{
-		ontile = SDL_GetTicks();
-		iOnTileOld = iOnTile;
-	}
-	if ((iOnTile != 0) && (IsDisabled (iOnTile) == 0))
+	/*** Events. ***/
+	for (iSC = 1; iSC <= 256; iSC++)
 	{
-		if (iOnTile <= 78) /*** (large) tiles ***/
-		{
-			iX = (((iOnTile - 1) % 13) * (TILEWIDTH + 2));
-			iY = 2 + (((int)((iOnTile - 1) / 13)) * (TILEHEIGHT + 2));
-			ShowImage (imgborderb, iX, iY, "imgborderb");
-
-			/*** large preview ***/
-			if ((SDL_GetTicks() > ontile + 1000) && (iEventHover == 0))
-			{
-				GetTileModChange (iOnTile, &iGetTile, &iGetMod);
-				snprintf (sInfo, MAX_INFO, "tile=%02x_%02x", iGetTile, iGetMod);
-				if (((iOnTile >= 1) && (iOnTile <= 7)) ||
-					((iOnTile >= 14) && (iOnTile <= 20)) ||
-					((iOnTile >= 27) && (iOnTile <= 33)) ||
-					((iOnTile >= 40) && (iOnTile <= 46)) ||
-					((iOnTile >= 53) && (iOnTile <= 59)) ||
-					((iOnTile >= 66) && (iOnTile <= 72)))
-				{ /*** show right ***/
-					ShowImage (imgpreviewb, 356, 76, "imgpreviewb");
-					ShowImage (NULL, 371, 91, sInfo);
-				} else { /*** show left ***/
-					ShowImage (imgpreviewb, 71, 76, "imgpreviewb");
-					ShowImage (NULL, 86, 91, sInfo);
-				}
-			}
-		} else { /*** living ***/
-			iX = 0 + (22 * (iOnTile - 79));
-			iY = 326;
-			ShowImage (imgborders, iX, iY, "imgborders");
-		}
+		EventToBytes (iLevel, iSC, &sBytes[iByte], &sBytes[iByte + EVENTS]);
+		iByte++;
 	}
+	iByte+=EVENTS;
 
-	/*** guard skill ***/
-	switch (iGuardType)
+	/*** Room links. ***/
+	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
 	{
-		case 0: iX = 315; iY = 427; break;
-		case 1: iX = 330; iY = 427; break;
-		case 2: iX = 345; iY = 427; break;
-		case 3: iX = 360; iY = 427; break;
-		case 4: iX = 375; iY = 427; break;
-		case 5: iX = 390; iY = 427; break;
-		case 6: iX = 405; iY = 427; break;
-		case 7: iX = 420; iY = 427; break;
-		case 8: iX = 345; iY = 442; break;
-		case 9: iX = 360; iY = 442; break;
-		case 10: iX = 375; iY = 442; break;
-		case 11: iX = 390; iY = 442; break;
+		for (iSideLoop = 1; iSideLoop <= 4; iSideLoop++)
+		{
+			sBytes[iByte++] = arLevels[iLevel].arRoom[iRoomLoop].arLink[iSideLoop];
+		}
 	}
-	ShowImage (imgsell, iX, iY, "imgsell");
 
-	/*** custom tile ***/
-	if (iCustomX == 1) { ShowImage (imgsell, 11, 434, "imgsell"); }
-	CenterNumber (iCustomTile, 85, 431, color_bl, 1);
-	CenterNumber (iCustomMod, 214, 431, color_bl, 1);
+	/*** Unknown (64). ***/
+	for (iSC = 0; iSC < 64; iSC++)
+		{ sBytes[iByte++] = arLevels[iLevel].arBytes64[iSC]; }
 
-	/*** event number ***/
-	CenterNumber (iChangeEvent, 478, 431, color_bl, 0);
+	/*** Start location. ***/
+	sBytes[iByte++] = arLevels[iLevel].arStartLocation[1];
+	sBytes[iByte++] = arLevels[iLevel].arStartLocation[2] - 1;
+	cStartDir = arLevels[iLevel].arStartLocation[3];
+	/*** 2 of 2 ***/
+	if ((iLevel == 1) || (iLevel == 13))
+	{
+		if (arLevels[iLevel].arStartLocation[3] == 0x00)
+			{ cStartDir = 0xFF; }
+				else { cStartDir = 0x00; }
+	}
+	sBytes[iByte++] = cStartDir;
 
-	if (iCustomHover == 1)
-		{ ShowImage (imgchover, 3, 383, "imgchover"); }
+	/*** Unknown (4). ***/
+	for (iSC = 0; iSC < 4; iSC++)
+		{ sBytes[iByte++] = arLevels[iLevel].arBytes4[iSC]; }
 
-	if (iGuardTooltip == 1)
-		{ ShowImage (imgtooltipg, 311, 383, "imgtooltipg"); }
+	/*** Guards. ***/
+	for (iSC = 1; iSC <= 24; iSC++)
+	{
+		sBytes[iByte] = arLevels[iLevel].arRoom[iSC].cGuardTile - 1;
+		sBytes[iByte + (ROOMS * 1)] = arLevels[iLevel].arRoom[iSC].cGuardDir;
+		sBytes[iByte + (ROOMS * 2)] = arLevels[iLevel].arRoom[iSC].cGuardUnk1;
+		sBytes[iByte + (ROOMS * 3)] = arLevels[iLevel].arRoom[iSC].cGuardUnk2;
+		sBytes[iByte + (ROOMS * 4)] = arLevels[iLevel].arRoom[iSC].cGuardSkill;
+		sBytes[iByte + (ROOMS * 5)] = arLevels[iLevel].arRoom[iSC].cGuardUnk3;
+		sBytes[iByte + (ROOMS * 6)] = arLevels[iLevel].arRoom[iSC].cGuardC;
+		iByte++;
+	}
+	iByte+=(ROOMS * 6);
 
-	if (iEventHover == 1)
-		{ ShowImage (imgeventh, 440, 56, "imgeventh"); }
+	/*** Unknown (16). ***/
+	for (iSC = 0; iSC < 16; iSC++)
+		{ sBytes[iByte++] = arLevels[iLevel].arBytes16[iSC]; }
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
+	/*** Checksum. ***/
+	ulSum = 0;
+	for (iByteLoop = 0; iByteLoop < iByte; iByteLoop++)
+		{ ulSum+=sBytes[iByteLoop]; }
+	sBytes[iByte] = 255 - (ulSum % 256);
+
+	return (sBytes[iByte]);
 }
 /*****************************************************************************/
-int OnTile (void)
+int Verify (int iOffset, char *sText)
 /*****************************************************************************/
 {
-	int iTempX;
-	int iTempY;
-	int iTempOn;
+	int iSize;
 
-	/*** (large) tiles ***/
-	for (iTempY = 0; iTempY < 6; iTempY++)
-	{
-		for (iTempX = 0; iTempX < 13; iTempX++)
-		{
-			if (InArea (2 + (iTempX * (TILEWIDTH + 2)),
-				4 + (iTempY * (TILEHEIGHT + 2)),
-				2 + (iTempX * (TILEWIDTH + 2)) + TILEWIDTH,
-				4 + (iTempY * (TILEHEIGHT + 2)) + TILEHEIGHT) == 1)
-			{
-				iTempOn = (iTempY * 13) + iTempX + 1;
-				if ((iTempOn >= 1) && (iTempOn <= 78)) { return (iTempOn); }
-			}
-		}
-	}
+	iSize = strlen (sText);
 
-	/*** living ***/
-	for (iTempX = 0; iTempX < 26; iTempX++)
+	if ((unsigned long)(iOffset + iSize) > ulDiskImageSize)
+		{ return (0); }
+	if (memcmp (arDiskImage + iOffset, sText, iSize) != 0)
 	{
-		if (InArea (2 + (22 * iTempX), 328,
-			2 + (22 * iTempX) + 20, 328 + 52) == 1)
-		{ return (79 + iTempX); }
+		return (0);
+	} else {
+		return (1);
 	}
-
-	return (0);
 }
 /*****************************************************************************/
-void ChangePosAction (char *sAction)
+void GetTileMod (int iGetRoom, int iGetTile, int *iTile, int *iMod)
 /*****************************************************************************/
 {
-	if (strcmp (sAction, "left") == 0)
+	*iTile = arLevels[iCurLevel].arRoom[iGetRoom].arTile[iGetTile];
+	*iMod = arLevels[iCurLevel].arRoom[iGetRoom].arMod[iGetTile];
+}
+/*****************************************************************************/
+void GetTileModChange (int iGetTile, int *iTile, int *iMod)
+/*****************************************************************************/
+{
+	switch (iGetTile)
 	{
-		do {
-			switch (iOnTile)
-			{
-				case 1: iOnTile = 13; break;
-				case 14: iOnTile = 26; break;
-				case 27: iOnTile = 39; break;
-				case 40: iOnTile = 52; break;
-				case 53: iOnTile = 65; break;
-				case 66: iOnTile = 78; break;
-				case 79: iOnTile = 104; break;
-				default: iOnTile--; break;
-			}
-		} while (IsDisabled (iOnTile) == 1);
-	}
+		/*** Row 1. ***/
+		case 1: *iTile = 0x00; *iMod = 0x00; break;
+		case 2: *iTile = 0x00; *iMod = 0x01; break;
+		case 3: *iTile = 0x00; *iMod = 0x02; break;
+		case 4: *iTile = 0x00; *iMod = 0x03; break;
+		case 5: *iTile = 0x00; *iMod = 0xFF; break;
+		case 6: *iTile = 0x01; *iMod = 0x00; break;
+		case 7: *iTile = 0x01; *iMod = 0x01; break;
+		case 8: *iTile = 0x01; *iMod = 0x02; break;
+		case 9: *iTile = 0x01; *iMod = 0x03; break;
+		case 10: *iTile = 0x01; *iMod = 0xFF; break;
+		case 11: *iTile = 0x02; *iMod = 0x00; break;
+		case 12: *iTile = 0x02; *iMod = 0x01; break;
+		case 13: *iTile = 0x02; *iMod = 0x02; break;
 
-	if (strcmp (sAction, "right") == 0)
-	{
-		do {
-			switch (iOnTile)
-			{
-				case 13: iOnTile = 1; break;
-				case 26: iOnTile = 14; break;
-				case 39: iOnTile = 27; break;
-				case 52: iOnTile = 40; break;
-				case 65: iOnTile = 53; break;
-				case 78: iOnTile = 66; break;
-				case 104: iOnTile = 79; break;
-				default: iOnTile++; break;
-			}
-		} while (IsDisabled (iOnTile) == 1);
-	}
+		/*** Row 2. ***/
+		case 14: *iTile = 0x02; *iMod = 0x03; break;
+		case 15: *iTile = 0x02; *iMod = 0x04; break;
+		case 16: *iTile = 0x02; *iMod = 0x05; break;
+		case 17: *iTile = 0x02; *iMod = 0x06; break;
+		case 18: *iTile = 0x02; *iMod = 0x07; break;
+		case 19: *iTile = 0x02; *iMod = 0x08; break;
+		case 20: *iTile = 0x02; *iMod = 0x09; break;
+		case 21: *iTile = 0x03; *iMod = 0x00; break;
+		case 22: *iTile = 0x04; *iMod = 0x02; break;
+		case 23: *iTile = 0x04; *iMod = 0x01; break;
+		case 24: *iTile = 0x05; *iMod = 0x00; break;
+		case 25: *iTile = 0x06; *iMod = iChangeEvent - 1; break;
+		case 26: *iTile = 0x07; *iMod = 0x00; break;
 
-	if (strcmp (sAction, "up") == 0)
-	{
-		do {
-			switch (iOnTile)
-			{
-				case 1: iOnTile = 79; break;
-				case 2: iOnTile = 81; break;
-				case 3: iOnTile = 83; break;
-				case 4: iOnTile = 85; break;
-				case 5: iOnTile = 87; break;
-				case 6: iOnTile = 89; break;
-				case 7: iOnTile = 91; break;
-				case 8: iOnTile = 93; break;
-				case 9: iOnTile = 95; break;
-				case 10: iOnTile = 97; break;
-				case 11: iOnTile = 99; break;
-				case 12: iOnTile = 101; break;
-				case 13: iOnTile = 103; break;
-				case 79: case 80: iOnTile = 66; break;
-				case 81: case 82: iOnTile = 67; break;
-				case 83: case 84: iOnTile = 68; break;
-				case 85: case 86: iOnTile = 69; break;
-				case 87: case 88: iOnTile = 70; break;
-				case 89: case 90: iOnTile = 71; break;
-				case 91: case 92: iOnTile = 72; break;
-				case 93: case 94: iOnTile = 73; break;
-				case 95: case 96: iOnTile = 74; break;
-				case 97: case 98: iOnTile = 75; break;
-				case 99: case 100: iOnTile = 76; break;
-				case 101: case 102: iOnTile = 77; break;
-				case 103: case 104: iOnTile = 78; break;
-				default: iOnTile-=13; break;
-			}
-		} while (IsDisabled (iOnTile) == 1);
-	}
+		/*** Row 3. ***/
+		case 27: *iTile = 0x07; *iMod = 0x01; break;
+		case 28: *iTile = 0x07; *iMod = 0x02; break;
+		case 29: *iTile = 0x07; *iMod = 0x03; break;
+		case 30: *iTile = 0x08; *iMod = 0x00; break;
+		case 31: *iTile = 0x09; *iMod = 0x00; break;
+		case 32: *iTile = 0x0A; *iMod = 0x00; break;
+		case 33: *iTile = 0x0A; *iMod = 0x01; break;
+		case 34: *iTile = 0x0A; *iMod = 0x02; break;
+		case 35: *iTile = 0x0A; *iMod = 0x03; break;
+		case 36: *iTile = 0x0A; *iMod = 0x04; break;
+		case 37: *iTile = 0x0A; *iMod = 0x05; break;
+		case 38: *iTile = 0x0A; *iMod = 0x06; break;
+		case 39: *iTile = 0x0B; *iMod = 0x00; break;
 
-	if (strcmp (sAction, "down") == 0)
-	{
-		do {
-			switch (iOnTile)
-			{
-				case 66: iOnTile = 79; break;
-				case 67: iOnTile = 81; break;
-				case 68: iOnTile = 83; break;
-				case 69: iOnTile = 85; break;
-				case 70: iOnTile = 87; break;
-				case 71: iOnTile = 89; break;
-				case 72: iOnTile = 91; break;
-				case 73: iOnTile = 93; break;
-				case 74: iOnTile = 95; break;
-				case 75: iOnTile = 97; break;
-				case 76: iOnTile = 99; break;
-				case 77: iOnTile = 101; break;
-				case 78: iOnTile = 103; break;
-				case 79: case 80: iOnTile = 1; break;
-				case 81: case 82: iOnTile = 2; break;
-				case 83: case 84: iOnTile = 3; break;
-				case 85: case 86: iOnTile = 4; break;
-				case 87: case 88: iOnTile = 5; break;
-				case 89: case 90: iOnTile = 6; break;
-				case 91: case 92: iOnTile = 7; break;
-				case 93: case 94: iOnTile = 8; break;
-				case 95: case 96: iOnTile = 9; break;
-				case 97: case 98: iOnTile = 10; break;
-				case 99: case 100: iOnTile = 11; break;
-				case 101: case 102: iOnTile = 12; break;
-				case 103: case 104: iOnTile = 13; break;
-				default: iOnTile+=13; break;
-			}
-		} while (IsDisabled (iOnTile) == 1);
+		/*** Row 4. ***/
+		case 40: *iTile = 0x0C; *iMod = 0x00; break;
+		case 41: *iTile = 0x0C; *iMod = 0x01; break;
+		case 42: *iTile = 0x0C; *iMod = 0x02; break;
+		case 43: *iTile = 0x0C; *iMod = 0x03; break;
+		case 44: *iTile = 0x0C; *iMod = 0x04; break;
+		case 45: *iTile = 0x0C; *iMod = 0x05; break;
+		case 46: *iTile = 0x0C; *iMod = 0x06; break;
+		case 47: *iTile = 0x0C; *iMod = 0x07; break;
+		case 48: *iTile = 0x0D; *iMod = 0x00; break;
+		case 49: *iTile = 0x0E; *iMod = 0x00; break;
+		case 50: *iTile = 0x0F; *iMod = iChangeEvent - 1; break;
+		case 51: *iTile = 0x10; *iMod = 0x00; break;
+		case 52: *iTile = 0x11; *iMod = 0x00; break;
+
+		/*** Row 5. ***/
+		case 53: *iTile = 0x12; *iMod = 0x00; break;
+		case 54: *iTile = 0x12; *iMod = 0x01; break;
+		case 55: *iTile = 0x12; *iMod = 0x02; break;
+		case 56: *iTile = 0x12; *iMod = 0x03; break;
+		case 57: *iTile = 0x12; *iMod = 0x04; break;
+		case 58: *iTile = 0x12; *iMod = 0x05; break;
+		case 59: *iTile = 0x13; *iMod = 0x00; break;
+		case 60: *iTile = 0x14; *iMod = 0x00; break;
+		case 61: *iTile = 0x14; *iMod = 0x01; break;
+		case 62: *iTile = 0x15; *iMod = 0x00; break;
+		case 63: *iTile = 0x16; *iMod = 0x00; break;
+		case 64: *iTile = 0x17; *iMod = 0x00; break;
+		case 65: *iTile = 0x18; *iMod = 0x00; break;
+
+		/*** Row 6. ***/
+		case 66: *iTile = 0x19; *iMod = 0x00; break;
+		case 67: *iTile = 0x1A; *iMod = 0x00; break;
+		case 68: *iTile = 0x1B; *iMod = 0x00; break;
+		case 69: *iTile = 0x1C; *iMod = 0x00; break;
+		case 70: *iTile = 0x1D; *iMod = 0x00; break;
+		case 71: *iTile = 0x1E; *iMod = 0x00; break;
+		case 72: *iTile = 0x2B; *iMod = 0x00; break;
+		case 73: *iTile = 0x12; *iMod = 0x80; break;
+		case 74: *iTile = 0x12; *iMod = 0x81; break;
+		case 75: *iTile = 0x12; *iMod = 0x82; break;
+		case 76: *iTile = 0x12; *iMod = 0x83; break;
+		case 77: *iTile = 0x12; *iMod = 0x84; break;
+		case 78: *iTile = 0x12; *iMod = 0x85; break;
 	}
 }
 /*****************************************************************************/
-void DisableSome (void)
+void ApplySkillIfNecessary (int iTile)
 /*****************************************************************************/
 {
-	if (iCurGuard != 0x01)
-	{
-		/*** disable skeleton ***/
-		ShowImage (imgdisabled, 88, 326, "imgdisabled");
-	}
-
-	if (iCurGuard != 0x03)
-	{
-		/*** disable fat ***/
-		ShowImage (imgdisabled, 132, 326, "imgdisabled");
-	}
-
-	if (iCurGuard != 0x04)
-	{
-		/*** disable shadow ***/
-		ShowImage (imgdisabled, 176, 326, "imgdisabled");
-	}
-
-	if (iCurGuard != 0x05)
-	{
-		/*** disable Jaffar ***/
-		ShowImage (imgdisabled, 220, 326, "imgdisabled");
-	}
-
-	if (((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14))
+	if (arLevels[iCurLevel].arRoom[iCurRoom].cGuardTile == iTile)
 	{
-		/*** disable guard ***/
-		ShowImage (imgdisabled, 44, 326, "imgdisabled");
+		arLevels[iCurLevel].arRoom[iCurRoom].cGuardSkill = iGuardType;
+		LevelChanged();
 	}
 }
 /*****************************************************************************/
-int IsDisabled (int iTile)
+void LoadingBar (int iBarHeight)
 /*****************************************************************************/
 {
-	/*** skeleton ***/
-	if ((iCurGuard != 0x01) && ((iTile == 83) || (iTile == 84)))
-		{ return (1); }
-
-	/*** fat ***/
-	if ((iCurGuard != 0x03) && ((iTile == 85) || (iTile == 86)))
-		{ return (1); }
-
-	/*** shadow ***/
-	if ((iCurGuard != 0x04) && ((iTile == 87) || (iTile == 88)))
-		{ return (1); }
-
-	/*** Jaffar ***/
-	if ((iCurGuard != 0x05) && ((iTile == 89) || (iTile == 90)))
-		{ return (1); }
-
-	/*** guard ***/
-	if ((((iCurGuard != 0x00) && (iCurGuard != 0x02)) || (iCurLevel == 14)) &&
-		((iTile == 81) || (iTile == 82))) { return (1); }
+	SDL_Rect bar;
 
-	if (Unused (iTile) == 1) { return (1); }
+	bar.x = (10 + 2) * iScale;
+	bar.y = (441 + 10 - 2 - iBarHeight) * iScale;
+	bar.w = (20 - 2 - 2) * iScale;
+	bar.h = iBarHeight * iScale;
+	SDL_SetRenderDrawColor (ascreen, 0x44, 0x44, 0x44, SDL_ALPHA_OPAQUE);
+	BatchFlush();
+	SDL_RenderFillRect (ascreen, &bar);
+	iCurrentBarHeight = iBarHeight;
 
-	return (0);
+	/*** refresh screen ***/
+	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void CenterNumber (int iNumber, int iX, int iY,
-	SDL_Color fore, int iHex)
+void HomeComputerAction (char *sAction)
 /*****************************************************************************/
 {
-	char sText[MAX_TEXT + 2];
-
-	if (iHex == 0)
+	if (strcmp (sAction, "one") == 0)
 	{
-		snprintf (sText, MAX_TEXT, "%i", iNumber);
-	} else {
-		snprintf (sText, MAX_TEXT, "%02x", iNumber);
+		if (iAppleII == 1)
+		{
+			iHomeComputer = 1;
+			iHomeComputerActive = 0;
+		}
 	}
-	/* The 100000 is a workaround for 0 being broken. SDL devs have fixed that
-	 * see e.g. https://hg.libsdl.org/SDL_ttf/rev/72b8861dbc01 but
-	 * Ubuntu et al. still ship an sdl-ttf that is >10 years(!) old.
-	 */
-	message = TTF_RenderText_Blended_Wrapped (font3, sText, fore, 100000);
-	messaget = SDL_CreateTextureFromSurface (ascreen, message);
-	if (iHex == 0)
+
+	if (strcmp (sAction, "two") == 0)
 	{
-		if ((iNumber >= -9) && (iNumber <= -1))
+		if (iBBCMaster == 1)
 		{
-			offset.x = iX + 16;
-		} else if ((iNumber >= 0) && (iNumber <= 9)) {
-			offset.x = iX + 21;
-		} else if ((iNumber >= 10) && (iNumber <= 99)) {
-			offset.x = iX + 14;
-		} else {
-			offset.x = iX + 7;
+			iHomeComputer = 2;
+			iHomeComputerActive = 0;
 		}
-	} else {
-		offset.x = iX + 14;
 	}
-	offset.y = iY - 1;
-	offset.w = message->w; offset.h = message->h;
-	CustomRenderCopy (messaget, NULL, &offset, "message");
-	SDL_DestroyTexture (messaget); SDL_FreeSurface (message);
-}
-/*****************************************************************************/
-int Unused (int iTile)
-/*****************************************************************************/
-{
-	if ((iTile >= 91) && (iTile <= 104)) { return (1); }
 
-	return (0);
-}
-/*****************************************************************************/
-void OpenURL (char *sURL)
-/*****************************************************************************/
-{
-#if defined WIN32 || _WIN32 || WIN64 || _WIN64
-ShellExecute (NULL, "open", sURL, NULL, NULL, SW_SHOWNORMAL);
-#else
-pid_t pid;
-pid = fork();
-if (pid == 0)
-{
-	execl ("/usr/bin/xdg-open", "xdg-open", sURL, (char *)NULL);
-	exit (EXIT_NORMAL);
-}
-#endif
+	if (strcmp (sAction, "three") == 0)
+	{
+		if (iC64 == 1)
+		{
+			iHomeComputer = 3;
+			iHomeComputerActive = 0;
+		}
+	}
 }
 /*****************************************************************************/
-void EXELoad (void)
+void HomeComputer (void)
 /*****************************************************************************/
 {
-	int iFdEXE;
-	unsigned char sRead[2 + 2];
-	int iTab;
-	int iHCSwitch;
-	unsigned long ulOffset;
-
-	/*** Used for looping. ***/
-	int iSkillLoop;
-
-	switch (iHomeComputer)
-	{
-		case 1: iHCSwitch = 1; break;
-		case 2: iHCSwitch = 2; break;
-		case 3: iHCSwitch = 3; break;
-		default:
-			printf ("[FAILED] Strange iHomeComputer: %i!\n", iHomeComputer);
-			exit (EXIT_ERROR); break;
-	}
-
-	iFdEXE = open (sPathFile, O_RDONLY|O_BINARY);
-	if (iFdEXE == -1)
-	{
-		printf ("[FAILED] Error opening %s: %s!\n",
-			sPathFile, strerror (errno));
-		exit (EXIT_ERROR);
-	}
-
-	/*** Prince HP. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulPrinceHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulPrinceHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulPrinceHPC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		read (iFdEXE, sRead, 1);
-		iEXEPrinceHP = sRead[0];
-	}
-
-	/*** Shadow HP. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulShadowHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulShadowHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulShadowHPC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		read (iFdEXE, sRead, 1);
-		iEXEShadowHP = sRead[0];
-	}
-
-	/*** Chomper delay. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulChomperDelayA[iDiskImageA]; break;
-		case 2: ulOffset = ulChomperDelayB[iDiskImageB]; break;
-		case 3: ulOffset = ulChomperDelayC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		read (iFdEXE, sRead, 1);
-		iEXEChomperDelay = sRead[0];
-	}
+	SDL_Event event;
+	int iOldXPos, iOldYPos;
 
-	/*** Mouse delay. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulMouseDelayA[iDiskImageA]; break;
-		case 2: ulOffset = ulMouseDelayB[iDiskImageB]; break;
-		case 3: ulOffset = ulMouseDelayC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		read (iFdEXE, sRead, 1);
-		iEXEMouseDelay = sRead[0];
-	}
+	iHomeComputerActive = 1;
 
-	/*** Guard settings. ***/
-	for (iTab = 1; iTab <= TABS_GUARD; iTab++)
+	ShowHomeComputer();
+	while (iHomeComputerActive == 1)
 	{
-		switch (iHCSwitch)
-		{
-			case 1: ulOffset = ulGuardA[iDiskImageA][iTab - 1]; break;
-			case 2: ulOffset = ulGuardB[iDiskImageB][iTab - 1]; break;
-			case 3: ulOffset = ulGuardC[iDiskImageC][iTab - 1]; break;
-		}
-		if (ulOffset != 0x00)
+		while (SDL_PollEvent (&event))
 		{
-			lseek (iFdEXE, ulOffset, SEEK_SET);
-			for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
+			switch (event.type)
 			{
-				read (iFdEXE, sRead, 1);
-				iEXEGuard[iTab][iSkillLoop] = sRead[0];
-			}
-		}
-	}
+				case SDL_CONTROLLERBUTTONDOWN:
+					/*** Nothing for now. ***/
+					break;
+				case SDL_CONTROLLERBUTTONUP:
+					switch (event.cbutton.button)
+					{
+						case SDL_CONTROLLER_BUTTON_A:
+						case SDL_CONTROLLER_BUTTON_START:
+							if ((iAppleII == 1) && (iOnAppleII == 1))
+								{ HomeComputerAction ("one"); }
+							if ((iBBCMaster == 1) && (iOnBBCMaster == 1))
+								{ HomeComputerAction ("two"); }
+							if ((iC64 == 1) && (iOnC64 == 1))
+								{ HomeComputerAction ("three"); }
+							break;
+						case SDL_CONTROLLER_BUTTON_B:
+						case SDL_CONTROLLER_BUTTON_BACK:
+							Quit(); break;
+						case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
+						case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
+							if ((iOnC64 == 1) && (iBBCMaster == 1))
+							{
+								iOnBBCMaster = 1; iOnC64 = 0;
+								ShowHomeComputer();
+							} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
+								iOnAppleII = 1; iOnBBCMaster = 0;
+								ShowHomeComputer();
+							}
+							break;
+						case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
+						case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
+							if ((iOnAppleII == 1) && (iBBCMaster == 1))
+							{
+								iOnAppleII = 0; iOnBBCMaster = 1;
+								ShowHomeComputer();
+							} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
+								iOnBBCMaster = 0; iOnC64 = 1;
+								ShowHomeComputer();
+							}
+							break;
+						case SDL_CONTROLLER_BUTTON_X:
+							HomeComputerAction ("one");
+							break;
+						case SDL_CONTROLLER_BUTTON_Y:
+							HomeComputerAction ("two");
+							break;
+						case SDL_CONTROLLER_BUTTON_GUIDE:
+							HomeComputerAction ("three");
+							break;
+					}
+					ShowHomeComputer();
+					break;
+				case SDL_CONTROLLERAXISMOTION: /*** triggers and analog sticks ***/
+					iXJoy1 = SDL_JoystickGetAxis (joystick, 0);
+					iXJoy2 = SDL_JoystickGetAxis (joystick, 3);
+					if ((event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERLEFT) ||
+						(iXJoy1 < -30000) || (iXJoy2 < -30000)) /*** left ***/
+					{
+						if ((iOnC64 == 1) && (iBBCMaster == 1))
+						{
+							iOnBBCMaster = 1; iOnC64 = 0;
+							ShowHomeComputer();
+						} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
+							iOnAppleII = 1; iOnBBCMaster = 0;
+							ShowHomeComputer();
+						}
+					}
+					if ((event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT) ||
+						(iXJoy1 > 30000) || (iXJoy2 > 30000)) /*** right ***/
+					{
+						if ((iOnAppleII == 1) && (iBBCMaster == 1))
+						{
+							iOnAppleII = 0; iOnBBCMaster = 1;
+							ShowHomeComputer();
+						} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
+							iOnBBCMaster = 0; iOnC64 = 1;
+							ShowHomeComputer();
+						}
+					}
+					break;
+				case SDL_KEYDOWN:
+					switch (event.key.keysym.sym)
+					{
+						case SDLK_ESCAPE:
+							Quit(); break;
+						case SDLK_KP_ENTER:
+						case SDLK_RETURN:
+						case SDLK_SPACE:
+							if ((iAppleII == 1) && (iOnAppleII == 1))
+								{ HomeComputerAction ("one"); }
+							if ((iBBCMaster == 1) && (iOnBBCMaster == 1))
+								{ HomeComputerAction ("two"); }
+							if ((iC64 == 1) && (iOnC64 == 1))
+								{ HomeComputerAction ("three"); }
+							break;
+						case SDLK_1: /*** Apple II ***/
+							HomeComputerAction ("one");
+							break;
+						case SDLK_2: /*** BBC Master ***/
+							HomeComputerAction ("two");
+							break;
+						case SDLK_3: /*** C64 ***/
+							HomeComputerAction ("three");
+							break;
+						case SDLK_LEFT:
+							if ((iOnC64 == 1) && (iBBCMaster == 1))
+							{
+								iOnBBCMaster = 1; iOnC64 = 0;
+								ShowHomeComputer();
+							} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
+								iOnAppleII = 1; iOnBBCMaster = 0;
+								ShowHomeComputer();
+							}
+							break;
+						case SDLK_RIGHT:
+							if ((iOnAppleII == 1) && (iBBCMaster == 1))
+							{
+								iOnAppleII = 0; iOnBBCMaster = 1;
+								ShowHomeComputer();
+							} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
+								iOnBBCMaster = 0; iOnC64 = 1;
+								ShowHomeComputer();
+							}
+							break;
+						default: break;
+					}
+					ShowHomeComputer();
+					break;
+				case SDL_MOUSEMOTION:
+					iOldXPos = iXPos;
+					iOldYPos = iYPos;
+					iXPos = event.motion.x;
+					iYPos = event.motion.y;
+					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
 
-	/*** Guard HP. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulGuardHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardHPC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				read (iFdEXE, sRead, 1);
-				iEXEGuardHP[iTab - 1] = sRead[0];
+					if (InArea (22, 22, 22 + 176, 22 + 417) == 1) /*** Apple II ***/
+					{
+						if ((iAppleII == 1) && (iOnAppleII != 1))
+							{ iOnAppleII = 1; iOnBBCMaster = 0; iOnC64 = 0; }
+					} else if (InArea (218, 22, 218 + 176, 22 + 417) == 1) { /*** BM ***/
+						if ((iBBCMaster == 1) && (iOnBBCMaster != 1))
+							{ iOnAppleII = 0; iOnBBCMaster = 1; iOnC64 = 0; }
+					} else if (InArea (414, 22, 414 + 176, 22 + 417) == 1) { /*** C ***/
+						if ((iC64 == 1) && (iOnC64 != 1))
+							{ iOnAppleII = 0; iOnBBCMaster = 0; iOnC64 = 1; }
+					} else {
+						iOnAppleII = 0; iOnBBCMaster = 0; iOnC64 = 0;
+					}
+					ShowHomeComputer();
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					/*** Nothing for now. ***/
+					break;
+				case SDL_MOUSEBUTTONUP:
+					iOnAppleII = 0;
+					iOnBBCMaster = 0;
+					if (event.button.button == 1)
+					{
+						if (InArea (22, 22, 22 + 176, 22 + 417) == 1)
+						{ /*** Apple II ***/
+							HomeComputerAction ("one");
+						}
+						if (InArea (218, 22, 218 + 176, 22 + 417) == 1)
+						{ /*** BBC Master ***/
+							HomeComputerAction ("two");
+						}
+						if (InArea (414, 22, 414 + 176, 22 + 417) == 1)
+						{ /*** C64 ***/
+							HomeComputerAction ("three");
+						}
+					}
+					ShowHomeComputer(); break;
+				case SDL_WINDOWEVENT:
+					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
+						{ ShowHomeComputer(); } break;
+				case SDL_QUIT:
+					Quit(); break;
 			}
 		}
 	}
 
-	/*** Guard uniform. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulGuardUniformA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardUniformB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardUniformC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
+	/*** prevent CPU eating ***/
+	gamespeed = REFRESH_PROG;
+	while ((SDL_GetTicks() - looptime) < gamespeed)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				read (iFdEXE, sRead, 1);
-				iEXEGuardU[iTab - 1] = sRead[0];
-			}
-		}
+		SDL_Delay (10);
 	}
+	looptime = SDL_GetTicks();
+}
+/*****************************************************************************/
+void ShowHomeComputer (void)
+/*****************************************************************************/
+{
+	/*** background ***/
+	ShowImage (imghc, 0, 0, "imghc");
 
-	/*** Guard sprite. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulGuardSpriteA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardSpriteB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardSpriteC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
+	/*** Apple II ***/
+	if (iAppleII == 0)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				read (iFdEXE, sRead, 1);
-				iEXEGuardS[iTab - 1] = sRead[0];
-			}
-		}
+		/*** disabled ***/
+		ShowImage (imghcadis, 22, 22, "imghcadis");
+	} else if (iOnAppleII == 0) {
+		/*** off ***/
+		ShowImage (imghcaoff, 22, 22, "imghcaoff");
 	} else {
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				iEXEGuardS[iTab - 1] = arDefaultGuardS[iTab - 1];
-			}
-		}
+		/*** on ***/
+		ShowImage (imghcaon, 22, 22, "imghcaon");
 	}
 
-	/*** Env. 1 ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulEnv1A[iDiskImageA]; break;
-		case 2: ulOffset = ulEnv1B[iDiskImageB]; break;
-		case 3: ulOffset = ulEnv1C[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
+	/*** BBC Master ***/
+	if (iBBCMaster == 0)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			read (iFdEXE, sRead, 1);
-			iEXEEnv1[iTab - 1] = sRead[0];
-		}
+		/*** disabled ***/
+		ShowImage (imghcbdis, 218, 22, "imghcbdis");
+	} else if (iOnBBCMaster == 0) {
+		/*** off ***/
+		ShowImage (imghcboff, 218, 22, "imghcboff");
 	} else {
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			iEXEEnv1[iTab - 1] = arDefaultEnv1[iTab - 1];
-		}
+		/*** on ***/
+		ShowImage (imghcbon, 218, 22, "imghcbon");
 	}
 
-	/*** Env. 2 ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulEnv2A[iDiskImageA]; break;
-		case 2: ulOffset = ulEnv2B[iDiskImageB]; break;
-		case 3: ulOffset = ulEnv2C[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
+	/*** C64 ***/
+	if (iC64 == 0)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			read (iFdEXE, sRead, 1);
-			iEXEEnv2[iTab - 1] = sRead[0];
-		}
+		/*** disabled ***/
+		ShowImage (imghccdis, 414, 22, "imghccdis");
+	} else if (iOnC64 == 0) {
+		/*** off ***/
+		ShowImage (imghccoff, 414, 22, "imghccoff");
 	} else {
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			iEXEEnv2[iTab - 1] = arDefaultEnv2[iTab - 1];
-		}
+		/*** on ***/
+		ShowImage (imghccon, 414, 22, "imghccon");
 	}
 
-	close (iFdEXE);
+	/*** refresh screen ***/
+	BatchFlush();
+	SDL_RenderPresent (ascreen);
 }
 /*****************************************************************************/
-void EXESave (void)
+void PlaytestStart (int iLevel)
 /*****************************************************************************/
 {
-	int iFdEXE;
-	char sToWrite[MAX_TOWRITE + 2];
-	int iTab;
-	int iHCSwitch;
-	unsigned long ulOffset;
+	int iOffsetStart;
+	unsigned char sToWrite[1 + 2];
 
-	/*** Used for looping. ***/
-	int iSkillLoop;
+	/*** Nothing is written before JournalCommit(). ***/
+	JournalStart();
 
+	/*** Skip the intro. ***/
 	switch (iHomeComputer)
 	{
-		case 1: iHCSwitch = 1; break;
-		case 2: iHCSwitch = 2; break;
-		case 3: iHCSwitch = 3; break;
-		default:
-			printf ("[FAILED] Strange iHomeComputer: %i!\n", iHomeComputer);
-			exit (EXIT_ERROR); break;
+		case 1: iOffsetStart = ulSkipIntroA[iDiskImageA]; break;
+		case 2: iOffsetStart = ulSkipIntroB[iDiskImageB]; break;
+		case 3: iOffsetStart = ulSkipIntroC[iDiskImageC]; break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
-
-	iFdEXE = open (sPathFile, O_RDWR|O_BINARY);
-	if (iFdEXE == -1)
+	if (iOffsetStart != 0x00)
 	{
-		printf ("[FAILED] Error opening %s: %s!\n",
-			sPathFile, strerror (errno));
-		exit (EXIT_ERROR);
+		sToWrite[0] = 0xD5;
+		JournalAdd (iOffsetStart, sToWrite, 1);
 	}
 
-	/*** Prince HP. ***/
-	switch (iHCSwitch)
+	/*** Set the starting level. ***/
+	switch (iHomeComputer)
 	{
-		case 1: ulOffset = ulPrinceHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulPrinceHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulPrinceHPC[iDiskImageC]; break;
+		case 1: iOffsetStart = ulStartLevelA[iDiskImageA]; break;
+		case 2: iOffsetStart = ulStartLevelB[iDiskImageB]; break;
+		case 3: iOffsetStart = ulStartLevelC[iDiskImageC]; break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
-	if (ulOffset != 0x00)
+	if (iOffsetStart != 0x00)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEPrinceHP);
-		write (iFdEXE, sToWrite, 1);
+		sToWrite[0] = iLevel;
+		JournalAdd (iOffsetStart, sToWrite, 1);
 	}
 
-	/*** Shadow HP. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulShadowHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulShadowHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulShadowHPC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEShadowHP);
-		write (iFdEXE, sToWrite, 1);
-	}
+	JournalCommit();
 
-	/*** Chomper delay. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulChomperDelayA[iDiskImageA]; break;
-		case 2: ulOffset = ulChomperDelayB[iDiskImageB]; break;
-		case 3: ulOffset = ulChomperDelayC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEChomperDelay);
-		write (iFdEXE, sToWrite, 1);
-	}
+	/*** The next reader maps the file again, including these bytes. ***/
+	DiskImageClose();
 
-	/*** Mouse delay. ***/
-	switch (iHCSwitch)
-	{
-		case 1: ulOffset = ulMouseDelayA[iDiskImageA]; break;
-		case 2: ulOffset = ulMouseDelayB[iDiskImageB]; break;
-		case 3: ulOffset = ulMouseDelayC[iDiskImageC]; break;
-	}
-	if (ulOffset != 0x00)
-	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEMouseDelay);
-		write (iFdEXE, sToWrite, 1);
-	}
+	iModified = 1;
+}
+/*****************************************************************************/
+void PlaytestStop (void)
+/*****************************************************************************/
+{
+	int iOffsetStart;
+	unsigned char sToWrite[1 + 2];
 
-	/*** Guard settings. ***/
-	for (iTab = 1; iTab <= TABS_GUARD; iTab++)
-	{
-		switch (iHCSwitch)
-		{
-			case 1: ulOffset = ulGuardA[iDiskImageA][iTab - 1]; break;
-			case 2: ulOffset = ulGuardB[iDiskImageB][iTab - 1]; break;
-			case 3: ulOffset = ulGuardC[iDiskImageC][iTab - 1]; break;
-		}
-		if (ulOffset != 0x00)
-		{
-			lseek (iFdEXE, ulOffset, SEEK_SET);
-			for (iSkillLoop = 1; iSkillLoop <= 12; iSkillLoop++)
-			{
-				snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEGuard[iTab][iSkillLoop]);
-				write (iFdEXE, sToWrite, 1);
-			}
-		}
-	}
+	/*** Nothing is written before JournalCommit(). ***/
+	JournalStart();
 
-	/*** Guard HP. ***/
-	switch (iHCSwitch)
+	/*** [Undo] Skip the intro. ***/
+	switch (iHomeComputer)
 	{
-		case 1: ulOffset = ulGuardHPA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardHPB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardHPC[iDiskImageC]; break;
+		case 1: iOffsetStart = ulSkipIntroA[iDiskImageA]; break;
+		case 2: iOffsetStart = ulSkipIntroB[iDiskImageB]; break;
+		case 3: iOffsetStart = ulSkipIntroC[iDiskImageC]; break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
-	if (ulOffset != 0x00)
+	if (iOffsetStart != 0x00)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEGuardHP[iTab - 1]);
-				write (iFdEXE, sToWrite, 1);
-			}
-		}
+		sToWrite[0] = 0x8A;
+		JournalAdd (iOffsetStart, sToWrite, 1);
 	}
 
-	/*** Guard uniform. ***/
-	switch (iHCSwitch)
+	/*** [Undo] Set the starting level. ***/
+	switch (iHomeComputer)
 	{
-		case 1: ulOffset = ulGuardUniformA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardUniformB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardUniformC[iDiskImageC]; break;
+		case 1: iOffsetStart = ulStartLevelA[iDiskImageA]; break;
+		case 2: iOffsetStart = ulStartLevelB[iDiskImageB]; break;
+		case 3: iOffsetStart = ulStartLevelC[iDiskImageC]; break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
-	if (ulOffset != 0x00)
+	if (iOffsetStart != 0x00)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEGuardU[iTab - 1]);
-				write (iFdEXE, sToWrite, 1);
-			}
-		}
+		sToWrite[0] = 0x01;
+		JournalAdd (iOffsetStart, sToWrite, 1);
 	}
 
-	/*** Guard sprite. ***/
-	switch (iHCSwitch)
+	JournalCommit();
+
+	/*** The next reader maps the file again, including these bytes. ***/
+	DiskImageClose();
+
+	iModified = 0;
+}
+/*****************************************************************************/
+int DiskImageOpen (char *sPath)
+/*****************************************************************************/
+{
+	/* Maps the disk image, so that readers can use it as an array instead of
+	 * doing an lseek() and read() per byte. If sPath is already mapped, this
+	 * does nothing. Returns 0 on failure, with errno set.
+	 * The image may be shorter than expected, or empty (then arDiskImage is
+	 * NULL); readers must check ulDiskImageSize, as DiskImageRead() does.
+	 */
+
+	struct stat stStat;
+	int iErrno;
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	unsigned long ulDone;
+	int iRead;
+#endif
+
+	if ((iFdDiskImage != -1) && (strcmp (sDiskImage, sPath) == 0))
+		{ return (1); }
+	DiskImageClose();
+
+	iFdDiskImage = open (sPath, O_RDONLY|O_BINARY);
+	if (iFdDiskImage == -1) { return (0); }
+	if (fstat (iFdDiskImage, &stStat) == -1)
 	{
-		case 1: ulOffset = ulGuardSpriteA[iDiskImageA]; break;
-		case 2: ulOffset = ulGuardSpriteB[iDiskImageB]; break;
-		case 3: ulOffset = ulGuardSpriteC[iDiskImageC]; break;
+		iErrno = errno;
+		DiskImageClose();
+		errno = iErrno;
+		return (0);
 	}
-	if (ulOffset != 0x00)
+	ulDiskImageSize = stStat.st_size;
+	if (ulDiskImageSize == 0)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			if (iTab != TABS_LEVEL) /*** Level 14 has no guards. ***/
-			{
-				snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEGuardS[iTab - 1]);
-				write (iFdEXE, sToWrite, 1);
-			}
-		}
+		/*** Nothing to map; mmap() would fail with EINVAL. ***/
+		snprintf (sDiskImage, MAX_PATHFILE, "%s", sPath);
+		return (1);
 	}
 
-	/*** Update iCurGuard if necessary. ***/
-	if (iCurGuard != iEXEGuardS[iCurLevel])
-		{ iCurGuard = iEXEGuardS[iCurLevel]; }
-
-	/*** Env. 1 ***/
-	switch (iHCSwitch)
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	/*** No mmap(); keep a copy. ***/
+	arDiskImage = malloc (ulDiskImageSize + 1);
+	if (arDiskImage == NULL)
 	{
-		case 1: ulOffset = ulEnv1A[iDiskImageA]; break;
-		case 2: ulOffset = ulEnv1B[iDiskImageB]; break;
-		case 3: ulOffset = ulEnv1C[iDiskImageC]; break;
+		DiskImageClose();
+		errno = ENOMEM;
+		return (0);
 	}
-	if (ulOffset != 0x00)
+	ulDone = 0;
+	while (ulDone < ulDiskImageSize)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
+		iRead = read (iFdDiskImage, arDiskImage + ulDone,
+			ulDiskImageSize - ulDone);
+		if (iRead <= 0)
 		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEEnv1[iTab - 1]);
-			write (iFdEXE, sToWrite, 1);
+			iErrno = (iRead == 0) ? EIO : errno;
+			DiskImageClose();
+			errno = iErrno;
+			return (0);
 		}
+		ulDone+=iRead;
+	}
+#else
+	/*** Read-only; all writes go through the journal. ***/
+	arDiskImage = mmap (NULL, ulDiskImageSize, PROT_READ,
+		MAP_SHARED, iFdDiskImage, 0);
+	if (arDiskImage == MAP_FAILED)
+	{
+		arDiskImage = NULL;
+		iErrno = errno;
+		DiskImageClose();
+		errno = iErrno;
+		return (0);
 	}
+#endif
 
-	/*** Env. 2 ***/
-	switch (iHCSwitch)
+	snprintf (sDiskImage, MAX_PATHFILE, "%s", sPath);
+
+	return (1);
+}
+/*****************************************************************************/
+void DiskImageClose (void)
+/*****************************************************************************/
+{
+	if (arDiskImage != NULL)
 	{
-		case 1: ulOffset = ulEnv2A[iDiskImageA]; break;
-		case 2: ulOffset = ulEnv2B[iDiskImageB]; break;
-		case 3: ulOffset = ulEnv2C[iDiskImageC]; break;
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+		free (arDiskImage);
+#else
+		munmap (arDiskImage, ulDiskImageSize);
+#endif
+		arDiskImage = NULL;
 	}
-	if (ulOffset != 0x00)
+	if (iFdDiskImage != -1)
 	{
-		lseek (iFdEXE, ulOffset, SEEK_SET);
-		for (iTab = 1; iTab <= TABS_LEVEL; iTab++)
-		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c", iEXEEnv2[iTab - 1]);
-			write (iFdEXE, sToWrite, 1);
-		}
+		close (iFdDiskImage);
+		iFdDiskImage = -1;
 	}
+	ulDiskImageSize = 0;
+	snprintf (sDiskImage, MAX_PATHFILE, "%s", "");
+}
+/*****************************************************************************/
+unsigned char DiskImageRead (unsigned long ulOffset)
+/*****************************************************************************/
+{
+	if (ulOffset >= ulDiskImageSize) { return (0x00); }
 
-	/*** Update cCurType if necessary. ***/
-	if ((iEXEEnv1[iCurLevel] == 0x01) && (iEXEEnv2[iCurLevel] == 0x01) &&
-		(cCurType == 'd')) { cCurType = 'p'; }
-	if ((iEXEEnv1[iCurLevel] == 0x02) && (iEXEEnv2[iCurLevel] == 0x02) &&
-		(cCurType == 'p')) { cCurType = 'd'; }
-
-	close (iFdEXE);
-
-	PlaySound ("wav/save.wav");
+	return (arDiskImage[ulOffset]);
 }
 /*****************************************************************************/
-int PlusMinus (int *iWhat, int iX, int iY,
-	int iMin, int iMax, int iChange, int iAddChanged)
+void LevelChanged (void)
 /*****************************************************************************/
 {
-	if ((InArea (iX, iY, iX + 13, iY + 20) == 1) &&
-		(((iChange < 0) && (*iWhat > iMin)) ||
-		((iChange > 0) && (*iWhat < iMax))))
+	/*** Only changed levels are written by SaveLevels(). ***/
+	arLevelChanged[iCurLevel] = 1;
+	iChanged++;
+	UndoRecord();
+}
+/*****************************************************************************/
+unsigned long OffsetFor (const unsigned long *ulA, const unsigned long *ulB,
+	const unsigned long *ulC)
+/*****************************************************************************/
+{
+	switch (iHomeComputer)
 	{
-		*iWhat = *iWhat + iChange;
-		if ((iChange < 0) && (*iWhat < iMin)) { *iWhat = iMin; }
-		if ((iChange > 0) && (*iWhat > iMax)) { *iWhat = iMax; }
-		if (iAddChanged == 1) { iChanged++; }
-		PlaySound ("wav/plus_minus.wav");
-		return (1);
-	} else { return (0); }
+		case 1: return (ulA[iDiskImageA]);
+		case 2: return (ulB[iDiskImageB]);
+		case 3: return (ulC[iDiskImageC]);
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+	}
+	return (0x00);
 }
 /*****************************************************************************/
-void GetOptionValue (char *sArgv, char *sValue)
+int BackupRanges (unsigned long *arOffset, int *arSize)
 /*****************************************************************************/
 {
-	int iTemp;
-	char sTemp[MAX_OPTION + 2];
+	/* Fills in which parts of the disk image are backed up: the levels and
+	 * the bytes of the executable screen. Returns the number of ranges.
+	 */
 
-	iTemp = strlen (sArgv) - 1;
-	snprintf (sValue, MAX_OPTION, "%s", "");
-	while (sArgv[iTemp] != '=')
+	int iRanges;
+	int iUsed;
+	unsigned long ulOffset;
+
+	/*** Used for looping. ***/
+	int iLevelLoop;
+	int iTabLoop;
+	int iRangeLoop;
+
+	iRanges = 0;
+
+	for (iLevelLoop = 0; iLevelLoop < LEVELS; iLevelLoop++)
+	{
+		switch (iHomeComputer)
+		{
+			case 1: ulOffset = arLevelOffsetsA[iDiskImageA][iLevelLoop]; break;
+			case 2: ulOffset = arLevelOffsetsB[iDiskImageB][iLevelLoop]; break;
+			case 3: ulOffset = arLevelOffsetsC[iDiskImageC][iLevelLoop]; break;
+			default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		}
+		if (ulOffset != 0x00)
+		{
+			arOffset[iRanges] = ulOffset;
+			arSize[iRanges] = LEVEL_SIZE;
+			iRanges++;
+		}
+	}
+
+	for (iTabLoop = 0; iTabLoop < TABS_GUARD; iTabLoop++)
+	{
+		switch (iHomeComputer)
+		{
+			case 1: ulOffset = ulGuardA[iDiskImageA][iTabLoop]; break;
+			case 2: ulOffset = ulGuardB[iDiskImageB][iTabLoop]; break;
+			case 3: ulOffset = ulGuardC[iDiskImageC][iTabLoop]; break;
+			default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		}
+		if (ulOffset != 0x00)
+		{
+			arOffset[iRanges] = ulOffset;
+			arSize[iRanges] = 12;
+			iRanges++;
+		}
+	}
+
+	arOffset[iRanges] = OffsetFor (ulPrinceHPA, ulPrinceHPB, ulPrinceHPC);
+	arSize[iRanges++] = 1;
+	arOffset[iRanges] = OffsetFor (ulShadowHPA, ulShadowHPB, ulShadowHPC);
+	arSize[iRanges++] = 1;
+	arOffset[iRanges] = OffsetFor (ulChomperDelayA, ulChomperDelayB,
+		ulChomperDelayC);
+	arSize[iRanges++] = 1;
+	arOffset[iRanges] = OffsetFor (ulMouseDelayA, ulMouseDelayB,
+		ulMouseDelayC);
+	arSize[iRanges++] = 1;
+	arOffset[iRanges] = OffsetFor (ulGuardHPA, ulGuardHPB, ulGuardHPC);
+	arSize[iRanges++] = TABS_LEVEL - 1; /*** Level 14 has no guards. ***/
+	arOffset[iRanges] = OffsetFor (ulGuardUniformA, ulGuardUniformB,
+		ulGuardUniformC);
+	arSize[iRanges++] = TABS_LEVEL - 1;
+	arOffset[iRanges] = OffsetFor (ulGuardSpriteA, ulGuardSpriteB,
+		ulGuardSpriteC);
+	arSize[iRanges++] = TABS_LEVEL - 1;
+	arOffset[iRanges] = OffsetFor (ulEnv1A, ulEnv1B, ulEnv1C);
+	arSize[iRanges++] = TABS_LEVEL;
+	arOffset[iRanges] = OffsetFor (ulEnv2A, ulEnv2B, ulEnv2C);
+	arSize[iRanges++] = TABS_LEVEL;
+
+	/*** Drop the unused (0x00) ones. ***/
+	iUsed = 0;
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
 	{
-		snprintf (sTemp, MAX_OPTION, "%c%s", sArgv[iTemp], sValue);
-		snprintf (sValue, MAX_OPTION, "%s", sTemp);
-		iTemp--;
+		if (arOffset[iRangeLoop] != 0x00)
+		{
+			arOffset[iUsed] = arOffset[iRangeLoop];
+			arSize[iUsed] = arSize[iRangeLoop];
+			iUsed++;
+		}
 	}
+
+	return (iUsed);
 }
 /*****************************************************************************/
-int BitsToInt (char *sString)
+void BackupHash (unsigned char *sBytes, int iSize, char *sHash)
 /*****************************************************************************/
 {
-	/*** Converts binary to decimal. ***/
-	/*** Example: 11111111 to 255 ***/
+	/*** 64-bit FNV-1a, as 16 hex digits. ***/
 
-	int iTemp = 0;
+	unsigned long long ullHash;
+	int iByteLoop;
 
-	for (; *sString; iTemp = (iTemp << 1) | (*sString++ - '0'));
-	return (iTemp);
+	ullHash = 0xCBF29CE484222325ULL;
+	for (iByteLoop = 0; iByteLoop < iSize; iByteLoop++)
+	{
+		ullHash^=sBytes[iByteLoop];
+		ullHash*=0x100000001B3ULL;
+	}
+	snprintf (sHash, BACKUP_HASH + 1, "%016llx", ullHash);
 }
 /*****************************************************************************/
-void IntToBits (int iInt, char *sOutput, int iBits)
+void BackupDir (char *sDir)
 /*****************************************************************************/
 {
-	/*** Converts decimal to exactly iBits bits. ***/
-	/*** Example: 255 to 11111111 ***/
-
-	unsigned long luScale;
-	unsigned long luFinal;
-	int iTemp;
-	int iDigit;
-	char sOutputTemp[MAX_TOWRITE + 2];
-
-	iTemp = iInt;
-	luScale = 1;
-	luFinal = 0;
-
-	while (iTemp > 0)
-	{
-		iDigit = iTemp % 2;
-		luFinal+=iDigit * luScale;
-		iTemp = iTemp / 2;
-		luScale = luScale * 10;
-	}
-
-	snprintf (sOutput, MAX_TOWRITE, "%lu", luFinal);
-	if ((int)strlen (sOutput) != iBits)
+	switch (iHomeComputer)
 	{
-		do {
-			snprintf (sOutputTemp, MAX_TOWRITE, "%s", sOutput);
-			snprintf (sOutput, MAX_TOWRITE, "0%s", sOutputTemp);
-		} while ((int)strlen (sOutput) != iBits);
+		case 1: snprintf (sDir, MAX_PATHFILE, "%s", DISK_DIR_A SLASH BACKUP_DIR);
+			break;
+		case 2: snprintf (sDir, MAX_PATHFILE, "%s", DISK_DIR_B SLASH BACKUP_DIR);
+			break;
+		case 3: snprintf (sDir, MAX_PATHFILE, "%s", DISK_DIR_C SLASH BACKUP_DIR);
+			break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
 	}
 }
 /*****************************************************************************/
-void GetAsEightBits (unsigned char cChar, char *sBinary)
+int BackupNewest (char *sDir, int *iOldest)
 /*****************************************************************************/
 {
-	int i = CHAR_BIT;
-	int iTemp;
+	/*** Returns the highest version number in sDir (0 = none). ***/
 
-	iTemp = 0;
-	while (i > 0)
+	DIR *dDir;
+	struct dirent *stDirent;
+	int iVersion;
+	int iNewest;
+	char cEnd;
+
+	iNewest = 0;
+	if (iOldest != NULL) { *iOldest = 0; }
+	dDir = opendir (sDir);
+	if (dDir == NULL) { return (0); }
+	while ((stDirent = readdir (dDir)) != NULL)
 	{
-		i--;
-		if (cChar&(1 << i))
+		if ((strlen (stDirent->d_name) == 9) &&
+			(sscanf (stDirent->d_name, "%5d.tx%c", &iVersion, &cEnd) == 2) &&
+			(cEnd == 't') && (iVersion > 0))
 		{
-			sBinary[iTemp] = '1';
-		} else {
-			sBinary[iTemp] = '0';
+			if (iVersion > iNewest) { iNewest = iVersion; }
+			if ((iOldest != NULL) && ((*iOldest == 0) || (iVersion < *iOldest)))
+				{ *iOldest = iVersion; }
 		}
-		iTemp++;
 	}
-	sBinary[iTemp] = '\0';
+	closedir (dDir);
+
+	return (iNewest);
 }
 /*****************************************************************************/
-int ChecksumOrWrite (int iFd, int iLevel)
+int BackupRead (char *sDir, int iVersion, char *sTime,
+	unsigned long *arOffset, int *arSize, char arHash[][BACKUP_HASH + 2])
 /*****************************************************************************/
 {
-	long lSum;
-	char sToWrite[MAX_TOWRITE + 2];
-	int iSC;
-	char sBitsRoom[8 + 2];
-	char sBitsTile[8 + 2];
-	char sBinaryFDoors[9 + 2]; /*** 8 chars, plus \0 ***/
-	char sBinarySDoors[9 + 2]; /*** 8 chars, plus \0 ***/
-	char cNext;
-	unsigned char cStartDir;
+	/*** Reads a version's list of ranges. Returns the number of ranges. ***/
 
-	/*** Used for looping. ***/
-	int iRoomLoop;
-	int iTileLoop;
-	int iSideLoop;
+	char sFile[MAX_PATHFILE + 2];
+	char sLine[MAX_TEXT + 2];
+	FILE *fVersion;
+	int iRanges;
 
-	lSum = 0;
-
-	/*** Tiles. ***/
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	snprintf (sFile, MAX_PATHFILE, "%s%s%05i.txt", sDir, SLASH, iVersion);
+	fVersion = fopen (sFile, "r");
+	if (fVersion == NULL) { return (0); }
+	iRanges = 0;
+	snprintf (sTime, MAX_TEXT, "%s", "?");
+	while (fgets (sLine, MAX_TEXT, fVersion) != NULL)
 	{
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
+		if (strncmp (sLine, "time ", 5) == 0)
 		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c",
-				arRoomTiles[iLevel][iRoomLoop][iTileLoop]);
-			if (arRoomX[iLevel][iRoomLoop][iTileLoop] == 1)
-				{ sToWrite[0]+=32; }
-			if (iFd == -1)
-				{ lSum+=sToWrite[0]; }
-					else { write (iFd, sToWrite, 1); }
+			snprintf (sTime, MAX_TEXT, "%s", sLine + 5);
+			sTime[strcspn (sTime, "\r\n")] = '\0';
 		}
+		if ((iRanges < BACKUP_RANGES) &&
+			(sscanf (sLine, "range %lx %i %16s", &arOffset[iRanges],
+			&arSize[iRanges], arHash[iRanges]) == 3)) { iRanges++; }
 	}
+	fclose (fVersion);
 
-	/*** Mods. ***/
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
-	{
-		for (iTileLoop = 1; iTileLoop <= TILES; iTileLoop++)
-		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c",
-				arRoomMod[iLevel][iRoomLoop][iTileLoop]);
-			if (iFd == -1)
-				{ lSum+=sToWrite[0]; }
-					else { write (iFd, sToWrite, 1); }
-		}
-	}
+	return (iRanges);
+}
+/*****************************************************************************/
+void BackupVersion (void)
+/*****************************************************************************/
+{
+	/* Adds a version with the current disk image's levels and executable
+	 * bytes to the backup store. A range is stored in a file named after its
+	 * hash, so only ranges that are not in an earlier version take space.
+	 */
 
-	/*** Events. ***/
-	for (iSC = 1; iSC <= 256; iSC++)
-	{
-		IntToBits (arEventsRoom[iLevel][iSC], sBitsRoom, 5);
-		IntToBits (arEventsTile[iLevel][iSC] - 1, sBitsTile, 5);
-		cNext = '0'; /*** Fallback. ***/
-		switch (arEventsNext[iLevel][iSC])
-		{
-			case 0: cNext = '1'; break;
-			case 1: cNext = '0'; break;
-		}
-		sBinaryFDoors[0] = cNext;
-		sBinaryFDoors[1] = sBitsRoom[3];
-		sBinaryFDoors[2] = sBitsRoom[4];
-		sBinaryFDoors[3] = sBitsTile[0];
-		sBinaryFDoors[4] = sBitsTile[1];
-		sBinaryFDoors[5] = sBitsTile[2];
-		sBinaryFDoors[6] = sBitsTile[3];
-		sBinaryFDoors[7] = sBitsTile[4];
-		sBinaryFDoors[8] = '\0';
-
-		snprintf (sToWrite, MAX_TOWRITE, "%c", BitsToInt (sBinaryFDoors));
-		if (iFd == -1)
-			{ lSum+=sToWrite[0]; }
-				else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 256; iSC++)
+	char sDir[MAX_PATHFILE + 2];
+	char sFile[MAX_PATHFILE + 2];
+	char sTime[MAX_TEXT + 2];
+	char sList[BACKUP_LIST + 2];
+	int iList;
+	time_t tmNow;
+	unsigned long arOffset[BACKUP_RANGES + 2];
+	int arSize[BACKUP_RANGES + 2];
+	char arHash[BACKUP_RANGES + 2][BACKUP_HASH + 2];
+	unsigned long arOldOffset[BACKUP_RANGES + 2];
+	int arOldSize[BACKUP_RANGES + 2];
+	char arOldHash[BACKUP_RANGES + 2][BACKUP_HASH + 2];
+	int iRanges;
+	int iOldRanges;
+	int iNewest;
+	int iOldest;
+	int iSame;
+
+	/*** Used for looping. ***/
+	int iRangeLoop;
+
+	if (DiskImageOpen (sPathFile) == 0)
 	{
-		IntToBits (arEventsRoom[iLevel][iSC], sBitsRoom, 5);
-		IntToBits (arEventsTile[iLevel][iSC] - 1, sBitsTile, 5);
-		sBinarySDoors[0] = sBitsRoom[0];
-		sBinarySDoors[1] = sBitsRoom[1];
-		sBinarySDoors[2] = sBitsRoom[2];
-		/*** Not using arEventsTimer, for now. ***/
-		sBinarySDoors[3] = '0';
-		sBinarySDoors[4] = '0';
-		sBinarySDoors[5] = '0';
-		sBinarySDoors[6] = '0';
-		sBinarySDoors[7] = '0';
-		sBinarySDoors[8] = '\0';
-
-		snprintf (sToWrite, MAX_TOWRITE, "%c", BitsToInt (sBinarySDoors));
-		if (iFd == -1)
-			{ lSum+=sToWrite[0]; }
-				else { write (iFd, sToWrite, 1); }
+		printf ("[ WARN ] No backup was made. Could not open \"%s\": %s!\n",
+			sPathFile, strerror (errno));
+		return;
 	}
 
-	/*** Room links. ***/
-	for (iRoomLoop = 1; iRoomLoop <= ROOMS; iRoomLoop++)
+	BackupDir (sDir);
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	mkdir (sDir);
+#else
+	mkdir (sDir, 0755);
+#endif
+
+	iRanges = BackupRanges (arOffset, arSize);
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
 	{
-		for (iSideLoop = 1; iSideLoop <= 4; iSideLoop++)
+		if (arOffset[iRangeLoop] + arSize[iRangeLoop] > ulDiskImageSize)
 		{
-			snprintf (sToWrite, MAX_TOWRITE, "%c",
-				arRoomLinks[iLevel][iRoomLoop][iSideLoop]);
-			if (iFd == -1)
-				{ lSum+=sToWrite[0]; }
-					else { write (iFd, sToWrite, 1); }
+			printf ("[ WARN ] No backup was made. \"%s\" is too small!\n",
+				sPathFile);
+			return;
 		}
+		BackupHash (arDiskImage + arOffset[iRangeLoop], arSize[iRangeLoop],
+			arHash[iRangeLoop]);
 	}
 
-	/*** Unknown (64). ***/
-	for (iSC = 0; iSC < 64; iSC++)
+	/*** Nothing changed since the newest version? ***/
+	iNewest = BackupNewest (sDir, NULL);
+	iOldRanges = BackupRead (sDir, iNewest, sTime,
+		arOldOffset, arOldSize, arOldHash);
+	iSame = (iOldRanges == iRanges) ? 1 : 0;
+	for (iRangeLoop = 0; (iSame == 1) && (iRangeLoop < iRanges); iRangeLoop++)
 	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arBytes64[iLevel][iSC]);
-		if (iFd == -1)
-			{ lSum+=sToWrite[0]; }
-				else { write (iFd, sToWrite, 1); }
+		if ((arOldOffset[iRangeLoop] != arOffset[iRangeLoop]) ||
+			(strcmp (arOldHash[iRangeLoop], arHash[iRangeLoop]) != 0))
+			{ iSame = 0; }
 	}
-
-	/*** Start location. ***/
-	snprintf (sToWrite, MAX_TOWRITE, "%c", arStartLocation[iLevel][1]);
-	if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	snprintf (sToWrite, MAX_TOWRITE, "%c", arStartLocation[iLevel][2] - 1);
-	if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	snprintf (sToWrite, MAX_TOWRITE, "%c", arStartLocation[iLevel][3]);
-	/*** 2 of 2 ***/
-	if ((iLevel == 1) || (iLevel == 13))
+	if (iSame == 1)
 	{
-		if (arStartLocation[iLevel][3] == 0x00)
-			{ cStartDir = 0xFF; }
-				else { cStartDir = 0x00; }
-		snprintf (sToWrite, MAX_TOWRITE, "%c", cStartDir);
+		PrIfDe ("[ INFO ] The newest backup is identical.\n");
+		return;
 	}
-	if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
 
-	/*** Unknown (4). ***/
-	for (iSC = 0; iSC < 4; iSC++)
+	/*** Ranges. ***/
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
 	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arBytes4[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
+		snprintf (sFile, MAX_PATHFILE, "%s%s%s.bin", sDir, SLASH,
+			arHash[iRangeLoop]);
+		if ((access (sFile, F_OK) == -1) &&
+			(BackupWrite (sFile, arDiskImage + arOffset[iRangeLoop],
+			arSize[iRangeLoop]) == 0))
+		{
+			printf ("[ WARN ] No backup was made. Could not write \"%s\": %s!\n",
+				sFile, strerror (errno));
+			return;
+		}
 	}
 
-	/*** Guards. ***/
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardTile[iLevel][iSC] - 1);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardDir[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardUnk1[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardUnk2[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardSkill[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
-	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardUnk3[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
-	}
-	for (iSC = 1; iSC <= 24; iSC++)
+	/*** Version; only written once all its ranges are on disk. ***/
+	snprintf (sFile, MAX_PATHFILE, "%s%s%05i.txt", sDir, SLASH, iNewest + 1);
+	time (&tmNow);
+	strftime (sTime, MAX_TEXT, "%Y-%m-%d %H:%M:%S", localtime (&tmNow));
+	iList = snprintf (sList, BACKUP_LIST, "time %s\n", sTime);
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
 	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arGuardC[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
+		iList+=snprintf (sList + iList, BACKUP_LIST - iList, "range %lx %i %s\n",
+			arOffset[iRangeLoop], arSize[iRangeLoop], arHash[iRangeLoop]);
 	}
-
-	/*** Unknown (16). ***/
-	for (iSC = 0; iSC < 16; iSC++)
+	if (BackupWrite (sFile, (unsigned char *)sList, iList) == 0)
 	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", arBytes16[iLevel][iSC]);
-		if (iFd == -1) { lSum+=sToWrite[0]; } else { write (iFd, sToWrite, 1); }
+		printf ("[ WARN ] No backup was made. Could not write \"%s\": %s!\n",
+			sFile, strerror (errno));
+		return;
 	}
+	if (iDebug == 1)
+		{ printf ("[  OK  ] Created backup %i.\n", iNewest + 1); }
 
-	if (iFd != -1)
+	/*** Keep BACKUP_KEEP versions. ***/
+	BackupNewest (sDir, &iOldest);
+	if (iNewest + 1 - iOldest >= BACKUP_KEEP)
 	{
-		snprintf (sToWrite, MAX_TOWRITE, "%c", cChecksum);
-		write (iFd, sToWrite, 1);
-		if (iDebug == 1)
+		for (; iOldest <= iNewest + 1 - BACKUP_KEEP; iOldest++)
 		{
-			printf ("[ INFO ] Saved checksum: 0x%02x (%i)\n",
-				cChecksum, cChecksum);
+			snprintf (sFile, MAX_PATHFILE, "%s%s%05i.txt", sDir, SLASH, iOldest);
+			remove (sFile);
 		}
+		BackupClean (sDir);
 	}
-
-	return (255 - (lSum % 256));
 }
 /*****************************************************************************/
-int Verify (int iFd, int iOffset, char *sText)
+int BackupWrite (char *sFile, unsigned char *sBytes, int iSize)
 /*****************************************************************************/
 {
-	char sVerify[100 + 2];
-	int iSize;
+	/* Writes sFile completely or not at all: first to sFile.tmp, which is
+	 * flushed to disk and then renamed. Returns 0 on failure, with errno set.
+	 */
 
-	iSize = strlen (sText);
+	char sTemp[MAX_PATHFILE + 2];
+	int iFd;
+	int iDone;
+	int iWritten;
+	int iErrno;
 
-	lseek (iFd, iOffset, SEEK_SET);
-	read (iFd, sVerify, iSize);
-	sVerify[iSize] = '\0';
-	if (strcmp (sVerify, sText) != 0)
+	snprintf (sTemp, MAX_PATHFILE, "%s.tmp", sFile);
+	iFd = open (sTemp, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0666);
+	if (iFd == -1) { return (0); }
+	iDone = 0;
+	while (iDone < iSize)
+	{
+		iWritten = write (iFd, sBytes + iDone, iSize - iDone);
+		if (iWritten <= 0)
+		{
+			if (iWritten == 0) { errno = ENOSPC; }
+			break;
+		}
+		iDone+=iWritten;
+	}
+	if ((iDone < iSize) || (fsync (iFd) == -1))
 	{
+		iErrno = errno;
+		close (iFd);
+		unlink (sTemp);
+		errno = iErrno;
 		return (0);
-	} else {
-		return (1);
 	}
+	if ((close (iFd) == -1) || (rename (sTemp, sFile) == -1))
+	{
+		iErrno = errno;
+		unlink (sTemp);
+		errno = iErrno;
+		return (0);
+	}
+
+	return (SyncDir (sFile));
 }
 /*****************************************************************************/
-void GetTileMod (int iGetRoom, int iGetTile, int *iTile, int *iMod)
-/*****************************************************************************/
-{
-	*iTile = arRoomTiles[iCurLevel][iGetRoom][iGetTile];
-	if (arRoomX[iCurLevel][iGetRoom][iGetTile] == 1) { *iTile+=32; }
-	*iMod = arRoomMod[iCurLevel][iGetRoom][iGetTile];
-}
-/*****************************************************************************/
-void GetTileModChange (int iGetTile, int *iTile, int *iMod)
+void BackupClean (char *sDir)
 /*****************************************************************************/
 {
-	switch (iGetTile)
-	{
-		/*** Row 1. ***/
-		case 1: *iTile = 0x00; *iMod = 0x00; break;
-		case 2: *iTile = 0x00; *iMod = 0x01; break;
-		case 3: *iTile = 0x00; *iMod = 0x02; break;
-		case 4: *iTile = 0x00; *iMod = 0x03; break;
-		case 5: *iTile = 0x00; *iMod = 0xFF; break;
-		case 6: *iTile = 0x01; *iMod = 0x00; break;
-		case 7: *iTile = 0x01; *iMod = 0x01; break;
-		case 8: *iTile = 0x01; *iMod = 0x02; break;
-		case 9: *iTile = 0x01; *iMod = 0x03; break;
-		case 10: *iTile = 0x01; *iMod = 0xFF; break;
-		case 11: *iTile = 0x02; *iMod = 0x00; break;
-		case 12: *iTile = 0x02; *iMod = 0x01; break;
-		case 13: *iTile = 0x02; *iMod = 0x02; break;
-
-		/*** Row 2. ***/
-		case 14: *iTile = 0x02; *iMod = 0x03; break;
-		case 15: *iTile = 0x02; *iMod = 0x04; break;
-		case 16: *iTile = 0x02; *iMod = 0x05; break;
-		case 17: *iTile = 0x02; *iMod = 0x06; break;
-		case 18: *iTile = 0x02; *iMod = 0x07; break;
-		case 19: *iTile = 0x02; *iMod = 0x08; break;
-		case 20: *iTile = 0x02; *iMod = 0x09; break;
-		case 21: *iTile = 0x03; *iMod = 0x00; break;
-		case 22: *iTile = 0x04; *iMod = 0x02; break;
-		case 23: *iTile = 0x04; *iMod = 0x01; break;
-		case 24: *iTile = 0x05; *iMod = 0x00; break;
-		case 25: *iTile = 0x06; *iMod = iChangeEvent - 1; break;
-		case 26: *iTile = 0x07; *iMod = 0x00; break;
-
-		/*** Row 3. ***/
-		case 27: *iTile = 0x07; *iMod = 0x01; break;
-		case 28: *iTile = 0x07; *iMod = 0x02; break;
-		case 29: *iTile = 0x07; *iMod = 0x03; break;
-		case 30: *iTile = 0x08; *iMod = 0x00; break;
-		case 31: *iTile = 0x09; *iMod = 0x00; break;
-		case 32: *iTile = 0x0A; *iMod = 0x00; break;
-		case 33: *iTile = 0x0A; *iMod = 0x01; break;
-		case 34: *iTile = 0x0A; *iMod = 0x02; break;
-		case 35: *iTile = 0x0A; *iMod = 0x03; break;
-		case 36: *iTile = 0x0A; *iMod = 0x04; break;
-		case 37: *iTile = 0x0A; *iMod = 0x05; break;
-		case 38: *iTile = 0x0A; *iMod = 0x06; break;
-		case 39: *iTile = 0x0B; *iMod = 0x00; break;
+	/*** Removes the range files that no version uses. ***/
 
-		/*** Row 4. ***/
-		case 40: *iTile = 0x0C; *iMod = 0x00; break;
-		case 41: *iTile = 0x0C; *iMod = 0x01; break;
-		case 42: *iTile = 0x0C; *iMod = 0x02; break;
-		case 43: *iTile = 0x0C; *iMod = 0x03; break;
-		case 44: *iTile = 0x0C; *iMod = 0x04; break;
-		case 45: *iTile = 0x0C; *iMod = 0x05; break;
-		case 46: *iTile = 0x0C; *iMod = 0x06; break;
-		case 47: *iTile = 0x0C; *iMod = 0x07; break;
-		case 48: *iTile = 0x0D; *iMod = 0x00; break;
-		case 49: *iTile = 0x0E; *iMod = 0x00; break;
-		case 50: *iTile = 0x0F; *iMod = iChangeEvent - 1; break;
-		case 51: *iTile = 0x10; *iMod = 0x00; break;
-		case 52: *iTile = 0x11; *iMod = 0x00; break;
+	DIR *dDir;
+	struct dirent *stDirent;
+	char sFile[MAX_PATHFILE + 2];
+	char sTime[MAX_TEXT + 2];
+	unsigned long arOffset[BACKUP_RANGES + 2];
+	int arSize[BACKUP_RANGES + 2];
+	char arHash[BACKUP_RANGES + 2][BACKUP_HASH + 2];
+	char (*arUsed)[BACKUP_HASH + 2];
+	int iUsed;
+	int iRanges;
+	int iOldest;
+	int iNewest;
+	int iFound;
+	int iLength;
 
-		/*** Row 5. ***/
-		case 53: *iTile = 0x12; *iMod = 0x00; break;
-		case 54: *iTile = 0x12; *iMod = 0x01; break;
-		case 55: *iTile = 0x12; *iMod = 0x02; break;
-		case 56: *iTile = 0x12; *iMod = 0x03; break;
-		case 57: *iTile = 0x12; *iMod = 0x04; break;
-		case 58: *iTile = 0x12; *iMod = 0x05; break;
-		case 59: *iTile = 0x13; *iMod = 0x00; break;
-		case 60: *iTile = 0x14; *iMod = 0x00; break;
-		case 61: *iTile = 0x14; *iMod = 0x01; break;
-		case 62: *iTile = 0x15; *iMod = 0x00; break;
-		case 63: *iTile = 0x16; *iMod = 0x00; break;
-		case 64: *iTile = 0x17; *iMod = 0x00; break;
-		case 65: *iTile = 0x18; *iMod = 0x00; break;
+	/*** Used for looping. ***/
+	int iVersionLoop;
+	int iRangeLoop;
+	int iUsedLoop;
 
-		/*** Row 6. ***/
-		case 66: *iTile = 0x19; *iMod = 0x00; break;
-		case 67: *iTile = 0x1A; *iMod = 0x00; break;
-		case 68: *iTile = 0x1B; *iMod = 0x00; break;
-		case 69: *iTile = 0x1C; *iMod = 0x00; break;
-		case 70: *iTile = 0x1D; *iMod = 0x00; break;
-		case 71: *iTile = 0x1E; *iMod = 0x00; break;
-		case 72: *iTile = 0x2B; *iMod = 0x00; break;
-		case 73: *iTile = 0x12; *iMod = 0x80; break;
-		case 74: *iTile = 0x12; *iMod = 0x81; break;
-		case 75: *iTile = 0x12; *iMod = 0x82; break;
-		case 76: *iTile = 0x12; *iMod = 0x83; break;
-		case 77: *iTile = 0x12; *iMod = 0x84; break;
-		case 78: *iTile = 0x12; *iMod = 0x85; break;
+	iNewest = BackupNewest (sDir, &iOldest);
+	arUsed = malloc ((iNewest - iOldest + 1) * BACKUP_RANGES *
+		sizeof (*arUsed));
+	if (arUsed == NULL) { return; }
+	iUsed = 0;
+	for (iVersionLoop = iOldest; iVersionLoop <= iNewest; iVersionLoop++)
+	{
+		iRanges = BackupRead (sDir, iVersionLoop, sTime,
+			arOffset, arSize, arHash);
+		for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
+		{
+			snprintf (arUsed[iUsed++], BACKUP_HASH + 1, "%s", arHash[iRangeLoop]);
+		}
 	}
-}
-/*****************************************************************************/
-void ApplySkillIfNecessary (int iTile)
-/*****************************************************************************/
-{
-	if (arGuardTile[iCurLevel][iCurRoom] == iTile)
+
+	dDir = opendir (sDir);
+	if (dDir != NULL)
 	{
-		arGuardSkill[iCurLevel][iCurRoom] = iGuardType;
-		iChanged++;
+		while ((stDirent = readdir (dDir)) != NULL)
+		{
+			iFound = 1;
+			iLength = strlen (stDirent->d_name);
+			if ((iLength == BACKUP_HASH + 4) &&
+				(strcmp (stDirent->d_name + BACKUP_HASH, ".bin") == 0))
+				{ iFound = 0; }
+			for (iUsedLoop = 0; (iFound == 0) && (iUsedLoop < iUsed); iUsedLoop++)
+			{
+				if (strncmp (stDirent->d_name, arUsed[iUsedLoop], BACKUP_HASH) == 0)
+					{ iFound = 1; }
+			}
+			/*** Left behind by an interrupted BackupWrite(). ***/
+			if ((iLength > 4) &&
+				(strcmp (stDirent->d_name + iLength - 4, ".tmp") == 0))
+				{ iFound = 0; }
+			if (iFound == 0)
+			{
+				snprintf (sFile, MAX_PATHFILE, "%s%s%s", sDir, SLASH,
+					stDirent->d_name);
+				remove (sFile);
+			}
+		}
+		closedir (dDir);
 	}
+
+	free (arUsed);
 }
 /*****************************************************************************/
-void LoadingBar (int iBarHeight)
+void BackupList (void)
 /*****************************************************************************/
 {
-	SDL_Rect bar;
+	char sDir[MAX_PATHFILE + 2];
+	char sTime[MAX_TEXT + 2];
+	char sHash[BACKUP_HASH + 2];
+	unsigned long arOffset[BACKUP_RANGES + 2];
+	int arSize[BACKUP_RANGES + 2];
+	char arHash[BACKUP_RANGES + 2][BACKUP_HASH + 2];
+	int iRanges;
+	int iOldest;
+	int iNewest;
+	int iDiffer;
 
-	bar.x = (10 + 2) * iScale;
-	bar.y = (441 + 10 - 2 - iBarHeight) * iScale;
-	bar.w = (20 - 2 - 2) * iScale;
-	bar.h = iBarHeight * iScale;
-	SDL_SetRenderDrawColor (ascreen, 0x44, 0x44, 0x44, SDL_ALPHA_OPAQUE);
-	SDL_RenderFillRect (ascreen, &bar);
-	iCurrentBarHeight = iBarHeight;
+	/*** Used for looping. ***/
+	int iVersionLoop;
+	int iRangeLoop;
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
+	BackupDir (sDir);
+	iNewest = BackupNewest (sDir, &iOldest);
+	printf ("Backups of \"%s\" (%s):\n", sPathFile, sDir);
+	if (iNewest == 0) { printf ("  none\n"); return; }
+	if (DiskImageOpen (sPathFile) == 0)
+	{
+		printf ("[FAILED] Could not open \"%s\": %s!\n",
+			sPathFile, strerror (errno));
+		exit (EXIT_ERROR);
+	}
+	for (iVersionLoop = iOldest; iVersionLoop <= iNewest; iVersionLoop++)
+	{
+		iRanges = BackupRead (sDir, iVersionLoop, sTime,
+			arOffset, arSize, arHash);
+		/*** Compared to the current disk image. ***/
+		iDiffer = 0;
+		for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
+		{
+			if (arOffset[iRangeLoop] + arSize[iRangeLoop] > ulDiskImageSize)
+			{
+				iDiffer++;
+			} else {
+				BackupHash (arDiskImage + arOffset[iRangeLoop], arSize[iRangeLoop],
+					sHash);
+				if (strcmp (sHash, arHash[iRangeLoop]) != 0) { iDiffer++; }
+			}
+		}
+		if (iRanges != 0)
+		{
+			printf ("  %5i  %s  (%i of %i ranges differ from the disk image)\n",
+				iVersionLoop, sTime, iDiffer, iRanges);
+		}
+	}
 }
 /*****************************************************************************/
-void HomeComputerAction (char *sAction)
+void BackupRestore (int iVersion)
 /*****************************************************************************/
 {
-	if (strcmp (sAction, "one") == 0)
+	char sDir[MAX_PATHFILE + 2];
+	char sFile[MAX_PATHFILE + 2];
+	char sTime[MAX_TEXT + 2];
+	char sHash[BACKUP_HASH + 2];
+	unsigned long arOffset[BACKUP_RANGES + 2];
+	int arSize[BACKUP_RANGES + 2];
+	char arHash[BACKUP_RANGES + 2][BACKUP_HASH + 2];
+	unsigned char *sBytes;
+	FILE *fIn;
+	int iRanges;
+
+	/*** Used for looping. ***/
+	int iRangeLoop;
+
+	BackupDir (sDir);
+	iRanges = BackupRead (sDir, iVersion, sTime, arOffset, arSize, arHash);
+	if (iRanges < 1)
 	{
-		if (iAppleII == 1)
-		{
-			iHomeComputer = 1;
-			iHomeComputerActive = 0;
-		}
+		printf ("[FAILED] There is no backup %i in \"%s\"!\n", iVersion, sDir);
+		exit (EXIT_ERROR);
 	}
 
-	if (strcmp (sAction, "two") == 0)
+	/*** A damaged list must not make JournalAdd() write past the image. ***/
+	if (DiskImageOpen (sPathFile) == 0)
 	{
-		if (iBBCMaster == 1)
+		printf ("[FAILED] Could not open \"%s\": %s!\n",
+			sPathFile, strerror (errno));
+		exit (EXIT_ERROR);
+	}
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
+	{
+		if ((arSize[iRangeLoop] < 1) || (arSize[iRangeLoop] > LEVEL_SIZE) ||
+			(arOffset[iRangeLoop] > ulDiskImageSize) ||
+			((unsigned long)arSize[iRangeLoop] >
+			ulDiskImageSize - arOffset[iRangeLoop]))
 		{
-			iHomeComputer = 2;
-			iHomeComputerActive = 0;
+			printf ("[FAILED] Backup %i has a range (0x%lx, %i bytes) outside"
+				" \"%s\"!\n", iVersion, arOffset[iRangeLoop],
+				arSize[iRangeLoop], sPathFile);
+			exit (EXIT_ERROR);
 		}
 	}
 
-	if (strcmp (sAction, "three") == 0)
+	/*** Read and check all ranges before changing anything. ***/
+	sBytes = malloc (iRanges * LEVEL_SIZE);
+	if (sBytes == NULL)
 	{
-		if (iC64 == 1)
+		printf ("[FAILED] Could not allocate memory!\n");
+		exit (EXIT_ERROR);
+	}
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
+	{
+		snprintf (sFile, MAX_PATHFILE, "%s%s%s.bin", sDir, SLASH,
+			arHash[iRangeLoop]);
+		fIn = fopen (sFile, "rb");
+		if ((fIn == NULL) || (arSize[iRangeLoop] < 1) ||
+			(arSize[iRangeLoop] > LEVEL_SIZE) ||
+			(fread (sBytes + (iRangeLoop * LEVEL_SIZE), 1, arSize[iRangeLoop],
+			fIn) != (size_t)arSize[iRangeLoop]))
 		{
-			iHomeComputer = 3;
-			iHomeComputerActive = 0;
+			printf ("[FAILED] Could not read \"%s\"!\n", sFile);
+			exit (EXIT_ERROR);
+		}
+		fclose (fIn);
+		BackupHash (sBytes + (iRangeLoop * LEVEL_SIZE), arSize[iRangeLoop],
+			sHash);
+		if (strcmp (sHash, arHash[iRangeLoop]) != 0)
+		{
+			printf ("[FAILED] File \"%s\" is damaged!\n", sFile);
+			exit (EXIT_ERROR);
 		}
 	}
+
+	/*** So that this restore can be undone. ***/
+	BackupVersion();
+	DiskImageClose();
+
+	JournalStart();
+	for (iRangeLoop = 0; iRangeLoop < iRanges; iRangeLoop++)
+	{
+		JournalAdd (arOffset[iRangeLoop], sBytes + (iRangeLoop * LEVEL_SIZE),
+			arSize[iRangeLoop]);
+	}
+	JournalCommit();
+	free (sBytes);
+
+	printf ("[  OK  ] Restored backup %i (%s) to \"%s\".\n",
+		iVersion, sTime, sPathFile);
 }
 /*****************************************************************************/
-void HomeComputer (void)
+void Backups (int iList, int iRestore)
 /*****************************************************************************/
 {
-	SDL_Event event;
-	int iOldXPos, iOldYPos;
+	/*** For the --backups and --restore=NR options. ***/
 
-	iHomeComputerActive = 1;
+	int iOnly;
+	int iAvailable;
 
-	ShowHomeComputer();
-	while (iHomeComputerActive == 1)
+	/*** Used for looping. ***/
+	int iHCLoop;
+
+	iOnly = iHomeComputer;
+	if ((iRestore != 0) && (iOnly == 0))
 	{
-		while (SDL_PollEvent (&event))
-		{
-			switch (event.type)
-			{
-				case SDL_CONTROLLERBUTTONDOWN:
-					/*** Nothing for now. ***/
-					break;
-				case SDL_CONTROLLERBUTTONUP:
-					switch (event.cbutton.button)
-					{
-						case SDL_CONTROLLER_BUTTON_A:
-						case SDL_CONTROLLER_BUTTON_START:
-							if ((iAppleII == 1) && (iOnAppleII == 1))
-								{ HomeComputerAction ("one"); }
-							if ((iBBCMaster == 1) && (iOnBBCMaster == 1))
-								{ HomeComputerAction ("two"); }
-							if ((iC64 == 1) && (iOnC64 == 1))
-								{ HomeComputerAction ("three"); }
-							break;
-						case SDL_CONTROLLER_BUTTON_B:
-						case SDL_CONTROLLER_BUTTON_BACK:
-							Quit(); break;
-						case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
-						case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-							if ((iOnC64 == 1) && (iBBCMaster == 1))
-							{
-								iOnBBCMaster = 1; iOnC64 = 0;
-								ShowHomeComputer();
-							} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
-								iOnAppleII = 1; iOnBBCMaster = 0;
-								ShowHomeComputer();
-							}
-							break;
-						case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
-						case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-							if ((iOnAppleII == 1) && (iBBCMaster == 1))
-							{
-								iOnAppleII = 0; iOnBBCMaster = 1;
-								ShowHomeComputer();
-							} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
-								iOnBBCMaster = 0; iOnC64 = 1;
-								ShowHomeComputer();
-							}
-							break;
-						case SDL_CONTROLLER_BUTTON_X:
-							HomeComputerAction ("one");
-							break;
-						case SDL_CONTROLLER_BUTTON_Y:
-							HomeComputerAction ("two");
-							break;
-						case SDL_CONTROLLER_BUTTON_GUIDE:
-							HomeComputerAction ("three");
-							break;
-					}
-					ShowHomeComputer();
-					break;
-				case SDL_CONTROLLERAXISMOTION: /*** triggers and analog sticks ***/
-					iXJoy1 = SDL_JoystickGetAxis (joystick, 0);
-					iXJoy2 = SDL_JoystickGetAxis (joystick, 3);
-					if ((event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERLEFT) ||
-						(iXJoy1 < -30000) || (iXJoy2 < -30000)) /*** left ***/
-					{
-						if ((iOnC64 == 1) && (iBBCMaster == 1))
-						{
-							iOnBBCMaster = 1; iOnC64 = 0;
-							ShowHomeComputer();
-						} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
-							iOnAppleII = 1; iOnBBCMaster = 0;
-							ShowHomeComputer();
-						}
-					}
-					if ((event.caxis.axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT) ||
-						(iXJoy1 > 30000) || (iXJoy2 > 30000)) /*** right ***/
-					{
-						if ((iOnAppleII == 1) && (iBBCMaster == 1))
-						{
-							iOnAppleII = 0; iOnBBCMaster = 1;
-							ShowHomeComputer();
-						} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
-							iOnBBCMaster = 0; iOnC64 = 1;
-							ShowHomeComputer();
-						}
-					}
-					break;
-				case SDL_KEYDOWN:
-					switch (event.key.keysym.sym)
-					{
-						case SDLK_ESCAPE:
-							Quit(); break;
-						case SDLK_KP_ENTER:
-						case SDLK_RETURN:
-						case SDLK_SPACE:
-							if ((iAppleII == 1) && (iOnAppleII == 1))
-								{ HomeComputerAction ("one"); }
-							if ((iBBCMaster == 1) && (iOnBBCMaster == 1))
-								{ HomeComputerAction ("two"); }
-							if ((iC64 == 1) && (iOnC64 == 1))
-								{ HomeComputerAction ("three"); }
-							break;
-						case SDLK_1: /*** Apple II ***/
-							HomeComputerAction ("one");
-							break;
-						case SDLK_2: /*** BBC Master ***/
-							HomeComputerAction ("two");
-							break;
-						case SDLK_3: /*** C64 ***/
-							HomeComputerAction ("three");
-							break;
-						case SDLK_LEFT:
-							if ((iOnC64 == 1) && (iBBCMaster == 1))
-							{
-								iOnBBCMaster = 1; iOnC64 = 0;
-								ShowHomeComputer();
-							} else if ((iOnBBCMaster == 1) && (iAppleII == 1)) {
-								iOnAppleII = 1; iOnBBCMaster = 0;
-								ShowHomeComputer();
-							}
-							break;
-						case SDLK_RIGHT:
-							if ((iOnAppleII == 1) && (iBBCMaster == 1))
-							{
-								iOnAppleII = 0; iOnBBCMaster = 1;
-								ShowHomeComputer();
-							} else if ((iOnBBCMaster == 1) && (iC64 == 1)) {
-								iOnBBCMaster = 0; iOnC64 = 1;
-								ShowHomeComputer();
-							}
-							break;
-						default: break;
-					}
-					ShowHomeComputer();
-					break;
-				case SDL_MOUSEMOTION:
-					iOldXPos = iXPos;
-					iOldYPos = iYPos;
-					iXPos = event.motion.x;
-					iYPos = event.motion.y;
-					if ((iOldXPos == iXPos) && (iOldYPos == iYPos)) { break; }
+		printf ("[FAILED] Use --restore with -a, -b or -c!\n");
+		exit (EXIT_ERROR);
+	}
 
-					if (InArea (22, 22, 22 + 176, 22 + 417) == 1) /*** Apple II ***/
-					{
-						if ((iAppleII == 1) && (iOnAppleII != 1))
-							{ iOnAppleII = 1; iOnBBCMaster = 0; iOnC64 = 0; }
-					} else if (InArea (218, 22, 218 + 176, 22 + 417) == 1) { /*** BM ***/
-						if ((iBBCMaster == 1) && (iOnBBCMaster != 1))
-							{ iOnAppleII = 0; iOnBBCMaster = 1; iOnC64 = 0; }
-					} else if (InArea (414, 22, 414 + 176, 22 + 417) == 1) { /*** C ***/
-						if ((iC64 == 1) && (iOnC64 != 1))
-							{ iOnAppleII = 0; iOnBBCMaster = 0; iOnC64 = 1; }
-					} else {
-						iOnAppleII = 0; iOnBBCMaster = 0; iOnC64 = 0;
-					}
-					ShowHomeComputer();
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					/*** Nothing for now. ***/
-					break;
-				case SDL_MOUSEBUTTONUP:
-					iOnAppleII = 0;
-					iOnBBCMaster = 0;
-					if (event.button.button == 1)
-					{
-						if (InArea (22, 22, 22 + 176, 22 + 417) == 1)
-						{ /*** Apple II ***/
-							HomeComputerAction ("one");
-						}
-						if (InArea (218, 22, 218 + 176, 22 + 417) == 1)
-						{ /*** BBC Master ***/
-							HomeComputerAction ("two");
-						}
-						if (InArea (414, 22, 414 + 176, 22 + 417) == 1)
-						{ /*** C64 ***/
-							HomeComputerAction ("three");
-						}
-					}
-					ShowHomeComputer(); break;
-				case SDL_WINDOWEVENT:
-					if (event.window.event == SDL_WINDOWEVENT_EXPOSED)
-						{ ShowHomeComputer(); } break;
-				case SDL_QUIT:
-					Quit(); break;
-			}
+	for (iHCLoop = 1; iHCLoop <= 3; iHCLoop++)
+	{
+		switch (iHCLoop)
+		{
+			case 1:
+				iAvailable = iAppleII;
+				snprintf (sPathFile, MAX_PATHFILE, "%s", sPathFileA); break;
+			case 2:
+				iAvailable = iBBCMaster;
+				snprintf (sPathFile, MAX_PATHFILE, "%s", sPathFileB); break;
+			default:
+				iAvailable = iC64;
+				snprintf (sPathFile, MAX_PATHFILE, "%s", sPathFileC); break;
+		}
+		if ((iAvailable == 1) && ((iOnly == 0) || (iOnly == iHCLoop)))
+		{
+			iHomeComputer = iHCLoop;
+			if (iRestore != 0) { BackupRestore (iRestore); }
+			if (iList == 1) { BackupList(); }
 		}
 	}
 
-	/*** prevent CPU eating ***/
-	gamespeed = REFRESH_PROG;
-	while ((SDL_GetTicks() - looptime) < gamespeed)
+	DiskImageClose();
+	exit (EXIT_NORMAL);
+}
+/*****************************************************************************/
+void JournalStart (void)
+/*****************************************************************************/
+{
+	/*** The header (magic and number of ranges) is filled in on commit. ***/
+	iJournalSize = 8;
+	iJournalRanges = 0;
+}
+/*****************************************************************************/
+void JournalAdd (unsigned long ulOffset, unsigned char *sBytes, int iSize)
+/*****************************************************************************/
+{
+	/*** Used for looping. ***/
+	int iByteLoop;
+
+	if (iJournalSize + 8 + iSize > JOURNAL_SIZE - BACKUP_HASH)
+	{
+		printf ("[FAILED] The journal is full!\n");
+		exit (EXIT_ERROR);
+	}
+
+	/*** Offset and size, big-endian. ***/
+	for (iByteLoop = 0; iByteLoop < 4; iByteLoop++)
 	{
-		SDL_Delay (10);
+		arJournal[iJournalSize + iByteLoop] =
+			(ulOffset >> (24 - (iByteLoop * 8))) & 0xFF;
+		arJournal[iJournalSize + 4 + iByteLoop] =
+			(iSize >> (24 - (iByteLoop * 8))) & 0xFF;
 	}
-	looptime = SDL_GetTicks();
+	memcpy (arJournal + iJournalSize + 8, sBytes, iSize);
+	iJournalSize += 8 + iSize;
+	iJournalRanges++;
 }
 /*****************************************************************************/
-void ShowHomeComputer (void)
+unsigned long JournalNumber (unsigned char *sBytes)
 /*****************************************************************************/
 {
-	/*** background ***/
-	ShowImage (imghc, 0, 0, "imghc");
+	return (((unsigned long)sBytes[0] << 24) | ((unsigned long)sBytes[1] << 16) |
+		((unsigned long)sBytes[2] << 8) | (unsigned long)sBytes[3]);
+}
+/*****************************************************************************/
+int JournalValid (unsigned char *sJournal, int iSize)
+/*****************************************************************************/
+{
+	/* Returns 1 if sJournal is a complete journal: the magic, the
+	 * ranges that it announces, and a hash over all of that.
+	 */
 
-	/*** Apple II ***/
-	if (iAppleII == 0)
+	char sHash[BACKUP_HASH + 2];
+	unsigned long ulRanges;
+	unsigned long ulRangeSize;
+	int iAt;
+
+	/*** Used for looping. ***/
+	unsigned long ulRangeLoop;
+
+	if ((iSize < 8 + BACKUP_HASH) ||
+		(memcmp (sJournal, JOURNAL_MAGIC, 4) != 0)) { return (0); }
+	BackupHash (sJournal, iSize - BACKUP_HASH, sHash);
+	if (memcmp (sJournal + iSize - BACKUP_HASH, sHash, BACKUP_HASH) != 0)
+		{ return (0); }
+
+	ulRanges = JournalNumber (sJournal + 4);
+	iAt = 8;
+	for (ulRangeLoop = 0; ulRangeLoop < ulRanges; ulRangeLoop++)
 	{
-		/*** disabled ***/
-		ShowImage (imghcadis, 22, 22, "imghcadis");
-	} else if (iOnAppleII == 0) {
-		/*** off ***/
-		ShowImage (imghcaoff, 22, 22, "imghcaoff");
-	} else {
-		/*** on ***/
-		ShowImage (imghcaon, 22, 22, "imghcaon");
+		if (iAt + 8 > iSize - BACKUP_HASH) { return (0); }
+		ulRangeSize = JournalNumber (sJournal + iAt + 4);
+		if (ulRangeSize > (unsigned long)(iSize - BACKUP_HASH - iAt - 8))
+			{ return (0); }
+		iAt += 8 + ulRangeSize;
 	}
+	if (iAt != iSize - BACKUP_HASH) { return (0); }
 
-	/*** BBC Master ***/
-	if (iBBCMaster == 0)
+	return (1);
+}
+/*****************************************************************************/
+int JournalApply (char *sPath, unsigned char *sJournal, int iSize)
+/*****************************************************************************/
+{
+	/*** Writes the ranges of a valid journal to sPath. ***/
+
+	int iFd;
+	unsigned long ulRanges;
+	unsigned long ulRangeSize;
+	int iAt;
+
+	/*** Used for looping. ***/
+	unsigned long ulRangeLoop;
+
+	if (JournalValid (sJournal, iSize) == 0) { return (0); }
+
+	iFd = open (sPath, O_WRONLY|O_BINARY);
+	if (iFd == -1) { return (0); }
+	ulRanges = JournalNumber (sJournal + 4);
+	iAt = 8;
+	for (ulRangeLoop = 0; ulRangeLoop < ulRanges; ulRangeLoop++)
 	{
-		/*** disabled ***/
-		ShowImage (imghcbdis, 218, 22, "imghcbdis");
-	} else if (iOnBBCMaster == 0) {
-		/*** off ***/
-		ShowImage (imghcboff, 218, 22, "imghcboff");
-	} else {
-		/*** on ***/
-		ShowImage (imghcbon, 218, 22, "imghcbon");
+		ulRangeSize = JournalNumber (sJournal + iAt + 4);
+		if ((lseek (iFd, JournalNumber (sJournal + iAt), SEEK_SET) == -1) ||
+			(write (iFd, sJournal + iAt + 8, ulRangeSize) != (ssize_t)ulRangeSize))
+		{
+			close (iFd);
+			return (0);
+		}
+		iAt += 8 + ulRangeSize;
 	}
-
-	/*** C64 ***/
-	if (iC64 == 0)
+	if (fsync (iFd) == -1)
 	{
-		/*** disabled ***/
-		ShowImage (imghccdis, 414, 22, "imghccdis");
-	} else if (iOnC64 == 0) {
-		/*** off ***/
-		ShowImage (imghccoff, 414, 22, "imghccoff");
-	} else {
-		/*** on ***/
-		ShowImage (imghccon, 414, 22, "imghccon");
+		close (iFd);
+		return (0);
 	}
+	close (iFd);
 
-	/*** refresh screen ***/
-	SDL_RenderPresent (ascreen);
+	return (1);
 }
 /*****************************************************************************/
-void PlaytestStart (int iLevel)
+void JournalFile (char *sJournal)
+/*****************************************************************************/
+{
+	switch (iHomeComputer)
+	{
+		case 1: snprintf (sJournal, MAX_PATHFILE, "%s", JOURNAL_A); break;
+		case 2: snprintf (sJournal, MAX_PATHFILE, "%s", JOURNAL_B); break;
+		case 3: snprintf (sJournal, MAX_PATHFILE, "%s", JOURNAL_C); break;
+		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+	}
+}
+/*****************************************************************************/
+void JournalCommit (void)
 /*****************************************************************************/
 {
+	/* Stages everything added since JournalStart() in the journal file,
+	 * and only then patches the disk image. If leapop (or the computer)
+	 * stops halfway, JournalReplay() finishes the job on the next start.
+	 */
+
+	char sJournal[MAX_PATHFILE + 2];
 	int iFd;
-	int iOffsetStart;
-	char sToWrite[MAX_TOWRITE + 2];
 
-	/*** Open file. ***/
-	iFd = open (sPathFile, O_RDWR|O_BINARY, 0600);
+	/*** Used for looping. ***/
+	int iByteLoop;
+
+	if (iJournalRanges == 0) { return; }
+
+	memcpy (arJournal, JOURNAL_MAGIC, 4);
+	for (iByteLoop = 0; iByteLoop < 4; iByteLoop++)
+	{
+		arJournal[4 + iByteLoop] =
+			(iJournalRanges >> (24 - (iByteLoop * 8))) & 0xFF;
+	}
+	BackupHash (arJournal, iJournalSize, (char *)arJournal + iJournalSize);
+	iJournalSize += BACKUP_HASH;
+
+	JournalFile (sJournal);
+	iFd = open (sJournal, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0666);
 	if (iFd == -1)
 	{
-		printf ("[FAILED] Error opening %s: %s!\n",
-			sPathFile, strerror (errno));
+		printf ("[FAILED] Could not create \"%s\": %s!\n",
+			sJournal, strerror (errno));
 		exit (EXIT_ERROR);
 	}
-
-	/*** Skip the intro. ***/
-	switch (iHomeComputer)
+	if ((write (iFd, arJournal, iJournalSize) != iJournalSize) ||
+		(fsync (iFd) == -1))
 	{
-		case 1: iOffsetStart = ulSkipIntroA[iDiskImageA]; break;
-		case 2: iOffsetStart = ulSkipIntroB[iDiskImageB]; break;
-		case 3: iOffsetStart = ulSkipIntroC[iDiskImageC]; break;
-		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		printf ("[FAILED] Could not write to \"%s\": %s!\n",
+			sJournal, strerror (errno));
+		close (iFd);
+		unlink (sJournal);
+		exit (EXIT_ERROR);
 	}
-	if (iOffsetStart != 0x00)
+	close (iFd);
+	/*** The journal's directory entry must be on disk as well. ***/
+	if (SyncDir (sJournal) == 0)
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", 0xD5);
-		write (iFd, sToWrite, 1);
+		printf ("[FAILED] Could not write to \"%s\": %s!\n",
+			sJournal, strerror (errno));
+		unlink (sJournal);
+		exit (EXIT_ERROR);
 	}
 
-	/*** Set the starting level. ***/
-	switch (iHomeComputer)
+	if (JournalApply (sPathFile, arJournal, iJournalSize) == 0)
 	{
-		case 1: iOffsetStart = ulStartLevelA[iDiskImageA]; break;
-		case 2: iOffsetStart = ulStartLevelB[iDiskImageB]; break;
-		case 3: iOffsetStart = ulStartLevelC[iDiskImageC]; break;
-		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		/*** The journal stays, for the next start. ***/
+		printf ("[FAILED] Could not write to \"%s\": %s!\n",
+			sPathFile, strerror (errno));
+		exit (EXIT_ERROR);
 	}
-	if (iOffsetStart != 0x00)
+	unlink (sJournal);
+	/*** If this is lost, the next start only applies the journal again. ***/
+	SyncDir (sJournal);
+
+	iJournalSize = 0;
+	iJournalRanges = 0;
+}
+/*****************************************************************************/
+void JournalReplay (char *sPath, char *sJournal)
+/*****************************************************************************/
+{
+	/*** Finishes or discards a save that was interrupted. ***/
+
+	int iFd;
+	int iSize;
+	char sWarning[MAX_WARNING + 2];
+
+	iFd = open (sJournal, O_RDONLY|O_BINARY);
+	if (iFd == -1) { return; }
+	iSize = read (iFd, arJournal, JOURNAL_SIZE + 1);
+	close (iFd);
+
+	if ((iSize > 0) && (iSize <= JOURNAL_SIZE) &&
+		(JournalValid (arJournal, iSize) == 1))
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", iLevel);
-		write (iFd, sToWrite, 1);
+		if (JournalApply (sPath, arJournal, iSize) == 1)
+		{
+			printf ("[ INFO ] Finished an interrupted save to \"%s\".\n", sPath);
+			unlink (sJournal);
+			SyncDir (sJournal);
+		} else {
+			/*** Keep the journal, and try again next time. ***/
+			snprintf (sWarning, MAX_WARNING, "Could not finish an interrupted"
+				" save to \"%s\": %s!", sPath, strerror (errno));
+			printf ("[ WARN ] %s\n", sWarning);
+			SDL_ShowSimpleMessageBox (SDL_MESSAGEBOX_ERROR,
+				"Warning", sWarning, NULL);
+		}
+	} else {
+		/*** Not (completely) staged, so the disk image was not touched. ***/
+		snprintf (sWarning, MAX_WARNING, "An interrupted save to \"%s\" was"
+			" discarded; the disk image is as it was before that save.", sPath);
+		printf ("[ WARN ] %s\n", sWarning);
+		SDL_ShowSimpleMessageBox (SDL_MESSAGEBOX_ERROR,
+			"Warning", sWarning, NULL);
+		unlink (sJournal);
+		SyncDir (sJournal);
 	}
+	iJournalSize = 0;
+}
+/*****************************************************************************/
+int SyncDir (char *sPath)
+/*****************************************************************************/
+{
+	/* Flushes the directory that contains sPath, so that a file created,
+	 * renamed or removed there survives a crash. Returns 0 on failure, with
+	 * errno set. On Windows, there is nothing to do; NTFS journals this.
+	 */
+
+#if defined WIN32 || _WIN32 || WIN64 || _WIN64
+	if (sPath != NULL) { } /*** To prevent warnings. ***/
+
+	return (1);
+#else
+	char sDir[MAX_PATHFILE + 2];
+	char *sSlash;
+	int iFd;
+	int iResult;
 
+	snprintf (sDir, MAX_PATHFILE, "%s", sPath);
+	sSlash = strrchr (sDir, '/');
+	if (sSlash == NULL)
+	{
+		snprintf (sDir, MAX_PATHFILE, "%s", ".");
+	} else if (sSlash == sDir) {
+		sDir[1] = '\0';
+	} else {
+		sSlash[0] = '\0';
+	}
+	iFd = open (sDir, O_RDONLY);
+	if (iFd == -1) { return (0); }
+	iResult = (fsync (iFd) == -1) ? 0 : 1;
 	close (iFd);
 
-	iModified = 1;
+	return (iResult);
+#endif
 }
 /*****************************************************************************/
-void PlaytestStop (void)
+void UndoReset (void)
 /*****************************************************************************/
 {
-	int iFd;
-	int iOffsetStart;
-	char sToWrite[MAX_TOWRITE + 2];
+	/*** Forgets all steps, and remembers all levels as they are now. ***/
 
-	/*** Open file. ***/
-	iFd = open (sPathFile, O_RDWR|O_BINARY, 0600);
-	if (iFd == -1)
+	/*** Used for looping. ***/
+	int iLevelLoop;
+
+	for (iLevelLoop = 1; iLevelLoop <= LEVELS; iLevelLoop++)
 	{
-		printf ("[FAILED] Error opening %s: %s!\n",
-			sPathFile, strerror (errno));
-		exit (EXIT_ERROR);
+		memcpy (&arUndoShadow[iLevelLoop], &arLevels[iLevelLoop],
+			sizeof (struct level));
+		arUndoDone[iLevelLoop] = -1;
+		arUndoRedo[iLevelLoop] = -1;
 	}
+	iUndoOldest = iUndoSteps;
+	iUndoOldestDelta = iUndoDeltas;
+	iUndoOpen = -1;
+}
+/*****************************************************************************/
+void UndoForget (int iLevel)
+/*****************************************************************************/
+{
+	/* Forgets the steps of iLevel, for when it is put back as it is on
+	 * disk. Its steps stay in the rings until they are dropped, but can no
+	 * longer be reached.
+	 */
 
-	/*** [Undo] Skip the intro. ***/
-	switch (iHomeComputer)
+	memcpy (&arUndoShadow[iLevel], &arLevels[iLevel], sizeof (struct level));
+	arUndoDone[iLevel] = -1;
+	arUndoRedo[iLevel] = -1;
+	if ((iUndoOpen != -1) && (arUndo[iUndoOpen % UNDO_STEPS].iLevel == iLevel))
+		{ iUndoOpen = -1; }
+}
+/*****************************************************************************/
+int UndoValid (int iStep)
+/*****************************************************************************/
+{
+	return ((iStep != -1) && (iStep >= iUndoOldest) ? 1 : 0);
+}
+/*****************************************************************************/
+void UndoDrop (void)
+/*****************************************************************************/
+{
+	/*** Drops the oldest step, with its deltas. ***/
+
+	iUndoOldest++;
+	if (iUndoOldest < iUndoSteps)
 	{
-		case 1: iOffsetStart = ulSkipIntroA[iDiskImageA]; break;
-		case 2: iOffsetStart = ulSkipIntroB[iDiskImageB]; break;
-		case 3: iOffsetStart = ulSkipIntroC[iDiskImageC]; break;
-		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		iUndoOldestDelta = arUndo[iUndoOldest % UNDO_STEPS].iFirst;
+	} else {
+		iUndoOldestDelta = iUndoDeltas;
 	}
-	if (iOffsetStart != 0x00)
+}
+/*****************************************************************************/
+void UndoOpen (int iLevel)
+/*****************************************************************************/
+{
+	/* Starts a step of iLevel. Steps of iLevel that were undone can then no
+	 * longer be redone.
+	 */
+
+	struct undo *step;
+
+	if (iUndoSteps - iUndoOldest == UNDO_STEPS) { UndoDrop(); }
+	iUndoOpen = iUndoSteps;
+	iUndoSteps++;
+	step = &arUndo[iUndoOpen % UNDO_STEPS];
+	step->iLevel = iLevel;
+	step->iFirst = iUndoDeltas;
+	step->iLast = iUndoDeltas;
+	step->iPrev = -1;
+	step->iNext = -1;
+	if (UndoValid (arUndoDone[iLevel]) == 1)
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", 0x8A);
-		write (iFd, sToWrite, 1);
+		step->iPrev = arUndoDone[iLevel];
+		arUndo[step->iPrev % UNDO_STEPS].iNext = iUndoOpen;
 	}
+	arUndoDone[iLevel] = iUndoOpen;
+	arUndoRedo[iLevel] = -1;
+}
+/*****************************************************************************/
+void UndoRecord (void)
+/*****************************************************************************/
+{
+	/* Compares the current level with how it was, and adds a delta for
+	 * every byte that was changed. Within one step, a byte that changes
+	 * again updates its existing delta instead (found through arUndoSlot[]),
+	 * so that dragging, holding plus/minus, Sprinkle(), ClearRoom() or
+	 * FlipRoom() are undone at once.
+	 * The level is only edited in ~50 places, but read in ~300; comparing
+	 * its 3 KB is cheap, and cannot miss an edit that a call would.
+	 */
 
-	/*** [Undo] Set the starting level. ***/
-	switch (iHomeComputer)
+	unsigned char *sNow;
+	unsigned char *sWas;
+	struct undo *step;
+	int iDelta;
+
+	/*** Used for looping. ***/
+	int iByteLoop;
+
+	if (memcmp (&arUndoShadow[iCurLevel], &arLevels[iCurLevel],
+		sizeof (struct level)) == 0) { return; }
+
+	if ((iUndoOpen != -1) &&
+		(arUndo[iUndoOpen % UNDO_STEPS].iLevel != iCurLevel))
+		{ iUndoOpen = -1; }
+	if (iUndoOpen == -1) { UndoOpen (iCurLevel); }
+	step = &arUndo[iUndoOpen % UNDO_STEPS];
+
+	sNow = (unsigned char *)&arLevels[iCurLevel];
+	sWas = (unsigned char *)&arUndoShadow[iCurLevel];
+	for (iByteLoop = 0; iByteLoop < (int)sizeof (struct level); iByteLoop++)
 	{
-		case 1: iOffsetStart = ulStartLevelA[iDiskImageA]; break;
-		case 2: iOffsetStart = ulStartLevelB[iDiskImageB]; break;
-		case 3: iOffsetStart = ulStartLevelC[iDiskImageC]; break;
-		default: printf ("[FAILED] iHomeComputer!\n"); exit (EXIT_ERROR); break;
+		if (sNow[iByteLoop] == sWas[iByteLoop]) { continue; }
+
+		/*** Only one delta per byte can be in this step. ***/
+		iDelta = arUndoSlot[iByteLoop];
+		if ((iDelta >= step->iFirst) && (iDelta < step->iLast) &&
+			(arUndoIndex[iDelta % UNDO_DELTAS] == iByteLoop))
+		{
+			arUndoNew[iDelta % UNDO_DELTAS] = sNow[iByteLoop];
+		} else {
+			/*** Full; this never drops the open step itself. ***/
+			if (iUndoDeltas - iUndoOldestDelta == UNDO_DELTAS) { UndoDrop(); }
+			iDelta = iUndoDeltas;
+			iUndoDeltas++;
+			arUndoIndex[iDelta % UNDO_DELTAS] = iByteLoop;
+			arUndoOld[iDelta % UNDO_DELTAS] = sWas[iByteLoop];
+			arUndoNew[iDelta % UNDO_DELTAS] = sNow[iByteLoop];
+			arUndoSlot[iByteLoop] = iDelta;
+			step->iLast = iUndoDeltas;
+		}
+		sWas[iByteLoop] = sNow[iByteLoop];
 	}
-	if (iOffsetStart != 0x00)
+}
+/*****************************************************************************/
+void UndoStep (void)
+/*****************************************************************************/
+{
+	/*** Called for every key press and button press. ***/
+	UndoRecord();
+	iUndoOpen = -1;
+}
+/*****************************************************************************/
+void UndoApply (int iLevel, int iDelta, int iRedo)
+/*****************************************************************************/
+{
+	unsigned char cValue;
+	int iByte;
+
+	iByte = arUndoIndex[iDelta % UNDO_DELTAS];
+	if (iRedo == 1) { cValue = arUndoNew[iDelta % UNDO_DELTAS]; }
+		else { cValue = arUndoOld[iDelta % UNDO_DELTAS]; }
+	((unsigned char *)&arLevels[iLevel])[iByte] = cValue;
+
+	/*** Keep the shadow in sync, so that this is not recorded again. ***/
+	((unsigned char *)&arUndoShadow[iLevel])[iByte] = cValue;
+}
+/*****************************************************************************/
+void UndoRedo (int iRedo)
+/*****************************************************************************/
+{
+	/*** Undoes or redoes a step of the current level. ***/
+
+	struct undo *step;
+	int iStep;
+
+	/*** Used for looping. ***/
+	int iDeltaLoop;
+
+	UndoStep();
+
+	if (iRedo == 1)
+	{
+		iStep = arUndoRedo[iCurLevel];
+		if (UndoValid (iStep) == 0) { return; }
+		step = &arUndo[iStep % UNDO_STEPS];
+		for (iDeltaLoop = step->iFirst; iDeltaLoop < step->iLast; iDeltaLoop++)
+			{ UndoApply (iCurLevel, iDeltaLoop, 1); }
+		arUndoDone[iCurLevel] = iStep;
+		arUndoRedo[iCurLevel] = step->iNext;
+	} else {
+		iStep = arUndoDone[iCurLevel];
+		if (UndoValid (iStep) == 0) { return; }
+		step = &arUndo[iStep % UNDO_STEPS];
+		for (iDeltaLoop = step->iLast - 1; iDeltaLoop >= step->iFirst;
+			iDeltaLoop--)
+			{ UndoApply (iCurLevel, iDeltaLoop, 0); }
+		arUndoDone[iCurLevel] = step->iPrev;
+		arUndoRedo[iCurLevel] = iStep;
+	}
+
+	if (iScreen != 2)
+		{ arBrokenRoomLinks[iCurLevel] = BrokenRoomLinks (iCurLevel, 0); }
+	LevelChanged();
+	PlaySound ("wav/extras.wav");
+}
+/*****************************************************************************/
+void LevelType (int iLevel)
+/*****************************************************************************/
+{
+	/*** Set cCurType and iCurGuard. ***/
+	switch (iEXEEnv1[iLevel])
 	{
-		lseek (iFd, iOffsetStart, SEEK_SET);
-		snprintf (sToWrite, MAX_TOWRITE, "%c", 0x01);
-		write (iFd, sToWrite, 1);
+		case 0x00: case 0x02: cCurType = 'd'; break;
+		case 0x01: cCurType = 'p'; break;
 	}
+	iCurGuard = iEXEGuardS[iLevel];
+}
+/*****************************************************************************/
+void LevelPristine (int iLevel, int iRestore)
+/*****************************************************************************/
+{
+	/*** Remembers (0) or restores (1) iLevel as it is on disk. ***/
 
-	close (iFd);
+	if (iRestore == 1)
+	{
+		memcpy (&arLevels[iLevel], &arPristine[iLevel], sizeof (struct level));
+	} else {
+		memcpy (&arPristine[iLevel], &arLevels[iLevel], sizeof (struct level));
+	}
+}
+/*****************************************************************************/
+void DiscardChanges (int iAtLevel)
+/*****************************************************************************/
+{
+	/*** Like LoadLevels(), but without reading the disk image again. ***/
 
-	iModified = 0;
+	/*** Used for looping. ***/
+	int iLevelLoop;
+
+	for (iLevelLoop = 1; iLevelLoop <= LEVELS; iLevelLoop++)
+	{
+		if (arLevelChanged[iLevelLoop] == 1)
+		{
+			LevelPristine (iLevelLoop, 1);
+			arLevelChanged[iLevelLoop] = 0;
+			UndoForget (iLevelLoop);
+			arBrokenRoomLinks[iLevelLoop] = BrokenRoomLinks (iLevelLoop, 0);
+		}
+	}
+	iChanged = 0;
+
+	/*** Unsaved EXE edits go too; LevelType() uses iEXEEnv1[]. ***/
+	EXELoad();
+	LevelType (iAtLevel);
+	arBrokenRoomLinks[iAtLevel] = BrokenRoomLinks (iAtLevel, 0);
 }
 /*****************************************************************************/